@@ -80,6 +80,10 @@ using namespace tpch;
         sum(increase(decrease($"l_extendedprice", $"l_discount"), $"l_tax")),
         avg($"l_quantity"), avg($"l_extendedprice"), avg($"l_discount"), count($"l_quantity"))
       .sort($"l_returnflag", $"l_linestatus")
+
+with a second argument of "D", the query groups on the codes of the two flags in the lineitem
+dictionary, loaded by tpchDataLoader with whetherToLoadLineItemDictionary, and only the printed
+results are turned back into strings
 */
 
 
@@ -92,6 +96,13 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    bool whetherToUseDictionary = false;
+    if (argc > 2) {
+        if (strcmp(argv[2], "D") == 0) {
+            whetherToUseDictionary = true;
+        }
+    }
+
 
     // Connection info
     string managerHostname = "localhost";
@@ -109,13 +120,21 @@ int main(int argc, char* argv[]) {
         pdbClient.registerType ("libraries/libQ01AggOut.so");
         pdbClient.registerType ("libraries/libQ01KeyClass.so");
         pdbClient.registerType ("libraries/libQ01ValueClass.so");    
+        pdbClient.registerType ("libraries/libQ01EncodedAgg.so");
+        pdbClient.registerType ("libraries/libQ01EncodedAggOut.so");
+        pdbClient.registerType ("libraries/libQ01EncodedKey.so");
     }    
 
 
     // now, create the sets for storing TPCHCustomer Data
     pdbClient.removeSet("tpch", "q01_output_set");
-    if (!pdbClient.createSet<Q01AggOut>(
-            "tpch", "q01_output_set")) {
+    bool created = false;
+    if (whetherToUseDictionary) {
+        created = pdbClient.createSet<Q01EncodedAggOut>("tpch", "q01_output_set");
+    } else {
+        created = pdbClient.createSet<Q01AggOut>("tpch", "q01_output_set");
+    }
+    if (!created) {
         cout << "Not able to create set.";
         exit(-1);
     } else {
@@ -125,10 +144,32 @@ int main(int argc, char* argv[]) {
     // for allocations
     const UseTemporaryAllocationBlock tempBlock{1024 * 1024 * 256};
 
+    // the dictionary is copied out of the pages of its set, which go away as we iterate
+    Handle<StringDictionary> dictionary = nullptr;
+    if (whetherToUseDictionary) {
+        SetIterator<StringDictionary> dictionaries =
+            pdbClient.getSetIterator<StringDictionary>("tpch", "lineitem_dictionary");
+        for (auto a : dictionaries) {
+            dictionary = deepCopyToCurrentAllocationBlock<StringDictionary>(a);
+        }
+        if (dictionary == nullptr) {
+            cout << "The lineitem dictionary is missing, load it with tpchDataLoader.\n";
+            exit(-1);
+        }
+        pdbClient.addBroadcastVariable(Q01_DICTIONARY, dictionary);
+    }
+
     // make the query graph
     Handle<Computation> myTPCHLineItemScanner = makeObject<ScanUserSet<TPCHLineItem>>("tpch", "lineitem");
-    Handle<Computation> myQ01Agg = makeObject<Q01Agg>();
-    Handle<Computation> myQ01Writer = makeObject<WriteUserSet<Q01AggOut>> ("tpch", "q01_output_set");
+    Handle<Computation> myQ01Agg = nullptr;
+    Handle<Computation> myQ01Writer = nullptr;
+    if (whetherToUseDictionary) {
+        myQ01Agg = makeObject<Q01EncodedAgg>();
+        myQ01Writer = makeObject<WriteUserSet<Q01EncodedAggOut>> ("tpch", "q01_output_set");
+    } else {
+        myQ01Agg = makeObject<Q01Agg>();
+        myQ01Writer = makeObject<WriteUserSet<Q01AggOut>> ("tpch", "q01_output_set");
+    }
 
     myQ01Agg->setInput(myTPCHLineItemScanner);
     myQ01Writer->setInput(myQ01Agg);
@@ -156,20 +197,37 @@ int main(int argc, char* argv[]) {
     std::cout << "to print result..." << std::endl;
 
 
-    SetIterator<Q01AggOut> result =
-            pdbClient.getSetIterator<Q01AggOut>("tpch", "q01_output_set");
-
-    std::cout << "Query results: ";
-    int count = 0;
-    for (auto a : result) {
-        Q01ValueClass r = a->getValue();
+    auto printValue = [](Q01ValueClass& r) {
         std::cout << "sum_qty=" << r.sum_qty << ", sum_base_price=" << r.sum_base_price << ", sum_disc_price=" << r.sum_disc_price 
             << ", sum_charge=" << r.sum_charge << ", sum_disc=" << r.sum_disc << ", avg_qty=" << r.getAvgQty()
             << ", avg_price=" << r.getAvgPrice() << ", avg_disc=" << r.getAvgDiscount() << std::endl;
-        count++;
+    };
+
+    std::cout << "Query results: ";
+    int count = 0;
+    if (whetherToUseDictionary) {
+        SetIterator<Q01EncodedAggOut> result =
+                pdbClient.getSetIterator<Q01EncodedAggOut>("tpch", "q01_output_set");
+        for (auto a : result) {
+            Q01EncodedKey& key = a->getKey();
+            std::cout << "l_returnflag=" << dictionary->decode(key.l_returnflag)
+                      << ", l_linestatus=" << dictionary->decode(key.l_linestatus) << ", ";
+            printValue(a->getValue());
+            count++;
+        }
+    } else {
+        SetIterator<Q01AggOut> result =
+                pdbClient.getSetIterator<Q01AggOut>("tpch", "q01_output_set");
+        for (auto a : result) {
+            printValue(a->getValue());
+            count++;
+        }
     }
     std::cout << "Output count:" << count << "\n";
     std::cout << "#TimeDuration for query execution: " << timeDifference << " Second " << std::endl;
+    std::cout << "#StageStats shuffledBytes=" << pdbClient.getShuffledBytes()
+              << " peakSharedMemory=" << pdbClient.getPeakSharedMemoryBytes()
+              << " peakQueryMemory=" << pdbClient.getPeakMemoryBytes() << std::endl;
 
     // Remove the output set
     if (!pdbClient.removeSet("tpch", "q01_output_set")) {
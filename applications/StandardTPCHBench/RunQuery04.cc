@@ -178,6 +178,9 @@ int main(int argc, char* argv[]) {
     }
     std::cout << "Output count:" << count << "\n";
     std::cout << "#TimeDuration for query execution: " << timeDifference << " Second " << std::endl;
+    std::cout << "#StageStats shuffledBytes=" << pdbClient.getShuffledBytes()
+              << " peakSharedMemory=" << pdbClient.getPeakSharedMemoryBytes()
+              << " peakQueryMemory=" << pdbClient.getPeakMemoryBytes() << std::endl;
 
     // Remove the output set
     if (!pdbClient.removeSet("tpch", "q04_output_set")) {
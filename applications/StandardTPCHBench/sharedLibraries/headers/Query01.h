@@ -40,6 +40,7 @@
 #include "SelectionComp.h"
 #include "JoinComp.h"
 #include "AggregateComp.h"
+#include "DictionaryEncoder.h"
 
 
 using namespace pdb;
@@ -184,6 +185,97 @@ public:
 
 };
 
+
+// the name of the broadcast variable holding the dictionary of l_returnflag and l_linestatus
+#define Q01_DICTIONARY "q01_lineitem_dictionary"
+
+// the key of Q01 with the two flags replaced by their codes in the lineitem dictionary, so it is
+// flat, and hashing and shuffling it never touches a string
+class Q01EncodedKey : public Object {
+
+public:
+
+    int32_t l_returnflag;
+    int32_t l_linestatus;
+
+    ENABLE_DEEP_COPY
+
+    Q01EncodedKey () {}
+
+    Q01EncodedKey (int32_t l_returnflag, int32_t l_linestatus) {
+        this->l_returnflag = l_returnflag;
+        this->l_linestatus = l_linestatus;
+    }
+
+    size_t hash() const {
+        return (((size_t)(uint32_t)l_returnflag) << 32) ^ (size_t)(uint32_t)l_linestatus;
+    }
+
+    bool operator==(const Q01EncodedKey& toMe) {
+        return l_returnflag == toMe.l_returnflag && l_linestatus == toMe.l_linestatus;
+    }
+
+};
+
+class Q01EncodedAggOut : public Object {
+
+public:
+
+    Q01EncodedKey key;
+
+    Q01ValueClass value;
+
+    ENABLE_DEEP_COPY
+
+    Q01EncodedAggOut() {};
+
+    Q01EncodedKey & getKey() {
+       return this->key;
+    }
+
+    Q01ValueClass & getValue() {
+       return this->value;
+    }
+
+};
+
+// Q01 grouping on the codes of the flags, the dictionary is read from the broadcast variable
+// Q01_DICTIONARY, and the codes are turned back into strings when the output is printed
+class Q01EncodedAgg : public AggregateComp<Q01EncodedAggOut,
+                                           TPCHLineItem,
+                                           Q01EncodedKey,
+                                           Q01ValueClass> {
+
+public:
+
+    ENABLE_DEEP_COPY
+
+    Q01EncodedAgg () {}
+
+    // a worker does not run this computation without the dictionary
+    void getRequiredBroadcastVariables(std::vector<std::string>& names) override {
+        names.push_back(Q01_DICTIONARY);
+    }
+
+    // the encoder is made once, when the pipeline is built, and a flag the dictionary does not
+    // know fails the query instead of sharing a group with other unknown flags
+    Lambda<Q01EncodedKey> getKeyProjection(Handle<TPCHLineItem> aggMe) override {
+         DictionaryEncoder encoder(getBroadcastVariable<StringDictionary>(Q01_DICTIONARY));
+         return makeLambda(aggMe, [encoder](Handle<TPCHLineItem>& aggMe) {
+              Q01EncodedKey key (encoder(aggMe->l_returnflag), encoder(aggMe->l_linestatus));
+              return key;
+         });
+    }
+
+    Lambda<Q01ValueClass> getValueProjection (Handle<TPCHLineItem> aggMe) override {
+         return makeLambda(aggMe, [](Handle<TPCHLineItem>& aggMe) {
+             Q01ValueClass ret(*aggMe);
+             return ret;
+         });
+    }
+
+};
+
 }
 
 #endif
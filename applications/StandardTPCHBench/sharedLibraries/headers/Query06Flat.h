@@ -0,0 +1,114 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+#ifndef QUERY06_FLAT_H
+#define QUERY06_FLAT_H
+
+
+#include "TPCHFlatSchema.h"
+#include "Lambda.h"
+#include "LambdaCreationFunctions.h"
+#include "AggregateComp.h"
+#include "DoubleSumResult.h"
+
+using namespace pdb;
+
+namespace tpch {
+
+
+// Query 6 over the flat lineitem set: the input is a whole block of rows, so the selection
+// runs inside the value projection, as a single pass over the rows of the block
+
+class Q06FlatAgg : public AggregateComp<DoubleSumResult,
+                                        TPCHLineItemBlock,
+                                        int,
+                                        double> {
+
+public:
+
+    ENABLE_DEEP_COPY
+
+
+    Q06FlatAgg () {}
+
+    Lambda<int> getKeyProjection(Handle<TPCHLineItemBlock> aggMe) override {
+         return makeLambda(aggMe, [](Handle<TPCHLineItemBlock>& aggMe) { return 0; });
+    }
+
+    Lambda<double> getValueProjection (Handle<TPCHLineItemBlock> aggMe) override {
+         return makeLambda(aggMe, [](Handle<TPCHLineItemBlock>& aggMe) {
+             double revenue = 0;
+             for (const TPCHLineItemRow& me : *aggMe) {
+                 if ((me.l_shipdate >= "1994-01-01") &&
+                     (me.l_shipdate < "1995-10-01") &&
+                     (me.l_discount >= 0.05) && (me.l_discount <= 0.07) &&
+                     (me.l_quantity < 24)) {
+                     revenue += me.l_extendedprice * me.l_discount;
+                 }
+             }
+             return revenue;
+         });
+    }
+
+
+};
+
+
+// the same over the columnar lineitem set: only the four columns the query needs are read
+
+class Q06ColumnarAgg : public AggregateComp<DoubleSumResult,
+                                            TPCHLineItemColumns,
+                                            int,
+                                            double> {
+
+public:
+
+    ENABLE_DEEP_COPY
+
+
+    Q06ColumnarAgg () {}
+
+    Lambda<int> getKeyProjection(Handle<TPCHLineItemColumns> aggMe) override {
+         return makeLambda(aggMe, [](Handle<TPCHLineItemColumns>& aggMe) { return 0; });
+    }
+
+    Lambda<double> getValueProjection (Handle<TPCHLineItemColumns> aggMe) override {
+         return makeLambda(aggMe, [](Handle<TPCHLineItemColumns>& aggMe) {
+             const FixedString<10>* shipdate = aggMe->getColumn(&TPCHLineItemRow::l_shipdate);
+             const double* discount = aggMe->getColumn(&TPCHLineItemRow::l_discount);
+             const double* quantity = aggMe->getColumn(&TPCHLineItemRow::l_quantity);
+             const double* extendedprice = aggMe->getColumn(&TPCHLineItemRow::l_extendedprice);
+             double revenue = 0;
+             for (size_t i = 0; i < aggMe->size(); i++) {
+                 if ((discount[i] >= 0.05) && (discount[i] <= 0.07) &&
+                     (quantity[i] < 24) &&
+                     (shipdate[i] >= "1994-01-01") &&
+                     (shipdate[i] < "1995-10-01")) {
+                     revenue += extendedprice[i] * discount[i];
+                 }
+             }
+             return revenue;
+         });
+    }
+
+
+};
+
+
+}
+
+#endif
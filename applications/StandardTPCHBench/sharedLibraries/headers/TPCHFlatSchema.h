@@ -0,0 +1,128 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+#ifndef TPCH_FLAT_SCHEMA_H
+#define TPCH_FLAT_SCHEMA_H
+
+#include <string>
+
+#include "FixedString.h"
+#include "FlatRowBlock.h"
+#include "ColumnarBlock.h"
+
+// this file describes flat versions of the TPCH records, for the sets that are stored as blocks
+// of rows (see FlatRowBlock.h) or of columns (see ColumnarBlock.h); the string fields are sized
+// after the TPCH specification
+
+using namespace pdb;
+
+namespace tpch {
+
+struct TPCHLineItemRow {
+
+   int l_orderkey;
+   int l_partkey;
+   int l_suppkey;
+   int l_linenumber;
+   double l_quantity;
+   double l_extendedprice;
+   double l_discount;
+   double l_tax;
+   FixedString<1> l_returnflag;
+   FixedString<1> l_linestatus;
+   FixedString<10> l_shipdate;
+   FixedString<10> l_commitdate;
+   FixedString<10> l_receiptdate;
+   FixedString<25> l_shipinstruct;
+   FixedString<10> l_shipmode;
+   FixedString<44> l_comment;
+
+   TPCHLineItemRow () {}
+
+   TPCHLineItemRow (int l_orderkey, int l_partkey, int l_suppkey, int l_linenumber,
+       double l_quantity, double l_extendedprice, double l_discount, double l_tax,
+       std::string l_returnflag, std::string l_linestatus, std::string l_shipdate, std::string l_commitdate,
+       std::string l_receiptdate, std::string l_shipinstruct, std::string l_shipmode, std::string l_comment) {
+        this->l_orderkey = l_orderkey;
+        this->l_partkey = l_partkey;
+        this->l_suppkey = l_suppkey;
+        this->l_linenumber = l_linenumber;
+        this->l_quantity = l_quantity;
+        this->l_extendedprice = l_extendedprice;
+        this->l_discount = l_discount;
+        this->l_tax = l_tax;
+        this->l_returnflag = l_returnflag;
+        this->l_linestatus = l_linestatus;
+        this->l_shipdate = l_shipdate;
+        this->l_commitdate = l_commitdate;
+        this->l_receiptdate = l_receiptdate;
+        this->l_shipinstruct = l_shipinstruct;
+        this->l_shipmode = l_shipmode;
+        this->l_comment = l_comment;
+   }
+
+   static void describeColumns(ColumnSchema<TPCHLineItemRow>& schema) {
+        schema.add("l_orderkey", &TPCHLineItemRow::l_orderkey);
+        schema.add("l_partkey", &TPCHLineItemRow::l_partkey);
+        schema.add("l_suppkey", &TPCHLineItemRow::l_suppkey);
+        schema.add("l_linenumber", &TPCHLineItemRow::l_linenumber);
+        schema.add("l_quantity", &TPCHLineItemRow::l_quantity);
+        schema.add("l_extendedprice", &TPCHLineItemRow::l_extendedprice);
+        schema.add("l_discount", &TPCHLineItemRow::l_discount);
+        schema.add("l_tax", &TPCHLineItemRow::l_tax);
+        schema.add("l_returnflag", &TPCHLineItemRow::l_returnflag);
+        schema.add("l_linestatus", &TPCHLineItemRow::l_linestatus);
+        schema.add("l_shipdate", &TPCHLineItemRow::l_shipdate);
+        schema.add("l_commitdate", &TPCHLineItemRow::l_commitdate);
+        schema.add("l_receiptdate", &TPCHLineItemRow::l_receiptdate);
+        schema.add("l_shipinstruct", &TPCHLineItemRow::l_shipinstruct);
+        schema.add("l_shipmode", &TPCHLineItemRow::l_shipmode);
+        schema.add("l_comment", &TPCHLineItemRow::l_comment);
+   }
+
+};
+
+
+class TPCHLineItemBlock : public FlatRowBlock<TPCHLineItemRow> {
+
+public:
+
+   ENABLE_DEEP_COPY
+
+   TPCHLineItemBlock () {}
+
+   TPCHLineItemBlock (uint32_t numRows) : FlatRowBlock<TPCHLineItemRow>(numRows) {}
+
+};
+
+
+class TPCHLineItemColumns : public ColumnarBlock<TPCHLineItemRow> {
+
+public:
+
+   ENABLE_DEEP_COPY
+
+   TPCHLineItemColumns () {}
+
+   TPCHLineItemColumns (uint32_t numRows) : ColumnarBlock<TPCHLineItemRow>(numRows) {}
+
+};
+
+
+}
+
+#endif
@@ -25,6 +25,7 @@
 #include <cstring>
 #include <fstream>
 #include <map>
+#include <set>
 #include <chrono>
 #include <sstream>
 #include <vector>
@@ -56,6 +57,7 @@
 #include "QueryOutput.h"
 #include "DataTypes.h"
 #include "TPCHSchema.h"
+#include "TPCHFlatSchema.h"
 #include "Query01.h"
 
 #include <ctime>
@@ -75,6 +77,13 @@ using namespace tpch;
 
 #define BLOCKSIZE (256 * MB)
 
+// the number of rows in each block of the flat lineitem set
+#define FLAT_ROWS_PER_BLOCK 4096
+
+// the number of rows in each block of the columnar lineitem set, every block keeps the minimum
+// and maximum of each column, so smaller blocks let more of them be told apart
+#define COLUMNAR_ROWS_PER_BLOCK 16384
+
 
 // A function to parse a Line
 std::vector<std::string> parseLine(std::string line) {
@@ -175,6 +184,8 @@ void registerLibraries (PDBClient & pdbClient) {
 
     pdbClient.registerType ("libraries/libTPCHCustomer.so");
     pdbClient.registerType ("libraries/libTPCHLineItem.so");
+    pdbClient.registerType ("libraries/libTPCHLineItemBlock.so");
+    pdbClient.registerType ("libraries/libTPCHLineItemColumns.so");
     pdbClient.registerType ("libraries/libTPCHNation.so");
     pdbClient.registerType ("libraries/libTPCHOrder.so");
     pdbClient.registerType ("libraries/libTPCHPart.so");
@@ -190,6 +201,9 @@ void registerLibraries (PDBClient & pdbClient) {
        pdbClient.registerType ("libraries/libQ01AggOut.so");
        pdbClient.registerType ("libraries/libQ01KeyClass.so");
        pdbClient.registerType ("libraries/libQ01ValueClass.so");
+       pdbClient.registerType ("libraries/libQ01EncodedAgg.so");
+       pdbClient.registerType ("libraries/libQ01EncodedAggOut.so");
+       pdbClient.registerType ("libraries/libQ01EncodedKey.so");
 
     }
 
@@ -247,6 +261,8 @@ void registerLibraries (PDBClient & pdbClient) {
 
         pdbClient.registerType ("libraries/libQ06Agg.so");
         pdbClient.registerType ("libraries/libQ06TPCHLineItemSelection.so");
+        pdbClient.registerType ("libraries/libQ06FlatAgg.so");
+        pdbClient.registerType ("libraries/libQ06ColumnarAgg.so");
 
     }
 
@@ -351,6 +367,31 @@ void createSets (PDBClient & pdbClient) {
 
 }
 
+void createFlatSets (PDBClient & pdbClient, bool rows, bool columns) {
+
+    pdbClient.createDatabase("tpch");
+    if (rows) {
+        pdbClient.removeSet("tpch", "lineitem_flat");
+        std::cout << "to create set for TPCHLineItemBlock" << std::endl;
+        pdbClient.createSet<TPCHLineItemBlock>("tpch", "lineitem_flat", (size_t)64*(size_t)1024*(size_t)1024);
+    }
+    if (columns) {
+        pdbClient.removeSet("tpch", "lineitem_columnar");
+        std::cout << "to create set for TPCHLineItemColumns" << std::endl;
+        pdbClient.createSet<TPCHLineItemColumns>("tpch", "lineitem_columnar", (size_t)64*(size_t)1024*(size_t)1024);
+    }
+
+}
+
+void createDictionarySet (PDBClient & pdbClient) {
+
+    pdbClient.createDatabase("tpch");
+    pdbClient.removeSet("tpch", "lineitem_dictionary");
+    std::cout << "to create set for StringDictionary" << std::endl;
+    pdbClient.createSet<StringDictionary>("tpch", "lineitem_dictionary");
+
+}
+
 void removeSets (PDBClient & pdbClient) {
 
     pdbClient.removeSet("tpch", "customer");
@@ -361,6 +402,9 @@ void removeSets (PDBClient & pdbClient) {
     pdbClient.removeSet("tpch", "partsupp");
     pdbClient.removeSet("tpch", "region");
     pdbClient.removeSet("tpch", "supplier");
+    pdbClient.removeSet("tpch", "lineitem_flat");
+    pdbClient.removeSet("tpch", "lineitem_columnar");
+    pdbClient.removeSet("tpch", "lineitem_dictionary");
 
 }
 
@@ -484,6 +528,111 @@ void loadData(PDBClient & pdbClient, std::string fileName, std::string dataType)
 }
 
 
+// loads the lineitem table as blocks of flat rows, BlockType is TPCHLineItemBlock or TPCHLineItemColumns
+template <class BlockType>
+void loadLineItemBlocks(PDBClient & pdbClient, std::string fileName, std::string setName, size_t rowsPerBlock) {
+
+    std::cout << "to load data from " << fileName << " for set " << setName << std::endl;
+    std::string line;
+    std::ifstream infile;
+    infile.open(fileName.c_str());
+    if (infile.good() == false) {
+        cout << "file: " << fileName.c_str() << ", can't be open! "  << endl;
+        exit(-1);
+    }
+
+    // the rows of the next block, we only move them to a block once we have them all, so that
+    // running out of space simply means sending what we have and retrying the same rows
+    std::vector<TPCHLineItemRow> rows;
+    rows.reserve(rowsPerBlock);
+    int numRows = 0;
+    bool end = false;
+    while (!end) {
+        makeObjectAllocatorBlock((size_t)BLOCKSIZE, true);
+        Handle<Vector<Handle<BlockType>>> blocks = makeObject<Vector<Handle<BlockType>>>();
+        try {
+            while (1) {
+                if (rows.empty()) {
+                    while (rows.size() < rowsPerBlock && std::getline(infile, line)) {
+                        std::vector<std::string> tokens = parseLine(line);
+                        rows.push_back(TPCHLineItemRow(atoi(tokens.at(0).c_str()),
+                                                       atoi(tokens.at(1).c_str()),
+                                                       atoi(tokens.at(2).c_str()),
+                                                       atoi(tokens.at(3).c_str()),
+                                                       atof(tokens.at(4).c_str()),
+                                                       atof(tokens.at(5).c_str()),
+                                                       atof(tokens.at(6).c_str()),
+                                                       atof(tokens.at(7).c_str()),
+                                                       tokens.at(8),
+                                                       tokens.at(9),
+                                                       tokens.at(10),
+                                                       tokens.at(11),
+                                                       tokens.at(12),
+                                                       tokens.at(13),
+                                                       tokens.at(14),
+                                                       tokens.at(15)));
+                    }
+                    if (rows.empty()) {
+                        end = true;
+                        break;
+                    }
+                }
+                Handle<BlockType> block = makeObject<BlockType>(rows.size());
+                for (const TPCHLineItemRow& row : rows) {
+                    block->push_back(row);
+                }
+                blocks->push_back(block);
+                numRows += rows.size();
+                rows.clear();
+            }
+        } catch (NotEnoughSpace & n) {
+        }
+        if (blocks->size() > 0) {
+            std::cout << "to send vector with " << blocks->size() << std::endl;
+            pdbClient.sendData<BlockType> (
+                std::pair<std::string, std::string>(setName, "tpch"), blocks);
+        }
+    }
+    std::cout << "sent " << numRows << " TPCHLineItem rows" << std::endl;
+    infile.close();
+}
+
+
+// builds the dictionary of the low-cardinality string attributes of lineitem that queries group
+// on, l_returnflag and l_linestatus, and stores it as the only object of its own set
+void loadLineItemDictionary(PDBClient & pdbClient, std::string fileName) {
+
+    std::cout << "to build the lineitem dictionary from " << fileName << std::endl;
+    std::string line;
+    std::ifstream infile;
+    infile.open(fileName.c_str());
+    if (infile.good() == false) {
+        cout << "file: " << fileName.c_str() << ", can't be open! "  << endl;
+        exit(-1);
+    }
+
+    // the distinct values are found first, so that codes follow the sort order of the strings
+    std::set<std::string> values;
+    while (std::getline(infile, line)) {
+        std::vector<std::string> tokens = parseLine(line);
+        values.insert(tokens.at(8));
+        values.insert(tokens.at(9));
+    }
+    infile.close();
+
+    const UseTemporaryAllocationBlock tempBlock{1024 * 1024};
+    Handle<StringDictionary> dictionary = makeObject<StringDictionary>();
+    for (const std::string& value : values) {
+        dictionary->encode(String(value));
+    }
+    Handle<Vector<Handle<StringDictionary>>> dictionaries = makeObject<Vector<Handle<StringDictionary>>>();
+    dictionaries->push_back(dictionary);
+    pdbClient.sendData<StringDictionary> (
+        std::pair<std::string, std::string>("lineitem_dictionary", "tpch"), dictionaries);
+    std::cout << "sent a dictionary of " << dictionary->size() << " lineitem flags" << std::endl;
+}
+
+
 int main(int argc, char* argv[]) {
 
     std::string tpchDirectory = "";
@@ -519,10 +668,33 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    if ((argc > 6) || (argc == 1)) {
+    bool whetherToLoadFlatLineItem = false;
+    if (argc > 6) {
+        if (strcmp(argv[6], "Y") == 0) {
+           whetherToLoadFlatLineItem = true;
+        }
+    }
+
+    bool whetherToLoadColumnarLineItem = false;
+    if (argc > 7) {
+        if (strcmp(argv[7], "Y") == 0) {
+           whetherToLoadColumnarLineItem = true;
+        }
+    }
+
+    bool whetherToLoadLineItemDictionary = false;
+    if (argc > 8) {
+        if (strcmp(argv[8], "Y") == 0) {
+           whetherToLoadLineItemDictionary = true;
+        }
+    }
+
+    if ((argc > 9) || (argc == 1)) {
        std::cout << "Usage: #tpchDirectory #whetherToRegisterLibraries (Y/N)" 
                  << " #whetherToCreateSets (Y/N) #whetherToAddData (Y/N)"
-                 << " #whetherToRemoveData (Y/N)" << std::endl;
+                 << " #whetherToRemoveData (Y/N) #whetherToLoadFlatLineItem (Y/N)"
+                 << " #whetherToLoadColumnarLineItem (Y/N)"
+                 << " #whetherToLoadLineItemDictionary (Y/N)" << std::endl;
     }
 
     // Connection info
@@ -546,6 +718,10 @@ int main(int argc, char* argv[]) {
 
     if (whetherToCreateSets == true) {
         createSets (pdbClient);
+        createFlatSets (pdbClient, whetherToLoadFlatLineItem, whetherToLoadColumnarLineItem);
+        if (whetherToLoadLineItemDictionary == true) {
+            createDictionarySet (pdbClient);
+        }
     }
 
     if (whetherToAddData == true) {
@@ -557,6 +733,17 @@ int main(int argc, char* argv[]) {
         loadData(pdbClient, tpchDirectory + "/partsupp.tbl", "TPCHTPCHPartSupp");
         loadData(pdbClient, tpchDirectory + "/region.tbl", "TPCHRegion");
         loadData(pdbClient, tpchDirectory + "/supplier.tbl", "TPCHSupplier");
+        if (whetherToLoadFlatLineItem == true) {
+            loadLineItemBlocks<TPCHLineItemBlock>(
+                pdbClient, tpchDirectory + "/lineitem.tbl", "lineitem_flat", FLAT_ROWS_PER_BLOCK);
+        }
+        if (whetherToLoadColumnarLineItem == true) {
+            loadLineItemBlocks<TPCHLineItemColumns>(
+                pdbClient, tpchDirectory + "/lineitem.tbl", "lineitem_columnar", COLUMNAR_ROWS_PER_BLOCK);
+        }
+        if (whetherToLoadLineItemDictionary == true) {
+            loadLineItemDictionary(pdbClient, tpchDirectory + "/lineitem.tbl");
+        }
 
         std::cout << "to flush data to disk" << std::endl;
         pdbClient.flushData();
@@ -48,7 +48,7 @@ public:
         Handle<Customer> aggMe) override {
         return makeLambda(aggMe, [&](Handle<Customer>& aggMe) {
             Handle<AllParts> myGuy = makeObject<AllParts>();
-            return TopKQueue<double, Handle<AllParts>>(
+            return offer(
                 k, myGuy->fill(partsToCheckFor.c_ptr(), partsToCheckFor.size(), *aggMe), myGuy);
         });
     }
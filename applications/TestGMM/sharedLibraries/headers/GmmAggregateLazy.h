@@ -69,40 +69,56 @@ public:
   // datapoint
   // for each component, and calculate the aggregated sums that will later be
   // used
-  // to update the weights, means and covars
+  // to update the weights, means and covars. The datapoints of a whole
+  // TupleSet are evaluated against each component at once
   Lambda<GmmAggregateOutputLazy>
   getValueProjection(Handle<DoubleVector> aggMe) override {
 
-    return makeLambda(aggMe, [&](Handle<DoubleVector> &aggMe) {
-
-      int k = model->getNumK();
-
-      // Calculate responsabilities per component and normalize
-      // dividing by the total sum totalR
-      Vector<double> r_values(k, k);
-      double *r_valuesptr = r_values.c_ptr();
-
-      for (int i = 0; i < k; i++) {
-        r_valuesptr[i] =
-            model->log_normpdf(i, aggMe) + log(model->getWeight(i));
-      }
-
-      // Now normalize r (in log space)
-      double logLikelihood = model->logSumExp(r_values);
-
-      for (int i = 0; i < k; i++) {
-        r_valuesptr[i] = exp(r_valuesptr[i] - logLikelihood);
-      }
-
-      // GmmAggregateDatapoint contains a pointer to the datapoint
-      // and the responsabilities
-      // The aggregate (sum) of those values is done lazily in the operator+
-      Handle<GmmAggregateDatapoint> aggDatapoint =
-          makeObject<GmmAggregateDatapoint>(*aggMe, r_values, logLikelihood);
-      Handle<GmmAggregateOutputLazy> result =
-          makeObject<GmmAggregateOutputLazy>(aggDatapoint);
-      return *(result);
-    });
+    return makeBatchLambda<GmmAggregateOutputLazy>(
+        aggMe, [this](std::vector<Handle<DoubleVector>> &datapoints,
+                      std::vector<GmmAggregateOutputLazy> &outputs) {
+
+          int k = model->getNumK();
+          size_t numDatapoints = datapoints.size();
+
+          std::vector<double> logWeights(k);
+          for (int i = 0; i < k; i++) {
+            logWeights[i] = log(model->getWeight(i));
+          }
+
+          std::vector<double> logPdfs(numDatapoints * k);
+          model->log_normpdfs(datapoints, logPdfs.data());
+
+          for (size_t p = 0; p < numDatapoints; p++) {
+
+            // Calculate responsabilities per component and normalize
+            // dividing by the total sum totalR
+            Vector<double> r_values(k, k);
+            double *r_valuesptr = r_values.c_ptr();
+
+            for (int i = 0; i < k; i++) {
+              r_valuesptr[i] = logPdfs[p * k + i] + logWeights[i];
+            }
+
+            // Now normalize r (in log space)
+            double logLikelihood = model->logSumExp(r_values);
+
+            for (int i = 0; i < k; i++) {
+              r_valuesptr[i] = exp(r_valuesptr[i] - logLikelihood);
+            }
+
+            // GmmAggregateDatapoint contains a pointer to the datapoint
+            // and the responsabilities
+            // The aggregate (sum) of those values is done lazily in the
+            // operator+
+            Handle<GmmAggregateDatapoint> aggDatapoint =
+                makeObject<GmmAggregateDatapoint>(*datapoints[p], r_values,
+                                                  logLikelihood);
+            Handle<GmmAggregateOutputLazy> result =
+                makeObject<GmmAggregateOutputLazy>(aggDatapoint);
+            outputs[p] = *(result);
+          }
+        });
   }
 };
 
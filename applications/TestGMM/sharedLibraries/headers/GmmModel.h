@@ -18,6 +18,7 @@
 #ifndef GMM_MODEL_H
 #define GMM_MODEL_H
 
+#include "DistanceKernels.h"
 #include "DoubleVector.h"
 #include "GmmAggregateNewComp.h"
 #include "Handle.h"
@@ -220,6 +221,31 @@ public:
     return ay;
   }
 
+  // It calculates log_normpdf for a batch of datapoints and all components,
+  // the result for datapoint p and component i goes to logPdfs[p * k + i].
+  // We go component by component, so that its inverse covariance stays in
+  // cache while we go over the datapoints, and the quadratic form runs on the
+  // vectorized kernels without allocating anything per datapoint
+  void log_normpdfs(std::vector<Handle<DoubleVector>> &inputData,
+                    double *logPdfs) {
+
+    std::vector<double> datan(ndim);
+    for (int i = 0; i < k; i++) {
+      double *mean = (*means)[i]->getRawData();
+      double *inv_covar = (*inv_covars)[i]->getRawData();
+      double ax = dets->getDouble(i);
+      for (size_t p = 0; p < inputData.size(); p++) {
+        double *data = inputData[p]->getRawData();
+        for (int j = 0; j < ndim; j++) {
+          datan[j] = data[j] - mean[j];
+        }
+        double ay = DistanceKernels::quadraticFormUpper(inv_covar, datan.data(),
+                                                        ndim);
+        logPdfs[p * k + i] = -ax - 0.5 * ay;
+      }
+    }
+  }
+
   // It calculates the sum of elements in vector v in log space
   // To do this, we extract the maximum factor (maxVal) from
   // all the values
@@ -376,29 +376,36 @@ int main(int argc, char *argv[]) {
     const UseTemporaryAllocationBlock tempBlock{1024 * 1024 * 24};
 
     /* Read in the model */
-    pdb::Handle<pdb::Vector<Handle<KMeansDoubleVector>>> my_model =
-        pdb::makeObject<pdb::Vector<Handle<KMeansDoubleVector>>>();
+    pdb::Handle<pdb::Vector<KMeansDoubleVector>> my_model =
+        pdb::makeObject<pdb::Vector<KMeansDoubleVector>>();
 
     for (int i = 0; i < k; i++) {
-      Handle<KMeansDoubleVector> tmp = pdb::makeObject<KMeansDoubleVector>();
-      double *rawData = tmp->getRawData();
+      KMeansDoubleVector tmp;
+      double *rawData = tmp.getRawData();
       double norm = 0;
       for (int j = 0; j < NUM_KMEANS_DIMENSIONS; j++) {
         rawData[j] = model[i][j];
         norm += rawData[j] * rawData[j];
       }
-      tmp->norm = norm;
+      tmp.norm = norm;
       my_model->push_back(tmp);
     }
 
-    /* Aggregation for each cluster */
-    Handle<Computation> myScanSet = makeObject<ScanKMeansDoubleVectorSet>(
-        "kmeans_db", "kmeans_norm_vector_set");
-    Handle<Computation> myQuery = pdb::makeObject<KMeansAggregate>(my_model);
-    myQuery->setInput(myScanSet);
-    myQuery->setOutput("kmeans_db", "kmeans_output_set");
+    /* The model is shipped once to every worker, where all threads share it */
+    pdbClient.addBroadcastVariable("kmeans_model", my_model);
 
-    pdbClient.executeComputations(myQuery);
+    /* Aggregation for each cluster, it is sent and planned once, later
+     * iterations only send the new model */
+    if (n == 0) {
+      Handle<Computation> myScanSet = makeObject<ScanKMeansDoubleVectorSet>(
+          "kmeans_db", "kmeans_norm_vector_set");
+      Handle<Computation> myQuery =
+          pdb::makeObject<KMeansAggregate>(std::string("kmeans_model"));
+      myQuery->setInput(myScanSet);
+      myQuery->setOutput("kmeans_db", "kmeans_output_set");
+      pdbClient.prepareComputations("kmeans_iteration", myQuery);
+    }
+    pdbClient.executePreparedComputations("kmeans_iteration");
 
     /* Update the model */
     SetIterator<KMeansAggregateOutputType> result =
@@ -417,7 +424,7 @@ int main(int argc, char *argv[]) {
       KMeansDoubleVector &meanVec = (*a).getValue().getMean();
       KMeansDoubleVector tmpModel = meanVec / count;
       if (converge &&
-          (tmpModel.getFastSquaredDistance((*(*my_model)[kk])) > threshold)) {
+          (tmpModel.getFastSquaredDistance((*my_model)[kk]) > threshold)) {
         converge = false;
       }
       double *rawData = tmpModel.getRawData();
@@ -467,6 +474,8 @@ int main(int argc, char *argv[]) {
                    .count()
             << " secs." << std::endl;
 
+  pdbClient.releasePreparedComputations("kmeans_iteration");
+
   /* Remove the sets */
   if (clusterMode == false) {
     pdbClient.deleteSet("kmeans_db", "kmeans_output_set");
@@ -0,0 +1,167 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef TEST_KMEANS_KERNELS_CC
+#define TEST_KMEANS_KERNELS_CC
+
+/*
+ * Measures how fast KMeansAggregate assigns points to centroids, one point at
+ * a time (computeClusterMemberOptimized) and a TupleSet chunk at a time
+ * (computeClusterMembers), with the scalar and the AVX2/FMA distance kernels.
+ * It runs locally, no cluster is needed.
+ *
+ * Usage: TestKMeansKernels [numPoints] [k] [chunkSize] [numThreads]
+ */
+
+#include "KMeansAggregate.h"
+#include "KMeansDoubleVector.h"
+#include "DistanceKernels.h"
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace pdb;
+
+/* Runs the assignment of all chunks on numThreads threads and returns the seconds it took */
+template <typename Assign>
+double timeAssignment(int numThreads, size_t numChunks, Assign assign) {
+  auto begin = std::chrono::high_resolution_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (size_t chunk = t; chunk < numChunks; chunk += numThreads) {
+        assign(chunk);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::duration<double>>(end - begin).count();
+}
+
+int main(int argc, char *argv[]) {
+
+  size_t numPoints = 20000;
+  int k = 10;
+  size_t chunkSize = 1000;
+  int numThreads = 1;
+  if (argc > 1) {
+    numPoints = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    k = std::stoi(argv[2]);
+  }
+  if (argc > 3) {
+    chunkSize = std::stoul(argv[3]);
+  }
+  if (argc > 4) {
+    numThreads = std::stoi(argv[4]);
+  }
+
+  std::cout << "points: " << numPoints << ", dimensions: " << NUM_KMEANS_DIMENSIONS
+            << ", k: " << k << ", chunk: " << chunkSize << ", threads: " << numThreads
+            << std::endl;
+  std::cout << "AVX2/FMA kernels available: "
+            << (DistanceKernels::isSIMDEnabled() ? "yes" : "no") << std::endl;
+  bool simdAvailable = DistanceKernels::isSIMDEnabled();
+
+  makeObjectAllocatorBlock((numPoints + k + 16) * sizeof(KMeansDoubleVector) * 2, true);
+
+  /* Generate the points and the model */
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  std::vector<Handle<KMeansDoubleVector>> points;
+  for (size_t i = 0; i < numPoints; i++) {
+    Handle<KMeansDoubleVector> point = makeObject<KMeansDoubleVector>();
+    for (int j = 0; j < NUM_KMEANS_DIMENSIONS; j++) {
+      point->rawData[j] = distribution(generator);
+    }
+    point->norm = point->dot(*point);
+    points.push_back(point);
+  }
+  Handle<Vector<Handle<KMeansDoubleVector>>> model =
+      makeObject<Vector<Handle<KMeansDoubleVector>>>();
+  for (int i = 0; i < k; i++) {
+    model->push_back(points[(i * 7919) % numPoints]);
+  }
+  Handle<KMeansAggregate> aggregate = makeObject<KMeansAggregate>(model);
+
+  /* Split the points into chunks up front, the threads only read them */
+  std::vector<std::vector<Handle<KMeansDoubleVector>>> chunks;
+  for (size_t first = 0; first < numPoints; first += chunkSize) {
+    size_t last = std::min(first + chunkSize, numPoints);
+    chunks.emplace_back(points.begin() + first, points.begin() + last);
+  }
+  std::vector<std::vector<int>> perPoint(chunks.size());
+  std::vector<std::vector<int>> batched(chunks.size());
+  std::vector<std::vector<int>> exact(chunks.size());
+  for (size_t i = 0; i < chunks.size(); i++) {
+    perPoint[i].resize(chunks[i].size());
+    batched[i].resize(chunks[i].size());
+    exact[i].resize(chunks[i].size());
+  }
+  KMeansAggregate &agg = *aggregate;
+
+  /* The exact assignment, to check the batched one against */
+  for (size_t i = 0; i < chunks.size(); i++) {
+    for (size_t j = 0; j < chunks[i].size(); j++) {
+      exact[i][j] = agg.computeClusterMember(chunks[i][j]);
+    }
+  }
+
+  for (int simd = 0; simd <= (simdAvailable ? 1 : 0); simd++) {
+    DistanceKernels::setSIMDEnabled(simd == 1);
+    std::string kernels = simd == 1 ? "AVX2/FMA" : "scalar";
+
+    double perPointSeconds = timeAssignment(numThreads, chunks.size(), [&](size_t chunk) {
+      for (size_t i = 0; i < chunks[chunk].size(); i++) {
+        perPoint[chunk][i] = agg.computeClusterMemberOptimized(*chunks[chunk][i]);
+      }
+    });
+    double batchedSeconds = timeAssignment(numThreads, chunks.size(), [&](size_t chunk) {
+      agg.computeClusterMembers(chunks[chunk], batched[chunk]);
+    });
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+      for (size_t j = 0; j < chunks[i].size(); j++) {
+        if (exact[i][j] != batched[i][j]) {
+          mismatches++;
+        }
+      }
+    }
+
+    std::cout << kernels << " per point: " << numPoints / perPointSeconds / numThreads
+              << " points/sec/core" << std::endl;
+    std::cout << kernels << " batched:   " << numPoints / batchedSeconds / numThreads
+              << " points/sec/core (" << perPointSeconds / batchedSeconds << "x)"
+              << std::endl;
+    std::cout << kernels << " batched assignments that differ from the exact ones: "
+              << mismatches << std::endl;
+  }
+
+  return 0;
+}
+
+#endif
@@ -25,10 +25,12 @@ typedef struct LADimension {
     int blockColSize;
     int blockRowNum;  // Number of blocks
     int blockColNum;
+    bool sparse;  // Blocks are stored as SparseMatrixBlock instead of MatrixBlock
 
-    LADimension() : blockRowSize(0), blockColSize(0), blockRowNum(0), blockColNum(0) {}
+    LADimension()
+        : blockRowSize(0), blockColSize(0), blockRowNum(0), blockColNum(0), sparse(false) {}
     LADimension(int rs, int cs, int rn, int cn)
-        : blockRowSize(rs), blockColSize(cs), blockRowNum(rn), blockColNum(cn) {}
+        : blockRowSize(rs), blockColSize(cs), blockRowNum(rn), blockColNum(cn), sparse(false) {}
 
     LADimension transpose() {
         LADimension T;
@@ -36,6 +38,7 @@ typedef struct LADimension {
         T.blockColSize = this->blockRowSize;
         T.blockRowNum = this->blockColNum;
         T.blockColNum = this->blockRowNum;
+        T.sparse = this->sparse;
         return T;
     }
 
@@ -44,6 +47,7 @@ typedef struct LADimension {
         blockColSize = other.blockColSize;
         blockRowNum = other.blockRowNum;
         blockColNum = other.blockColNum;
+        sparse = other.sparse;
         return *this;
     }
 
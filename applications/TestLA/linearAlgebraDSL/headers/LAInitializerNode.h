@@ -40,6 +40,7 @@ public:
     LAInitializerNode(const char* methodTag, int rs, int cs, int rn, int cn)
         : LAExpressionNode(LA_ASTNODE_TYPE_INITIALIZER), dim(rs, cs, rn, cn) {
         method = methodTag;
+        dim.sparse = (method.compare("loadSparse") == 0);
     }
 
 
@@ -63,6 +64,10 @@ public:
             return "load(" + std::to_string(dim.blockRowSize) + "," +
                 std::to_string(dim.blockColSize) + "," + std::to_string(dim.blockRowNum) + "," +
                 std::to_string(dim.blockColNum) + "," + path + ")";
+        } else if (method.compare("loadSparse") == 0) {
+            return "loadSparse(" + std::to_string(dim.blockRowSize) + "," +
+                std::to_string(dim.blockColSize) + "," + std::to_string(dim.blockRowNum) + "," +
+                std::to_string(dim.blockColNum) + "," + path + ")";
         } else {
             return "Initializer invalid method: " + method;
         }
@@ -26,6 +26,7 @@
 #undef TOKEN_ONES
 #undef TOKEN_IDENTITY
 #undef TOKEN_LOAD
+#undef TOKEN_LOADSPARSE
 #undef TOKEN_TRANSPOSE
 #undef TOKEN_INV
 #undef TOKEN_MULTIPLY
@@ -45,6 +46,8 @@
 #undef TOKEN_COLMAX
 #undef TOKEN_COLMIN
 #undef TOKEN_COLSUM
+#undef TOKEN_SPARSE
+#undef TOKEN_DENSE
 #undef DOUBLE
 #undef INTEGER
 #undef IDENTIFIERLITERAL
@@ -58,6 +61,7 @@
 #define TOKEN_ONES 702
 #define TOKEN_IDENTITY 703
 #define TOKEN_LOAD 704
+#define TOKEN_LOADSPARSE 705
 
 // postfix operator
 #define TOKEN_TRANSPOSE 711
@@ -89,6 +93,8 @@
 #define TOKEN_COLSUM 758
 #define TOKEN_DUPLICATEROW 759
 #define TOKEN_DUPLICATECOL 760
+#define TOKEN_SPARSE 761
+#define TOKEN_DENSE 762
 
 
 #define DOUBLE 790
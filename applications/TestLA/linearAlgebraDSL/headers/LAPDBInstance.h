@@ -111,6 +111,19 @@ public:
         catalogClient.registerType("libraries/libMatrixData.so", errMsg);
         catalogClient.registerType("libraries/libMatrixBlock.so", errMsg);
         catalogClient.registerType("libraries/libLASingleMatrix.so", errMsg);
+        catalogClient.registerType("libraries/libSparseMatrixData.so", errMsg);
+        catalogClient.registerType("libraries/libSparseMatrixBlock.so", errMsg);
+        catalogClient.registerType("libraries/libLAScanSparseMatrixBlockSet.so", errMsg);
+        catalogClient.registerType("libraries/libLAWriteSparseMatrixBlockSet.so", errMsg);
+        catalogClient.registerType("libraries/libLASparseToDenseSelection.so", errMsg);
+        catalogClient.registerType("libraries/libLADenseToSparseSelection.so", errMsg);
+        catalogClient.registerType("libraries/libLASparseTransposeSelection.so", errMsg);
+        catalogClient.registerType("libraries/libLASparseAddJoin.so", errMsg);
+        catalogClient.registerType("libraries/libLASparseDenseAddJoin.so", errMsg);
+        catalogClient.registerType("libraries/libLASparseMultiply1Join.so", errMsg);
+        catalogClient.registerType("libraries/libLASparseMultiply2Aggregate.so", errMsg);
+        catalogClient.registerType("libraries/libLASparseDenseMultiply1Join.so", errMsg);
+        catalogClient.registerType("libraries/libLADenseSparseMultiply1Join.so", errMsg);
 
         if (!storageClient.createDatabase("LA_db", errMsg)) {
             std::cout << "Not able to create database: " + errMsg;
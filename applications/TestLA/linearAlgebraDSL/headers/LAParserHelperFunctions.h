@@ -45,6 +45,8 @@ struct LAInitializerNode* makeIdentityInitializer(int size, int num);
 
 struct LAInitializerNode* makeLoadInitializer(int rs, int cs, int rn, int cn, char* path);
 
+struct LAInitializerNode* makeLoadSparseInitializer(int rs, int cs, int rn, int cn, char* path);
+
 struct LAPrimaryExpressionNode* makePrimaryExpressionFromIdentifier(
     struct LAIdentifierNode* identifierPointer);
 
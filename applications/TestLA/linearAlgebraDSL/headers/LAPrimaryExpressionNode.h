@@ -55,7 +55,8 @@ public:
         } else if (flag.compare("max") == 0 || flag.compare("min") == 0 ||
                    flag.compare("rowMax") == 0 || flag.compare("rowMin") == 0 ||
                    flag.compare("colMin") == 0 || flag.compare("colMax") == 0 ||
-                   flag.compare("rowSum") == 0 || flag.compare("colSum") == 0) {
+                   flag.compare("rowSum") == 0 || flag.compare("colSum") == 0 ||
+                   flag.compare("sparse") == 0 || flag.compare("dense") == 0) {
             return flag + "(" + child->toString() + ")";
         } else if (flag.compare("duplicateCol") == 0) {
             return flag + "(" + child->toString() + "," +
@@ -31,18 +31,23 @@
 #include "LAMinElementOutputType.h"
 #include "LAMinElementValueType.h"
 #include "LAScanMatrixBlockSet.h"
+#include "LAScanSparseMatrixBlockSet.h"
 #include "LAWriteMatrixBlockSet.h"
+#include "LAWriteSparseMatrixBlockSet.h"
 #include "LAWriteMaxElementSet.h"
 #include "LAWriteMinElementSet.h"
 #include "MatrixBlock.h"
 #include "MatrixData.h"
 #include "MatrixMeta.h"
+#include "SparseMatrixBlock.h"
 
 #include <fstream>
 #include "LAAddJoin.h"
 #include "LAColMaxAggregate.h"
 #include "LAColMinAggregate.h"
 #include "LAColSumAggregate.h"
+#include "LADenseSparseMultiply1Join.h"
+#include "LADenseToSparseSelection.h"
 #include "LADuplicateColMultiSelection.h"
 #include "LADuplicateRowMultiSelection.h"
 #include "LAInverse1Aggregate.h"
@@ -57,6 +62,13 @@
 #include "LARowSumAggregate.h"
 #include "LAScaleMultiplyJoin.h"
 #include "LAScaleMultiplyJoin.h"
+#include "LASparseAddJoin.h"
+#include "LASparseDenseAddJoin.h"
+#include "LASparseDenseMultiply1Join.h"
+#include "LASparseMultiply1Join.h"
+#include "LASparseMultiply2Aggregate.h"
+#include "LASparseToDenseSelection.h"
+#include "LASparseTransposeSelection.h"
 #include "LASubstractJoin.h"
 #include "LATransposeMultiply1Join.h"
 #include "LATransposeSelection.h"
@@ -64,13 +76,30 @@
 // by Binhang, June 2017
 
 
+// Evaluates an operand of an operator that has no sparse kernel; a sparse operand is converted to
+// dense blocks first.
+static pdb::Handle<pdb::Computation> evaluateDense(LAExpressionNode& node,
+                                                  LAPDBInstance& instance) {
+    pdb::Handle<pdb::Computation> input = node.evaluate(instance);
+    if (!node.getDimension().sparse) {
+        return input;
+    }
+    pdb::Handle<pdb::Computation> toDense = makeObject<LASparseToDenseSelection>();
+    toDense->setInput(input);
+    return toDense;
+}
+
+
 pdb::Handle<pdb::Computation>& LAInitializerNode::evaluate(LAPDBInstance& instance) {
     int totalBlocks = dim.blockRowNum * dim.blockColNum;
     std::string setName = "LA_" + method + "_" + std::to_string(instance.getDispatchCount());
     instance.increaseDispatchCount();
     // now, create a new set in LA_db
-    if (!instance.getStorageClient().createSet<MatrixBlock>(
-            "LA_db", setName, instance.instanceErrMsg())) {
+    bool created = dim.sparse ? instance.getStorageClient().createSet<SparseMatrixBlock>(
+                                    "LA_db", setName, instance.instanceErrMsg())
+                              : instance.getStorageClient().createSet<MatrixBlock>(
+                                    "LA_db", setName, instance.instanceErrMsg());
+    if (!created) {
         std::cout << "Not able to create set: " + instance.instanceErrMsg();
         exit(-1);
     } else {
@@ -208,6 +237,82 @@ pdb::Handle<pdb::Computation>& LAInitializerNode::evaluate(LAPDBInstance& instan
                 }
             }
         }
+    } else if (method.compare("loadSparse") == 0) {
+        // Each block is written as "i j nnz" followed by nnz lines of "row col value" inside the
+        // block; blocks that are left out are all zeros.
+        std::ifstream input(path.substr(1, path.length() - 2), std::ios::in);
+        if (!input.is_open()) {
+            std::cerr << "File Path <" << path.substr(1, path.length() - 2) << "> invalid!"
+                      << std::endl;
+            exit(1);
+        }
+        std::vector<CSRBuffers> blocks(totalBlocks);
+        for (CSRBuffers& block : blocks) {
+            block.rowOffsets.assign(dim.blockRowSize + 1, 0);
+        }
+        int i, j, nonZeros;
+        while (input >> i >> j >> nonZeros) {
+            if (i < 0 || i >= dim.blockRowNum || j < 0 || j >= dim.blockColNum) {
+                std::cerr << "Block (" << i << "," << j << ") is out of range!" << std::endl;
+                exit(1);
+            }
+            std::vector<int> rows(nonZeros), cols(nonZeros);
+            std::vector<double> values(nonZeros);
+            for (int k = 0; k < nonZeros; k++) {
+                input >> rows[k] >> cols[k] >> values[k];
+                if (rows[k] < 0 || rows[k] >= dim.blockRowSize || cols[k] < 0 ||
+                    cols[k] >= dim.blockColSize) {
+                    std::cerr << "Element (" << rows[k] << "," << cols[k] << ") of block (" << i
+                              << "," << j << ") is out of range!" << std::endl;
+                    exit(1);
+                }
+            }
+            SparseMatrixKernels::fromTriplets(
+                dim.blockRowSize, rows, cols, values, blocks[i * dim.blockColNum + j]);
+        }
+
+        // every block is stored, even an empty one, so that the joins find their partners
+        int writtenBlocks = 0;
+        while (writtenBlocks < totalBlocks) {
+            const UseTemporaryAllocationBlock tempBlock{instance.getBlockSize() * 1024 * 1024};
+            {
+                pdb::Handle<pdb::Vector<pdb::Handle<SparseMatrixBlock>>> storeMatrix =
+                    pdb::makeObject<pdb::Vector<pdb::Handle<SparseMatrixBlock>>>();
+                try {
+                    while (writtenBlocks < totalBlocks) {
+                        pdb::Handle<SparseMatrixBlock> myData =
+                            pdb::makeObject<SparseMatrixBlock>(writtenBlocks / dim.blockColNum,
+                                                               writtenBlocks % dim.blockColNum,
+                                                               dim.blockRowSize,
+                                                               dim.blockColSize,
+                                                               totalRows,
+                                                               totalCols,
+                                                               blocks[writtenBlocks]);
+                        storeMatrix->push_back(myData);
+                        writtenBlocks++;
+                    }
+                    if (!instance.getDispatchClient().sendData<SparseMatrixBlock>(
+                            std::pair<std::string, std::string>(setName, "LA_db"),
+                            storeMatrix,
+                            instance.instanceErrMsg())) {
+                        std::cerr << "Failed to send data to dispatcher server" << std::endl;
+                        exit(1);
+                    }
+                    instance.getStorageClient().flushData(instance.instanceErrMsg());
+                    std::cout << "Dispatched data when it is the last patch!" << std::endl;
+                } catch (pdb::NotEnoughSpace& n) {
+                    // the block that did not fit is redone in the next allocation block
+                    if (!instance.getDispatchClient().sendData<SparseMatrixBlock>(
+                            std::pair<std::string, std::string>(setName, "LA_db"),
+                            storeMatrix,
+                            instance.instanceErrMsg())) {
+                        std::cerr << "Failed to send data to dispatcher server" << std::endl;
+                        exit(1);
+                    }
+                    std::cout << "Dispatched data when allocated block is full!" << std::endl;
+                }
+            }
+        }
     } else {
         std::cerr << "LAInitializerNode <" << method << "> method invalid!" << std::endl;
         exit(1);
@@ -218,7 +323,11 @@ pdb::Handle<pdb::Computation>& LAInitializerNode::evaluate(LAPDBInstance& instan
                   << std::endl;
         exit(1);
     }
-    scanSet = makeObject<LAScanMatrixBlockSet>("LA_db", setName);
+    if (dim.sparse) {
+        scanSet = makeObject<LAScanSparseMatrixBlockSet>("LA_db", setName);
+    } else {
+        scanSet = makeObject<LAScanMatrixBlockSet>("LA_db", setName);
+    }
     instance.addToCachedSet(setName);
     if (scanSet.isNullPtr()) {
         std::cerr << "LAInitializerNode " << method << " scanSet did not set!" << std::endl;
@@ -231,18 +340,23 @@ pdb::Handle<pdb::Computation>& LAInitializerNode::evaluate(LAPDBInstance& instan
 
 
 pdb::Handle<pdb::Computation>& LAIdentifierNode::evaluate(LAPDBInstance& instance) {
-    scanSet =
-        pdb::makeObject<LAScanMatrixBlockSet>("LA_db", instance.getPDBSetNameForIdentifier(name));
-    if (scanSet.isNullPtr()) {
-        std::cerr << "LAIdentifierNode " << name << " scanSet did not set yet!" << std::endl;
-        exit(1);
-    }
     if (!instance.existsDimension(name)) {
         std::cerr << "The variable name <" << name << "> does not have a corresponding Dimension!"
                   << std::endl;
         exit(1);
     }
     setDimension(instance.findDimension(name));
+    if (dim.sparse) {
+        scanSet = pdb::makeObject<LAScanSparseMatrixBlockSet>(
+            "LA_db", instance.getPDBSetNameForIdentifier(name));
+    } else {
+        scanSet = pdb::makeObject<LAScanMatrixBlockSet>("LA_db",
+                                                        instance.getPDBSetNameForIdentifier(name));
+    }
+    if (scanSet.isNullPtr()) {
+        std::cerr << "LAIdentifierNode " << name << " scanSet did not set yet!" << std::endl;
+        exit(1);
+    }
     std::cout << "evaluate::Identifier ScanSet Handle Offset: " << scanSet.getOffset() << std::endl;
     std::cout << "LAIdentifierNode:: Dimension " << dim.blockRowSize << "," << dim.blockColSize
               << "," << dim.blockRowNum << "," << dim.blockColNum << std::endl;
@@ -262,44 +376,44 @@ pdb::Handle<pdb::Computation>& LAPrimaryExpressionNode::evaluate(LAPDBInstance&
         setDimension(child->getDimension());
     } else if (flag.compare("max") == 0) {
         query = makeObject<LAMaxElementAggregate>();
-        query->setInput(child->evaluate(instance));
+        query->setInput(evaluateDense(*child, instance));
         setDimension(LADimension(1, 1, 1, 1));
     } else if (flag.compare("min") == 0) {
         query = makeObject<LAMinElementAggregate>();
-        query->setInput(child->evaluate(instance));
+        query->setInput(evaluateDense(*child, instance));
         setDimension(LADimension(1, 1, 1, 1));
     } else if (flag.compare("rowMax") == 0) {
         query = makeObject<LARowMaxAggregate>();
-        query->setInput(child->evaluate(instance));
+        query->setInput(evaluateDense(*child, instance));
         setDimension(LADimension(
             child->getDimension().blockRowSize, 1, child->getDimension().blockRowNum, 1));
     } else if (flag.compare("rowMin") == 0) {
         query = makeObject<LARowMinAggregate>();
-        query->setInput(child->evaluate(instance));
+        query->setInput(evaluateDense(*child, instance));
         setDimension(LADimension(
             child->getDimension().blockRowSize, 1, child->getDimension().blockRowNum, 1));
     } else if (flag.compare("rowSum") == 0) {
         query = makeObject<LARowSumAggregate>();
-        query->setInput(child->evaluate(instance));
+        query->setInput(evaluateDense(*child, instance));
         setDimension(LADimension(
             child->getDimension().blockRowSize, 1, child->getDimension().blockRowNum, 1));
     } else if (flag.compare("colMax") == 0) {
         query = makeObject<LAColMaxAggregate>();
-        query->setInput(child->evaluate(instance));
+        query->setInput(evaluateDense(*child, instance));
         setDimension(LADimension(
             1, child->getDimension().blockColSize, 1, child->getDimension().blockColNum));
     } else if (flag.compare("colMin") == 0) {
         query = makeObject<LAColMinAggregate>();
-        query->setInput(child->evaluate(instance));
+        query->setInput(evaluateDense(*child, instance));
         setDimension(LADimension(
             1, child->getDimension().blockColSize, 1, child->getDimension().blockColNum));
     } else if (flag.compare("colSum") == 0) {
         query = makeObject<LAColSumAggregate>();
-        query->setInput(child->evaluate(instance));
+        query->setInput(evaluateDense(*child, instance));
         setDimension(LADimension(
             1, child->getDimension().blockColSize, 1, child->getDimension().blockColNum));
     } else if (flag.compare("duplicateRow") == 0) {
-        pdb::Handle<pdb::Computation> input = child->evaluate(instance);
+        pdb::Handle<pdb::Computation> input = evaluateDense(*child, instance);
         LADimension updatedDim(duplicateDim.blockRowSize,
                                child->getDimension().blockColSize,
                                duplicateDim.blockRowNum,
@@ -308,7 +422,7 @@ pdb::Handle<pdb::Computation>& LAPrimaryExpressionNode::evaluate(LAPDBInstance&
         query->setInput(input);
         setDimension(updatedDim);
     } else if (flag.compare("duplicateCol") == 0) {
-        pdb::Handle<pdb::Computation> input = child->evaluate(instance);
+        pdb::Handle<pdb::Computation> input = evaluateDense(*child, instance);
         LADimension updatedDim(child->getDimension().blockRowSize,
                                duplicateDim.blockColSize,
                                child->getDimension().blockRowNum,
@@ -316,6 +430,21 @@ pdb::Handle<pdb::Computation>& LAPrimaryExpressionNode::evaluate(LAPDBInstance&
         query = makeObject<LADuplicateColMultiSelection>(updatedDim);
         query->setInput(input);
         setDimension(updatedDim);
+    } else if (flag.compare("sparse") == 0) {
+        query = child->evaluate(instance);
+        LADimension updatedDim = child->getDimension();
+        if (!updatedDim.sparse) {
+            pdb::Handle<pdb::Computation> input = query;
+            query = makeObject<LADenseToSparseSelection>();
+            query->setInput(input);
+            updatedDim.sparse = true;
+        }
+        setDimension(updatedDim);
+    } else if (flag.compare("dense") == 0) {
+        query = evaluateDense(*child, instance);
+        LADimension updatedDim = child->getDimension();
+        updatedDim.sparse = false;
+        setDimension(updatedDim);
     } else {
         std::cerr << "PostfixExpression invalid flag: " + flag << std::endl;
         exit(1);
@@ -331,17 +460,23 @@ pdb::Handle<pdb::Computation>& LAPostfixExpressionNode::evaluate(LAPDBInstance&
         query = child->evaluate(instance);
         setDimension(child->getDimension());
     } else if (postOperator.compare("transpose") == 0) {
-        query = makeObject<LATransposeSelection>();
-        query->setInput(child->evaluate(instance));
+        pdb::Handle<pdb::Computation> input = child->evaluate(instance);
+        if (child->getDimension().sparse) {
+            query = makeObject<LASparseTransposeSelection>();
+        } else {
+            query = makeObject<LATransposeSelection>();
+        }
+        query->setInput(input);
         setDimension(child->getDimension().transpose());
     } else if (postOperator.compare("inverse") == 0) {
         pdb::Handle<pdb::Computation> queryAgg1 = makeObject<LAInverse1Aggregate>();
-        queryAgg1->setInput(child->evaluate(instance));
+        queryAgg1->setInput(evaluateDense(*child, instance));
 
         pdb::Handle<pdb::Computation> querySelect2 = makeObject<LAInverse2Selection>();
         querySelect2->setInput(queryAgg1);
 
         LADimension targetDim(child->getDimension().transpose());
+        targetDim.sparse = false;
         std::cout << "Make Inverse Dimension:" << targetDim.blockRowSize << ","
                   << targetDim.blockColSize << "," << targetDim.blockRowNum << ","
                   << targetDim.blockColNum << std::endl;
@@ -366,8 +501,8 @@ pdb::Handle<pdb::Computation>& LAMultiplicativeExpressionNode::evaluate(LAPDBIns
         setDimension(rightChild->getDimension());
     } else if (multiOperator.compare("scale_multiply") == 0) {
         query2 = makeObject<LAScaleMultiplyJoin>();
-        query2->setInput(0, leftChild->evaluate(instance));
-        query2->setInput(1, rightChild->evaluate(instance));
+        query2->setInput(0, evaluateDense(*leftChild, instance));
+        query2->setInput(1, evaluateDense(*rightChild, instance));
         LADimension dimLeft = leftChild->getDimension();
         LADimension dimRight = rightChild->getDimension();
         if (dimLeft != dimRight) {
@@ -375,11 +510,11 @@ pdb::Handle<pdb::Computation>& LAMultiplicativeExpressionNode::evaluate(LAPDBIns
                       << "," << rightChild->toString() << std::endl;
             exit(1);
         }
+        dimLeft.sparse = false;
         setDimension(dimLeft);
     } else if (multiOperator.compare("multiply") == 0) {
-        query1 = makeObject<LAMultiply1Join>();
-        query1->setInput(0, leftChild->evaluate(instance));
-        query1->setInput(1, rightChild->evaluate(instance));
+        pdb::Handle<pdb::Computation> left = leftChild->evaluate(instance);
+        pdb::Handle<pdb::Computation> right = rightChild->evaluate(instance);
         LADimension dimLeft = leftChild->getDimension();
         LADimension dimRight = rightChild->getDimension();
         if (dimLeft.blockColSize != dimRight.blockRowSize ||
@@ -388,15 +523,31 @@ pdb::Handle<pdb::Computation>& LAMultiplicativeExpressionNode::evaluate(LAPDBIns
                       << rightChild->toString() << std::endl;
             exit(1);
         }
-        query2 = makeObject<LAMultiply2Aggregate>();
+        // the product of two sparse matrices stays sparse, anything else becomes dense
+        if (dimLeft.sparse && dimRight.sparse) {
+            query1 = makeObject<LASparseMultiply1Join>();
+            query2 = makeObject<LASparseMultiply2Aggregate>();
+        } else {
+            if (dimLeft.sparse) {
+                query1 = makeObject<LASparseDenseMultiply1Join>();
+            } else if (dimRight.sparse) {
+                query1 = makeObject<LADenseSparseMultiply1Join>();
+            } else {
+                query1 = makeObject<LAMultiply1Join>();
+            }
+            query2 = makeObject<LAMultiply2Aggregate>();
+        }
+        query1->setInput(0, left);
+        query1->setInput(1, right);
         query2->setInput(query1);
         LADimension dimNew(
             dimLeft.blockRowSize, dimRight.blockColSize, dimLeft.blockRowNum, dimRight.blockColNum);
+        dimNew.sparse = dimLeft.sparse && dimRight.sparse;
         setDimension(dimNew);
     } else if (multiOperator.compare("transpose_multiply") == 0) {
         query1 = makeObject<LATransposeMultiply1Join>();
-        query1->setInput(0, leftChild->evaluate(instance));
-        query1->setInput(1, rightChild->evaluate(instance));
+        query1->setInput(0, evaluateDense(*leftChild, instance));
+        query1->setInput(1, evaluateDense(*rightChild, instance));
         LADimension dimLeft = leftChild->getDimension();
         LADimension dimRight = rightChild->getDimension();
         if (dimLeft.blockRowSize != dimRight.blockRowSize ||
@@ -425,9 +576,8 @@ pdb::Handle<pdb::Computation>& LAAdditiveExpressionNode::evaluate(LAPDBInstance&
         query = rightChild->evaluate(instance);
         setDimension(rightChild->getDimension());
     } else if (addOperator.compare("add") == 0) {
-        query = makeObject<LAAddJoin>();
-        query->setInput(0, leftChild->evaluate(instance));
-        query->setInput(1, rightChild->evaluate(instance));
+        pdb::Handle<pdb::Computation> left = leftChild->evaluate(instance);
+        pdb::Handle<pdb::Computation> right = rightChild->evaluate(instance);
         LADimension dimLeft = leftChild->getDimension();
         LADimension dimRight = rightChild->getDimension();
         if (dimLeft != dimRight) {
@@ -435,11 +585,25 @@ pdb::Handle<pdb::Computation>& LAAdditiveExpressionNode::evaluate(LAPDBInstance&
                       << rightChild->toString() << std::endl;
             exit(1);
         }
+        if (dimLeft.sparse && dimRight.sparse) {
+            query = makeObject<LASparseAddJoin>();
+        } else if (dimLeft.sparse || dimRight.sparse) {
+            // the sparse operand always goes first
+            query = makeObject<LASparseDenseAddJoin>();
+            if (dimRight.sparse) {
+                std::swap(left, right);
+            }
+        } else {
+            query = makeObject<LAAddJoin>();
+        }
+        query->setInput(0, left);
+        query->setInput(1, right);
+        dimLeft.sparse = dimLeft.sparse && dimRight.sparse;
         setDimension(dimLeft);
     } else if (addOperator.compare("substract") == 0) {
         query = makeObject<LASubstractJoin>();
-        query->setInput(0, leftChild->evaluate(instance));
-        query->setInput(1, rightChild->evaluate(instance));
+        query->setInput(0, evaluateDense(*leftChild, instance));
+        query->setInput(1, evaluateDense(*rightChild, instance));
         LADimension dimLeft = leftChild->getDimension();
         LADimension dimRight = rightChild->getDimension();
         if (dimLeft != dimRight) {
@@ -447,6 +611,7 @@ pdb::Handle<pdb::Computation>& LAAdditiveExpressionNode::evaluate(LAPDBInstance&
                       << rightChild->toString() << std::endl;
             exit(1);
         }
+        dimLeft.sparse = false;
         setDimension(dimLeft);
     } else {
         std::cerr << "AdditiveExpression invalid operator: " + addOperator << std::endl;
@@ -484,6 +649,13 @@ void LAStatementNode::evaluateQuery(LAPDBInstance& instance) {
                 exit(-1);
             }
             writeSet = makeObject<LAWriteMatrixBlockSet>("LA_db", outputSetName);
+        } else if (statementQuery->getOutputType().compare("SparseMatrixBlock") == 0) {
+            if (!instance.getStorageClient().createSet<SparseMatrixBlock>(
+                    "LA_db", outputSetName, instance.instanceErrMsg())) {
+                std::cout << "Not able to create set: " + instance.instanceErrMsg() << std::endl;
+                exit(-1);
+            }
+            writeSet = makeObject<LAWriteSparseMatrixBlockSet>("LA_db", outputSetName);
         } else if (statementQuery->getOutputType().compare("LAMaxElementOutputType") == 0) {
             if (!instance.getStorageClient().createSet<LAMaxElementOutputType>(
                     "LA_db", outputSetName, instance.instanceErrMsg())) {
@@ -530,6 +702,19 @@ void LAStatementNode::evaluateQuery(LAPDBInstance& instance) {
                     count++;
                 }
                 std::cout << "Matrix output block nums:" << count << "\n";
+            } else if (statementQuery->getOutputType().compare("SparseMatrixBlock") == 0) {
+                SetIterator<SparseMatrixBlock> output =
+                    instance.getQueryClient().getSetIterator<SparseMatrixBlock>("LA_db",
+                                                                                outputSetName);
+                std::cout << "Output Sparse Matrix:" << std::endl;
+                int count = 0;
+                for (auto a : output) {
+                    std::cout << count << ":";
+                    a->printMeta();
+                    std::cout << std::endl;
+                    count++;
+                }
+                std::cout << "Matrix output block nums:" << count << "\n";
             } else if (statementQuery->getOutputType().compare("LAMaxElementOutputType") == 0) {
                 SetIterator<LAMaxElementOutputType> result =
                     instance.getQueryClient().getSetIterator<LAMaxElementOutputType>("LA_db",
@@ -66,6 +66,7 @@
 %token TOKEN_ONES               702
 %token TOKEN_IDENTITY           703
 %token TOKEN_LOAD               704
+%token TOKEN_LOADSPARSE         705
 %token TOKEN_TRANSPOSE          711
 %token TOKEN_INV                712
 %token TOKEN_MULTIPLY           721
@@ -87,6 +88,8 @@
 %token TOKEN_COLSUM             758 
 %token TOKEN_DUPLICATEROW       759
 %token TOKEN_DUPLICATECOL       760
+%token TOKEN_SPARSE             761
+%token TOKEN_DENSE              762
 
 %token <doubleVal>        DOUBLE                790
 %token <intVal>           INTEGER               791
@@ -364,6 +367,22 @@ primaryExpression
     }
     $$ = makePrimaryExpressionFromExpressionDuplicate("duplicateCol",$3,$5,$7);
   }
+  // stores the blocks of expression as compressed sparse rows
+  | TOKEN_SPARSE TOKEN_LEFT_BRACKET expression TOKEN_RIGHT_BRACKET
+  {
+    if(LAPARSEPRINTFLAG){
+      printf("sparse function Expression\n");
+    }
+    $$ = makePrimaryExpressionFromExpression("sparse",$3);
+  }
+
+  | TOKEN_DENSE TOKEN_LEFT_BRACKET expression TOKEN_RIGHT_BRACKET
+  {
+    if(LAPARSEPRINTFLAG){
+      printf("dense function Expression\n");
+    }
+    $$ = makePrimaryExpressionFromExpression("dense",$3);
+  }
   ;
 
 
@@ -400,6 +419,14 @@ initializer
     }
     $$ = makeLoadInitializer($3,$5,$7,$9,$11);
   }
+
+  | TOKEN_LOADSPARSE TOKEN_LEFT_BRACKET INTEGER TOKEN_COMMA INTEGER TOKEN_COMMA INTEGER TOKEN_COMMA INTEGER TOKEN_COMMA STRINGLITERAL TOKEN_RIGHT_BRACKET 
+  {
+    if(LAPARSEPRINTFLAG){
+      printf("loadSparse(%d, %d, %d, %d, %s)\n",$3,$5,$7,$9,$11);
+    }
+    $$ = makeLoadSparseInitializer($3,$5,$7,$9,$11);
+  }
   ;
 
 
@@ -93,6 +93,20 @@ struct LAInitializerNode* makeLoadInitializer(int rs, int cs, int rn, int cn, ch
 }
 
 
+struct LAInitializerNode* makeLoadSparseInitializer(int rs, int cs, int rn, int cn, char* path) {
+    if (makePrintFlag) {
+        std::cout << "Make loadSparse(" << rs << "," << cs << "," << rn << "," << cn << "," << path
+                  << ")" << std::endl;
+    }
+    LAInitializerNodePtr returnVal =
+        std::make_shared<LAInitializerNode>("loadSparse", rs, cs, rn, cn);
+    returnVal->setLoadPath(path);
+    returnVal->setShared(returnVal);
+    free(path);
+    return returnVal.get();
+}
+
+
 struct LAPrimaryExpressionNode* makePrimaryExpressionFromIdentifier(
     struct LAIdentifierNode* identifierPointer) {
     if (makePrintFlag) {
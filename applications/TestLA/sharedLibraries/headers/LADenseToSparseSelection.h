@@ -0,0 +1,63 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef LA_DENSE_TO_SPARSE_SELECTION_H
+#define LA_DENSE_TO_SPARSE_SELECTION_H
+
+#include "Lambda.h"
+#include "LambdaCreationFunctions.h"
+#include "SelectionComp.h"
+#include "MatrixBlock.h"
+#include "SparseMatrixBlock.h"
+
+using namespace pdb;
+
+// keeps only the non-zeros of a dense matrix, block by block
+class LADenseToSparseSelection : public SelectionComp<SparseMatrixBlock, MatrixBlock> {
+
+public:
+    ENABLE_DEEP_COPY
+
+    LADenseToSparseSelection() {}
+
+    Lambda<bool> getSelection(Handle<MatrixBlock> checkMe) override {
+        return makeLambda(checkMe, [](Handle<MatrixBlock>& checkMe) { return true; });
+    }
+
+    Lambda<Handle<SparseMatrixBlock>> getProjection(Handle<MatrixBlock> checkMe) override {
+        return makeLambda(checkMe, [](Handle<MatrixBlock>& checkMe) {
+            CSRBuffers nonZeros;
+            SparseMatrixKernels::fromDense(checkMe->getRowNums(),
+                                           checkMe->getColNums(),
+                                           checkMe->getRawDataHandle()->c_ptr(),
+                                           checkMe->getColNums(),
+                                           nonZeros);
+            pdb::Handle<SparseMatrixBlock> resultMatrixBlock =
+                pdb::makeObject<SparseMatrixBlock>(checkMe->getBlockRowIndex(),
+                                                   checkMe->getBlockColIndex(),
+                                                   checkMe->getRowNums(),
+                                                   checkMe->getColNums(),
+                                                   checkMe->getTotalRowNums(),
+                                                   checkMe->getTotalColNums(),
+                                                   nonZeros);
+            return resultMatrixBlock;
+        });
+    }
+};
+
+#endif
@@ -0,0 +1,69 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef LA_SPARSE_DENSE_ADD_JOIN_H
+#define LA_SPARSE_DENSE_ADD_JOIN_H
+
+#include "Lambda.h"
+#include "LambdaCreationFunctions.h"
+#include "JoinComp.h"
+#include "MatrixBlock.h"
+#include "SparseMatrixBlock.h"
+
+using namespace pdb;
+
+// a sparse plus a dense matrix is dense; the DSL puts the sparse one first
+class LASparseDenseAddJoin : public JoinComp<MatrixBlock, SparseMatrixBlock, MatrixBlock> {
+
+public:
+    ENABLE_DEEP_COPY
+
+    LASparseDenseAddJoin() {}
+
+    Lambda<bool> getSelection(Handle<SparseMatrixBlock> in1, Handle<MatrixBlock> in2) override {
+        return makeLambdaFromMethod(in1, getKey) == makeLambdaFromMethod(in2, getKey);
+    }
+
+    Lambda<Handle<MatrixBlock>> getProjection(Handle<SparseMatrixBlock> in1,
+                                              Handle<MatrixBlock> in2) override {
+        return makeLambda(in1, in2, [](Handle<SparseMatrixBlock>& in1, Handle<MatrixBlock>& in2) {
+            if (in1->getRowNums() != in2->getRowNums() ||
+                in1->getColNums() != in2->getColNums()) {
+                std::cerr << "Block dimemsions mismatch!" << std::endl;
+                exit(1);
+            }
+            int rowNums = in2->getRowNums();
+            int colNums = in2->getColNums();
+            pdb::Handle<MatrixBlock> resultMatrixBlock =
+                pdb::makeObject<MatrixBlock>(in2->getBlockRowIndex(),
+                                             in2->getBlockColIndex(),
+                                             rowNums,
+                                             colNums,
+                                             in2->getTotalRowNums(),
+                                             in2->getTotalColNums());
+            double* result = resultMatrixBlock->getRawDataHandle()->c_ptr();
+            std::copy(in2->getRawDataHandle()->c_ptr(),
+                      in2->getRawDataHandle()->c_ptr() + rowNums * colNums,
+                      result);
+            SparseMatrixKernels::addToDense(in1->view(), result, colNums);
+            return resultMatrixBlock;
+        });
+    }
+};
+
+#endif
@@ -0,0 +1,70 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef LA_SPARSE_DENSE_MULTIPLY1_JOIN_H
+#define LA_SPARSE_DENSE_MULTIPLY1_JOIN_H
+
+#include "Lambda.h"
+#include "LambdaCreationFunctions.h"
+#include "JoinComp.h"
+#include "MatrixBlock.h"
+#include "SparseMatrixBlock.h"
+
+using namespace pdb;
+
+// the partial products of a sparse matrix times a dense one, summed up by LAMultiply2Aggregate
+class LASparseDenseMultiply1Join : public JoinComp<MatrixBlock, SparseMatrixBlock, MatrixBlock> {
+
+public:
+    ENABLE_DEEP_COPY
+
+    LASparseDenseMultiply1Join() {}
+
+    Lambda<bool> getSelection(Handle<SparseMatrixBlock> in1, Handle<MatrixBlock> in2) override {
+        return makeLambdaFromMethod(in1, getBlockColIndex) ==
+            makeLambdaFromMethod(in2, getBlockRowIndex);
+    }
+
+    Lambda<Handle<MatrixBlock>> getProjection(Handle<SparseMatrixBlock> in1,
+                                              Handle<MatrixBlock> in2) override {
+        return makeLambda(in1, in2, [](Handle<SparseMatrixBlock>& in1, Handle<MatrixBlock>& in2) {
+            if (in1->getColNums() != in2->getRowNums()) {
+                std::cerr << "Block dimemsions mismatch!" << std::endl;
+                exit(1);
+            }
+            int colNums = in2->getColNums();
+            pdb::Handle<MatrixBlock> resultMatrixBlock =
+                pdb::makeObject<MatrixBlock>(in1->getBlockRowIndex(),
+                                             in2->getBlockColIndex(),
+                                             in1->getRowNums(),
+                                             colNums,
+                                             in1->getTotalRowNums(),
+                                             in2->getTotalColNums());
+            resultMatrixBlock->setZero();
+            SparseMatrixKernels::multiplyDense(in1->view(),
+                                               colNums,
+                                               in2->getRawDataHandle()->c_ptr(),
+                                               colNums,
+                                               resultMatrixBlock->getRawDataHandle()->c_ptr(),
+                                               colNums);
+            return resultMatrixBlock;
+        });
+    }
+};
+
+#endif
@@ -0,0 +1,67 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef LA_SPARSE_MULTIPLY1_JOIN_H
+#define LA_SPARSE_MULTIPLY1_JOIN_H
+
+#include "Lambda.h"
+#include "LambdaCreationFunctions.h"
+#include "JoinComp.h"
+#include "SparseMatrixBlock.h"
+
+using namespace pdb;
+
+// the sparse partial products of two sparse matrices, summed up by LASparseMultiply2Aggregate
+class LASparseMultiply1Join
+    : public JoinComp<SparseMatrixBlock, SparseMatrixBlock, SparseMatrixBlock> {
+
+public:
+    ENABLE_DEEP_COPY
+
+    LASparseMultiply1Join() {}
+
+    Lambda<bool> getSelection(Handle<SparseMatrixBlock> in1,
+                              Handle<SparseMatrixBlock> in2) override {
+        return makeLambdaFromMethod(in1, getBlockColIndex) ==
+            makeLambdaFromMethod(in2, getBlockRowIndex);
+    }
+
+    Lambda<Handle<SparseMatrixBlock>> getProjection(Handle<SparseMatrixBlock> in1,
+                                                    Handle<SparseMatrixBlock> in2) override {
+        return makeLambda(
+            in1, in2, [](Handle<SparseMatrixBlock>& in1, Handle<SparseMatrixBlock>& in2) {
+                if (in1->getColNums() != in2->getRowNums()) {
+                    std::cerr << "Block dimemsions mismatch!" << std::endl;
+                    exit(1);
+                }
+                CSRBuffers product;
+                SparseMatrixKernels::multiplySparse(in1->view(), in2->view(), product);
+                pdb::Handle<SparseMatrixBlock> resultMatrixBlock =
+                    pdb::makeObject<SparseMatrixBlock>(in1->getBlockRowIndex(),
+                                                       in2->getBlockColIndex(),
+                                                       in1->getRowNums(),
+                                                       in2->getColNums(),
+                                                       in1->getTotalRowNums(),
+                                                       in2->getTotalColNums(),
+                                                       product);
+                return resultMatrixBlock;
+            });
+    }
+};
+
+#endif
@@ -0,0 +1,47 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef LA_SPARSE_MULTIPLY2_AGGREGATE_H
+#define LA_SPARSE_MULTIPLY2_AGGREGATE_H
+
+#include "AggregateComp.h"
+#include "SparseMatrixBlock.h"
+#include "LambdaCreationFunctions.h"
+
+using namespace pdb;
+
+class LASparseMultiply2Aggregate
+    : public AggregateComp<SparseMatrixBlock, SparseMatrixBlock, MatrixMeta, SparseMatrixData> {
+
+public:
+    ENABLE_DEEP_COPY
+
+    LASparseMultiply2Aggregate() {}
+
+    // the key type must have == and size_t hash () defined
+    Lambda<MatrixMeta> getKeyProjection(Handle<SparseMatrixBlock> aggMe) override {
+        return makeLambdaFromMethod(aggMe, getMultiplyKey);
+    }
+
+    // the value type must have + defined
+    Lambda<SparseMatrixData> getValueProjection(Handle<SparseMatrixBlock> aggMe) override {
+        return makeLambdaFromMethod(aggMe, getMultiplyValue);
+    }
+};
+
+#endif
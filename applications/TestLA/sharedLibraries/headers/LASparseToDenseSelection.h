@@ -0,0 +1,60 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef LA_SPARSE_TO_DENSE_SELECTION_H
+#define LA_SPARSE_TO_DENSE_SELECTION_H
+
+#include "Lambda.h"
+#include "LambdaCreationFunctions.h"
+#include "SelectionComp.h"
+#include "MatrixBlock.h"
+#include "SparseMatrixBlock.h"
+
+using namespace pdb;
+
+// turns a sparse matrix into a dense one, block by block
+class LASparseToDenseSelection : public SelectionComp<MatrixBlock, SparseMatrixBlock> {
+
+public:
+    ENABLE_DEEP_COPY
+
+    LASparseToDenseSelection() {}
+
+    Lambda<bool> getSelection(Handle<SparseMatrixBlock> checkMe) override {
+        return makeLambda(checkMe, [](Handle<SparseMatrixBlock>& checkMe) { return true; });
+    }
+
+    Lambda<Handle<MatrixBlock>> getProjection(Handle<SparseMatrixBlock> checkMe) override {
+        return makeLambda(checkMe, [](Handle<SparseMatrixBlock>& checkMe) {
+            pdb::Handle<MatrixBlock> resultMatrixBlock =
+                pdb::makeObject<MatrixBlock>(checkMe->getBlockRowIndex(),
+                                             checkMe->getBlockColIndex(),
+                                             checkMe->getRowNums(),
+                                             checkMe->getColNums(),
+                                             checkMe->getTotalRowNums(),
+                                             checkMe->getTotalColNums());
+            resultMatrixBlock->setZero();
+            SparseMatrixKernels::addToDense(checkMe->view(),
+                                            resultMatrixBlock->getRawDataHandle()->c_ptr(),
+                                            checkMe->getColNums());
+            return resultMatrixBlock;
+        });
+    }
+};
+
+#endif
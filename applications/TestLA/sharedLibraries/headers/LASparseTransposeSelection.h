@@ -0,0 +1,58 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef LA_SPARSE_TRANSPOSE_SELECTION_H
+#define LA_SPARSE_TRANSPOSE_SELECTION_H
+
+#include "Lambda.h"
+#include "LambdaCreationFunctions.h"
+#include "SelectionComp.h"
+#include "SparseMatrixBlock.h"
+
+using namespace pdb;
+
+// transposes a sparse matrix; each block is converted to CSC, which is the CSR of its transpose
+class LASparseTransposeSelection : public SelectionComp<SparseMatrixBlock, SparseMatrixBlock> {
+
+public:
+    ENABLE_DEEP_COPY
+
+    LASparseTransposeSelection() {}
+
+    Lambda<bool> getSelection(Handle<SparseMatrixBlock> checkMe) override {
+        return makeLambda(checkMe, [](Handle<SparseMatrixBlock>& checkMe) { return true; });
+    }
+
+    Lambda<Handle<SparseMatrixBlock>> getProjection(Handle<SparseMatrixBlock> checkMe) override {
+        return makeLambda(checkMe, [](Handle<SparseMatrixBlock>& checkMe) {
+            CSRBuffers transposed;
+            SparseMatrixKernels::transpose(checkMe->view(), transposed);
+            pdb::Handle<SparseMatrixBlock> resultMatrixBlock =
+                pdb::makeObject<SparseMatrixBlock>(checkMe->getBlockColIndex(),
+                                                   checkMe->getBlockRowIndex(),
+                                                   checkMe->getColNums(),
+                                                   checkMe->getRowNums(),
+                                                   checkMe->getTotalColNums(),
+                                                   checkMe->getTotalRowNums(),
+                                                   transposed);
+            return resultMatrixBlock;
+        });
+    }
+};
+
+#endif
@@ -68,19 +68,12 @@ public:
                 int blockColIndex = in2->getBlockColIndex();
                 int totalRows = in1->getTotalColNums();
                 int totalCols = in2->getTotalColNums();
-                Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
-                    currentMatrix1(
-                        in1->getRawDataHandle()->c_ptr(), in1->getRowNums(), in1->getColNums());
-                Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
-                    currentMatrix2(
-                        in2->getRawDataHandle()->c_ptr(), in2->getRowNums(), in2->getColNums());
-
                 pdb::Handle<MatrixBlock> resultMatrixBlock = pdb::makeObject<MatrixBlock>(
                     blockRowIndex, blockColIndex, rowNums, colNums, totalRows, totalCols);
-                Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
-                    productMatrix(resultMatrixBlock->getRawDataHandle()->c_ptr(), rowNums, colNums);
 
-                productMatrix = (currentMatrix1.transpose()) * currentMatrix2;
+                // the product is written straight into the new block, without an Eigen temporary
+                resultMatrixBlock->setZero();
+                resultMatrixBlock->multiplyAccumulate(*in1, true, *in2);
 
                 // std::cout <<"Result Matrix :"<< std::endl;
                 // resultMatrixBlock->print();
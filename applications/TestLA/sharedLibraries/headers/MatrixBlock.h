@@ -33,6 +33,8 @@
 #include "PDBString.h"
 #include "Handle.h"
 #include "ExportableObject.h"
+#include "GemmKernels.h"
+#include <algorithm>
 #include <vector>
 
 // LA libraries:
@@ -198,6 +200,47 @@ public:
     }
 
 
+    // sets every element of this block to zero
+    void setZero() {
+        std::fill(data.rawData->c_ptr(), data.rawData->c_ptr() + data.rowNums * data.colNums, 0.0);
+    }
+
+    // adds op(a) * b to this block in place, op(a) is a or its transpose; the product runs on the
+    // blocked AVX2/FMA kernel if the CPU has it, otherwise on Eigen
+    void multiplyAccumulate(MatrixBlock& a, bool transposeA, MatrixBlock& b) {
+        int m = transposeA ? a.data.colNums : a.data.rowNums;
+        int k = transposeA ? a.data.rowNums : a.data.colNums;
+        int n = b.data.colNums;
+        if (m != data.rowNums || k != b.data.rowNums || n != data.colNums) {
+            std::cerr << "Block dimemsions mismatch!" << std::endl;
+            exit(1);
+        }
+        if (pdb::DistanceKernels::isSIMDEnabled()) {
+            pdb::GemmKernels::multiplyAccumulate(m,
+                                                 n,
+                                                 k,
+                                                 a.data.rawData->c_ptr(),
+                                                 a.data.colNums,
+                                                 transposeA,
+                                                 b.data.rawData->c_ptr(),
+                                                 n,
+                                                 data.rawData->c_ptr(),
+                                                 n);
+            return;
+        }
+        Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+            matrixA(a.data.rawData->c_ptr(), a.data.rowNums, a.data.colNums);
+        Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+            matrixB(b.data.rawData->c_ptr(), b.data.rowNums, b.data.colNums);
+        Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+            matrixC(data.rawData->c_ptr(), data.rowNums, data.colNums);
+        if (transposeA) {
+            matrixC.noalias() += matrixA.transpose() * matrixB;
+        } else {
+            matrixC.noalias() += matrixA * matrixB;
+        }
+    }
+
     MatrixMeta& getMultiplyKey() {
         return meta;
     }
@@ -36,8 +36,13 @@ class MatrixData : public pdb::Object {
 private:
     void SumAggregate(MatrixData& other) {
         // std::cout << "Sum Aggregation +" << std::endl;
-        for (int i = 0; i < rowNums * colNums; i++) {
-            (*rawData)[i] += (*(other.rawData))[i];
+        // this adds up the partial products of a multiply, so we go through the raw arrays and
+        // let the compiler vectorize it
+        double* mine = rawData->c_ptr();
+        double* theirs = other.rawData->c_ptr();
+        int length = rowNums * colNums;
+        for (int i = 0; i < length; i++) {
+            mine[i] += theirs[i];
         }
     }
 
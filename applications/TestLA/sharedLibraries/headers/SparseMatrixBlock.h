@@ -0,0 +1,135 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef SPARSE_MATRIX_BLOCK_H
+#define SPARSE_MATRIX_BLOCK_H
+
+#include "Object.h"
+#include "Handle.h"
+#include "MatrixMeta.h"
+#include "SparseMatrixData.h"
+
+/**
+ * A block of a sparse matrix, the sparse counterpart of MatrixBlock. Only the non-zeros are stored,
+ * in CSR form. A sparse matrix keeps all of its blocks, the empty ones too, so that the joins of
+ * the LA operators find a partner for every block.
+ */
+class SparseMatrixBlock : public pdb::Object {
+
+private:
+    MatrixMeta meta;
+    SparseMatrixData data;
+
+public:
+    ENABLE_DEEP_COPY
+
+    ~SparseMatrixBlock() {}
+    SparseMatrixBlock() {}
+
+    // creates an all-zero block
+    SparseMatrixBlock(int blockRowIndexIn,
+                      int blockColIndexIn,
+                      int rowNumsIn,
+                      int colNumsIn,
+                      int totalRows,
+                      int totalCols) {
+        meta.blockRowIndex = blockRowIndexIn;
+        meta.blockColIndex = blockColIndexIn;
+        meta.totalRows = totalRows;
+        meta.totalCols = totalCols;
+        data.setEmpty(rowNumsIn, colNumsIn);
+    }
+
+    // creates a block holding the given non-zeros
+    SparseMatrixBlock(int blockRowIndexIn,
+                      int blockColIndexIn,
+                      int rowNumsIn,
+                      int colNumsIn,
+                      int totalRows,
+                      int totalCols,
+                      CSRBuffers& nonZeros) {
+        meta.blockRowIndex = blockRowIndexIn;
+        meta.blockColIndex = blockColIndexIn;
+        meta.totalRows = totalRows;
+        meta.totalCols = totalCols;
+        data.rowNums = rowNumsIn;
+        data.colNums = colNumsIn;
+        data.setFrom(nonZeros);
+    }
+
+    void printMeta() {
+        std::cout << "Sparse Block: (" << meta.blockRowIndex << "," << meta.blockColIndex
+                  << "), size: (" << data.rowNums << "," << data.colNums
+                  << "), non-zeros:" << data.getNonZeros() << " ";
+    }
+
+    void print() {
+        printMeta();
+        data.print();
+    }
+
+    int getBlockRowIndex() {
+        return meta.blockRowIndex;
+    }
+
+    int getBlockColIndex() {
+        return meta.blockColIndex;
+    }
+
+    int getRowNums() {
+        return data.rowNums;
+    }
+
+    int getColNums() {
+        return data.colNums;
+    }
+
+    int getTotalRowNums() {
+        return meta.totalRows;
+    }
+
+    int getTotalColNums() {
+        return meta.totalCols;
+    }
+
+    int getNonZeros() {
+        return data.getNonZeros();
+    }
+
+    CSRMatrix view() {
+        return data.view();
+    }
+
+    MatrixMeta& getKey() {
+        return meta;
+    }
+
+    SparseMatrixData& getValue() {
+        return data;
+    }
+
+    MatrixMeta& getMultiplyKey() {
+        return meta;
+    }
+
+    SparseMatrixData& getMultiplyValue() {
+        return data;
+    }
+};
+
+#endif
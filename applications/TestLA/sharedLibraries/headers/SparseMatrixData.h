@@ -0,0 +1,111 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef SPARSE_MATRIX_DATA_H
+#define SPARSE_MATRIX_DATA_H
+
+#include "Object.h"
+#include "PDBVector.h"
+#include "Handle.h"
+#include "InterfaceFunctions.h"
+#include "SparseMatrixKernels.h"
+
+#include <algorithm>
+#include <iostream>
+
+// The values of a sparse matrix block, in CSR form (see SparseMatrixKernels.h)
+class SparseMatrixData : public pdb::Object {
+
+public:
+    ENABLE_DEEP_COPY
+
+    ~SparseMatrixData() {}
+    SparseMatrixData() {}
+
+    int rowNums = 0;
+    int colNums = 0;
+
+    // rowNums + 1 offsets into colIndices and values
+    pdb::Handle<pdb::Vector<int>> rowOffsets;
+
+    // the column of every non-zero, sorted within each row
+    pdb::Handle<pdb::Vector<int>> colIndices;
+
+    // the non-zeros
+    pdb::Handle<pdb::Vector<double>> values;
+
+    int getNonZeros() {
+        return rowOffsets.isNullPtr() ? 0 : (*rowOffsets)[rowNums];
+    }
+
+    CSRMatrix view() {
+        return CSRMatrix{
+            rowNums, colNums, rowOffsets->c_ptr(), colIndices->c_ptr(), values->c_ptr()};
+    }
+
+    // copies a CSR matrix into this block's vectors, in the current allocation block
+    void setFrom(CSRBuffers& from) {
+        rowOffsets = toPDBVector(from.rowOffsets);
+        colIndices = toPDBVector(from.colIndices);
+        values = toPDBVector(from.values);
+    }
+
+    // makes this an all-zero rowNums x colNums matrix
+    void setEmpty(int rowNumsIn, int colNumsIn) {
+        rowNums = rowNumsIn;
+        colNums = colNumsIn;
+        CSRBuffers empty;
+        empty.rowOffsets.assign(rowNums + 1, 0);
+        setFrom(empty);
+    }
+
+    void print() {
+        std::cout << "Row: " << rowNums << " Col: " << colNums << " Non-zeros: " << getNonZeros()
+                  << std::endl;
+        for (int i = 0; i < rowNums; i++) {
+            for (int p = (*rowOffsets)[i]; p < (*rowOffsets)[i + 1]; p++) {
+                std::cout << "(" << i << "," << (*colIndices)[p] << ") " << (*values)[p] << " ";
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    // the aggregation of a sparse multiply adds up the partial products of a block
+    SparseMatrixData& operator+(SparseMatrixData& other) {
+        if (rowNums != other.rowNums || colNums != other.colNums) {
+            std::cerr << "Block dimemsions mismatch!" << std::endl;
+            exit(1);
+        }
+        CSRBuffers sum;
+        SparseMatrixKernels::add(view(), other.view(), sum);
+        setFrom(sum);
+        return *this;
+    }
+
+private:
+    template <class T>
+    static pdb::Handle<pdb::Vector<T>> toPDBVector(std::vector<T>& from) {
+        uint32_t size = from.size();
+        pdb::Handle<pdb::Vector<T>> result =
+            pdb::makeObject<pdb::Vector<T>>(std::max(size, (uint32_t)1), size);
+        std::copy(from.begin(), from.end(), result->c_ptr());
+        return result;
+    }
+};
+
+#endif
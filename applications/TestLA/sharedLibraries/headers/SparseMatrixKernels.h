@@ -0,0 +1,260 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef SPARSE_MATRIX_KERNELS_H
+#define SPARSE_MATRIX_KERNELS_H
+
+#include <algorithm>
+#include <vector>
+
+// A read-only view of a CSR (compressed sparse row) matrix: the non-zeros of row i are
+// values[rowOffsets[i] .. rowOffsets[i + 1]), at columns colIndices[...] sorted in ascending order.
+// The CSR form of a matrix is the CSC form of its transpose.
+struct CSRMatrix {
+    int rowNums;
+    int colNums;
+    const int* rowOffsets;
+    const int* colIndices;
+    const double* values;
+
+    int getNonZeros() const {
+        return rowOffsets[rowNums];
+    }
+};
+
+// The arrays of a CSR matrix while it is being built
+struct CSRBuffers {
+    std::vector<int> rowOffsets;
+    std::vector<int> colIndices;
+    std::vector<double> values;
+
+    CSRMatrix view(int rowNums, int colNums) const {
+        return CSRMatrix{rowNums, colNums, rowOffsets.data(), colIndices.data(), values.data()};
+    }
+};
+
+/**
+ * The kernels behind the sparse matrix blocks of the LA DSL. Dense matrices are row-major arrays
+ * with a leading dimension, and sparse results come out with sorted columns.
+ */
+class SparseMatrixKernels {
+
+public:
+    // y += a * x
+    static void multiplyVector(const CSRMatrix& a, const double* x, double* y) {
+        for (int i = 0; i < a.rowNums; i++) {
+            double sum = 0;
+            for (int p = a.rowOffsets[i]; p < a.rowOffsets[i + 1]; p++) {
+                sum += a.values[p] * x[a.colIndices[p]];
+            }
+            y[i] += sum;
+        }
+    }
+
+    // C += a * B, where B is a.colNums x n; every non-zero of a scales a row of B into a row of C
+    static void multiplyDense(
+        const CSRMatrix& a, int n, const double* b, int ldb, double* c, int ldc) {
+        if (n == 1 && ldb == 1 && ldc == 1) {
+            multiplyVector(a, b, c);
+            return;
+        }
+        for (int i = 0; i < a.rowNums; i++) {
+            double* cRow = c + (size_t)i * ldc;
+            for (int p = a.rowOffsets[i]; p < a.rowOffsets[i + 1]; p++) {
+                double value = a.values[p];
+                const double* bRow = b + (size_t)a.colIndices[p] * ldb;
+                for (int j = 0; j < n; j++) {
+                    cRow[j] += value * bRow[j];
+                }
+            }
+        }
+    }
+
+    // C += A * b, where A is m x b.rowNums; we skip the zeros of A, and every other element
+    // scatters a sparse row of b into a row of C
+    static void denseMultiply(
+        int m, const double* a, int lda, const CSRMatrix& b, double* c, int ldc) {
+        for (int i = 0; i < m; i++) {
+            const double* aRow = a + (size_t)i * lda;
+            double* cRow = c + (size_t)i * ldc;
+            for (int k = 0; k < b.rowNums; k++) {
+                double value = aRow[k];
+                if (value == 0) {
+                    continue;
+                }
+                for (int p = b.rowOffsets[k]; p < b.rowOffsets[k + 1]; p++) {
+                    cRow[b.colIndices[p]] += value * b.values[p];
+                }
+            }
+        }
+    }
+
+    // result = a * b, row by row with a dense accumulator (Gustavson's algorithm)
+    static void multiplySparse(const CSRMatrix& a, const CSRMatrix& b, CSRBuffers& result) {
+        std::vector<double> accumulator(b.colNums, 0.0);
+        std::vector<int> lastRowSeen(b.colNums, -1);
+        std::vector<int> touched;
+
+        clear(result, a.rowNums);
+        for (int i = 0; i < a.rowNums; i++) {
+            touched.clear();
+            for (int p = a.rowOffsets[i]; p < a.rowOffsets[i + 1]; p++) {
+                int k = a.colIndices[p];
+                double value = a.values[p];
+                for (int q = b.rowOffsets[k]; q < b.rowOffsets[k + 1]; q++) {
+                    int j = b.colIndices[q];
+                    if (lastRowSeen[j] != i) {
+                        lastRowSeen[j] = i;
+                        accumulator[j] = 0;
+                        touched.push_back(j);
+                    }
+                    accumulator[j] += value * b.values[q];
+                }
+            }
+            std::sort(touched.begin(), touched.end());
+            for (int j : touched) {
+                if (accumulator[j] != 0) {
+                    result.colIndices.push_back(j);
+                    result.values.push_back(accumulator[j]);
+                }
+            }
+            result.rowOffsets[i + 1] = (int)result.values.size();
+        }
+    }
+
+    // result = a + b, merging the sorted rows
+    static void add(const CSRMatrix& a, const CSRMatrix& b, CSRBuffers& result) {
+        clear(result, a.rowNums);
+        result.colIndices.reserve(a.getNonZeros() + b.getNonZeros());
+        result.values.reserve(a.getNonZeros() + b.getNonZeros());
+        for (int i = 0; i < a.rowNums; i++) {
+            int p = a.rowOffsets[i], pEnd = a.rowOffsets[i + 1];
+            int q = b.rowOffsets[i], qEnd = b.rowOffsets[i + 1];
+            while (p < pEnd || q < qEnd) {
+                int j;
+                double value;
+                if (q == qEnd || (p < pEnd && a.colIndices[p] < b.colIndices[q])) {
+                    j = a.colIndices[p];
+                    value = a.values[p++];
+                } else if (p == pEnd || b.colIndices[q] < a.colIndices[p]) {
+                    j = b.colIndices[q];
+                    value = b.values[q++];
+                } else {
+                    j = a.colIndices[p];
+                    value = a.values[p++] + b.values[q++];
+                }
+                if (value != 0) {
+                    result.colIndices.push_back(j);
+                    result.values.push_back(value);
+                }
+            }
+            result.rowOffsets[i + 1] = (int)result.values.size();
+        }
+    }
+
+    // result = the transpose of a, i.e. the CSR form of a's CSC form
+    static void transpose(const CSRMatrix& a, CSRBuffers& result) {
+        int nonZeros = a.getNonZeros();
+        result.rowOffsets.assign(a.colNums + 1, 0);
+        result.colIndices.resize(nonZeros);
+        result.values.resize(nonZeros);
+        for (int p = 0; p < nonZeros; p++) {
+            result.rowOffsets[a.colIndices[p] + 1]++;
+        }
+        for (int j = 0; j < a.colNums; j++) {
+            result.rowOffsets[j + 1] += result.rowOffsets[j];
+        }
+        // going over the rows in order keeps the new columns sorted
+        std::vector<int> next(result.rowOffsets.begin(), result.rowOffsets.end() - 1);
+        for (int i = 0; i < a.rowNums; i++) {
+            for (int p = a.rowOffsets[i]; p < a.rowOffsets[i + 1]; p++) {
+                int target = next[a.colIndices[p]]++;
+                result.colIndices[target] = i;
+                result.values[target] = a.values[p];
+            }
+        }
+    }
+
+    // result = the non-zeros of a dense m x n matrix
+    static void fromDense(int m, int n, const double* a, int lda, CSRBuffers& result) {
+        clear(result, m);
+        for (int i = 0; i < m; i++) {
+            const double* row = a + (size_t)i * lda;
+            for (int j = 0; j < n; j++) {
+                if (row[j] != 0) {
+                    result.colIndices.push_back(j);
+                    result.values.push_back(row[j]);
+                }
+            }
+            result.rowOffsets[i + 1] = (int)result.values.size();
+        }
+    }
+
+    // result = the rowNums-row matrix with the given (row, column, value) entries; duplicated
+    // coordinates are summed up
+    static void fromTriplets(int rowNums,
+                             const std::vector<int>& rows,
+                             const std::vector<int>& cols,
+                             const std::vector<double>& values,
+                             CSRBuffers& result) {
+        std::vector<size_t> order(rows.size());
+        for (size_t p = 0; p < order.size(); p++) {
+            order[p] = p;
+        }
+        std::sort(order.begin(), order.end(), [&](size_t x, size_t y) {
+            return rows[x] < rows[y] || (rows[x] == rows[y] && cols[x] < cols[y]);
+        });
+        clear(result, rowNums);
+        int lastRow = -1;
+        int lastCol = -1;
+        for (size_t p : order) {
+            if (rows[p] == lastRow && cols[p] == lastCol) {
+                result.values.back() += values[p];
+                continue;
+            }
+            lastRow = rows[p];
+            lastCol = cols[p];
+            result.colIndices.push_back(lastCol);
+            result.values.push_back(values[p]);
+            result.rowOffsets[lastRow + 1]++;
+        }
+        for (int i = 0; i < rowNums; i++) {
+            result.rowOffsets[i + 1] += result.rowOffsets[i];
+        }
+    }
+
+    // C += a
+    static void addToDense(const CSRMatrix& a, double* c, int ldc) {
+        for (int i = 0; i < a.rowNums; i++) {
+            double* cRow = c + (size_t)i * ldc;
+            for (int p = a.rowOffsets[i]; p < a.rowOffsets[i + 1]; p++) {
+                cRow[a.colIndices[p]] += a.values[p];
+            }
+        }
+    }
+
+private:
+    // empties result and gives it the offsets of rowNums empty rows
+    static void clear(CSRBuffers& result, int rowNums) {
+        result.rowOffsets.assign(rowNums + 1, 0);
+        result.colIndices.clear();
+        result.values.clear();
+    }
+};
+
+#endif
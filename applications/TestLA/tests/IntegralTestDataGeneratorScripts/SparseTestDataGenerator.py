@@ -0,0 +1,66 @@
+#  Copyright 2018 Rice University                                           
+#                                                                           
+#  Licensed under the Apache License, Version 2.0 (the "License");          
+#  you may not use this file except in compliance with the License.         
+#  You may obtain a copy of the License at                                  
+#                                                                           
+#      http://www.apache.org/licenses/LICENSE-2.0                           
+#                                                                           
+#  Unless required by applicable law or agreed to in writing, software      
+#  distributed under the License is distributed on an "AS IS" BASIS,        
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+#  See the License for the specific language governing permissions and      
+#  limitations under the License.                                           
+#  ======================================================================== 
+# Generates a sparse matrix in the block format read by loadSparse: every block that has a
+# non-zero is written as "i j nnz", followed by nnz lines of "row col value" inside the block.
+import random
+import sys
+import os
+
+
+path = "./applications/TestLA/tests/Benchmark/"
+if not os.path.exists(path):
+	os.makedirs(path)
+
+
+data_num = int(sys.argv[1])
+dim = int(sys.argv[2])
+blockRowSize = int(sys.argv[3])
+blockColSize = int(sys.argv[4])
+density = float(sys.argv[5])
+assert data_num% blockRowSize==0 and dim%blockColSize ==0
+blockRowNum = data_num/blockRowSize
+blockColNum = dim/blockColSize
+
+
+fileName = path+"Sparse_M_"+str(blockRowSize)+"_"+str(blockColSize)+"_"+str(blockRowNum)+"_"+str(blockColNum)+".data"
+blocks = open(fileName,"w")
+code = open(path+"Task04_Sparse_"+str(data_num)+"_"+str(dim)+"_"+str(blockRowSize)+"_"+str(blockColSize)+".pdml", "w")
+
+
+print "data_num: " + str(data_num) + "	dim: " + str(dim) + "  block row size: " +str(blockRowSize) + "  block col size: " + str(blockColSize) + "  density: " + str(density)
+
+
+for i in xrange(blockRowNum):
+	for j in xrange(blockColNum):
+		nonZeros = []
+		for ii in xrange(blockRowSize):
+			for jj in xrange(blockColSize):
+				if random.random() < density:
+					nonZeros.append((ii, jj, random.random()))
+		if len(nonZeros) == 0:
+			continue
+		blocks.write(str(i)+" "+str(j)+" "+str(len(nonZeros))+"\n")
+		for (ii, jj, value) in nonZeros:
+			blocks.write(str(ii)+" "+str(jj)+" "+str(value)+"\n")
+
+
+code.write("X = loadSparse("+str(blockRowSize)+","+str(blockColSize)+","+str(blockRowNum)+","+str(blockColNum)+',\"'+fileName+'\")\n')
+code.write("V = ones("+str(blockColSize)+",1,"+str(blockColNum)+",1)\n")
+code.write("XV = X * V\n")
+code.write("M = X^T * X\n")
+
+blocks.close()
+code.close()
+print "Write to PDB is done!"
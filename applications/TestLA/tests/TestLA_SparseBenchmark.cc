@@ -0,0 +1,163 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+#ifndef TEST_LA_SPARSE_BENCHMARK_CC
+#define TEST_LA_SPARSE_BENCHMARK_CC
+
+
+// compares the dense and the sparse matrix blocks on a mostly zero block: how much space a stored
+// block takes, and how long the block products behind LAMultiply1Join and LASparseMultiply1Join
+// take; runs locally, without a cluster
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include "Handle.h"
+#include "InterfaceFunctions.h"
+#include "UseTemporaryAllocationBlock.h"
+#include "MatrixBlock.h"
+#include "SparseMatrixBlock.h"
+
+using namespace pdb;
+
+// returns the seconds it takes to run f, the best of repeats runs
+template <typename F>
+double bestOf(int repeats, F f) {
+    double best = 0;
+    for (int r = 0; r < repeats; r++) {
+        auto begin = std::chrono::high_resolution_clock::now();
+        f();
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds =
+            std::chrono::duration_cast<std::chrono::duration<double>>(end - begin).count();
+        if (r == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+// returns the bytes a block takes once it is written to a page
+template <typename BlockType>
+size_t storedBytes(Handle<BlockType>& block, size_t maxBytes) {
+    const UseTemporaryAllocationBlock tempBlock{maxBytes};
+    Handle<BlockType> copy = deepCopyToCurrentAllocationBlock<BlockType>(block);
+    return getRecord(copy)->numBytes();
+}
+
+// returns the largest absolute difference between two n element arrays
+double maxDifference(const double* a, const double* b, size_t n) {
+    double diff = 0;
+    for (size_t i = 0; i < n; i++) {
+        diff = std::max(diff, std::fabs(a[i] - b[i]));
+    }
+    return diff;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Usage: #blockSize[rows] #density #repeats" << std::endl;
+    int n = argc > 1 ? atoi(argv[1]) : 1000;
+    double density = argc > 2 ? atof(argv[2]) : 0.01;
+    int repeats = argc > 3 ? atoi(argv[3]) : 3;
+    std::cout << "block size: " << n << "x" << n << ", density: " << density
+              << ", repeats: " << repeats << std::endl;
+
+    makeObjectAllocatorBlock((size_t)1024 * 1024 * 1024, true);
+
+    // a mostly zero block a, in both forms, and a dense block b
+    std::mt19937 generator(17);
+    std::uniform_real_distribution<double> values(-1.0, 1.0);
+    std::bernoulli_distribution isNonZero(density);
+    Handle<MatrixBlock> a = makeObject<MatrixBlock>(0, 0, n, n, n, n);
+    Handle<MatrixBlock> b = makeObject<MatrixBlock>(0, 0, n, n, n, n);
+    double* aData = a->getRawDataHandle()->c_ptr();
+    double* bData = b->getRawDataHandle()->c_ptr();
+    for (int i = 0; i < n * n; i++) {
+        aData[i] = isNonZero(generator) ? values(generator) : 0.0;
+        bData[i] = values(generator);
+    }
+    CSRBuffers nonZeros;
+    SparseMatrixKernels::fromDense(n, n, aData, n, nonZeros);
+    Handle<SparseMatrixBlock> sparseA = makeObject<SparseMatrixBlock>(0, 0, n, n, n, n, nonZeros);
+    std::cout << "non-zeros: " << sparseA->getNonZeros() << std::endl;
+
+    size_t maxBytes = (size_t)n * n * sizeof(double) + 1024 * 1024;
+    size_t denseBytes = storedBytes(a, maxBytes);
+    size_t sparseBytes = storedBytes(sparseA, maxBytes);
+    std::cout << "dense block bytes: " << denseBytes << ", sparse block bytes: " << sparseBytes
+              << " (" << (double)denseBytes / sparseBytes << "x smaller)" << std::endl;
+
+    Handle<MatrixBlock> expected = makeObject<MatrixBlock>(0, 0, n, n, n, n);
+    Handle<MatrixBlock> result = makeObject<MatrixBlock>(0, 0, n, n, n, n);
+    double* expectedData = expected->getRawDataHandle()->c_ptr();
+    double* resultData = result->getRawDataHandle()->c_ptr();
+
+    // sparse times dense, as in LASparseDenseMultiply1Join
+    double denseSeconds = bestOf(repeats, [&]() {
+        expected->setZero();
+        expected->multiplyAccumulate(*a, false, *b);
+    });
+    double sparseSeconds = bestOf(repeats, [&]() {
+        result->setZero();
+        SparseMatrixKernels::multiplyDense(sparseA->view(), n, bData, n, resultData, n);
+    });
+    double diff = maxDifference(expectedData, resultData, (size_t)n * n);
+    std::cout << "sparse x dense: dense kernel " << denseSeconds << " secs, sparse kernel "
+              << sparseSeconds << " secs (" << denseSeconds / sparseSeconds
+              << "x), max difference " << diff << std::endl;
+    bool ok = diff < 1e-9;
+
+    // dense times sparse, as in LADenseSparseMultiply1Join
+    denseSeconds = bestOf(repeats, [&]() {
+        expected->setZero();
+        expected->multiplyAccumulate(*b, false, *a);
+    });
+    sparseSeconds = bestOf(repeats, [&]() {
+        result->setZero();
+        SparseMatrixKernels::denseMultiply(n, bData, n, sparseA->view(), resultData, n);
+    });
+    diff = maxDifference(expectedData, resultData, (size_t)n * n);
+    std::cout << "dense x sparse: dense kernel " << denseSeconds << " secs, sparse kernel "
+              << sparseSeconds << " secs (" << denseSeconds / sparseSeconds
+              << "x), max difference " << diff << std::endl;
+    ok = ok && diff < 1e-9;
+
+    // sparse times sparse, as in LASparseMultiply1Join
+    denseSeconds = bestOf(repeats, [&]() {
+        expected->setZero();
+        expected->multiplyAccumulate(*a, false, *a);
+    });
+    CSRBuffers product;
+    sparseSeconds = bestOf(repeats, [&]() {
+        SparseMatrixKernels::multiplySparse(sparseA->view(), sparseA->view(), product);
+    });
+    result->setZero();
+    SparseMatrixKernels::addToDense(product.view(n, n), resultData, n);
+    diff = maxDifference(expectedData, resultData, (size_t)n * n);
+    std::cout << "sparse x sparse: dense kernel " << denseSeconds << " secs, sparse kernel "
+              << sparseSeconds << " secs (" << denseSeconds / sparseSeconds
+              << "x), product non-zeros " << product.values.size() << ", max difference " << diff
+              << std::endl;
+    ok = ok && diff < 1e-9;
+
+    std::cout << (ok ? "Sparse results match the dense ones." : "Sparse results do NOT match!")
+              << std::endl;
+    return ok ? 0 : 1;
+}
+
+#endif
@@ -76,6 +76,9 @@ void Array<TypeContained>::setUpAndCopyFrom(void* target, void* source) const {
         // in this case, we might have a fundmanetal type... regardless, just do a simple bitwise
         // copy
         memmove(newLoc, data, dataSize * fromMe.usedSlots);
+    } else if (toMe.typeInfo.isFlatObject()) {
+        // flat objects are bytes as well, they only need their vTable pointers fixed
+        toMe.typeInfo.copyFlatObjects(newLoc, data, fromMe.usedSlots);
     } else {
         for (uint32_t i = 0; i < fromMe.usedSlots; i++) {
             try {
@@ -129,12 +132,57 @@ Handle<Array<TypeContained>> Array<TypeContained>::doubleSize() {
     return resize(numSlots * 2);
 }
 
+template <class TypeContained>
+bool Array<TypeContained>::growInPlace(uint32_t howMany) {
+
+    // we were allocated by makeObjectWithExtraStorage, right behind our reference count
+    void* myChunk = ((char*)this) - REF_COUNT_PREAMBLE_SIZE;
+    size_t bytesNeeded =
+        REF_COUNT_PREAMBLE_SIZE + sizeof(Array<TypeContained>) + sizeof(TypeContained) * howMany;
+    if (!getAllocator().tryToGrowInPlace(myChunk, bytesNeeded)) {
+        return false;
+    }
+    if (howMany > numSlots) {
+        numSlots = howMany;
+    }
+    return true;
+}
+
+template <class TypeContained>
+void Array<TypeContained>::append(const TypeContained* values, uint32_t howMany) {
+
+    if (usedSlots + howMany > numSlots) {
+        std::cerr << "Bad: you are appending past the end of the array!\n";
+        return;
+    }
+
+    TypeContained* newLoc = ((TypeContained*)(data)) + usedSlots;
+    if (!typeInfo.descendsFromObject()) {
+        // a fundamental type or a plain struct, so a bitwise copy will do
+        memmove((void*)newLoc, (void*)values, sizeof(TypeContained) * howMany);
+        usedSlots += howMany;
+    } else if (typeInfo.isFlatObject()) {
+        typeInfo.copyFlatObjects((void*)newLoc, (void*)values, howMany);
+        usedSlots += howMany;
+    } else {
+        // an assignment may run out of RAM, so we count the items as they are done
+        for (uint32_t i = 0; i < howMany; i++) {
+            push_back(values[i]);
+        }
+    }
+}
+
 template <class TypeContained>
 bool Array<TypeContained>::isFull() {
     typeInfo.setup<TypeContained>();
     return usedSlots == numSlots;
 }
 
+template <class TypeContained>
+uint32_t Array<TypeContained>::capacity() {
+    return numSlots;
+}
+
 template <class TypeContained>
 Array<TypeContained>::Array() {
     typeInfo.setup<TypeContained>();
@@ -149,8 +197,8 @@ Array<TypeContained>::~Array() {
     if (typeInfo.getTypeCode() == 0) {
         std::cout << "Array::~Array: typeInfo = 0 before getSizeOfConstituentObject" << std::endl;
     }
-    // do no work if the guys we store do not come from pdb :: Object
-    if (!typeInfo.descendsFromObject())
+    // do no work if the guys we store do not come from pdb :: Object, or have trivial destructors
+    if (!typeInfo.descendsFromObject() || typeInfo.isFlatObject())
         return;
 
     // loop through and explicitly call the destructor on everything
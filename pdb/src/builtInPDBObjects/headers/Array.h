@@ -101,9 +101,19 @@ public:
     // return a new array that is twice the size, containing the same contents
     Handle<Array<TypeContained>> doubleSize();
 
+    // try to get howMany slots without moving the array; this only works if the array is the
+    // last thing allocated in the current allocation block, and returns false otherwise
+    bool growInPlace(uint32_t howMany);
+
+    // add howMany items to the end; there have to be enough free slots for all of them
+    void append(const TypeContained* values, uint32_t howMany);
+
     // check if the array is full
     bool isFull();
 
+    // return the number of slots
+    uint32_t capacity();
+
     // return/set the number of used slots
     uint32_t numUsedSlots();
     void setUsed(uint32_t toMe);
@@ -0,0 +1,62 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef BROADCAST_VARIABLE_H
+#define BROADCAST_VARIABLE_H
+
+#include "Object.h"
+#include "Handle.h"
+#include "PDBString.h"
+
+// PRELOAD %BroadcastVariable%
+
+namespace pdb {
+
+// a read-only object that is shipped once to every worker for a job, and that computations look up
+// by name through Computation::getBroadcastVariable
+class BroadcastVariable : public Object {
+
+public:
+    BroadcastVariable() {}
+    ~BroadcastVariable() {}
+
+    BroadcastVariable(std::string name, Handle<Object> value) {
+        this->name = name;
+        this->value = value;
+    }
+
+    std::string getName() {
+        return name;
+    }
+
+    Handle<Object> getValue() {
+        return value;
+    }
+
+    ENABLE_DEEP_COPY
+
+private:
+    // the name computations look the variable up with
+    String name;
+
+    // the object itself
+    Handle<Object> value;
+};
+}
+
+#endif
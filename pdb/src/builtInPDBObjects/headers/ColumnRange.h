@@ -0,0 +1,156 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef COLUMN_RANGE_H
+#define COLUMN_RANGE_H
+
+#include <cstdint>
+#include <cstring>
+
+#include "FixedString.h"
+
+namespace pdb {
+
+// the types of value a column can hold
+enum ColumnType : int8_t {
+    IntColumn,
+    LongColumn,
+    FloatColumn,
+    DoubleColumn,
+    StringColumn
+};
+
+// the widest value we keep the min and max of, wider columns have no statistics
+#define COLUMN_STATS_WIDTH 32
+
+// the column type of each kind of field a flat row can have
+inline ColumnType getColumnType(int32_t*) {
+    return IntColumn;
+}
+
+inline ColumnType getColumnType(int64_t*) {
+    return LongColumn;
+}
+
+inline ColumnType getColumnType(float*) {
+    return FloatColumn;
+}
+
+inline ColumnType getColumnType(double*) {
+    return DoubleColumn;
+}
+
+template <size_t Capacity>
+inline ColumnType getColumnType(FixedString<Capacity>*) {
+    return StringColumn;
+}
+
+template <class T>
+inline int compareColumnNumbers(T first, T second) {
+    return (first < second) ? -1 : ((second < first) ? 1 : 0);
+}
+
+// compares two values of a column, stored the same way as in the rows
+inline int compareColumnValues(ColumnType type, const void* first, const void* second) {
+    switch (type) {
+        case IntColumn:
+            return compareColumnNumbers(*(const int32_t*)first, *(const int32_t*)second);
+        case LongColumn:
+            return compareColumnNumbers(*(const int64_t*)first, *(const int64_t*)second);
+        case FloatColumn:
+            return compareColumnNumbers(*(const float*)first, *(const float*)second);
+        case DoubleColumn:
+            return compareColumnNumbers(*(const double*)first, *(const double*)second);
+        default:
+            return FixedString<1>::compareStored(first, second);
+    }
+}
+
+// A closed range of values of one named attribute, where either end may be open.  It is used
+// both for the min/max of an attribute over a page (a zone map entry) and for a range predicate
+// that the pages to scan have to overlap.  It is a plain struct, so it can be kept in a Vector.
+struct ColumnRange {
+
+    // the name of the attribute
+    char name[32];
+
+    // what kind of values it holds
+    ColumnType type;
+
+    // the size of a value
+    uint32_t width;
+
+    // false if the range is unbounded on that side
+    bool hasLower;
+    bool hasUpper;
+
+    // the ends of the range, stored the same way as in the rows
+    char lower[COLUMN_STATS_WIDTH];
+    char upper[COLUMN_STATS_WIDTH];
+
+    // creates a range of the values of an attribute of type T; a nullptr end leaves it open
+    template <class T>
+    static ColumnRange make(const char* name, const T* lower, const T* upper) {
+        static_assert(sizeof(T) <= COLUMN_STATS_WIDTH, "there is no range for values this wide");
+        ColumnRange range;
+        range.init(name, getColumnType((T*)nullptr), sizeof(T));
+        range.hasLower = (lower != nullptr);
+        range.hasUpper = (upper != nullptr);
+        if (lower != nullptr) {
+            memcpy(range.lower, lower, sizeof(T));
+        }
+        if (upper != nullptr) {
+            memcpy(range.upper, upper, sizeof(T));
+        }
+        return range;
+    }
+
+    // empties the range of an attribute, so that it holds no value until the first add
+    void init(const char* attribute, ColumnType columnType, uint32_t valueWidth) {
+        memset(this, 0, sizeof(ColumnRange));
+        strncpy(name, attribute, sizeof(name) - 1);
+        type = columnType;
+        width = valueWidth;
+    }
+
+    // widens the range so that it covers [minValue, maxValue]
+    void add(const void* minValue, const void* maxValue) {
+        if (!hasLower || compareColumnValues(type, minValue, lower) < 0) {
+            memcpy(lower, minValue, width);
+            hasLower = true;
+        }
+        if (!hasUpper || compareColumnValues(type, maxValue, upper) > 0) {
+            memcpy(upper, maxValue, width);
+            hasUpper = true;
+        }
+    }
+
+    // returns true if some value may be in both ranges
+    bool overlaps(const ColumnRange& other) const {
+        if (hasUpper && other.hasLower && compareColumnValues(type, upper, other.lower) < 0) {
+            return false;
+        }
+        if (hasLower && other.hasUpper && compareColumnValues(type, lower, other.upper) > 0) {
+            return false;
+        }
+        return true;
+    }
+};
+}
+
+#endif
@@ -0,0 +1,269 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef COLUMNAR_BLOCK_H
+#define COLUMNAR_BLOCK_H
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "PDBVector.h"
+#include "ColumnRange.h"
+#include "ZoneMappedObject.h"
+
+// PRELOAD %ColumnarBlock <Nothing>%
+
+namespace pdb {
+
+// describes one column of a ColumnarBlock
+struct ColumnMeta {
+
+    // the name of the field the column stores
+    char name[32];
+
+    // where the field is in a row
+    uint32_t rowOffset;
+
+    // the size of the field
+    uint32_t width;
+
+    // what kind of values it holds
+    ColumnType type;
+
+    // true if minValue and maxValue hold the smallest and largest value in the column
+    bool hasStats;
+
+    // where the column starts in the data of the block
+    uint64_t dataOffset;
+
+    // the smallest and the largest value, stored the same way as in the rows
+    char minValue[COLUMN_STATS_WIDTH];
+    char maxValue[COLUMN_STATS_WIDTH];
+
+    // compares two values of this column, stored the same way as in the rows
+    int compare(const void* first, const void* second) const {
+        return compareColumnValues(type, first, second);
+    }
+};
+
+// Collects the columns of a flat row type.  A row type that can be stored in a ColumnarBlock
+// lists its fields in a static method:
+//
+//     static void describeColumns(ColumnSchema<MyRow>& schema) {
+//         schema.add("key", &MyRow::key);
+//         schema.add("name", &MyRow::name);
+//     }
+template <class Row>
+class ColumnSchema {
+
+public:
+    template <class T>
+    void add(const char* name, T Row::*field) {
+        Row row;
+        ColumnMeta column;
+        memset(&column, 0, sizeof(ColumnMeta));
+        strncpy(column.name, name, sizeof(column.name) - 1);
+        column.rowOffset = (uint32_t)((char*)&(row.*field) - (char*)&row);
+        column.width = sizeof(T);
+        column.type = getColumnType((T*)nullptr);
+        columns.push_back(column);
+    }
+
+    // returns the columns of Row, in the order describeColumns lists them
+    static const std::vector<ColumnMeta>& get() {
+        static std::vector<ColumnMeta> result = [] {
+            ColumnSchema<Row> schema;
+            Row::describeColumns(schema);
+            return schema.columns;
+        }();
+        return result;
+    }
+
+private:
+    std::vector<ColumnMeta> columns;
+};
+
+// A block of flat records (see FlatRowBlock.h) stored column by column, in the PAX style: the
+// values of each field are kept together in their own array, and every column carries the
+// minimum and maximum value it holds.  Sized to fill a page, a set of ColumnarBlocks is a
+// columnar page format.  A computation that only looks at a few fields reads just their
+// columns through getColumn (), and the bytes of the other fields are never touched.  The
+// min/max of the columns also end up in the zone map of the page the block is stored on.
+
+template <class Row>
+class ColumnarBlock : public ZoneMappedObject {
+
+private:
+    // the columns, with where they are in data and their statistics
+    Vector<ColumnMeta> columns;
+
+    // the values of all the columns, one column after the other
+    Vector<char> data;
+
+    // the number of rows in the block
+    uint32_t numRows = 0;
+
+    // the number of rows the block has room for
+    uint32_t capacity = 0;
+
+    // returns the column holding the field at this offset of a row
+    const ColumnMeta& findColumn(uint32_t rowOffset) const {
+        for (uint32_t i = 0; i < columns.size(); i++) {
+            if (columns[i].rowOffset == rowOffset) {
+                return columns[i];
+            }
+        }
+        std::cout << "ColumnarBlock has no column at offset " << rowOffset << std::endl;
+        exit(-1);
+    }
+
+    // the bytes a column of numRows values takes up, rounded up so the next one stays aligned
+    static uint64_t getColumnSize(const ColumnMeta& column, uint32_t numRows) {
+        return ((uint64_t)column.width * numRows + 7) / 8 * 8;
+    }
+
+    template <class T>
+    static uint32_t getRowOffset(T Row::*field) {
+        Row row;
+        return (uint32_t)((char*)&(row.*field) - (char*)&row);
+    }
+
+public:
+    ENABLE_DEEP_COPY
+
+    ColumnarBlock() {}
+
+    ~ColumnarBlock() {}
+
+    // creates an empty block with room for numRows rows
+    ColumnarBlock(uint32_t numRows)
+        : columns(ColumnSchema<Row>::get().size()),
+          data(getDataSize(numRows), getDataSize(numRows)),
+          capacity(numRows) {
+        static_assert(std::is_trivially_copyable<Row>::value,
+                      "the rows of a ColumnarBlock must be trivially copyable");
+        uint64_t dataOffset = 0;
+        for (ColumnMeta column : ColumnSchema<Row>::get()) {
+            column.dataOffset = dataOffset;
+            columns.push_back(column);
+            dataOffset += getColumnSize(column, numRows);
+        }
+    }
+
+    // the bytes the columns of numRows rows take up
+    static uint64_t getDataSize(uint32_t numRows) {
+        uint64_t dataSize = 0;
+        for (const ColumnMeta& column : ColumnSchema<Row>::get()) {
+            dataSize += getColumnSize(column, numRows);
+        }
+        return dataSize;
+    }
+
+    size_t size() const {
+        return numRows;
+    }
+
+    size_t getCapacity() const {
+        return capacity;
+    }
+
+    bool isFull() const {
+        return numRows == capacity;
+    }
+
+    // appends a row, splitting it into the columns; the block must not be full
+    void push_back(const Row& row) {
+        const char* fields = (const char*)&row;
+        char* values = data.c_ptr();
+        for (uint32_t i = 0; i < columns.size(); i++) {
+            ColumnMeta& column = columns[i];
+            const char* value = fields + column.rowOffset;
+            memcpy(values + column.dataOffset + (uint64_t)numRows * column.width,
+                   value,
+                   column.width);
+            if (column.width > COLUMN_STATS_WIDTH) {
+                continue;
+            }
+            if (!column.hasStats) {
+                memcpy(column.minValue, value, column.width);
+                memcpy(column.maxValue, value, column.width);
+                column.hasStats = true;
+            } else if (column.compare(value, column.minValue) < 0) {
+                memcpy(column.minValue, value, column.width);
+            } else if (column.compare(value, column.maxValue) > 0) {
+                memcpy(column.maxValue, value, column.width);
+            }
+        }
+        numRows++;
+    }
+
+    // puts a row back together from the columns
+    Row getRow(uint32_t which) const {
+        Row row;
+        char* fields = (char*)&row;
+        const char* values = data.c_ptr();
+        for (uint32_t i = 0; i < columns.size(); i++) {
+            const ColumnMeta& column = columns[i];
+            memcpy(fields + column.rowOffset,
+                   values + column.dataOffset + (uint64_t)which * column.width,
+                   column.width);
+        }
+        return row;
+    }
+
+    // returns the values of a field, e.g. getColumn (&MyRow :: price) [i] is the price of row i
+    template <class T>
+    const T* getColumn(T Row::*field) const {
+        return (const T*)(data.c_ptr() + findColumn(getRowOffset(field)).dataOffset);
+    }
+
+    // returns the smallest value of a field in the block; the block must not be empty
+    template <class T>
+    const T& getMin(T Row::*field) const {
+        static_assert(sizeof(T) <= COLUMN_STATS_WIDTH, "there is no minimum for fields this wide");
+        return *(const T*)findColumn(getRowOffset(field)).minValue;
+    }
+
+    // returns the largest value of a field in the block; the block must not be empty
+    template <class T>
+    const T& getMax(T Row::*field) const {
+        static_assert(sizeof(T) <= COLUMN_STATS_WIDTH, "there is no maximum for fields this wide");
+        return *(const T*)findColumn(getRowOffset(field)).maxValue;
+    }
+
+    // the columns, for code that does not know the row type
+    const Vector<ColumnMeta>& getColumns() const {
+        return columns;
+    }
+
+    // adds the min and max of every column that has them to the zone map of our page
+    void addToZoneMap(PageZoneMap& zoneMap) override {
+        for (uint32_t i = 0; i < columns.size(); i++) {
+            const ColumnMeta& column = columns[i];
+            if (column.hasStats) {
+                zoneMap.add(
+                    column.name, column.type, column.width, column.minValue, column.maxValue);
+            }
+        }
+    }
+};
+}
+
+#endif
@@ -27,8 +27,12 @@
 #include "AtomicComputationClasses.h"
 #include "EqualsLambda.h"
 #include "AbstractJoinComp.h"
+#include "LogicalPlanOptimizer.h"
+#include "ParsedTCAPCache.h"
+#include "PDBDebug.h"
 #include "Lexer.h"
 #include "Parser.h"
+#include <algorithm>
 
 extern int yydebug;
 
@@ -44,6 +48,13 @@ inline LogicalPlanPtr ComputePlan::getPlan() {
 
     // get the string to compile
     std::string myLogicalPlan = TCAPComputation;
+
+    // a backend that already compiled this program only has to extract the lambdas
+    std::shared_ptr<AtomicComputationList> parsed = ParsedTCAPCache::find(myLogicalPlan);
+    if (parsed != nullptr) {
+        myPlan = std::make_shared<LogicalPlan>(*parsed, allComputations);
+        return myPlan;
+    }
     myLogicalPlan.push_back('\0');
 
     // where the result of the parse goes
@@ -64,9 +75,19 @@ inline LogicalPlanPtr ComputePlan::getPlan() {
         exit(1);
     }
 
+#ifndef DISABLE_TCAP_OPTIMIZER
+    // rewrite the plan before anybody plans it physically, the scheduler and the backends all
+    // parse the same TCAP so they all end up with the same rewritten plan
+    LogicalPlanOptimizer optimizer(*myResult);
+    *myResult = optimizer.optimize();
+    PDB_COUT << "TCAP optimizer eliminated " << optimizer.getNumEliminated() << " applies, pushed "
+             << optimizer.getNumPushedDown() << " filters below joins and pruned "
+             << optimizer.getNumPruned() << " attributes\n";
+#endif
+
     // this is the logical plan to return
     myPlan = std::make_shared<LogicalPlan>(*myResult, allComputations);
-    delete myResult;
+    ParsedTCAPCache::insert(TCAPComputation, std::shared_ptr<AtomicComputationList>(myResult));
 
     // and now we are outta here
     return myPlan;
@@ -76,6 +97,34 @@ inline void ComputePlan::nullifyPlanPointer() {
     myPlan = nullptr;
 }
 
+inline bool ComputePlan::setBroadcastVariables(BroadcastVariableMap* broadcastVariables,
+                                               std::string& errMsg) {
+    std::vector<std::string> names;
+    for (int i = 0; i < allComputations.size(); i++) {
+        allComputations[i]->setBroadcastVariables(broadcastVariables);
+        allComputations[i]->getRequiredBroadcastVariables(names);
+    }
+    for (const std::string& name : names) {
+        if (broadcastVariables == nullptr ||
+            broadcastVariables->find(name) == broadcastVariables->end()) {
+            errMsg = "The job has no broadcast variable named " + name +
+                ", but one of its computations requires it";
+            return false;
+        }
+    }
+    return true;
+}
+
+inline void ComputePlan::prefetchTypes() {
+    std::vector<std::string> typeNames;
+    for (int i = 0; i < allComputations.size(); i++) {
+        allComputations[i]->getReferencedTypes(typeNames);
+    }
+    std::sort(typeNames.begin(), typeNames.end());
+    typeNames.erase(std::unique(typeNames.begin(), typeNames.end()), typeNames.end());
+    VTableMap::prefetchTypes(typeNames);
+}
+
 // this does a DFS, trying to find a list of computations that lead to the specified computation
 inline bool recurse(LogicalPlanPtr myPlan,
                     std::vector<AtomicComputationPtr>& listSoFar,
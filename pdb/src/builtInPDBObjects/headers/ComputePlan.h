@@ -91,6 +91,15 @@ public:
     // sending the smart pointer.
     void nullifyPlanPointer();
 
+    // binds the broadcast variables of the running job to every computation of this plan, this is
+    // done on a worker's private copy of the plan; returns false, and says why in errMsg, if a
+    // computation requires a variable that the job has not set
+    bool setBroadcastVariables(BroadcastVariableMap* broadcastVariables, std::string& errMsg);
+
+    // loads the vTables of all of the types the computations work with, before the threads that
+    // run the plan need them
+    void prefetchTypes();
+
     // this builds a pipeline between the Computation that produces sourceTupleSetName and the
     // Computation
     // targetComputationName.  Since targetComputationName can have more than one input (in the case
@@ -21,6 +21,8 @@
 
 #include "Object.h"
 #include "PDBString.h"
+#include "PDBVector.h"
+#include "BroadcastVariable.h"
 
 // PRELOAD %ExecuteComputation%
 
@@ -45,10 +47,21 @@ public:
         return tcapString;
     }
 
+    Handle<Vector<Handle<BroadcastVariable>>> getBroadcastVariables() {
+        return broadcastVariables;
+    }
+
+    void setBroadcastVariables(Handle<Vector<Handle<BroadcastVariable>>> broadcastVariables) {
+        this->broadcastVariables = broadcastVariables;
+    }
+
     ENABLE_DEEP_COPY
 
 private:
     String tcapString;
+
+    // the read-only objects shipped to every worker for this job, nullptr if there are none
+    Handle<Vector<Handle<BroadcastVariable>>> broadcastVariables;
 };
 }
 
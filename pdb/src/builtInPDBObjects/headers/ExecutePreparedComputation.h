@@ -0,0 +1,68 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef EXECUTE_PREPARED_COMPUTATION_H
+#define EXECUTE_PREPARED_COMPUTATION_H
+
+#include "Object.h"
+#include "PDBString.h"
+#include "PDBVector.h"
+#include "BroadcastVariable.h"
+
+// PRELOAD %ExecutePreparedComputation%
+
+namespace pdb {
+
+// encapsulates a request to run a prepared computation; the scheduler already holds its computations,
+// an execution only names it and ships the broadcast variables it binds
+class ExecutePreparedComputation : public Object {
+
+public:
+    ExecutePreparedComputation() {}
+    ~ExecutePreparedComputation() {}
+
+    ExecutePreparedComputation(std::string preparedName,
+                               Handle<Vector<Handle<BroadcastVariable>>> broadcastVariables) {
+        this->preparedName = preparedName;
+        this->broadcastVariables = broadcastVariables;
+    }
+
+    std::string getPreparedName() {
+        return preparedName;
+    }
+
+    Handle<Vector<Handle<BroadcastVariable>>> getBroadcastVariables() {
+        return broadcastVariables;
+    }
+
+    void setBroadcastVariables(Handle<Vector<Handle<BroadcastVariable>>> broadcastVariables) {
+        this->broadcastVariables = broadcastVariables;
+    }
+
+    ENABLE_DEEP_COPY
+
+private:
+    // the name the computation was prepared under
+    String preparedName;
+
+    // the read-only objects shipped to every worker for this execution, nullptr if there are none
+    Handle<Vector<Handle<BroadcastVariable>>> broadcastVariables;
+};
+}
+
+#endif
@@ -0,0 +1,99 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef FLAT_ROW_BLOCK_H
+#define FLAT_ROW_BLOCK_H
+
+#include <type_traits>
+
+#include "Object.h"
+#include "PDBVector.h"
+
+// PRELOAD %FlatRowBlock <Nothing>%
+
+namespace pdb {
+
+// A block of flat records, stored back to back in a single array.  A flat record is a class
+// made up only of primitive types and FixedStrings: it has no v-table pointer, no Handles and
+// no object header, so reading a field is a load at a fixed offset from the start of the row,
+// and a scan over the block is a sequential pass over memory.  Storing a set of records as
+// FlatRowBlocks of a few thousand rows, instead of as one Object per record, leaves a single
+// Handle to decode per block rather than one per record and one per String field.
+//
+// Computations take the whole block as their input and loop over getRows () themselves.
+
+template <class Row>
+class FlatRowBlock : public Object {
+
+private:
+    // the records
+    Vector<Row> rows;
+
+    static void checkRowType() {
+        static_assert(std::is_trivially_copyable<Row>::value,
+                      "the rows of a FlatRowBlock must be trivially copyable");
+        static_assert(!std::is_base_of<Object, Row>::value,
+                      "the rows of a FlatRowBlock can not be pdb::Objects");
+    }
+
+public:
+    ENABLE_DEEP_COPY
+
+    FlatRowBlock() {}
+
+    // pre-allocates space for numRows rows
+    FlatRowBlock(uint32_t numRows) : rows(numRows) {}
+
+    ~FlatRowBlock() {}
+
+    size_t size() const {
+        return rows.size();
+    }
+
+    // appends a copy of the row; like Vector :: push_back, this throws a NotEnoughSpace
+    // exception if the current allocation block can not hold the grown array
+    void push_back(const Row& row) {
+        checkRowType();
+        rows.push_back(row);
+    }
+
+    Row& operator[](uint32_t which) {
+        return rows[which];
+    }
+
+    const Row& operator[](uint32_t which) const {
+        return rows[which];
+    }
+
+    // the first row, the others follow at increasing addresses
+    Row* getRows() const {
+        checkRowType();
+        return rows.c_ptr();
+    }
+
+    Row* begin() const {
+        return getRows();
+    }
+
+    Row* end() const {
+        return getRows() + rows.size();
+    }
+};
+}
+
+#endif
@@ -0,0 +1,62 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef GET_SET_NODES_H
+#define GET_SET_NODES_H
+
+#include "Object.h"
+#include "Handle.h"
+#include "PDBString.h"
+
+//  PRELOAD %GetSetNodes%
+
+namespace pdb {
+
+// A request to the distributed storage manager for the nodes that hold data of a set; the answer
+// is a ListOfNodes with one "address:port" entry per node
+class GetSetNodes : public Object {
+
+public:
+    GetSetNodes(std::string dbNameIn, std::string setNameIn) {
+        dbName = dbNameIn;
+        setName = setNameIn;
+    }
+
+    GetSetNodes() {}
+    ~GetSetNodes() {}
+
+    String getDatabase() {
+        return dbName;
+    }
+
+    String getSetName() {
+        return setName;
+    }
+
+    ENABLE_DEEP_COPY
+
+private:
+    // the database of the set
+    String dbName;
+
+    // and the set
+    String setName;
+};
+}
+
+#endif
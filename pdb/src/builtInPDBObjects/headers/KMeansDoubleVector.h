@@ -23,6 +23,7 @@
 #include "Handle.h"
 #include "PDBVector.h"
 #include "Configuration.h"
+#include "DistanceKernels.h"
 #include <math.h>
 // PRELOAD %KMeansDoubleVector%
 
@@ -88,25 +89,12 @@ public:
 
     /* Dot product */
     inline double dot(KMeansDoubleVector& other) {
-        double* otherRawData = other.getRawData();
-        double dotSum = 0;
-        for (size_t i = 0; i < NUM_KMEANS_DIMENSIONS; i++) {
-            dotSum += rawData[i] * otherRawData[i];
-        }
-        return dotSum;
+        return DistanceKernels::dot(rawData, other.getRawData(), NUM_KMEANS_DIMENSIONS);
     }
 
     /* Compute the squared distance */
     inline double getSquaredDistance(KMeansDoubleVector& other) {
-        double* otherRawData = other.getRawData();
-        double distance = 0;
-        size_t kv = 0;
-        while (kv < NUM_KMEANS_DIMENSIONS) {
-            double score = rawData[kv] - otherRawData[kv];
-            distance += score * score;
-            kv++;
-        }
-        return distance;
+        return DistanceKernels::squaredDistance(rawData, other.getRawData(), NUM_KMEANS_DIMENSIONS);
     }
 
 
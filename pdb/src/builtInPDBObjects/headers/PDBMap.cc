@@ -115,11 +115,13 @@ ValueType& Map<KeyType, ValueType>::operator[](const KeyType& which) {
     // so that we can make sure usedSlot < maxSlots each time before we invoke[] for insertion
     // and for read-only data, we will not invoke doubleArray(), if we always invoke count() before
     // invoke []
-    if (myArray->count(which) == 0) {
-        if (myArray->isOverFull()) {
-            Handle<PairArray<KeyType, ValueType>> temp = myArray->doubleArray();
-            myArray = temp;
-        }
+    ValueType* found = myArray->lookup(which);
+    if (found != nullptr) {
+        return *found;
+    }
+    if (myArray->isOverFull()) {
+        Handle<PairArray<KeyType, ValueType>> temp = myArray->doubleArray();
+        myArray = temp;
     }
     ValueType& res = (*myArray)[which];
     return res;
@@ -130,6 +132,11 @@ int Map<KeyType, ValueType>::count(const KeyType& which) {
     return myArray->count(which);
 }
 
+template <class KeyType, class ValueType>
+ValueType* Map<KeyType, ValueType>::lookup(const KeyType& which) {
+    return myArray->lookup(which);
+}
+
 template <class KeyType, class ValueType>
 size_t Map<KeyType, ValueType>::size() const {
     return myArray->numUsedSlots();
@@ -64,6 +64,9 @@ public:
     // returns 0 if this entry is undefined; 1 if it is defined
     int count(const KeyType& which);
 
+    // returns the value at which, or nullptr if it is undefined, with a single probe
+    ValueType* lookup(const KeyType& which);
+
     // these are used for iteration
     PDBMapIterator<KeyType, ValueType> begin();
     PDBMapIterator<KeyType, ValueType> end();
@@ -86,7 +86,7 @@ void Vector<TypeContained>::assign(uint32_t which, const TypeContained& val) {
 template <class TypeContained>
 void Vector<TypeContained>::push_back() {
     if (myArray->isFull()) {
-        myArray = myArray->doubleSize();
+        makeRoomFor(1);
     }
     myArray->push_back();
 }
@@ -94,7 +94,7 @@ void Vector<TypeContained>::push_back() {
 template <class TypeContained>
 void Vector<TypeContained>::push_back(const TypeContained& val) {
     if (myArray->isFull()) {
-        myArray = myArray->doubleSize();
+        makeRoomFor(1);
     }
     myArray->push_back(val);
 }
@@ -114,6 +114,68 @@ void Vector<TypeContained>::resize(uint32_t toMe) {
     myArray = myArray->resize(toMe);
 }
 
+template <class TypeContained>
+void Vector<TypeContained>::reserve(uint32_t toMe) {
+    if (myArray->capacity() >= toMe || myArray->growInPlace(toMe)) {
+        return;
+    }
+    myArray = myArray->resize(toMe);
+}
+
+template <class TypeContained>
+size_t Vector<TypeContained>::capacity() const {
+    return myArray->capacity();
+}
+
+template <class TypeContained>
+void Vector<TypeContained>::makeRoomFor(uint32_t howManyMore) {
+    uint32_t needed = myArray->numUsedSlots() + howManyMore;
+    uint32_t numSlots = myArray->capacity();
+    if (numSlots >= needed) {
+        return;
+    }
+
+    // if we are at the end of the block we can take just what we need, since nothing is copied
+    if (myArray->growInPlace(needed)) {
+        return;
+    }
+
+    // otherwise we double, like doubleSize () does, unless the request is larger
+    uint32_t target = numSlots * 2;
+    if (target < needed) {
+        target = needed;
+    }
+    myArray = myArray->resize(target);
+}
+
+template <class TypeContained>
+void Vector<TypeContained>::append(const TypeContained* values, uint32_t howMany) {
+    // the values may come from this vector, and growing it frees the array they are in, so we
+    // remember where they are instead of where they were
+    const TypeContained* first = c_ptr();
+    bool fromHere = values >= first && values < first + size();
+    uint32_t offset = fromHere ? values - first : 0;
+    try {
+        makeRoomFor(howMany);
+    } catch (NotEnoughSpace& n) {
+        // not everything fits, so add whatever does, each item is copied before we might move
+        for (uint32_t i = 0; i < howMany; i++) {
+            TypeContained value = fromHere ? c_ptr()[offset + i] : values[i];
+            push_back(value);
+        }
+        return;
+    }
+    if (fromHere) {
+        values = c_ptr() + offset;
+    }
+    myArray->append(values, howMany);
+}
+
+template <class TypeContained>
+void Vector<TypeContained>::append(const Vector<TypeContained>& values) {
+    append(values.c_ptr(), values.size());
+}
+
 template <class TypeContained>
 TypeContained* Vector<TypeContained>::c_ptr() const {
     return myArray->c_ptr();
@@ -68,6 +68,20 @@ public:
     void clear();
     TypeContained* c_ptr() const;
     void resize(uint32_t toMe);
+    void reserve(uint32_t toMe);
+    size_t capacity() const;
+
+    // makes sure that howManyMore items can be added without moving the vector again; it grows
+    // in place if the vector is the last thing in the allocation block, and otherwise to at least
+    // twice its size, so that a series of calls only copies the vector a logarithmic number of
+    // times
+    void makeRoomFor(uint32_t howManyMore);
+
+    // adds howMany items to the end, they may come from this vector itself.  If they do not all
+    // fit, as many of them as fit are added one by one before NotEnoughSpace is thrown, so size ()
+    // tells how far we got
+    void append(const TypeContained* values, uint32_t howMany);
+    void append(const Vector<TypeContained>& values);
 
     // added by Shangyu
     void print() const;
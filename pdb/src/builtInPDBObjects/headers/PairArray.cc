@@ -232,7 +232,7 @@ PairArray<KeyType, ValueType>::PairArray(const PairArray& toMe) {
 }
 
 template <class KeyType, class ValueType>
-int PairArray<KeyType, ValueType>::count(const KeyType& me) {
+ValueType* PairArray<KeyType, ValueType>::lookup(const KeyType& me) {
 
     // hash this dude
     size_t hashVal = Hasher<KeyType>::hash(me);
@@ -245,12 +245,12 @@ int PairArray<KeyType, ValueType>::count(const KeyType& me) {
 
         // if we found an empty slot, then this guy was not here
         if (GET_HASH(data, slot) == UNUSED) {
-            return 0;
+            return nullptr;
         } else if (GET_HASH(data, slot) == hashVal) {
 
             // potential match!!
             if (GET_KEY(data, slot, KeyType) == me) {
-                return 1;
+                return &GET_VALUE(data, slot, ValueType);
             }
         }
 
@@ -266,10 +266,14 @@ int PairArray<KeyType, ValueType>::count(const KeyType& me) {
     }
 
     // we should never reach here
-    std::cout << "in count(): hashVal = " << hashVal << ", slot = " << slot
+    std::cout << "in lookup(): hashVal = " << hashVal << ", slot = " << slot
               << ", numSlots =" << numSlots << ". Warning: Ran off the end of the hash table!!\n";
-    return 0;
-    // exit (1);
+    return nullptr;
+}
+
+template <class KeyType, class ValueType>
+int PairArray<KeyType, ValueType>::count(const KeyType& me) {
+    return lookup(me) == nullptr ? 0 : 1;
 }
 
 template <class KeyType, class ValueType>
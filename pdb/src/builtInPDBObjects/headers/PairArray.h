@@ -126,6 +126,10 @@ public:
     // returns 0 if this entry is undefined; 1 if it is defined
     int count(const KeyType& which);
 
+    // returns the value at which, or nullptr if it is undefined; unlike count () followed by
+    // operator [], this hashes and probes only once
+    ValueType* lookup(const KeyType& which);
+
     // so this guy can look inside
     template <class KeyTwo, class ValueTwo>
     friend class PDBMapIterator;
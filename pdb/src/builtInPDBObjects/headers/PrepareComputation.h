@@ -0,0 +1,62 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef PREPARE_COMPUTATION_H
+#define PREPARE_COMPUTATION_H
+
+#include "Object.h"
+#include "PDBString.h"
+
+// PRELOAD %PrepareComputation%
+
+namespace pdb {
+
+// encapsulates a request to prepare a computation graph under a name, so that its executions only
+// name it and reuse its plan and job stages; it is followed by the computations, which the
+// scheduler keeps
+class PrepareComputation : public Object {
+
+public:
+    PrepareComputation() {}
+    ~PrepareComputation() {}
+
+    PrepareComputation(std::string preparedName, std::string tcapString) {
+        this->preparedName = preparedName;
+        this->tcapString = tcapString;
+    }
+
+    std::string getPreparedName() {
+        return preparedName;
+    }
+
+    std::string getTCAPString() {
+        return tcapString;
+    }
+
+    ENABLE_DEEP_COPY
+
+private:
+    // the name the computation is prepared under
+    String preparedName;
+
+    // the TCAP program every execution has to match
+    String tcapString;
+};
+}
+
+#endif
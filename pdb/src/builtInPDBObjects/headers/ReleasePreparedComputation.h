@@ -0,0 +1,52 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef RELEASE_PREPARED_COMPUTATION_H
+#define RELEASE_PREPARED_COMPUTATION_H
+
+#include "Object.h"
+#include "PDBString.h"
+
+// PRELOAD %ReleasePreparedComputation%
+
+namespace pdb {
+
+// encapsulates a request to drop a prepared computation and the job stages cached for it
+class ReleasePreparedComputation : public Object {
+
+public:
+    ReleasePreparedComputation() {}
+    ~ReleasePreparedComputation() {}
+
+    ReleasePreparedComputation(std::string preparedName) {
+        this->preparedName = preparedName;
+    }
+
+    std::string getPreparedName() {
+        return preparedName;
+    }
+
+    ENABLE_DEEP_COPY
+
+private:
+    // the name the computation was prepared under
+    String preparedName;
+};
+}
+
+#endif
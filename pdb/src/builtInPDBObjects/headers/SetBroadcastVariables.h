@@ -0,0 +1,55 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef SET_BROADCAST_VARIABLES_H
+#define SET_BROADCAST_VARIABLES_H
+
+#include "Object.h"
+#include "Handle.h"
+#include "PDBVector.h"
+#include "BroadcastVariable.h"
+
+// PRELOAD %SetBroadcastVariables%
+
+namespace pdb {
+
+// sent by the scheduler to every worker before the stages of a job; the workers keep the variables
+// until the next SetBroadcastVariables replaces them, an empty one is sent when the job is done
+class SetBroadcastVariables : public Object {
+
+public:
+    SetBroadcastVariables() {}
+    ~SetBroadcastVariables() {}
+
+    SetBroadcastVariables(Handle<Vector<Handle<BroadcastVariable>>> variables) {
+        this->variables = variables;
+    }
+
+    Handle<Vector<Handle<BroadcastVariable>>> getVariables() {
+        return variables;
+    }
+
+    ENABLE_DEEP_COPY
+
+private:
+    // the variables of the job, nullptr if there are none
+    Handle<Vector<Handle<BroadcastVariable>>> variables;
+};
+}
+
+#endif
@@ -108,6 +108,39 @@ class SetIdentifier : public Object {
     return this->pageSize;
   }
 
+  // the most heap memory the job has held on the worker that ran the stage writing this set
+  void setPeakMemoryBytes(size_t peakMemoryBytes) {
+    this->peakMemoryBytes = peakMemoryBytes;
+  }
+
+  size_t getPeakMemoryBytes() {
+    return this->peakMemoryBytes;
+  }
+
+  // the bytes of intermediate data the worker that ran the stage writing this set received from
+  // the other workers while it ran, and the most shared memory it had in use meanwhile
+  void setStageStats(size_t shuffledBytes, size_t peakSharedMemoryBytes) {
+    this->shuffledBytes = shuffledBytes;
+    this->peakSharedMemoryBytes = peakSharedMemoryBytes;
+  }
+
+  size_t getShuffledBytes() {
+    return this->shuffledBytes;
+  }
+
+  size_t getPeakSharedMemoryBytes() {
+    return this->peakSharedMemoryBytes;
+  }
+
+  // why the stage writing this set failed on the worker that returns it, empty if it did not
+  void setErrMsg(std::string errMsg) {
+    this->errMsg = errMsg;
+  }
+
+  std::string getErrMsg() {
+    return this->errMsg;
+  }
+
   std::string toSourceSetName() {
     return getDatabase() + ":" + getSetName();
   }
@@ -140,6 +173,10 @@ class SetIdentifier : public Object {
   bool isAggregationResultOrNot;
   size_t numPages;
   size_t pageSize;
+  size_t peakMemoryBytes = 0;
+  size_t shuffledBytes = 0;
+  size_t peakSharedMemoryBytes = 0;
+  String errMsg;
 };
 }
 
@@ -25,6 +25,11 @@
 
 // PRELOAD %SetScan%
 
+// the number of pages a worker sends ahead of the client's acknowledgements, if not specified
+#ifndef DEFAULT_SET_SCAN_WINDOW
+#define DEFAULT_SET_SCAN_WINDOW 4
+#endif
+
 namespace pdb {
 
 // encapsulates a request to scan a set stored in the database
@@ -34,6 +39,18 @@ public:
     SetScan(std::string dbNameIn, std::string setNameIn) {
         dbName = dbNameIn;
         setName = setNameIn;
+#ifdef ENABLE_COMPRESSION
+        compressed = true;
+#endif
+    }
+
+    // windowSizeIn is the number of pages that may be in flight before the client acknowledges
+    // them with a KeepGoing, compressedIn tells whether pages are snappy compressed on the wire
+    SetScan(std::string dbNameIn, std::string setNameIn, int windowSizeIn, bool compressedIn) {
+        dbName = dbNameIn;
+        setName = setNameIn;
+        windowSize = windowSizeIn;
+        compressed = compressedIn;
     }
 
     SetScan() {}
@@ -47,6 +64,14 @@ public:
         return setName;
     }
 
+    int getWindowSize() {
+        return windowSize;
+    }
+
+    bool isCompressed() {
+        return compressed;
+    }
+
     ENABLE_DEEP_COPY
 
 private:
@@ -55,6 +80,12 @@ private:
 
     // and the set
     String setName;
+
+    // the number of unacknowledged pages the sender may have in flight
+    int windowSize = 1;
+
+    // whether the pages are compressed
+    bool compressed = false;
 };
 }
 
@@ -44,9 +44,39 @@ public:
         return std::make_pair(res, errMsg);
     }
 
+    // the most heap memory the query held on a worker, for the results of a job stage or a query
+    void setPeakMemoryBytes(size_t peakMemoryBytes) {
+        this->peakMemoryBytes = peakMemoryBytes;
+    }
+
+    size_t getPeakMemoryBytes() {
+        return peakMemoryBytes;
+    }
+
+    // the bytes of intermediate data the workers received from each other for a query
+    void setShuffledBytes(size_t shuffledBytes) {
+        this->shuffledBytes = shuffledBytes;
+    }
+
+    size_t getShuffledBytes() {
+        return shuffledBytes;
+    }
+
+    // the most shared memory a worker had in use while it ran a stage of a query
+    void setPeakSharedMemoryBytes(size_t peakSharedMemoryBytes) {
+        this->peakSharedMemoryBytes = peakSharedMemoryBytes;
+    }
+
+    size_t getPeakSharedMemoryBytes() {
+        return peakSharedMemoryBytes;
+    }
+
 private:
     bool res;
     String errMsg;
+    size_t peakMemoryBytes = 0;
+    size_t shuffledBytes = 0;
+    size_t peakSharedMemoryBytes = 0;
 };
 }
 
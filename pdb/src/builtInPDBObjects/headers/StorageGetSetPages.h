@@ -20,7 +20,10 @@
 #define SRC_BUILTINPDBOBJECTS_HEADERS_GETSETPAGES_H_
 
 #include "Object.h"
+#include "Handle.h"
+#include "PDBVector.h"
 #include "DataTypes.h"
+#include "ColumnRange.h"
 
 //  PRELOAD %StorageGetSetPages%
 
@@ -64,6 +67,14 @@ public:
         this->setId = setId;
     }
 
+    // get/set the ranges the scanned pages have to overlap, nullptr to scan all pages
+    Handle<Vector<ColumnRange>> getRangeFilter() {
+        return this->rangeFilter;
+    }
+    void setRangeFilter(Handle<Vector<ColumnRange>> rangeFilter) {
+        this->rangeFilter = rangeFilter;
+    }
+
     ENABLE_DEEP_COPY
 
 
@@ -72,6 +83,7 @@ private:
     DatabaseID dbId;
     UserTypeID userTypeId;
     SetID setId;
+    Handle<Vector<ColumnRange>> rangeFilter = nullptr;
 };
 }
 
@@ -0,0 +1,106 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef STRING_DICTIONARY_H
+#define STRING_DICTIONARY_H
+
+#include "Object.h"
+#include "PDBString.h"
+#include "PDBVector.h"
+#include "PDBMap.h"
+
+// PRELOAD %StringDictionary%
+
+namespace pdb {
+
+// the code encode () returns for a new string when the dictionary is full
+#define NO_DICTIONARY_CODE -1
+
+// Maps each distinct value of a low-cardinality string attribute (a flag, a status, a country
+// name) to a small integer code, and back.  A dictionary is built for a set when it is loaded, and
+// stored in a set of its own; a query ships it to the workers as a broadcast variable, and its
+// lambdas turn the strings into codes through a DictionaryEncoder, so that the hash sinks, the
+// shuffle and the aggregation only ever hash and compare integers.  The strings are looked up
+// again with decode () when the results are materialized.
+class StringDictionary : public Object {
+
+public:
+    ENABLE_DEEP_COPY
+
+    StringDictionary() {}
+
+    // maxSize is the most distinct strings the dictionary takes, an attribute with more than that
+    // is not worth encoding
+    StringDictionary(uint32_t maxSize) {
+        this->maxSize = maxSize;
+    }
+
+    // returns the code of the string, giving it the next code if it is new, or NO_DICTIONARY_CODE
+    // if it is new and the dictionary is full
+    int32_t encode(const String& addMe) {
+        int32_t* found = codes.lookup(addMe);
+        if (found != nullptr) {
+            return *found;
+        }
+        if (strings.size() >= maxSize) {
+            return NO_DICTIONARY_CODE;
+        }
+        int32_t code = (int32_t)strings.size();
+        strings.push_back(addMe);
+        codes[addMe] = code;
+        return code;
+    }
+
+    // sets code to the code of the string and returns true, or returns false if the string is not
+    // in the dictionary; a string that is not has no code that could stand for it
+    bool getCode(const String& findMe, int32_t& code) {
+        int32_t* found = codes.lookup(findMe);
+        if (found == nullptr) {
+            return false;
+        }
+        code = *found;
+        return true;
+    }
+
+    // returns the string with this code, which must be in the dictionary
+    String& decode(int32_t code) {
+        return strings[code];
+    }
+
+    // the number of strings in the dictionary, their codes are 0 up to this
+    size_t size() {
+        return strings.size();
+    }
+
+    bool isFull() {
+        return strings.size() >= maxSize;
+    }
+
+private:
+    // the strings, each at the position of its code
+    Vector<String> strings;
+
+    // the code of each string
+    Map<String, int32_t> codes;
+
+    // the most strings the dictionary takes
+    uint32_t maxSize = 65536;
+};
+}
+
+#endif
@@ -285,6 +285,12 @@ TopKQueue<Score, ValueType>& TopKQueue<Score, ValueType>::operator+(
 
 template <class Score, class ValueType>
 unsigned TopKQueue<Score, ValueType>::size() {
+    if (empty) {
+        return 0;
+    }
+    if (allValues == nullptr) {
+        return 1;
+    }
     return allValues->size();
 }
 
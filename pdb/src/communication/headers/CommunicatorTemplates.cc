@@ -107,6 +107,28 @@ bool PDBCommunicator::sendObject(Handle<ObjType>& sendMe, std::string& errMsg) {
     return true;
 }
 
+template <class ObjType>
+bool PDBCommunicator::sendRecord(Record<ObjType>* sendMe, std::string& errMsg) {
+
+    // first, write the record type
+    int16_t recType = getTypeID<ObjType>();
+    if (doTheWrite(((char*)&recType), ((char*)&recType) + sizeof(int16_t))) {
+        errMsg = "PDBCommunicator: not able to send the object type";
+        logToMe->error(errMsg);
+        logToMe->error(strerror(errno));
+        return false;
+    }
+
+    // next, write the record, its first bytes hold its size
+    if (doTheWrite((char*)sendMe, ((char*)sendMe) + sendMe->numBytes())) {
+        errMsg = "PDBCommunicator: not able to send the object";
+        logToMe->error(errMsg);
+        logToMe->error(strerror(errno));
+        return false;
+    }
+    return true;
+}
+
 inline bool PDBCommunicator::receiveBytes(void* data, std::string& errMsg) {
 
     // if we have previously gotten the size, just return it
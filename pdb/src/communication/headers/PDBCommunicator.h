@@ -80,6 +80,11 @@ public:
     template <class ObjType>
     bool sendObject(Handle<ObjType>& sendMe, std::string& errMsg);
 
+    // sends an object that was already serialized into a record... unlike sendObject, this does not
+    // touch the allocator, so it can be called from threads that do not own one
+    template <class ObjType>
+    bool sendRecord(Record<ObjType>* sendMe, std::string& errMsg);
+
     // sends a bunch of binary data over a channel
     bool sendBytes(void* data, size_t size, std::string& errMsg);
 
@@ -0,0 +1,66 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef BROADCAST_VARIABLE_MAP_H
+#define BROADCAST_VARIABLE_MAP_H
+
+#include "Object.h"
+#include "Record.h"
+#include <map>
+#include <memory>
+#include <string>
+
+namespace pdb {
+
+// the broadcast variables a worker holds for the running job, each one in its own malloced Record;
+// the Records live outside of any allocation block, so every pipeline thread can read them through
+// the same Handle without touching reference counts
+typedef std::map<std::string, Record<Object>*> BroadcastVariableMap;
+
+// the map is swapped as a whole when a job sets new variables, threads that still run keep theirs
+// alive through this pointer; the last one frees the Records
+typedef std::shared_ptr<BroadcastVariableMap> BroadcastVariableMapPtr;
+
+// binds a Computation to the broadcast variables of the worker it runs on; the address is only
+// valid in that process, so it is not part of the Computation's state: a copy of a Computation,
+// be it a deep copy into a page or the copy that is sent to another process, starts out unbound
+class BroadcastVariableBinding {
+
+public:
+    BroadcastVariableBinding() {}
+
+    BroadcastVariableBinding(const BroadcastVariableBinding& toMe) {}
+
+    BroadcastVariableBinding& operator=(const BroadcastVariableBinding& toMe) {
+        return *this;
+    }
+
+    void bind(BroadcastVariableMap* variables) {
+        this->variables = variables;
+    }
+
+    BroadcastVariableMap* getVariables() const {
+        return variables;
+    }
+
+private:
+    BroadcastVariableMap* variables = nullptr;
+};
+}
+
+#endif
@@ -27,6 +27,7 @@
 #include "SinkShuffler.h"
 #include "InputTupleSetSpecifier.h"
 #include "PDBString.h"
+#include "BroadcastVariableMap.h"
 #include <map>
 
 namespace pdb {
@@ -173,6 +174,18 @@ public:
      */
     virtual std::string getOutputType() = 0;
 
+    /**
+     * adds the names of the types this computation works with to typeNames, so that a worker
+     * can load all of them before running the computation
+     * @param typeNames the list to add the names to
+     */
+    virtual void getReferencedTypes(std::vector<std::string>& typeNames) {
+        typeNames.push_back(getOutputType());
+        for (int i = 0; i < getNumInputs(); i++) {
+            typeNames.push_back(getIthInputType(i));
+        }
+    }
+
     /**
      * gets the output type if of this query
      * @return
@@ -370,6 +383,41 @@ public:
      */
     virtual void setNumNodesToCollect(int numNodesToCollect) {}
 
+    /**
+     * Binds the broadcast variables of the job this computation runs in; this is done by the
+     * worker on each thread's copy of the computation, right before the pipeline is built
+     * @param broadcastVariables the variables, they outlive the pipeline
+     */
+    void setBroadcastVariables(BroadcastVariableMap* broadcastVariables) {
+        this->broadcastVariables.bind(broadcastVariables);
+    }
+
+    /**
+     * Adds the names of the broadcast variables this computation can not run without; a worker
+     * fails the stage, instead of running it, if the job has not set one of them
+     * @param names the list to add the names to
+     */
+    virtual void getRequiredBroadcastVariables(std::vector<std::string>& names) {}
+
+    /**
+     * Returns a read-only handle to a broadcast variable, the object is shared by all threads of
+     * the worker, so it must not be modified
+     * @param name the name the variable was broadcast with
+     * @return the variable, or nullptr if this job has no variable with this name
+     */
+    template <class ObjType>
+    Handle<ObjType> getBroadcastVariable(const std::string& name) {
+        BroadcastVariableMap* variables = broadcastVariables.getVariables();
+        if (variables == nullptr) {
+            return nullptr;
+        }
+        auto it = variables->find(name);
+        if (it == variables->end()) {
+            return nullptr;
+        }
+        return ((Record<ObjType>*)it->second)->getRootObject();
+    }
+
 private:
 
     Handle<Vector<Handle<Computation>>> inputs = nullptr;
@@ -385,6 +433,9 @@ private:
     AllocatorPolicy myAllocatorPolicy = AllocatorPolicy::defaultAllocator;
 
     ObjectPolicy myObjectPolicy = ObjectPolicy::defaultObject;
+
+    // the broadcast variables of the running job, only bound on the workers and never copied
+    BroadcastVariableBinding broadcastVariables;
 };
 }
 
@@ -20,6 +20,7 @@
 
 #include "AggregateComp.h"
 #include "TopKQueue.h"
+#include "TopKThreshold.h"
 #include "LambdaCreationFunctions.h"
 
 namespace pdb {
@@ -32,6 +33,13 @@ namespace pdb {
  * value of k (the number of items to return), the Score object extracted from aggMe, and the ValueType object
  * extracted from aggMe.
  *
+ * All items are aggregated under the same key.  The combiner of each worker merges the queues of
+ * its threads, so a worker shuffles a single queue of at most k items, and the aggregation merges
+ * those into the one queue of the output set.  An implementation that builds its queues with
+ * offer () also gets the k-th best score seen on the worker pushed back into the pipeline, so that
+ * items that can not qualify are dropped before they are aggregated, and getThreshold () lets it
+ * stop scoring an item as soon as it falls behind.
+ *
  * @tparam InputClass
  * @tparam Score
  * @tparam ValueType
@@ -60,6 +68,52 @@ public:
             return TopKQueue<Score, ValueType>(1, Score(), ValueType());
         });
     }
+
+    /**
+     * joins the threshold shared by the threads of the worker
+     * @param stageName - identifies the stage on this worker
+     * @return the threshold of this thread, it has to outlive the pipeline
+     */
+    std::shared_ptr<void> setUpLocalExecution(std::string stageName) override {
+        std::shared_ptr<TopKThreshold<Score>> myThreshold =
+            std::make_shared<TopKThreshold<Score>>(stageName);
+        threshold = myThreshold.get();
+        return myThreshold;
+    }
+
+protected:
+
+    /**
+     * builds the queue for a single item, or an empty one if the item can not make it into the
+     * top k anymore
+     * @param k - the number of items the query returns
+     * @param score - the score of the item
+     * @param value - the item
+     * @return the queue to aggregate
+     */
+    TopKQueue<Score, ValueType> offer(unsigned k, Score score, ValueType value) {
+        if (threshold != nullptr) {
+            if (!threshold->mayQualify(score)) {
+                return TopKQueue<Score, ValueType>(k);
+            }
+            threshold->add(k, score);
+        }
+        return TopKQueue<Score, ValueType>(k, score, value);
+    }
+
+    /**
+     * gets the score an item has to reach to make it into the top k, as far as this worker knows
+     * @param minScore - set to the threshold, if there is one
+     * @return true if there is a threshold
+     */
+    bool getThreshold(Score& minScore) {
+        return threshold != nullptr && threshold->getThreshold(minScore);
+    }
+
+private:
+
+    // the threshold of this pipeline thread, only set while the computation runs on a worker
+    TopKThreshold<Score>* threshold = nullptr;
 };
 
 }
@@ -25,6 +25,7 @@
 #include "PageCircularBufferIterator.h"
 #include "ScanUserSet.h"
 #include "DataTypes.h"
+#include <memory>
 #include <vector>
 
 
@@ -165,6 +166,17 @@ public:
         this->whereHashTableSitsForThePartition = hashTableLocation;
     }
 
+    /**
+     * Called on every pipeline thread of a worker before the pipeline that feeds this aggregation
+     * is built, so that the aggregation can set up state that is local to the worker
+     *
+     * @param stageName - identifies the stage, it is the same on all threads of the worker
+     * @return whatever has to stay alive until the thread is done with the pipeline
+     */
+    virtual std::shared_ptr<void> setUpLocalExecution(std::string stageName) {
+        return nullptr;
+    }
+
     /**
      * Is this aggregation using a combiner
      * @return true if it does false otherwise
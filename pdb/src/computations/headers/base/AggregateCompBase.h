@@ -248,6 +248,20 @@ class AggregateCompBase : public AbstractAggregateComp {
     }
   }
 
+  /**
+   * The keys and values also end up in the hash tables and the shuffled pages
+   * @param typeNames the list to add the names to
+   */
+  void getReferencedTypes(std::vector<std::string>& typeNames) override {
+    Computation::getReferencedTypes(typeNames);
+    if (std::is_base_of<Object, KeyClass>::value) {
+      typeNames.push_back(getTypeName<KeyClass>());
+    }
+    if (std::is_base_of<Object, ValueClass>::value) {
+      typeNames.push_back(getTypeName<ValueClass>());
+    }
+  }
+
   /**
    * Should the aggregation result be collected on the first 0 to numNodesToCollect
    * @param collectAsMapOrNot - true if it should false otherwise
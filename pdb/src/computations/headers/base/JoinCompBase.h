@@ -452,8 +452,7 @@ class JoinCompBase : public AbstractJoinComp {
             UserTypeID typeId = (UserTypeID)(*((UserTypeID*)(curBytes)));
             curBytes = curBytes + sizeof(UserTypeID);
             SetID setId = (SetID)(*((SetID*)(curBytes)));
-            freeMe->decRefCount();
-            if (freeMe->getRefCount() == 0) {
+            if (freeMe->decRefCount() == 0) {
 #ifdef PROFILING_CACHE
               std::cout << "To unpin Join source page with DatabaseID=" << dbId
                                   << ", UserTypeID=" << typeId << ", SetID=" << setId
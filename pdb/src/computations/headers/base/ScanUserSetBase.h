@@ -24,6 +24,8 @@
 #include "PageCircularBufferIterator.h"
 #include "VectorTupleSetIterator.h"
 #include "PDBString.h"
+#include "PDBVector.h"
+#include "ColumnRange.h"
 #include "DataTypes.h"
 #include "DataProxy.h"
 #include "Configuration.h"
@@ -72,6 +74,7 @@ class ScanUserSetBase : public Computation {
     toMe.dbName = fromMe.dbName;
     toMe.setName = fromMe.setName;
     toMe.outputType = fromMe.outputType;
+    toMe.rangeFilter = fromMe.rangeFilter;
 
   }
 
@@ -86,16 +89,15 @@ class ScanUserSetBase : public Computation {
   ComputeSourcePtr getComputeSource(TupleSpec &schema, ComputePlan &plan) override {
     return std::make_shared<VectorTupleSetIterator>(
 
-        [&]() -> void * {
+        [&](size_t &begin, size_t &end) -> void * {
           if (this->iterator == nullptr) {
             return nullptr;
           }
-          while (this->iterator->hasNext()) {
 
-            PDBPagePtr page = this->iterator->next();
-            if (page != nullptr) {
-              return page->getBytes();
-            }
+          // we may only get a range of the page, if other threads share it with us
+          PDBPagePtr page = nullptr;
+          if (this->iterator->nextRange(page, begin, end)) {
+            return page->getBytes();
           }
 
           return nullptr;
@@ -103,6 +105,10 @@ class ScanUserSetBase : public Computation {
         },
 
         [&](void *freeMe) -> void {
+          // whoever finishes the last range of a page unpins it
+          if (this->iterator != nullptr && !this->iterator->finishRange()) {
+            return;
+          }
           if (this->proxy != nullptr) {
             char *pageRawBytes = (char *) freeMe -
                 (sizeof(NodeID) + sizeof(DatabaseID) + sizeof(UserTypeID) + sizeof(SetID) +
@@ -148,6 +154,26 @@ class ScanUserSetBase : public Computation {
     return this->batchSize;
   }
 
+  /**
+   * Tells the storage that only the objects whose attribute is in [lower, upper] are needed. The pages
+   * whose zone maps show that they hold no such object are then skipped before they are pinned.
+   * It only prunes pages, so the computations reading this scan still have to apply the predicate.
+   * @param attribute the name the objects of the set give the attribute in their zone maps
+   * @param lower the smallest value needed, nullptr if there is no lower bound
+   * @param upper the largest value needed, nullptr if there is no upper bound
+   */
+  template<class T>
+  void addRangeFilter(std::string attribute, const T *lower, const T *upper) {
+    if (this->rangeFilter == nullptr) {
+      this->rangeFilter = makeObject<Vector<ColumnRange>>();
+    }
+    this->rangeFilter->push_back(ColumnRange::make(attribute.c_str(), lower, upper));
+  }
+
+  Handle<Vector<ColumnRange>> getRangeFilter() {
+    return this->rangeFilter;
+  }
+
   void setOutput(std::string dbName, std::string setName) override {
     this->dbName = dbName;
     this->setName = setName;
@@ -294,6 +320,11 @@ class ScanUserSetBase : public Computation {
   int batchSize{};
 
   String outputType = "";
+
+  /**
+   * the ranges the scanned pages have to overlap, see addRangeFilter
+   */
+  Handle<Vector<ColumnRange>> rangeFilter = nullptr;
 };
 
 }
@@ -71,6 +71,47 @@ using namespace std;
 #define DEFAULT_BATCH_SIZE 100
 #endif
 
+// whether pipelines tune the chunk size of their source while they run
+#ifndef DEFAULT_USE_ADAPTIVE_CHUNK_SIZE
+#define DEFAULT_USE_ADAPTIVE_CHUNK_SIZE true
+#endif
+
+// whether pipeline threads steal source pages from each other
+#ifndef DEFAULT_USE_WORK_STEALING
+#define DEFAULT_USE_WORK_STEALING true
+#endif
+
+// how many source morsels per pipeline thread can wait in the work-stealing scheduler
+#ifndef DEFAULT_QUEUED_MORSELS_PER_THREAD
+#define DEFAULT_QUEUED_MORSELS_PER_THREAD 8
+#endif
+
+// how many objects of a source page make up a morsel, so that several threads can share a page
+#ifndef DEFAULT_MORSEL_SIZE
+#define DEFAULT_MORSEL_SIZE 4096
+#endif
+
+// how often a running pipeline checks whether it can take more threads, in milliseconds
+#ifndef DEFAULT_PARALLELISM_CHECK_INTERVAL_MS
+#define DEFAULT_PARALLELISM_CHECK_INTERVAL_MS 20
+#endif
+
+// the most heap memory a single query may hold on a worker, in bytes; 0 means no limit
+#ifndef DEFAULT_QUERY_MEMORY_LIMIT
+#define DEFAULT_QUERY_MEMORY_LIMIT 0
+#endif
+
+// the most heap memory all the queries together may hold on a worker, in bytes; 0 means no limit
+#ifndef DEFAULT_NODE_MEMORY_LIMIT
+#define DEFAULT_NODE_MEMORY_LIMIT 0
+#endif
+
+// how long a query that is out of memory waits for its pages in flight to be written out and freed
+// before it fails, in milliseconds
+#ifndef DEFAULT_MEMORY_SPILL_WAIT_MS
+#define DEFAULT_MEMORY_SPILL_WAIT_MS 2000
+#endif
+
 
 #ifndef DEFAULT_HASH_PAGE_SIZE
 #define DEFAULT_HASH_PAGE_SIZE ((size_t)(512) * (size_t)(1024) * (size_t)(1024))
@@ -114,6 +155,12 @@ private:
     unsigned int numThreads;
     string backEndIpcFile;
     int batchSize;
+    bool useAdaptiveChunkSize;
+    bool useWorkStealing;
+    size_t morselSize;
+    int maxPipelineThreads;
+    size_t queryMemoryLimit;
+    size_t nodeMemoryLimit;
     size_t hashPageSize;
     bool isManager;
     string managerNodeHostName;
@@ -149,6 +196,12 @@ public:
         ipcFile = "/tmp/ipcFile";
         backEndIpcFile = "/tmp/backEndIpcFile";
         batchSize = DEFAULT_BATCH_SIZE;
+        useAdaptiveChunkSize = DEFAULT_USE_ADAPTIVE_CHUNK_SIZE;
+        useWorkStealing = DEFAULT_USE_WORK_STEALING;
+        morselSize = DEFAULT_MORSEL_SIZE;
+        maxPipelineThreads = sysconf(_SC_NPROCESSORS_ONLN);
+        queryMemoryLimit = DEFAULT_QUERY_MEMORY_LIMIT;
+        nodeMemoryLimit = DEFAULT_NODE_MEMORY_LIMIT;
         isManager = false;
         hashPageSize = DEFAULT_HASH_PAGE_SIZE;
         initDirs();
@@ -436,6 +489,54 @@ public:
         this->batchSize = batchSize;
     }
 
+    bool getUseAdaptiveChunkSize() {
+        return this->useAdaptiveChunkSize;
+    }
+
+    void setUseAdaptiveChunkSize(bool useAdaptiveChunkSize) {
+        this->useAdaptiveChunkSize = useAdaptiveChunkSize;
+    }
+
+    bool getUseWorkStealing() {
+        return this->useWorkStealing;
+    }
+
+    void setUseWorkStealing(bool useWorkStealing) {
+        this->useWorkStealing = useWorkStealing;
+    }
+
+    size_t getMorselSize() {
+        return this->morselSize;
+    }
+
+    void setMorselSize(size_t morselSize) {
+        this->morselSize = morselSize;
+    }
+
+    int getMaxPipelineThreads() {
+        return this->maxPipelineThreads;
+    }
+
+    void setMaxPipelineThreads(int maxPipelineThreads) {
+        this->maxPipelineThreads = maxPipelineThreads;
+    }
+
+    size_t getQueryMemoryLimit() {
+        return this->queryMemoryLimit;
+    }
+
+    void setQueryMemoryLimit(size_t queryMemoryLimit) {
+        this->queryMemoryLimit = queryMemoryLimit;
+    }
+
+    size_t getNodeMemoryLimit() {
+        return this->nodeMemoryLimit;
+    }
+
+    void setNodeMemoryLimit(size_t nodeMemoryLimit) {
+        this->nodeMemoryLimit = nodeMemoryLimit;
+    }
+
     std::string getStatisticsDB() {
         return this->statisticsDB;
     }
@@ -472,6 +573,12 @@ public:
         cout << "managerNodePort: " << managerNodePort << endl;
         cout << "logEnabled: " << logEnabled << endl;
         cout << "batchSize: " << batchSize << endl;
+        cout << "useAdaptiveChunkSize: " << useAdaptiveChunkSize << endl;
+        cout << "useWorkStealing: " << useWorkStealing << endl;
+        cout << "morselSize: " << morselSize << endl;
+        cout << "maxPipelineThreads: " << maxPipelineThreads << endl;
+        cout << "queryMemoryLimit: " << queryMemoryLimit << endl;
+        cout << "nodeMemoryLimit: " << nodeMemoryLimit << endl;
         cout << "statisticsDB: " << statisticsDB << endl;
     }
 };
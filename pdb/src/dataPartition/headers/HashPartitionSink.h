@@ -98,13 +98,31 @@ public:
         // get the value columns
         std::vector<Handle<ValueType>>& valueColumn = input->getColumn<Handle<ValueType>>(whichAttToStore);
 
-        // and allocate everyone to a partition
+        // find out where everyone goes
         size_t length = keyColumn.size();
+        std::vector<int> nodeIds(length);
+        std::vector<uint32_t> nodeCounts(numNodes, 0);
         for (size_t i = 0; i < length; i++) {
-
             hashVal = Hasher<KeyType>::hash(keyColumn[i]);
-            int nodeId = (hashVal % (numPartitions))/(numPartitions/numNodes);
-            Vector<Handle<ValueType>>& myVec = *((*writeMe)[nodeId]);
+            nodeIds[i] = (hashVal % (numPartitions))/(numPartitions/numNodes);
+            nodeCounts[nodeIds[i]]++;
+        }
+
+        // so that each node's vector grows at most once for this batch; if some of them do not
+        // fit, the loop below fills up what is left of the page before giving up
+        for (int i = 0; i < numNodes; i++) {
+            if (nodeCounts[i] > 0) {
+                try {
+                    (*writeMe)[i]->makeRoomFor(nodeCounts[i]);
+                } catch (NotEnoughSpace& n) {
+                }
+            }
+        }
+
+        // and allocate everyone to a partition
+        for (size_t i = 0; i < length; i++) {
+
+            Vector<Handle<ValueType>>& myVec = *((*writeMe)[nodeIds[i]]);
 
             try {
                 //to add the value to the partition
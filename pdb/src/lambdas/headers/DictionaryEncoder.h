@@ -0,0 +1,71 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef DICTIONARY_ENCODER_H
+#define DICTIONARY_ENCODER_H
+
+#include "Handle.h"
+#include "PDBString.h"
+#include "StringDictionary.h"
+#include "QueryFailure.h"
+#include <string>
+
+namespace pdb {
+
+// Turns strings into their codes in a StringDictionary, inside the lambdas of a computation, e.g.
+//
+// DictionaryEncoder encoder(getBroadcastVariable<StringDictionary>("flags"));
+// return makeLambda(aggMe, [encoder](Handle<LineItem>& aggMe) { return encoder(aggMe->flag); });
+//
+// The dictionary is a broadcast variable that all threads of a worker share, so the encoder only
+// points to it, and a lambda can capture it by value.  A string that the dictionary does not know
+// fails the query: there is no code it could get without sharing it with other strings, and so
+// being merged with them in the hash sinks.
+class DictionaryEncoder {
+
+public:
+    // an encoder without a dictionary, it fails the query if it is ever asked for a code; this is
+    // what a computation gets where its broadcast variables are not bound, and its lambdas not run
+    DictionaryEncoder() {}
+
+    explicit DictionaryEncoder(Handle<StringDictionary> dictionary) {
+        if (dictionary != nullptr) {
+            this->dictionary = &(*dictionary);
+        }
+    }
+
+    // returns the code of the string, or throws a QueryFailure if it has none
+    int32_t operator()(const String& encodeMe) const {
+        int32_t code;
+        if (dictionary == nullptr) {
+            throw QueryFailure("There is no dictionary to encode the string '" +
+                               std::string(encodeMe.c_str()) + "' with");
+        }
+        if (!dictionary->getCode(encodeMe, code)) {
+            throw QueryFailure("The dictionary has no code for the string '" +
+                               std::string(encodeMe.c_str()) + "'");
+        }
+        return code;
+    }
+
+private:
+    StringDictionary* dictionary = nullptr;
+};
+}
+
+#endif
@@ -25,6 +25,7 @@
 #include "AndLambdaCreationFunctions.h"
 #include "AttAccessLambdaCreationFunctions.h"
 #include "CPPLambdaCreationFunctions.h"
+#include "DictionaryLambdaCreationFunctions.h"
 #include "EqualsLambda.h"
 #include "MethodCallLambda.h"
 #include "SelfLambda.h"
@@ -28,6 +28,7 @@
 #include "EqualsLambdaCreationFunctions.h"
 #include "SimpleComputeExecutor.h"
 #include "CPlusPlusLambda.h"
+#include "CPlusPlusBatchLambda.h"
 #include "TypeName.h"
 
 namespace pdb {
@@ -280,5 +281,24 @@ auto makeLambda(Handle<ParamOne>& pOne,
                                                                                                       ParamFive>>(arg, pOne, pTwo, pThree, pFour, pFive));
 }
 
+/**
+ * Creates a PDB Lambda out of a C++ lambda that processes a whole column at once, e.g.
+ *
+ * makeBatchLambda<int>(aggMe, [](std::vector<Handle<Point>>& points, std::vector<int>& out) {...})
+ *
+ * @tparam ReturnType the type of the output column
+ * @tparam ParamOne the type of the input column
+ * @tparam F void (std::vector<Handle<ParamOne>>& inputs, std::vector<ReturnType>& outputs)
+ * @param pOne the input of the lambda
+ * @param arg the function, the output column is already sized to the input column
+ * @return the lambda tree
+ */
+template <typename ReturnType, typename ParamOne, typename F>
+LambdaTree<ReturnType> makeBatchLambda(Handle<ParamOne>& pOne, F arg) {
+  Handle<Nothing> p2, p3, p4, p5;
+  return LambdaTree<ReturnType>(
+    std::make_shared<CPlusPlusBatchLambda<F, ReturnType, ParamOne>>(arg, pOne, p2, p3, p4, p5));
+}
+
 }
 #endif //PDB_CPPLAMBDACREATIONFUNCTIONS_H
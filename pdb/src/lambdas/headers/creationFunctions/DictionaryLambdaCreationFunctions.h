@@ -0,0 +1,50 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef PDB_DICTIONARYLAMBDACREATIONFUNCTIONS_H
+#define PDB_DICTIONARYLAMBDACREATIONFUNCTIONS_H
+
+#include "CPPLambdaCreationFunctions.h"
+#include "DictionaryEncoder.h"
+
+namespace pdb {
+
+/**
+ * Creates a PDB lambda that returns the code of a string attribute in a dictionary, so that the
+ * computation it feeds, e.g. the key projection of an aggregation or one side of a join, hashes
+ * and ships an int instead of the string, e.g.
+ *
+ * makeDictionaryLambda(aggMe, encoder, [](Handle<LineItem>& aggMe) -> String& { return aggMe->flag; })
+ *
+ * @tparam ClassType the type of the input
+ * @tparam F String& (Handle<ClassType>& input)
+ * @param var the input of the lambda
+ * @param encoder the dictionary to encode with, a string it has no code for fails the query
+ * @param getString returns the string to encode
+ * @return the lambda tree
+ */
+template <typename ClassType, typename F>
+LambdaTree<int32_t> makeDictionaryLambda(Handle<ClassType>& var, DictionaryEncoder encoder, F getString) {
+  return makeLambda(var, [encoder, getString](Handle<ClassType>& input) {
+    return encoder(getString(input));
+  });
+}
+
+}
+
+#endif //PDB_DICTIONARYLAMBDACREATIONFUNCTIONS_H
@@ -0,0 +1,121 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef C_PLUS_PLUS_BATCH_LAM_CC
+#define C_PLUS_PLUS_BATCH_LAM_CC
+
+#include <memory>
+#include <vector>
+#include "CPlusPlusLambda.h"
+
+namespace pdb {
+
+// calls a batch function on a single input, this is what the lambda looks like row by row
+template <typename F, typename ReturnType, typename ParamOne>
+class BatchToRowAdapter {
+
+private:
+    F batchFunc;
+
+public:
+    BatchToRowAdapter(F batchFunc) : batchFunc(batchFunc) {}
+
+    ReturnType operator()(Handle<ParamOne>& input) {
+        std::vector<Handle<ParamOne>> inputs(1, input);
+        std::vector<ReturnType> outputs(1);
+        batchFunc(inputs, outputs);
+        return outputs[0];
+    }
+};
+
+/**
+ * A native lambda over a single input that is called once for a whole column of a TupleSet
+ * instead of once per row, so that it can process the rows with blocked or vectorized kernels.
+ * The function gets the input column and the output column, already sized to the input.
+ * For everything but the execution this is an ordinary native lambda.
+ */
+template <typename F, typename ReturnType, typename ParamOne>
+class CPlusPlusBatchLambda
+    : public CPlusPlusLambda<BatchToRowAdapter<F, ReturnType, ParamOne>, ReturnType, ParamOne> {
+
+private:
+    F myBatchFunc;
+
+public:
+    CPlusPlusBatchLambda(F arg,
+                         Handle<ParamOne>& input1,
+                         Handle<Nothing>& input2,
+                         Handle<Nothing>& input3,
+                         Handle<Nothing>& input4,
+                         Handle<Nothing>& input5)
+        : CPlusPlusLambda<BatchToRowAdapter<F, ReturnType, ParamOne>, ReturnType, ParamOne>(
+              BatchToRowAdapter<F, ReturnType, ParamOne>(arg),
+              input1,
+              input2,
+              input3,
+              input4,
+              input5),
+          myBatchFunc(arg) {}
+
+    ComputeExecutorPtr getExecutor(TupleSpec& inputSchema,
+                                   TupleSpec& attsToOperateOn,
+                                   TupleSpec& attsToIncludeInOutput) override {
+
+        // create the output tuple set
+        TupleSetPtr output = std::make_shared<TupleSet>();
+
+        // create the machine that is going to setup the output tuple set, using the input tuple set
+        TupleSetSetupMachinePtr myMachine =
+            std::make_shared<TupleSetSetupMachine>(inputSchema, attsToIncludeInOutput);
+
+        // this is the input attribute that we need to match on
+        std::vector<int> matches = myMachine->match(attsToOperateOn);
+        int inAtt = matches[0];
+
+        // this is the output attribute
+        int outAtt = attsToIncludeInOutput.getAtts().size();
+
+        F batchFunc = myBatchFunc;
+        return std::make_shared<SimpleComputeExecutor>(
+            output,
+            [=](TupleSetPtr input) mutable {
+
+                // set up the output tuple set
+                myMachine->setup(input, output);
+
+                // setup the output column, if it is not already set up
+                if (!output->hasColumn(outAtt)) {
+                    std::vector<ReturnType>* outputCol = new std::vector<ReturnType>;
+                    output->addColumn(outAtt, outputCol, true);
+                }
+
+                // and hand both columns to the function
+                std::vector<Handle<ParamOne>>& inColumn =
+                    input->getColumn<Handle<ParamOne>>(inAtt);
+                std::vector<ReturnType>& outColumn = output->getColumn<ReturnType>(outAtt);
+                outColumn.resize(inColumn.size());
+                batchFunc(inColumn, outColumn);
+
+                return output;
+            },
+            "nativeBatchLambda");
+    }
+};
+}
+
+#endif
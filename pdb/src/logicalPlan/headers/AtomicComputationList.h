@@ -42,6 +42,9 @@ private:
     // a list of all of the ScanSet objects
     std::vector<AtomicComputationPtr> scans;
 
+    // all of the computations, in the order they were added
+    std::vector<AtomicComputationPtr> allComputations;
+
 public:
     // gets the computation that builds the tuple set with the specified name
     AtomicComputationPtr getProducingAtomicComputation(std::string outputName);
@@ -54,6 +57,9 @@ public:
     // AtomicComputationPtr in the returned list will point to a ScanSet object
     std::vector<AtomicComputationPtr>& getAllScanSets();
 
+    // gets every computation in the graph, in the order they were added
+    std::vector<AtomicComputationPtr>& getAllComputations();
+
     // add an atomic computation to the graph
     void addAtomicComputation(AtomicComputationPtr addMe);
 
@@ -0,0 +1,107 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef LOGICAL_PLAN_OPTIMIZER_H
+#define LOGICAL_PLAN_OPTIMIZER_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "AtomicComputationList.h"
+
+// NOTE: like the rest of the logical plan, this is not part of the pdb namespace
+
+// this is a rule based optimizer for a parsed TCAP plan; it runs between parsing and physical
+// planning, and keeps on applying the following rewrites until none of them fires anymore:
+//
+// 1. common sub-expression elimination: two applications of the same deterministic lambda to the
+//    same attributes of the same tuple set are merged into one, as long as that does not give a
+//    tuple set with a single consumer more of them, since those are materialized
+// 2. predicate pushdown: a filter that follows a join, but only looks at attributes coming from one
+//    side of the join, is moved (together with the applies computing its predicate) in front of
+//    the hash of that side, so that the filtered out tuples are never hashed, shuffled or probed
+// 3. column pruning: attributes carried by an apply or a filter that none of its consumers asks for
+//    are dropped from its output
+//
+// the rewrites only depend on the TCAP, so every process that parses the same TCAP string ends up
+// with the same plan
+struct LogicalPlanOptimizer {
+
+public:
+    // takes the plan to optimize
+    explicit LogicalPlanOptimizer(AtomicComputationList& computationsIn);
+
+    // applies the rewrites and returns the optimized plan
+    AtomicComputationList optimize();
+
+    // the number of applies that were removed as common sub-expressions
+    int getNumEliminated() {
+        return numEliminated;
+    }
+
+    // the number of filters that were pushed below a join
+    int getNumPushedDown() {
+        return numPushedDown;
+    }
+
+    // the number of attributes dropped from the outputs
+    int getNumPruned() {
+        return numPruned;
+    }
+
+private:
+    // merges one pair of identical applies, returns false if there is none
+    bool eliminateCommonSubExpression();
+
+    // pushes one filter below a join, returns false if there is none that can be pushed
+    bool pushDownFilter();
+
+    // drops the attributes no consumer asks for, going from the sinks towards the scans
+    void pruneColumns();
+
+    // sorts the computations so that every producer comes before its consumers, and rebuilds the
+    // producer and consumer indexes
+    void rebuildIndex();
+
+    // returns the computation producing the given tuple set, or nullptr if there is none
+    AtomicComputationPtr getProducer(const std::string& setName);
+
+    // returns the computations consuming the given tuple set
+    std::vector<AtomicComputationPtr> getConsumers(const std::string& setName);
+
+    // returns every computation that (directly or indirectly) consumes the output of the given one
+    std::set<AtomicComputation*> getDescendants(AtomicComputationPtr from);
+
+    // the computations, in topological order
+    std::vector<AtomicComputationPtr> computations;
+
+    // the producer of each tuple set
+    std::map<std::string, AtomicComputationPtr> producers;
+
+    // the consumers of each tuple set
+    std::map<std::string, std::vector<AtomicComputationPtr>> consumers;
+
+    // what the rewrites did
+    int numEliminated = 0;
+    int numPushedDown = 0;
+    int numPruned = 0;
+};
+
+#endif
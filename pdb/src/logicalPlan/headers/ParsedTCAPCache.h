@@ -0,0 +1,86 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef PARSED_TCAP_CACHE_H
+#define PARSED_TCAP_CACHE_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <pthread.h>
+
+#include "AtomicComputationList.h"
+#include "LockGuard.h"
+
+// the most TCAP programs we keep parsed, the cache is emptied once it holds that many
+#define PARSED_TCAP_CACHE_SIZE 64
+
+// the TCAP programs this process already parsed and rewrote, keyed by their text, so the threads
+// that run the stages of a job, and the later executions of a prepared job, don't compile the same
+// program again; the plans built from an entry share its atomic computations, so the cache is only
+// turned on in the backends, which never change them, and not in the scheduler, which does while
+// it plans a job physically
+class ParsedTCAPCache {
+
+public:
+    // turns the cache on for this process
+    static void enable() {
+        const LockGuard guard{getMutex()};
+        getEnabled() = true;
+    }
+
+    // returns the parsed program, nullptr if it was not parsed yet or the cache is off
+    static std::shared_ptr<AtomicComputationList> find(const std::string& tcap) {
+        const LockGuard guard{getMutex()};
+        auto it = getEntries().find(tcap);
+        if (it == getEntries().end()) {
+            return nullptr;
+        }
+        return it->second;
+    }
+
+    // remembers a parsed program, nothing happens if the cache is off
+    static void insert(const std::string& tcap, std::shared_ptr<AtomicComputationList> parsed) {
+        const LockGuard guard{getMutex()};
+        if (!getEnabled()) {
+            return;
+        }
+        if (getEntries().size() >= PARSED_TCAP_CACHE_SIZE) {
+            getEntries().clear();
+        }
+        getEntries()[tcap] = parsed;
+    }
+
+private:
+    static pthread_mutex_t& getMutex() {
+        static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+        return mutex;
+    }
+
+    static bool& getEnabled() {
+        static bool enabled = false;
+        return enabled;
+    }
+
+    static std::map<std::string, std::shared_ptr<AtomicComputationList>>& getEntries() {
+        static std::map<std::string, std::shared_ptr<AtomicComputationList>> entries;
+        return entries;
+    }
+};
+
+#endif
@@ -48,6 +48,11 @@ std::vector<AtomicComputationPtr>& AtomicComputationList::getAllScanSets() {
     return scans;
 }
 
+// gets every computation in the graph, in the order they were added
+std::vector<AtomicComputationPtr>& AtomicComputationList::getAllComputations() {
+    return allComputations;
+}
+
 // add an atomic computation to the graph
 void AtomicComputationList::addAtomicComputation(AtomicComputationPtr addMe) {
 
@@ -55,6 +60,7 @@ void AtomicComputationList::addAtomicComputation(AtomicComputationPtr addMe) {
         scans.push_back(addMe);
     }
 
+    allComputations.push_back(addMe);
     producers[addMe->getOutputName()] = addMe;
     if (consumers.count(addMe->getInputName()) == 0) {
         std::vector<AtomicComputationPtr> rhs;
@@ -0,0 +1,503 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef LOGICAL_PLAN_OPTIMIZER_CC
+#define LOGICAL_PLAN_OPTIMIZER_CC
+
+#include <algorithm>
+#include <deque>
+
+#include "AtomicComputationClasses.h"
+#include "LogicalPlanOptimizer.h"
+
+namespace {
+
+// the types of lambdas that always give the same result for the same input, so that two of them
+// with the same key value pairs can share their output even across computations
+const std::set<std::string> deterministicLambdaTypes{
+    "attAccess", "methodCall", "deref", "self", "==", "&&"};
+
+bool contains(std::vector<std::string>& atts, const std::string& att) {
+    return std::find(atts.begin(), atts.end(), att) != atts.end();
+}
+
+// the tuple specs a computation reads
+std::vector<TupleSpec*> getInputSpecs(AtomicComputation& comp) {
+    std::vector<TupleSpec*> specs;
+    if (comp.getAtomicComputationTypeID() == ScanSetAtomicTypeID) {
+        return specs;
+    }
+    specs.push_back(&comp.getInput());
+    specs.push_back(&comp.getProjection());
+    if (comp.getAtomicComputationTypeID() == ApplyJoinTypeID) {
+        ApplyJoin& join = (ApplyJoin&)comp;
+        specs.push_back(&join.getRightInput());
+        specs.push_back(&join.getRightProjection());
+    }
+    return specs;
+}
+
+// the tuple specs a computation reads and writes
+std::vector<TupleSpec*> getAllSpecs(AtomicComputation& comp) {
+    std::vector<TupleSpec*> specs = getInputSpecs(comp);
+    specs.push_back(&comp.getOutput());
+    return specs;
+}
+
+// true if the computation is an apply, a hash or a filter that outputs its projected attributes
+// under their own names, followed by the attribute it creates (if any)
+bool carriesAttsAsIs(AtomicComputation& comp) {
+    size_t numCreated;
+    switch (comp.getAtomicComputationTypeID()) {
+        case ApplyFilterTypeID:
+            numCreated = 0;
+            break;
+        case ApplyLambdaTypeID:
+        case HashLeftTypeID:
+        case HashRightTypeID:
+        case HashOneTypeID:
+            numCreated = 1;
+            break;
+        default:
+            return false;
+    }
+    std::vector<std::string>& projected = comp.getProjection().getAtts();
+    std::vector<std::string>& output = comp.getOutput().getAtts();
+    return comp.getInputName() == comp.getProjection().getSetName() &&
+        output.size() == projected.size() + numCreated &&
+        std::equal(projected.begin(), projected.end(), output.begin());
+}
+
+// true if the two applies compute the same attribute out of the same tuple set
+bool isSameApplication(ApplyLambda& first, ApplyLambda& second) {
+
+    if (first.getInputName() != second.getInputName() ||
+        first.getInput().getAtts() != second.getInput().getAtts() || !carriesAttsAsIs(first) ||
+        !carriesAttsAsIs(second)) {
+        return false;
+    }
+
+    // the same lambda of the same computation
+    if (first.getComputationName() == second.getComputationName() &&
+        first.getLambdaToApply() == second.getLambdaToApply()) {
+        return true;
+    }
+
+    // two lambdas of different computations that access the same attribute, call the same
+    // method...
+    auto& firstInfo = first.getKeyValuePairs();
+    auto& secondInfo = second.getKeyValuePairs();
+    if (firstInfo == nullptr || secondInfo == nullptr || firstInfo->count("lambdaType") == 0 ||
+        deterministicLambdaTypes.count((*firstInfo)["lambdaType"]) == 0) {
+        return false;
+    }
+    return *firstInfo == *secondInfo;
+}
+}
+
+LogicalPlanOptimizer::LogicalPlanOptimizer(AtomicComputationList& computationsIn) {
+    computations = computationsIn.getAllComputations();
+    rebuildIndex();
+}
+
+AtomicComputationList LogicalPlanOptimizer::optimize() {
+
+    // each elimination removes an apply and each pushdown moves a filter closer to the scans, so
+    // this terminates
+    while (eliminateCommonSubExpression() || pushDownFilter()) {
+    }
+
+    // the pruning goes last, as the other rewrites change which attributes are used where
+    pruneColumns();
+
+    AtomicComputationList result;
+    for (auto& comp : computations) {
+        result.addAtomicComputation(comp);
+    }
+    return result;
+}
+
+bool LogicalPlanOptimizer::eliminateCommonSubExpression() {
+
+    for (size_t i = 0; i < computations.size(); i++) {
+        if (computations[i]->getAtomicComputationTypeID() != ApplyLambdaTypeID) {
+            continue;
+        }
+        for (size_t j = i + 1; j < computations.size(); j++) {
+            if (computations[j]->getAtomicComputationTypeID() != ApplyLambdaTypeID) {
+                continue;
+            }
+            ApplyLambda& keep = (ApplyLambda&)*computations[i];
+            ApplyLambda& drop = (ApplyLambda&)*computations[j];
+            if (!isSameApplication(keep, drop)) {
+                continue;
+            }
+
+            // the kept apply would feed the consumers of both, and the physical planner materializes
+            // every tuple set with more than one consumer, which costs more than applying the lambda
+            // twice; so we only merge into an apply whose output is materialized anyway
+            size_t keptConsumers = getConsumers(keep.getOutputName()).size();
+            size_t droppedConsumers = getConsumers(drop.getOutputName()).size();
+            if (keptConsumers < 2 && keptConsumers + droppedConsumers > 1) {
+                continue;
+            }
+
+            // the attribute of the dropped apply is renamed after the one of the kept apply in
+            // everything downstream, so the two branches must never meet again
+            std::string keptAtt = keep.getOutput().getAtts().back();
+            std::string droppedAtt = drop.getOutput().getAtts().back();
+            std::set<AtomicComputation*> keptDescendants = getDescendants(computations[i]);
+            std::set<AtomicComputation*> droppedDescendants = getDescendants(computations[j]);
+            bool clash = false;
+            for (auto descendant : droppedDescendants) {
+                clash = clash || keptDescendants.count(descendant) != 0;
+                for (auto spec : getAllSpecs(*descendant)) {
+                    clash = clash || contains(spec->getAtts(), keptAtt);
+                }
+            }
+            if (clash) {
+                continue;
+            }
+
+            // the kept apply now carries whatever either of them carried
+            std::vector<std::string>& projected = keep.getProjection().getAtts();
+            for (auto& att : drop.getProjection().getAtts()) {
+                if (!contains(projected, att)) {
+                    projected.push_back(att);
+                }
+            }
+            keep.getOutput().getAtts() = projected;
+            keep.getOutput().getAtts().push_back(keptAtt);
+
+            // and whatever read the dropped apply reads the kept one
+            for (auto& consumer : getConsumers(drop.getOutputName())) {
+                for (auto spec : getInputSpecs(*consumer)) {
+                    if (spec->getSetName() == drop.getOutputName()) {
+                        spec->getSetName() = keep.getOutputName();
+                    }
+                }
+            }
+            for (auto descendant : droppedDescendants) {
+                for (auto spec : getAllSpecs(*descendant)) {
+                    auto& atts = spec->getAtts();
+                    std::replace(atts.begin(), atts.end(), droppedAtt, keptAtt);
+                }
+            }
+
+            computations.erase(computations.begin() + j);
+            numEliminated++;
+            rebuildIndex();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LogicalPlanOptimizer::pushDownFilter() {
+
+    for (auto& filter : computations) {
+        if (filter->getAtomicComputationTypeID() != ApplyFilterTypeID) {
+            continue;
+        }
+
+        // walk up the applies and filters between the filter and the join it follows; we only
+        // move things out of a straight chain, otherwise the filter would affect other branches
+        std::vector<AtomicComputationPtr> chain;
+        AtomicComputationPtr join = nullptr;
+        AtomicComputationPtr cur = filter;
+        while (carriesAttsAsIs(*cur)) {
+            AtomicComputationPtr parent = getProducer(cur->getInputName());
+            if (parent == nullptr || getConsumers(parent->getOutputName()).size() != 1) {
+                break;
+            }
+            if (parent->getAtomicComputationTypeID() == ApplyJoinTypeID) {
+                join = parent;
+                break;
+            }
+            if (parent->getAtomicComputationTypeID() != ApplyLambdaTypeID &&
+                parent->getAtomicComputationTypeID() != ApplyFilterTypeID) {
+                break;
+            }
+            chain.push_back(parent);
+            cur = parent;
+        }
+        if (join == nullptr) {
+            continue;
+        }
+
+        // find the applies the predicate is computed by, and the attributes of the join it needs
+        std::vector<AtomicComputationPtr> predicate{filter};
+        std::set<std::string> created;
+        std::set<std::string> needed(filter->getInput().getAtts().begin(),
+                                     filter->getInput().getAtts().end());
+        for (auto& step : chain) {
+            std::string att = step->getOutput().getAtts().back();
+            if (step->getAtomicComputationTypeID() == ApplyLambdaTypeID && needed.count(att) != 0) {
+                predicate.push_back(step);
+                created.insert(att);
+                needed.erase(att);
+                needed.insert(step->getInput().getAtts().begin(), step->getInput().getAtts().end());
+            }
+        }
+        if (needed.empty()) {
+            continue;
+        }
+
+        // the attributes have to come from the same side of the join
+        ApplyJoin& joinRef = (ApplyJoin&)*join;
+        std::vector<std::string> joinAtts = join->getProjection().getAtts();
+        size_t numLeft = joinAtts.size();
+        joinAtts.insert(joinAtts.end(),
+                        joinRef.getRightProjection().getAtts().begin(),
+                        joinRef.getRightProjection().getAtts().end());
+        if (joinAtts != join->getOutput().getAtts()) {
+            continue;
+        }
+        bool allLeft = true;
+        bool allRight = true;
+        for (auto& att : needed) {
+            size_t pos = std::find(joinAtts.begin(), joinAtts.end(), att) - joinAtts.begin();
+            allLeft = allLeft && pos < numLeft;
+            allRight = allRight && pos >= numLeft && pos < joinAtts.size();
+        }
+        if (!allLeft && !allRight) {
+            continue;
+        }
+
+        // and that side has to be hashed right before the join, from a tuple set that has them
+        TupleSpec& sideInput = allLeft ? join->getInput() : joinRef.getRightInput();
+        AtomicComputationPtr hash = getProducer(sideInput.getSetName());
+        if (hash == nullptr ||
+            (hash->getAtomicComputationTypeID() != HashLeftTypeID &&
+             hash->getAtomicComputationTypeID() != HashRightTypeID &&
+             hash->getAtomicComputationTypeID() != HashOneTypeID) ||
+            !carriesAttsAsIs(*hash) || getConsumers(hash->getOutputName()).size() != 1) {
+            continue;
+        }
+        AtomicComputationPtr source = getProducer(hash->getInputName());
+        if (source == nullptr) {
+            continue;
+        }
+        std::vector<std::string> sourceAtts = source->getOutput().getAtts();
+        bool movable = true;
+        for (auto& att : needed) {
+            movable = movable && contains(sourceAtts, att);
+        }
+        for (auto& att : created) {
+            movable = movable && !contains(sourceAtts, att) &&
+                !contains(filter->getOutput().getAtts(), att);
+        }
+
+        // nothing that stays after the join may use what the predicate computes
+        for (auto& step : chain) {
+            if (std::find(predicate.begin(), predicate.end(), step) != predicate.end()) {
+                continue;
+            }
+            for (auto& att : step->getInput().getAtts()) {
+                movable = movable && created.count(att) == 0;
+            }
+        }
+        if (!movable) {
+            continue;
+        }
+
+        // take the predicate out of the chain, from the top down, so that whatever read one of its
+        // steps reads what that step read
+        for (auto it = predicate.rbegin(); it != predicate.rend(); ++it) {
+            std::string from = (*it)->getOutputName();
+            std::string to = (*it)->getInputName();
+            for (auto& consumer : getConsumers(from)) {
+                for (auto spec : getInputSpecs(*consumer)) {
+                    if (spec->getSetName() == from) {
+                        spec->getSetName() = to;
+                    }
+                }
+            }
+        }
+        for (auto& step : chain) {
+            if (std::find(predicate.begin(), predicate.end(), step) != predicate.end()) {
+                continue;
+            }
+            for (auto spec : {&step->getProjection(), &step->getOutput()}) {
+                auto& atts = spec->getAtts();
+                auto isCreated = [&](std::string& att) { return created.count(att) != 0; };
+                atts.erase(std::remove_if(atts.begin(), atts.end(), isCreated), atts.end());
+            }
+        }
+
+        // and put it between the source and the hash
+        std::string curSet = hash->getInputName();
+        std::vector<std::string> curAtts = sourceAtts;
+        for (auto it = predicate.rbegin(); it != predicate.rend(); ++it) {
+            AtomicComputationPtr step = *it;
+            step->getInput().getSetName() = curSet;
+            step->getProjection().getSetName() = curSet;
+            if (step == filter) {
+                step->getProjection().getAtts() = sourceAtts;
+                step->getOutput().getAtts() = sourceAtts;
+            } else {
+                std::string att = step->getOutput().getAtts().back();
+                step->getProjection().getAtts() = curAtts;
+                curAtts.push_back(att);
+                step->getOutput().getAtts() = curAtts;
+            }
+            curSet = step->getOutputName();
+        }
+        hash->getInput().getSetName() = curSet;
+        hash->getProjection().getSetName() = curSet;
+
+        numPushedDown++;
+        rebuildIndex();
+        return true;
+    }
+    return false;
+}
+
+void LogicalPlanOptimizer::pruneColumns() {
+
+    // the consumers come after their producers, so going backwards we see the final list of
+    // attributes a computation needs before we prune the computation producing them
+    for (auto it = computations.rbegin(); it != computations.rend(); ++it) {
+        AtomicComputationPtr comp = *it;
+        if ((comp->getAtomicComputationTypeID() != ApplyLambdaTypeID &&
+             comp->getAtomicComputationTypeID() != ApplyFilterTypeID) ||
+            !carriesAttsAsIs(*comp) || comp->getProjection().getAtts().empty()) {
+            continue;
+        }
+
+        // the tuple sets nobody reads are results, we leave them alone
+        std::vector<AtomicComputationPtr> readers = getConsumers(comp->getOutputName());
+        if (readers.empty()) {
+            continue;
+        }
+
+        std::set<std::string> used;
+        for (auto& reader : readers) {
+            for (auto spec : getInputSpecs(*reader)) {
+                if (spec->getSetName() == comp->getOutputName()) {
+                    used.insert(spec->getAtts().begin(), spec->getAtts().end());
+                }
+            }
+        }
+
+        // we always keep one attribute, so that there is something to copy the tuples with
+        std::vector<std::string>& projected = comp->getProjection().getAtts();
+        std::vector<std::string> kept;
+        for (auto& att : projected) {
+            if (used.count(att) != 0) {
+                kept.push_back(att);
+            }
+        }
+        if (kept.empty()) {
+            kept.push_back(projected.front());
+        }
+        if (kept.size() == projected.size()) {
+            continue;
+        }
+
+        numPruned += projected.size() - kept.size();
+        std::vector<std::string> output = kept;
+        if (comp->getAtomicComputationTypeID() == ApplyLambdaTypeID) {
+            output.push_back(comp->getOutput().getAtts().back());
+        }
+        projected = kept;
+        comp->getOutput().getAtts() = output;
+    }
+}
+
+void LogicalPlanOptimizer::rebuildIndex() {
+
+    producers.clear();
+    consumers.clear();
+    for (auto& comp : computations) {
+        producers[comp->getOutputName()] = comp;
+    }
+
+    // sort the computations topologically; we keep taking the first ones in the current order
+    // whose inputs are all placed, so the result does not depend on anything but the plan
+    std::vector<AtomicComputationPtr> sorted;
+    std::set<AtomicComputation*> placed;
+    while (sorted.size() < computations.size()) {
+        bool progress = false;
+        for (auto& comp : computations) {
+            if (placed.count(comp.get()) != 0) {
+                continue;
+            }
+            bool ready = true;
+            for (auto spec : getInputSpecs(*comp)) {
+                auto producer = producers.find(spec->getSetName());
+                ready = ready &&
+                    (producer == producers.end() || placed.count(producer->second.get()) != 0);
+            }
+            if (ready) {
+                sorted.push_back(comp);
+                placed.insert(comp.get());
+                progress = true;
+            }
+        }
+
+        // a cycle can not come out of the TCAP generation, but if it does we keep the rest as is
+        if (!progress) {
+            for (auto& comp : computations) {
+                if (placed.count(comp.get()) == 0) {
+                    sorted.push_back(comp);
+                    placed.insert(comp.get());
+                }
+            }
+        }
+    }
+    computations = sorted;
+
+    for (auto& comp : computations) {
+        if (comp->getAtomicComputationTypeID() == ScanSetAtomicTypeID) {
+            continue;
+        }
+        consumers[comp->getInputName()].push_back(comp);
+        if (comp->getAtomicComputationTypeID() == ApplyJoinTypeID) {
+            consumers[((ApplyJoin&)*comp).getRightInput().getSetName()].push_back(comp);
+        }
+    }
+}
+
+AtomicComputationPtr LogicalPlanOptimizer::getProducer(const std::string& setName) {
+    auto producer = producers.find(setName);
+    return producer == producers.end() ? nullptr : producer->second;
+}
+
+std::vector<AtomicComputationPtr> LogicalPlanOptimizer::getConsumers(
+    const std::string& setName) {
+    auto readers = consumers.find(setName);
+    return readers == consumers.end() ? std::vector<AtomicComputationPtr>() : readers->second;
+}
+
+std::set<AtomicComputation*> LogicalPlanOptimizer::getDescendants(AtomicComputationPtr from) {
+    std::set<AtomicComputation*> descendants;
+    std::deque<AtomicComputationPtr> toVisit{from};
+    while (!toVisit.empty()) {
+        AtomicComputationPtr cur = toVisit.front();
+        toVisit.pop_front();
+        for (auto& consumer : getConsumers(cur->getOutputName())) {
+            if (descendants.insert(consumer.get()).second) {
+                toVisit.push_back(consumer);
+            }
+        }
+    }
+    return descendants;
+}
+
+#endif
@@ -216,6 +216,40 @@ namespace pdb {
       bool executeComputations(Handle<Computation> firstParam,
                                Handle<Types>... args);
 
+      /* Prepares some computations under a name. The scheduler keeps them, the
+       * first execution plans them as usual and later executions reuse that
+       * plan; the parameters of an execution, e.g. the current model of an
+       * iterative job, are passed as broadcast variables. */
+      template <class... Types>
+      bool prepareComputations(std::string preparedName,
+                               Handle<Computation> firstParam,
+                               Handle<Types>... args);
+
+      /* Executes the computations prepared under a name, binding the broadcast
+       * variables added before it. */
+      bool executePreparedComputations(std::string preparedName);
+
+      /* Drops the computations prepared under a name. */
+      bool releasePreparedComputations(std::string preparedName);
+
+      /* Returns the most heap memory the last execution of computations held
+       * on a worker; it is also set if the execution ran out of memory. */
+      size_t getPeakMemoryBytes();
+
+      /* Returns the bytes the workers received from each other during the last
+       * execution of computations. */
+      size_t getShuffledBytes();
+
+      /* Returns the most shared memory a worker had in use during the last
+       * execution of computations. */
+      size_t getPeakSharedMemoryBytes();
+
+      /* Registers a read-only object, such as a model, with the next execution
+       * of computations. It is shipped once to every worker and shared by all
+       * the threads there; computations read it with getBroadcastVariable. */
+      template <class Type>
+      void addBroadcastVariable(std::string name, Handle<Type> value);
+
       /* Deletes a set. */
       bool deleteSet(std::string databaseName, std::string setName);
 
@@ -224,6 +258,16 @@ namespace pdb {
       SetIterator<Type> getSetIterator(std::string databaseName,
                                        std::string setName);
 
+      /* Gets a set iterator that streams the pages straight from the workers
+       * holding the set, all of them in parallel, with up to windowSize pages
+       * in flight per worker; compress turns on snappy compression on the wire.
+       * The pages of different workers come in no particular order. */
+      template <class Type>
+      SetIterator<Type> getParallelSetIterator(std::string databaseName,
+                                               std::string setName,
+                                               int windowSize = DEFAULT_SET_SCAN_WINDOW,
+                                               bool compress = true);
+
     private:
       std::shared_ptr<pdb::CatalogClient> catalogClient;
       std::shared_ptr<pdb::DispatcherClient> dispatcherClient;
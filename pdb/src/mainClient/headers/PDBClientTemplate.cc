@@ -103,6 +103,26 @@ namespace pdb {
       return result;
     }
 
+    template <class... Types>
+    bool PDBClient::prepareComputations(std::string preparedName,
+                                        Handle<Computation> firstParam,
+                                        Handle<Types>... args) {
+
+      bool result = queryClient->prepareComputations(returnedMsg, preparedName, firstParam, args...);
+
+      if (result==false) {
+          errorMsg = "Not able to prepare computations: " + returnedMsg;
+          exit(-1);
+      }
+      return result;
+    }
+
+    template <class Type>
+    void PDBClient::addBroadcastVariable(std::string name, Handle<Type> value) {
+
+      queryClient->addBroadcastVariable(name, value);
+    }
+
     template <class Type>
     SetIterator<Type> PDBClient::getSetIterator(std::string databaseName,
                                                 std::string setName) {
@@ -110,6 +130,16 @@ namespace pdb {
       return queryClient->getSetIterator<Type>(databaseName, setName);
     }
 
+    template <class Type>
+    SetIterator<Type> PDBClient::getParallelSetIterator(std::string databaseName,
+                                                        std::string setName,
+                                                        int windowSize,
+                                                        bool compress) {
+
+      return queryClient->getParallelSetIterator<Type>(databaseName, setName,
+                                                       windowSize, compress);
+    }
+
     template <class KeyClass, class ValueClass>
     bool PDBClient::partitionSet(std::pair<std::string, std::string> inputSet, 
                                  std::pair<std::string, std::string> outputSet, 
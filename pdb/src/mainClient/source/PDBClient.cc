@@ -325,6 +325,39 @@ namespace pdb {
       }
       return result;
     }
+
+    bool PDBClient::executePreparedComputations(std::string preparedName) {
+
+      bool result = queryClient->executePreparedComputations(returnedMsg, preparedName);
+
+      if (result==false) {
+          errorMsg = "Not able to execute prepared computations: " + returnedMsg;
+          exit(-1);
+      }
+      return result;
+    }
+
+    bool PDBClient::releasePreparedComputations(std::string preparedName) {
+
+      bool result = queryClient->releasePreparedComputations(returnedMsg, preparedName);
+
+      if (result==false) {
+          errorMsg = "Not able to release prepared computations: " + returnedMsg;
+      }
+      return result;
+    }
+
+    size_t PDBClient::getPeakMemoryBytes() {
+      return queryClient->getPeakMemoryBytes();
+    }
+
+    size_t PDBClient::getShuffledBytes() {
+      return queryClient->getShuffledBytes();
+    }
+
+    size_t PDBClient::getPeakSharedMemoryBytes() {
+      return queryClient->getPeakSharedMemoryBytes();
+    }
 }
 
 #endif
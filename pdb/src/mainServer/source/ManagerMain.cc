@@ -31,6 +31,7 @@
 #include "QuerySchedulerServer.h"
 #include "StorageAddDatabase.h"
 #include "SharedEmployee.h"
+#include "VTableMap.h"
 
 int main(int argc, char* argv[]) {
     int port = 8108;
@@ -74,6 +75,10 @@ int main(int argc, char* argv[]) {
     frontEnd.addFunctionality<pdb::CatalogServer>("CatalogDir", true, managerIp, port);
     frontEnd.addFunctionality<pdb::CatalogClient>(port, "localhost", myLogger);
 
+    // the libraries of the user types the manager has loaded before are kept next to its catalog
+    pdb::VTableMap::setSharedLibraryCache("CatalogDir/typeCache");
+    pdb::VTableMap::preloadSharedLibraryCache();
+
     //initialize StatisticsDB
     std::shared_ptr<StatisticsDB> statisticsDB = std::make_shared<StatisticsDB>(conf);
     if (statisticsDB == nullptr) {
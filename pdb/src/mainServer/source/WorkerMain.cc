@@ -26,6 +26,8 @@
 #include "PangeaStorageServer.h"
 #include "FrontendQueryTestServer.h"
 #include "HermesExecutionServer.h"
+#include "VTableMap.h"
+#include <sys/stat.h>
 
 int main(int argc, char* argv[]) {
 
@@ -111,6 +113,17 @@ int main(int argc, char* argv[]) {
     std::cout << "ipcFile=" << ipcFile << std::endl;
     conf->setBackEndIpcFile(ipcFile);
 
+    // the libraries of the user types this node has seen are kept next to its catalog, and loaded
+    // before the backend is forked, so that both processes start out knowing them
+    std::string catalogFile = "CatalogDir";
+    if (standalone == false) {
+        catalogFile = std::string("CatalogDir_") + localIp + std::string("_") +
+            std::to_string(localPort);
+    }
+    mkdir(catalogFile.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    pdb::VTableMap::setSharedLibraryCache(catalogFile + "/typeCache");
+    pdb::VTableMap::preloadSharedLibraryCache();
+
     string errMsg;
     if (shm != nullptr) {
         pid_t child_pid = fork();
@@ -157,7 +170,7 @@ int main(int argc, char* argv[]) {
                         String(nodeType),
                         1);
                 frontEnd.addFunctionality<pdb::CatalogServer>(
-                    "CatalogDir", true, "localhost", localPort);
+                    catalogFile, true, "localhost", localPort);
                 frontEnd.addFunctionality<pdb::CatalogClient>(localPort, "localhost", logger);
                 std::cout << "to register node metadata in catalog..." << std::endl;
                 if (!frontEnd.getFunctionality<pdb::CatalogServer>().addNodeMetadata(nodeData,
@@ -172,8 +185,6 @@ int main(int argc, char* argv[]) {
 
             } else {
 
-                std::string catalogFile = std::string("CatalogDir_") + localIp + std::string("_") +
-                    std::to_string(localPort);
                 frontEnd.addFunctionality<pdb::CatalogServer>(
                     catalogFile, false, managerIp, managerPort);
                 frontEnd.addFunctionality<pdb::CatalogClient>(localPort, "localhost", logger);
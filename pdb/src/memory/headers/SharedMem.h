@@ -33,6 +33,13 @@ class SharedMem;
 typedef shared_ptr<SharedMem> SharedMemPtr;
 
 
+// how much of the pool is allocated; it lives in the pool itself, so that the frontend and the
+// backend see the same numbers
+struct SharedMemUsage {
+    size_t usedBytes;
+    size_t peakUsedBytes;
+};
+
 //this class wraps a shared memory buffer pool for allocating pages
 //this class uses mmap system call
 
@@ -54,15 +61,26 @@ public:
     void _free_unsafe(void* ptr, size_t size);
     size_t getShmSize();
 
+    // the number of bytes currently allocated from the pool
+    size_t getUsedBytes();
+
+    // the largest number of bytes allocated at once since the last resetPeakUsedBytes()
+    size_t getPeakUsedBytes();
+
+    // starts tracking the peak again from the current use
+    void resetPeakUsedBytes();
+
 protected:
     int initialize();
     void destroy();
     int getMem();
     int initMallocs();
     int initMutex();
+    size_t getAllocatedSize(void* ptr, size_t size);
 
 private:
     pthread_mutex_t* memLock;
+    SharedMemUsage* usage;
     pdb::PDBLoggerPtr logger;
 #ifdef USE_MEMCACHED_SLAB_ALLOCATOR
     SlabAllocatorPtr allocator;
@@ -71,6 +71,34 @@ size_t SharedMem::getShmSize() {
     return this->shmMemSize;
 }
 
+size_t SharedMem::getUsedBytes() {
+    this->lock();
+    size_t usedBytes = this->usage->usedBytes;
+    this->unlock();
+    return usedBytes;
+}
+
+size_t SharedMem::getPeakUsedBytes() {
+    this->lock();
+    size_t peakUsedBytes = this->usage->peakUsedBytes;
+    this->unlock();
+    return peakUsedBytes;
+}
+
+void SharedMem::resetPeakUsedBytes() {
+    this->lock();
+    this->usage->peakUsedBytes = this->usage->usedBytes;
+    this->unlock();
+}
+
+size_t SharedMem::getAllocatedSize(void* ptr, size_t size) {
+#ifdef USE_MEMCACHED_SLAB_ALLOCATOR
+    return size;
+#else
+    return this->allocator.tlsf_block_size(ptr);
+#endif
+}
+
 
 void* SharedMem::malloc(size_t size) {
     void* ptr;
@@ -80,6 +108,12 @@ void* SharedMem::malloc(size_t size) {
 #else
     ptr = this->allocator.tlsf_malloc(this->my_tlsf, size);
 #endif
+    if (ptr != nullptr) {
+        this->usage->usedBytes += this->getAllocatedSize(ptr, size);
+        if (this->usage->usedBytes > this->usage->peakUsedBytes) {
+            this->usage->peakUsedBytes = this->usage->usedBytes;
+        }
+    }
     this->unlock();
     return ptr;
 }
@@ -99,6 +133,7 @@ void* SharedMem::mallocAlign(size_t size, size_t alignment, int& offset) {
 
 void SharedMem::free(void* ptr, size_t size) {
     this->lock();
+    this->usage->usedBytes -= this->getAllocatedSize(ptr, size);
 #ifdef USE_MEMCACHED_SLAB_ALLOCATOR
     this->allocator->slabs_free_unsafe(ptr, size);
 #else
@@ -166,6 +201,13 @@ int SharedMem::initMutex() {
     if (pthread_mutex_init(this->memLock, nullptr) != 0) {
         return -1;
     }
+    this->usage = (SharedMemUsage*)this->_malloc_unsafe(sizeof(SharedMemUsage));
+    if (this->usage == 0) {
+        std::cout << "FATAL ERROR: can't allocate for usage from buffer pool" << std::endl;
+        return -1;
+    }
+    this->usage->usedBytes = 0;
+    this->usage->peakUsedBytes = 0;
     return 0;
 }
 
@@ -27,6 +27,7 @@
 #include <algorithm>
 #include <iterator>
 #include <cstring>
+#include <climits>
 
 namespace pdb {
 
@@ -96,6 +97,86 @@ inline void* InactiveAllocationBlock::getEnd() {
     return end;
 }
 
+// the bucket of the address space that holds this address
+inline size_t getInactiveBlockBucket(void* here) {
+    return ((size_t)here) >> INACTIVE_BLOCK_BUCKET_BITS;
+}
+
+// remember a block
+inline void InactiveBlockDirectory::add(void* start, size_t numBytes) {
+    if (positions.count(start) != 0) {
+        return;
+    }
+    InactiveAllocationBlock block(start, numBytes);
+    positions[start] = blocks.size();
+    blocks.push_back(block);
+
+    // the end is in the block too, as far as operator== is concerned
+    size_t last = getInactiveBlockBucket(block.end);
+    for (size_t bucket = getInactiveBlockBucket(start); bucket <= last; bucket++) {
+        buckets[bucket].push_back(block);
+    }
+}
+
+// find the block containing here
+inline InactiveAllocationBlock* InactiveBlockDirectory::find(void* here) {
+    auto bucket = buckets.find(getInactiveBlockBucket(here));
+    if (bucket == buckets.end()) {
+        return nullptr;
+    }
+    for (auto& block : bucket->second) {
+        if (block == here) {
+            return &block;
+        }
+    }
+    return nullptr;
+}
+
+// forget a block
+inline void InactiveBlockDirectory::remove(void* start) {
+    auto position = positions.find(start);
+    if (position == positions.end()) {
+        return;
+    }
+    size_t i = position->second;
+    positions.erase(position);
+
+    // take it out of its buckets
+    size_t last = getInactiveBlockBucket(blocks[i].end);
+    for (size_t bucket = getInactiveBlockBucket(start); bucket <= last; bucket++) {
+        std::vector<InactiveAllocationBlock>& inBucket = buckets[bucket];
+        for (size_t j = 0; j < inBucket.size(); j++) {
+            if (inBucket[j].start == start) {
+                inBucket[j] = inBucket.back();
+                inBucket.pop_back();
+                break;
+            }
+        }
+        if (inBucket.empty()) {
+            buckets.erase(bucket);
+        }
+    }
+
+    // and out of the list of blocks, moving the last one into its place
+    if (i != blocks.size() - 1) {
+        blocks[i] = blocks.back();
+        positions[blocks[i].start] = i;
+    }
+    blocks.pop_back();
+}
+
+inline size_t InactiveBlockDirectory::size() {
+    return blocks.size();
+}
+
+inline std::vector<InactiveAllocationBlock>::iterator InactiveBlockDirectory::begin() {
+    return blocks.begin();
+}
+
+inline std::vector<InactiveAllocationBlock>::iterator InactiveBlockDirectory::end() {
+    return blocks.end();
+}
+
 // These macros are used to manipulate the block of RAM that makes up an allocation block
 // The layout is | num bytes used | offset to root object | number active objects | data <--> |
 #undef ALLOCATOR_REF_COUNT
@@ -107,17 +188,71 @@ inline void* InactiveAllocationBlock::getEnd() {
 #define GET_CHUNK_SIZE(ofMe) (*((unsigned*)ofMe))
 #define CHUNK_HEADER_SIZE sizeof(unsigned)
 
+// returns the list in myState.chunks that holds the free chunks of this many bytes
+inline unsigned getChunkList(unsigned chunkSize) {
+    if (chunkSize <= MAX_SMALL_CHUNK_SIZE) {
+        return chunkSize / 4 - 1;
+    }
+    return NUM_SMALL_CHUNK_LISTS + 31 - __builtin_clz(chunkSize);
+}
+
+// remember a free chunk
+inline void addChunk(void* chunk, unsigned chunkSize, AllocatorState& myState) {
+    unsigned list = getChunkList(chunkSize);
+    myState.chunks[list].push_back(chunk);
+    myState.nonEmptyChunks[list / 64] |= ((uint64_t)1 << (list % 64));
+}
+
+// take the chunk at position j out of the list, moving the last chunk of the list into its place
+inline void* takeChunk(unsigned list, size_t j, AllocatorState& myState) {
+    std::vector<void*>& chunks = myState.chunks[list];
+    void* chunk = chunks[j];
+    chunks[j] = chunks.back();
+    chunks.pop_back();
+    if (chunks.empty()) {
+        myState.nonEmptyChunks[list / 64] &= ~((uint64_t)1 << (list % 64));
+    }
+    return chunk;
+}
+
+// returns the first list from this one on that is not empty, or NUM_CHUNK_LISTS if there is none
+inline unsigned findNonEmptyChunkList(unsigned list, AllocatorState& myState) {
+    if (list >= NUM_CHUNK_LISTS) {
+        return NUM_CHUNK_LISTS;
+    }
+    unsigned word = list / 64;
+    uint64_t bits = myState.nonEmptyChunks[word] & (~((uint64_t)0) << (list % 64));
+    while (bits == 0) {
+        if (++word == NUM_CHUNK_LIST_WORDS) {
+            return NUM_CHUNK_LISTS;
+        }
+        bits = myState.nonEmptyChunks[word];
+    }
+    return word * 64 + __builtin_ctzll(bits);
+}
+
+// forget all of the free chunks
+inline void clearChunks(AllocatorState& myState) {
+    for (unsigned list = findNonEmptyChunkList(0, myState); list < NUM_CHUNK_LISTS;
+         list = findNonEmptyChunkList(list + 1, myState)) {
+        myState.chunks[list].clear();
+    }
+    for (auto& w : myState.nonEmptyChunks) {
+        w = 0;
+    }
+}
+
 // free some RAM
 #ifdef DEBUG_OBJECT_MODEL
 inline void defaultFreeRAM(bool isContained,
                            void* here,
-                           std::vector<InactiveAllocationBlock>& allInactives,
+                           InactiveBlockDirectory& allInactives,
                            AllocatorState& myState,
                            int16_t typeId) {
 #else
 inline void defaultFreeRAM(bool isContained,
                            void* here,
-                           std::vector<InactiveAllocationBlock>& allInactives,
+                           InactiveBlockDirectory& allInactives,
                            AllocatorState& myState) {
 #endif
 
@@ -129,11 +264,8 @@ inline void defaultFreeRAM(bool isContained,
         // get the chunk size
         unsigned chunkSize = GET_CHUNK_SIZE(here);
 
-        // get the number of leading zeros
-        int leadingZeros = __builtin_clz(chunkSize);
-
         // and remember this chunk
-        myState.chunks[31 - leadingZeros].push_back(here);
+        addChunk(here, chunkSize, myState);
 
         ALLOCATOR_REF_COUNT--;
 
@@ -145,17 +277,17 @@ inline void defaultFreeRAM(bool isContained,
         std::cout << "allocator block start =" << myState.activeRAM << std::endl;
         std::cout << "allocator numBytes=" << myState.numBytes << std::endl;
         std::cout << "freed numBytes=" << chunkSize << std::endl;
-        std::cout << "chunk index=" << 31 - leadingZeros << std::endl;
+        std::cout << "chunk index=" << getChunkList(chunkSize) << std::endl;
         std::cout << "###################################" << std::endl;
 #endif
         return;
     }
 
     // otherwise, he is not in the active block, so look for him
-    auto i = std::lower_bound(allInactives.begin(), allInactives.end(), here);
+    InactiveAllocationBlock* i = allInactives.find(here);
 
     // see if we found him
-    if (i != allInactives.end() && !(*i > here)) {
+    if (i != nullptr) {
 
         // we did, so dec reference count
         i->decReferenceCount();
@@ -171,7 +303,7 @@ inline void defaultFreeRAM(bool isContained,
         if (i->areNoReferences()) {
             i->freeBlock();
             PDB_COUT << "Killed an old block naturally." << std::endl;
-            allInactives.erase(i);
+            allInactives.remove(i->getStart());
         }
         return;
     }
@@ -199,44 +331,53 @@ inline void* defaultGetRAM(size_t howMuch, AllocatorState& myState) {
     if ((bytesNeeded % 4) != 0) {
         bytesNeeded += (4 - (bytesNeeded % 4));
     }
-    // get the number of leading zero bits in bytesNeeded
-    unsigned int numLeadingZeros = __builtin_clz(bytesNeeded);
+    // find the list for chunks of this size
+    unsigned list = getChunkList(bytesNeeded);
 
 #ifdef DEBUG_OBJECT_MODEL
-    std::cout << "howMuch=" << howMuch << ", bytesNeeded=" << bytesNeeded
-              << ", numLeadingZeros=" << numLeadingZeros << std::endl;
+    std::cout << "howMuch=" << howMuch << ", bytesNeeded=" << bytesNeeded << ", list=" << list
+              << std::endl;
 #endif
 
-    // loop through all of the free chunks
-    // Lets say that someone asks for 54 bytes.  In binary, this is ...000110110 and so there are 26
-    // leading zeros
-    // in the binary representation.  So, we are going to loop through the sets of chunks at
-    // position 5 (2^5 and larger)
-    // at position 6 (2^6 and larger) at position 7 (2^7 and larger), and so on, trying to find one
-    // that fits.
-    for (unsigned int i = 31 - numLeadingZeros; i < 32; i++) {
-        int len = myState.chunks[i].size();
-        for (int j = len - 1; j >= 0; j--) {
-            if (GET_CHUNK_SIZE(myState.chunks[i][j]) >= bytesNeeded) {
-                void* returnVal = myState.chunks[i][j];
-                myState.chunks[i].erase(myState.chunks[i].begin() + j);
-                ALLOCATOR_REF_COUNT++;
-                void* retAddress = CHAR_PTR(returnVal) + CHUNK_HEADER_SIZE;
-#ifdef DEBUG_OBJECT_MODEL
-                std::cout << "**defaultGetRAM**" << std::endl;
-                std::cout << "###################################" << std::endl;
-                std::cout << "allocator block reference count++=" << ALLOCATOR_REF_COUNT
-                          << " with typeId=" << typeId << std::endl;
-                std::cout << "allocator block start =" << myState.activeRAM << std::endl;
-                std::cout << "allocator numBytes=" << myState.numBytes << std::endl;
-                std::cout << "starting chunk index=" << 31 - numLeadingZeros << std::endl;
-                std::cout << "ending chunk index=" << i << std::endl;
-                std::cout << "bytes needed=" << bytesNeeded << std::endl;
-                std::cout << "###################################" << std::endl;
-#endif
-                return retAddress;
+    // Lets say that someone asks for 54 bytes, so that 60 are needed.  Every chunk in the list of
+    // 60 byte chunks fits, and so does every chunk in the lists after it.  But if someone asks for
+    // 2000 bytes, a chunk in the list from 2^10 up to 2^11 - 1 may not fit, so we look through that
+    // list first.  Every chunk in the lists after it fits.
+    void* returnVal = nullptr;
+    if (list >= NUM_SMALL_CHUNK_LISTS) {
+        std::vector<void*>& chunks = myState.chunks[list];
+        for (int j = (int)chunks.size() - 1; j >= 0; j--) {
+            if (GET_CHUNK_SIZE(chunks[j]) >= bytesNeeded) {
+                returnVal = takeChunk(list, j, myState);
+                break;
             }
         }
+        list++;
+    }
+
+    // otherwise, take the last chunk of the first list from here on that is not empty
+    if (returnVal == nullptr) {
+        list = findNonEmptyChunkList(list, myState);
+        if (list < NUM_CHUNK_LISTS) {
+            returnVal = takeChunk(list, myState.chunks[list].size() - 1, myState);
+        }
+    }
+
+    if (returnVal != nullptr) {
+        ALLOCATOR_REF_COUNT++;
+        void* retAddress = CHAR_PTR(returnVal) + CHUNK_HEADER_SIZE;
+#ifdef DEBUG_OBJECT_MODEL
+        std::cout << "**defaultGetRAM**" << std::endl;
+        std::cout << "###################################" << std::endl;
+        std::cout << "allocator block reference count++=" << ALLOCATOR_REF_COUNT
+                  << " with typeId=" << typeId << std::endl;
+        std::cout << "allocator block start =" << myState.activeRAM << std::endl;
+        std::cout << "allocator numBytes=" << myState.numBytes << std::endl;
+        std::cout << "chunk list=" << list << std::endl;
+        std::cout << "bytes needed=" << bytesNeeded << std::endl;
+        std::cout << "###################################" << std::endl;
+#endif
+        return retAddress;
     }
 
     // if we got here, then we cannot fit, and we need to carve out a bit at the end
@@ -332,13 +473,13 @@ inline void* fastGetRAM(size_t howMuch, AllocatorState& myState) {
 #ifdef DEBUG_OBJECT_MODEL
 inline void DefaultPolicy::freeRAM(bool isContained,
                                    void* here,
-                                   std::vector<InactiveAllocationBlock>& allInactives,
+                                   InactiveBlockDirectory& allInactives,
                                    AllocatorState& myState,
                                    int16_t typeId) {
 #else
 inline void DefaultPolicy::freeRAM(bool isContained,
                                    void* here,
-                                   std::vector<InactiveAllocationBlock>& allInactives,
+                                   InactiveBlockDirectory& allInactives,
                                    AllocatorState& myState) {
 #endif
 
@@ -369,13 +510,13 @@ inline void* DefaultPolicy::getRAM(size_t howMuch, AllocatorState& myState) {
 #ifdef DEBUG_OBJECT_MODEL
 inline void NoReusePolicy::freeRAM(bool isContained,
                                    void* here,
-                                   std::vector<InactiveAllocationBlock>& allInactives,
+                                   InactiveBlockDirectory& allInactives,
                                    AllocatorState& myState,
                                    int16_t typeId) {
 #else
 inline void NoReusePolicy::freeRAM(bool isContained,
                                    void* here,
-                                   std::vector<InactiveAllocationBlock>& allInactives,
+                                   InactiveBlockDirectory& allInactives,
                                    AllocatorState& myState) {
 #endif
 
@@ -407,14 +548,14 @@ inline void* NoReusePolicy::getRAM(size_t howMuch, AllocatorState& myState) {
 #ifdef DEBUG_OBJECT_MODEL
 inline void NoReferenceCountPolicy::freeRAM(bool isContained,
                                             void* here,
-                                            std::vector<InactiveAllocationBlock>& allInactives,
+                                            InactiveBlockDirectory& allInactives,
                                             AllocatorState& myState,
                                             int16_t typeId) {
     std::cout << "**NoReferenceCountPolicy**" << std::endl;
 #else
 inline void NoReferenceCountPolicy::freeRAM(bool isContained,
                                             void* here,
-                                            std::vector<InactiveAllocationBlock>& allInactives,
+                                            InactiveBlockDirectory& allInactives,
                                             AllocatorState& myState) {
 #endif
 }
@@ -472,10 +613,11 @@ MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::~MultiPolicyAllocator() {
 // we have no active RAM
 template <typename FirstPolicy, typename... OtherPolicies>
 MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::MultiPolicyAllocator() {
-    for (unsigned int i = 0; i < 32; i++) {
+    for (unsigned int i = 0; i < NUM_CHUNK_LISTS; i++) {
         std::vector<void*> temp;
         myState.chunks.push_back(temp);
     }
+    clearChunks(myState);
     myState.activeRAM = nullptr;
     myState.numBytes = 0;
 
@@ -503,10 +645,11 @@ MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::MultiPolicyAllocator() {
 
 template <typename FirstPolicy, typename... OtherPolicies>
 MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::MultiPolicyAllocator(size_t numBytesIn) {
-    for (unsigned int i = 0; i < 32; i++) {
+    for (unsigned int i = 0; i < NUM_CHUNK_LISTS; i++) {
         std::vector<void*> temp;
         myState.chunks.push_back(temp);
     }
+    clearChunks(myState);
     myState.activeRAM = nullptr;
     myState.numBytes = 0;
 
@@ -546,6 +689,37 @@ inline bool MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::contains(void*
     return (where >= target && where < target + myState.numBytes);
 }
 
+template <typename FirstPolicy, typename... OtherPolicies>
+inline bool MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::tryToGrowInPlace(void* here,
+                                                                                 size_t howMuch) {
+    if (myState.activeRAM == nullptr || !contains(here)) {
+        return false;
+    }
+
+    // the chunk has to end exactly where the used part of the block ends
+    char* chunk = CHAR_PTR(here) - CHUNK_HEADER_SIZE;
+    unsigned chunkSize = GET_CHUNK_SIZE(chunk);
+    if (chunk + chunkSize != CHAR_PTR(myState.activeRAM) + LAST_USED) {
+        return false;
+    }
+
+    // round up just like getRAM does
+    size_t bytesNeeded = CHUNK_HEADER_SIZE + howMuch;
+    if ((bytesNeeded % 4) != 0) {
+        bytesNeeded += (4 - (bytesNeeded % 4));
+    }
+    if (bytesNeeded <= chunkSize) {
+        return true;
+    }
+    if (bytesNeeded > UINT_MAX || LAST_USED - chunkSize + bytesNeeded > myState.numBytes) {
+        return false;
+    }
+
+    LAST_USED += bytesNeeded - chunkSize;
+    GET_CHUNK_SIZE(chunk) = (unsigned)bytesNeeded;
+    return true;
+}
+
 
 // returns some RAM... this can throw an exception if the request is too large
 // to be handled because there is not enough RAM in the current allocation block
@@ -582,10 +756,10 @@ inline bool MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::isManaged(void*
     }
 
     // otherwise, he is not in the active block, so look for him
-    auto i = std::lower_bound(allInactives.begin(), allInactives.end(), here);
+    InactiveAllocationBlock* i = allInactives.find(here);
 
     // see if we found him
-    if (i != allInactives.end() && !(*i > here)) {
+    if (i != nullptr) {
         return true;
     }
 
@@ -598,9 +772,7 @@ inline void MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::emptyOutBlock(v
     // if this is the active one, emty it out
     if (contains(here)) {
         // empty out the list of unused chunks of RAM in this block
-        for (auto& c : myState.chunks) {
-            c.clear();
-        }
+        clearChunks(myState);
 
         // LAST_USED = HEADER_SIZE;
         ALLOCATOR_REF_COUNT = 0;
@@ -610,12 +782,12 @@ inline void MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::emptyOutBlock(v
     }
 
     // otherwise, he is not in the active block, so look for him
-    auto i = std::lower_bound(allInactives.begin(), allInactives.end(), here);
+    InactiveAllocationBlock* i = allInactives.find(here);
 
     // see if we found him
-    if (i != allInactives.end() && !(*i > here)) {
+    if (i != nullptr) {
 
-        allInactives.erase(i);
+        allInactives.remove(i->getStart());
         PDB_COUT << "Killed an old block block.\n";
         return;
     }
@@ -662,8 +834,9 @@ MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::getBytesAvailableInCurrentA
 
     // count all of the chunks that are not currently in use
     unsigned amtUnused = 0;
-    for (auto& a : myState.chunks) {
-        for (auto& v : a) {
+    for (unsigned list = findNonEmptyChunkList(0, myState); list < NUM_CHUNK_LISTS;
+         list = findNonEmptyChunkList(list + 1, myState)) {
+        for (auto& v : myState.chunks[list]) {
             amtUnused += GET_CHUNK_SIZE(v);
         }
     }
@@ -687,10 +860,10 @@ inline unsigned MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::getNumObjec
     }
 
     // otherwise, he is not in the active block, so look for him
-    auto i = std::lower_bound(allInactives.begin(), allInactives.end(), here);
+    InactiveAllocationBlock* i = allInactives.find(here);
 
     // see if we found him
-    if (i != allInactives.end() && !(*i > here)) {
+    if (i != nullptr) {
 
         // we did, so dec reference count
         return i->getReferenceCount();
@@ -735,17 +908,14 @@ inline void MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::setupBlock(
 
         // don't remember a block with no objects
         if (ALLOCATOR_REF_COUNT != 0) {
-            allInactives.emplace_back(myState.activeRAM, myState.numBytes);
-            std::sort(allInactives.begin(), allInactives.end());
+            allInactives.add(myState.activeRAM, myState.numBytes);
         } else {
             free(myState.activeRAM);
         }
     }
 
     // empty out the list of unused chunks of RAM in this block
-    for (auto& c : myState.chunks) {
-        c.clear();
-    }
+    clearChunks(myState);
 
     myState.activeRAM = where;
 
@@ -772,10 +942,10 @@ inline void* MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::getAllocationB
     }
 
     // he's not, so see if he is from another block
-    auto i = std::lower_bound(allInactives.begin(), allInactives.end(), here);
+    InactiveAllocationBlock* i = allInactives.find(here);
 
     // see if we found him
-    if (i != allInactives.end() && !(*i > here)) {
+    if (i != nullptr) {
 
         // set up the pointer to the object
         OFFSET_TO_OBJECT_RELATIVE(i->start) = CHAR_PTR(here) - CHAR_PTR(i->start);
@@ -786,6 +956,25 @@ inline void* MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::getAllocationB
     return nullptr;
 }
 
+template <typename FirstPolicy, typename... OtherPolicies>
+inline AllocatorState MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::saveState() {
+
+    // the free chunks go with the old state, the rest of it is still the current block until a
+    // new one is set up
+    AllocatorState returnVal = std::move(myState);
+    myState.chunks.clear();
+    if (spareChunkLists.empty()) {
+        myState.chunks.resize(NUM_CHUNK_LISTS);
+    } else {
+        myState.chunks = std::move(spareChunkLists.back());
+        spareChunkLists.pop_back();
+    }
+    for (auto& w : myState.nonEmptyChunks) {
+        w = 0;
+    }
+    return returnVal;
+}
+
 // uses a specified block of memory for all allocations, until
 // restoreAllocationBlock () is called.
 template <typename FirstPolicy, typename... OtherPolicies>
@@ -794,7 +983,7 @@ MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::temporarilyUseBlockForAlloc
     void* putMeHere, size_t numBytesAvailable) {
 
     // remember the old stuff
-    AllocatorState returnVal = myState;
+    AllocatorState returnVal = saveState();
 
     // mark this one as user-supplied so that it is remembered
     myState.curBlockUserSupplied = false;
@@ -815,7 +1004,7 @@ MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::temporarilyUseBlockForAlloc
     size_t numBytesAvailable) {
 
     // remember the old stuff
-    AllocatorState returnVal = myState;
+    AllocatorState returnVal = saveState();
 
     // mark this one as user-supplied so that it is remembered
     myState.curBlockUserSupplied = false;
@@ -849,23 +1038,19 @@ inline void MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::restoreAllocati
     // if this guy was not user-allocated, then remember him
     if (!myState.curBlockUserSupplied) {
         if (ALLOCATOR_REF_COUNT != 0) {
-            allInactives.emplace_back(myState.activeRAM, myState.numBytes);
-            std::sort(allInactives.begin(), allInactives.end());
+            allInactives.add(myState.activeRAM, myState.numBytes);
         } else {
             free(myState.activeRAM);
         }
     }
 
-    // restore the old one
-    myState = useMe;
+    // keep the lists of this block for the next temporary one, and restore the old one
+    clearChunks(myState);
+    spareChunkLists.push_back(std::move(myState.chunks));
+    myState = std::move(useMe);
 
     // remove the old allocation block from the list of inactive ones
-    for (int i = 0; i < allInactives.size(); i++) {
-        if (allInactives[i].start == myState.activeRAM) {
-            allInactives.erase(allInactives.begin() + i);
-            break;
-        }
-    }
+    allInactives.remove(myState.activeRAM);
 
     // remove the phantom reference count for the old block
     ALLOCATOR_REF_COUNT--;
@@ -893,8 +1078,8 @@ inline std::string MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::printIna
     out = out + std::to_string(numInactives);
     out = out + std::string("\n");
 
-    for (i = 0; i < numInactives; i++) {
-        InactiveAllocationBlock curBlock = allInactives[i];
+    i = 0;
+    for (InactiveAllocationBlock& curBlock : allInactives) {
         out = out + std::to_string(i);
         out = out + std::string(":");
         out = out + std::to_string(curBlock.getReferenceCount());
@@ -905,6 +1090,7 @@ inline std::string MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::printIna
         stream << curBlock.getStart();
         out = out + stream.str();
         out = out + std::string("\n");
+        i++;
     }
 
     PDB_COUT << out << std::endl;
@@ -915,27 +1101,32 @@ inline std::string MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::printIna
 // this function should only be used for debugging purposes.
 template <typename FirstPolicy, typename... OtherPolicies>
 inline void MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::cleanInactiveBlocks() {
-    for (auto it = allInactives.begin(); it != allInactives.end();) {
-        it->freeBlock();
-        it = allInactives.erase(it);
+    std::vector<void*> toClean;
+    for (auto& block : allInactives) {
+        toClean.push_back(block.getStart());
+    }
+    for (void* start : toClean) {
+        allInactives.remove(start);
+        free(start);
     }
     return;
 }
 
 template <typename FirstPolicy, typename... OtherPolicies>
 inline void MultiPolicyAllocator<FirstPolicy, OtherPolicies...>::cleanInactiveBlocks(size_t size) {
-    for (auto it = allInactives.begin(); it != allInactives.end();) {
-        if (it->numBytes() == size) {
-            it->freeBlock();
-            it = allInactives.erase(it);
-        } else {
-            it++;
+    std::vector<void*> toClean;
+    for (auto& block : allInactives) {
+        if (block.numBytes() == size) {
+            toClean.push_back(block.getStart());
         }
     }
+    for (void* start : toClean) {
+        allInactives.remove(start);
+        free(start);
+    }
     return;
 }
 
-
 extern void* stackBase;
 extern void* stackEnd;
 extern Allocator* mainAllocatorPtr;
@@ -26,6 +26,7 @@
 #include <iterator>
 #include <cstring>
 #include <unordered_map>
+#include <cstdint>
 
 //#define DEBUG_OBJECT_MODEL
 //#define DEBUG_DEEP_COPY
@@ -91,6 +92,52 @@ public:
     void* getEnd();
 };
 
+// the blocks are filed in buckets of 2^INACTIVE_BLOCK_BUCKET_BITS bytes of the address space
+#define INACTIVE_BLOCK_BUCKET_BITS 20
+
+// this holds all of the Allocator-managed blocks that are not active, but still contain some
+// objects, so that the block containing a pointer is found in constant time, however many blocks
+// there are.  The address space is cut into buckets, and every bucket that a block overlaps lists
+// the block; blocks are malloced, so they never overlap, and a bucket lists only a few of them.
+class InactiveBlockDirectory {
+
+public:
+    // remember this block... the two params are the location, and the size in bytes
+    void add(void* start, size_t numBytes);
+
+    // returns the block that contains here, or nullptr if no block does
+    InactiveAllocationBlock* find(void* here);
+
+    // forget the block that begins at start, if there is one; this does not free it
+    void remove(void* start);
+
+    // the number of blocks
+    size_t size();
+
+    // the blocks, in no particular order
+    std::vector<InactiveAllocationBlock>::iterator begin();
+    std::vector<InactiveAllocationBlock>::iterator end();
+
+private:
+    // all of the blocks
+    std::vector<InactiveAllocationBlock> blocks;
+
+    // the position of each block in blocks, by its start
+    std::unordered_map<void*, size_t> positions;
+
+    // the blocks overlapping each bucket
+    std::unordered_map<size_t, std::vector<InactiveAllocationBlock>> buckets;
+};
+
+// the freed chunks of up to MAX_SMALL_CHUNK_SIZE bytes are kept in a list for each size; the sizes
+// are multiples of 4
+#define MAX_SMALL_CHUNK_SIZE 1024
+#define NUM_SMALL_CHUNK_LISTS (MAX_SMALL_CHUNK_SIZE / 4)
+
+// the larger ones are kept in a list for each power of two
+#define NUM_CHUNK_LISTS (NUM_SMALL_CHUNK_LISTS + 32)
+#define NUM_CHUNK_LIST_WORDS ((NUM_CHUNK_LISTS + 63) / 64)
+
 // this class holds the current state of an alloctor
 struct AllocatorState {
 
@@ -113,17 +160,25 @@ struct AllocatorState {
     // When the bytes are freed, a pointer to the region is added to the "chunks"
     // vector, declared below.
     //
-    // All of the free regions are organized into 32 lists.  The first list has all
-    // chunks 2^0 bytes in size.  The second all chunks 2^1 bytes in size.  The third
-    // all 2^2 and up to 2^3 - 1.  The fourth 2^3 and up to 2^4 - 1.  The fifth all
-    // 2^4 and up to 2^5 - 1, and so on.
+    // The free regions are organized into size classes.  Every chunk size is a multiple of 4,
+    // and the first NUM_SMALL_CHUNK_LISTS lists each hold the chunks of one size up to
+    // MAX_SMALL_CHUNK_SIZE: 4 bytes, 8 bytes, 12 bytes, and so on.  The last 32 lists hold
+    // the larger chunks by their power of two, the way that all of the chunks used to be: the
+    // list for 2^10 has the chunks from 2^10 and up to 2^11 - 1, the next 2^11 up to 2^12 - 1,
+    // and so on.
     //
-    // When a request for RAM is serviced, the correct list is located (that is, the
-    // first list that could possibly service the request) depending upon the size of
-    // the request.  It is searched linearly, and the first free region that can
-    // service the request is returned.  If no region in the list can service it, the
-    // next list is checked.  Then the next, and so on.
+    // When a request for RAM is serviced, the list for its size is located.  If it is a small
+    // list, any chunk in it fits; if it is a power of two list, it is searched for one that
+    // fits.  Otherwise, every chunk in every later list fits, so the first later list that
+    // is not empty, which nonEmptyChunks tells us without looking at the empty ones, gives
+    // the chunk.
+    //
+    // The lists are large, so a state is only ever moved, never copied: a temporary block takes
+    // the lists of a block it used before, and gives them back when it is done.
     std::vector<std::vector<void*>> chunks;
+
+    // bit i of this is set if and only if chunks[i] is not empty
+    uint64_t nonEmptyChunks[NUM_CHUNK_LIST_WORDS] = {};
 };
 
 
@@ -138,13 +193,13 @@ public:
 #ifdef DEBUG_OBJECT_MODEL
     inline void freeRAM(bool isContained,
                         void* here,
-                        std::vector<InactiveAllocationBlock>& allInactives,
+                        InactiveBlockDirectory& allInactives,
                         AllocatorState& myState,
                         int16_t typeId) {
 #else
     inline void freeRAM(bool isContained,
                         void* here,
-                        std::vector<InactiveAllocationBlock>& allInactives,
+                        InactiveBlockDirectory& allInactives,
                         AllocatorState& myState) {
 #endif
 
@@ -179,13 +234,13 @@ public:
 #ifdef DEBUG_OBJECT_MODEL
     inline void freeRAM(bool isContained,
                         void* here,
-                        std::vector<InactiveAllocationBlock>& allInactives,
+                        InactiveBlockDirectory& allInactives,
                         AllocatorState& myState,
                         int16_t typeId);
 #else
     inline void freeRAM(bool isContained,
                         void* here,
-                        std::vector<InactiveAllocationBlock>& allInactives,
+                        InactiveBlockDirectory& allInactives,
                         AllocatorState& myState);
 #endif
 
@@ -212,13 +267,13 @@ public:
 #ifdef DEBUG_OBJECT_MODEL
     inline void freeRAM(bool isContained,
                         void* here,
-                        std::vector<InactiveAllocationBlock>& allInactives,
+                        InactiveBlockDirectory& allInactives,
                         AllocatorState& myState,
                         int16_t typeId);
 #else
     inline void freeRAM(bool isContained,
                         void* here,
-                        std::vector<InactiveAllocationBlock>& allInactives,
+                        InactiveBlockDirectory& allInactives,
                         AllocatorState& myState);
 #endif
 
@@ -246,13 +301,13 @@ public:
 #ifdef DEBUG_OBJECT_MODEL
     inline void freeRAM(bool isContained,
                         void* here,
-                        std::vector<InactiveAllocationBlock>& allInactives,
+                        InactiveBlockDirectory& allInactives,
                         AllocatorState& myState,
                         int16_t typeId);
 #else
     inline void freeRAM(bool isContained,
                         void* here,
-                        std::vector<InactiveAllocationBlock>& allInactives,
+                        InactiveBlockDirectory& allInactives,
                         AllocatorState& myState);
 #endif
 
@@ -332,13 +387,13 @@ public:
 #ifdef DEBUG_OBJECT_MODEL
     inline void freeRAM(bool isContained,
                         void* here,
-                        std::vector<InactiveAllocationBlock>& allInactives,
+                        InactiveBlockDirectory& allInactives,
                         AllocatorState& myState,
                         int16_t typeId) {
 #else
     inline void freeRAM(bool isContained,
                         void* here,
-                        std::vector<InactiveAllocationBlock>& allInactives,
+                        InactiveBlockDirectory& allInactives,
                         AllocatorState& myState) {
 #endif
 
@@ -413,7 +468,11 @@ private:
 
     // this is the list of all self-managed allocation blocks that are not active, but
     // still contain some object...
-    std::vector<InactiveAllocationBlock> allInactives;
+    InactiveBlockDirectory allInactives;
+
+    // the empty free chunk lists of the temporary blocks we went back from, the next temporary
+    // block takes its lists from here
+    std::vector<std::vector<std::vector<void*>>> spareChunkLists;
 
 public:
     // return true if allocations should not fail due to not enough RAM...
@@ -455,6 +514,11 @@ public:
     // returns true if and only if the RAM is in the current allocation block
     inline bool contains(void* whereIn);
 
+    // tries to make the chunk at here (as returned by getRAM) howMuch bytes long without moving
+    // it; this only works if it is the last chunk carved out of the current allocation block and
+    // the block has room behind it, and returns false otherwise
+    inline bool tryToGrowInPlace(void* here, size_t howMuch);
+
     // returns true if and only if the RAM is in the current allocation block
     // or it is in some inactive allocation block that has not been deleted
     // as of yet
@@ -480,6 +544,10 @@ public:
     // make this RAM the current allocation block
     inline void setupBlock(void* where, size_t numBytesIn, bool throwExceptionOnFail);
 
+    // moves the current state out, to be restored later, and gives the current block empty free
+    // chunk lists
+    inline AllocatorState saveState();
+
     // make this user-supplied RAM the current allocation block
     inline void setupUserSuppliedBlock(void* where, size_t numBytesIn, bool throwExceptionOnFail);
 
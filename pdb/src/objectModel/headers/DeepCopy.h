@@ -62,4 +62,34 @@ void deleter(void* deleteMe, ObjType* dummy) {
         return computeSize(this);                                      \
     }
 
+#include <type_traits>
+
+namespace pdb {
+
+class Object;
+
+// true if ObjType declares getSize () itself (normally through ENABLE_DEEP_COPY), rather than
+// inheriting it, so that sizeof (ObjType) is the size of its objects
+template <class ObjType, class = void>
+struct DeclaresOwnGetSize : std::false_type {};
+
+template <class ObjType>
+struct DeclaresOwnGetSize<ObjType, decltype(void(&ObjType::getSize))>
+    : std::is_same<decltype(&ObjType::getSize), size_t (ObjType::*)(void*)> {};
+
+// A pdb :: Object is flat if all of its bytes are its own: it has no Handle, String, Vector or
+// other member that points somewhere else.  All of those have destructors that give up what they
+// point to, so we take a concrete type with a trivial destructor and its own deep copy methods to
+// be flat.  Flat objects are deep copied with a memmove and deleted without running anything, see
+// PDBTemplateBase.  A type that is trivially destructible but has a copy assignment with side
+// effects can opt out by specializing this to std :: false_type.
+template <class ObjType>
+struct IsFlatObject
+    : std::integral_constant<bool,
+                             std::is_trivially_destructible<ObjType>::value &&
+                                 !std::is_abstract<ObjType>::value &&
+                                 !std::is_same<ObjType, Object>::value &&
+                                 DeclaresOwnGetSize<ObjType>::value> {};
+}
+
 #endif
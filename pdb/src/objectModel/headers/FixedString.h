@@ -0,0 +1,185 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "Handle.h"
+#include "PDBMap.h"
+
+namespace pdb {
+
+// A string of at most Capacity characters that is stored inline, right where it is declared.
+// Unlike a String, it has no Handle and needs no allocation, so a class made up only of
+// primitive types and FixedStrings is a flat record: it can be copied with memcpy, and all
+// its fields sit at fixed offsets.  Values longer than Capacity are truncated.
+
+template <size_t Capacity>
+class FixedString {
+
+    static_assert(Capacity > 0 && Capacity < 256, "a FixedString holds 1 to 255 characters");
+
+private:
+    // the number of characters in use
+    unsigned char length;
+
+    // the characters, not null terminated
+    char chars[Capacity];
+
+    void set(const char* fromMe, size_t len) {
+        length = (unsigned char)std::min(len, Capacity);
+        memcpy(chars, fromMe, length);
+    }
+
+    int compare(const char* toMe, size_t len) const {
+        int result = memcmp(chars, toMe, std::min((size_t)length, len));
+        if (result != 0) {
+            return result;
+        }
+        return (length < len) ? -1 : ((length > len) ? 1 : 0);
+    }
+
+public:
+    FixedString() : length(0) {}
+
+    FixedString(const char* fromMe) {
+        set(fromMe, strlen(fromMe));
+    }
+
+    FixedString(const char* fromMe, size_t len) {
+        set(fromMe, len);
+    }
+
+    FixedString(const std::string& fromMe) {
+        set(fromMe.data(), fromMe.size());
+    }
+
+    FixedString& operator=(const char* toMe) {
+        set(toMe, strlen(toMe));
+        return *this;
+    }
+
+    FixedString& operator=(const std::string& toMe) {
+        set(toMe.data(), toMe.size());
+        return *this;
+    }
+
+    // the number of characters
+    size_t size() const {
+        return length;
+    }
+
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+
+    // the characters, note that they are not null terminated
+    const char* data() const {
+        return chars;
+    }
+
+    char operator[](size_t which) const {
+        return chars[which];
+    }
+
+    operator std::string() const {
+        return std::string(chars, length);
+    }
+
+    // returns the same hash as a String with the same characters
+    size_t hash() const {
+        return hashMe((char*)chars, length);
+    }
+
+    bool startsWith(const char* prefix) const {
+        size_t len = strlen(prefix);
+        return len <= length && memcmp(chars, prefix, len) == 0;
+    }
+
+    bool endsWith(const char* suffix) const {
+        size_t len = strlen(suffix);
+        return len <= length && memcmp(chars + length - len, suffix, len) == 0;
+    }
+
+    template <size_t OtherCapacity>
+    int compare(const FixedString<OtherCapacity>& toMe) const {
+        return compare(toMe.data(), toMe.size());
+    }
+
+    int compare(const char* toMe) const {
+        return compare(toMe, strlen(toMe));
+    }
+
+    int compare(const std::string& toMe) const {
+        return compare(toMe.data(), toMe.size());
+    }
+
+    template <class T>
+    bool operator==(const T& toMe) const {
+        return compare(toMe) == 0;
+    }
+
+    template <class T>
+    bool operator!=(const T& toMe) const {
+        return compare(toMe) != 0;
+    }
+
+    template <class T>
+    bool operator<(const T& toMe) const {
+        return compare(toMe) < 0;
+    }
+
+    template <class T>
+    bool operator<=(const T& toMe) const {
+        return compare(toMe) <= 0;
+    }
+
+    template <class T>
+    bool operator>(const T& toMe) const {
+        return compare(toMe) > 0;
+    }
+
+    template <class T>
+    bool operator>=(const T& toMe) const {
+        return compare(toMe) >= 0;
+    }
+
+    // compares two FixedStrings of any capacities, given only their addresses; this works
+    // because a FixedString is laid out as a length byte followed by its characters
+    static int compareStored(const void* first, const void* second) {
+        const unsigned char* a = (const unsigned char*)first;
+        const unsigned char* b = (const unsigned char*)second;
+        int result = memcmp(a + 1, b + 1, std::min(a[0], b[0]));
+        if (result != 0) {
+            return result;
+        }
+        return (int)a[0] - (int)b[0];
+    }
+
+    friend std::ostream& operator<<(std::ostream& stream, const FixedString& printMe) {
+        return stream.write(printMe.chars, printMe.length);
+    }
+};
+}
+
+#endif
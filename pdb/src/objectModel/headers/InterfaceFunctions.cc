@@ -301,6 +301,24 @@ Record<ObjType>* getRecord(Handle<ObjType>& forMe, void* putMeHere, size_t numBy
     return (Record<ObjType>*)res;
 }
 
+template <class ObjType>
+Record<ObjType>* getMallocedRecord(Handle<ObjType>& forMe, size_t initialSize) {
+
+    size_t size = initialSize;
+    while (true) {
+        void* space = malloc(size);
+        try {
+            Record<ObjType>* record = getRecord(forMe, space, size);
+
+            // the Record starts at the beginning of the space, so we can give back the rest
+            return (Record<ObjType>*)realloc(record, record->numBytes());
+        } catch (NotEnoughSpace& n) {
+            free(space);
+            size *= 2;
+        }
+    }
+}
+
 // added by Jia based on Chris' proposal
 template <class TargetType>
 Handle<TargetType> deepCopyToCurrentAllocationBlock(Handle<TargetType>& copyMe) {
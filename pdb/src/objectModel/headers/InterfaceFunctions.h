@@ -252,6 +252,14 @@ Record<ObjType>* getRecord(Handle<ObjType>& forMe);
 template <class ObjType>
 Record<ObjType>* getRecord(Handle<ObjType>& forMe, void* putMeHere, size_t numBytesAvailable);
 
+// This is like the above, except that the space is malloced for the caller: we start with
+// initialSize bytes and double them until the copy fits, then give back what the copy does not
+// use.  This is handy when the size of the object is not known up front.  The resulting
+// Record <ObjType> * is owned by the caller, and must be deallocated using free ().
+//
+template <class ObjType>
+Record<ObjType>* getMallocedRecord(Handle<ObjType>& forMe, size_t initialSize = 1024 * 1024);
+
 // this gets the type ID that the system has assigned to this particular type
 template <class ObjType>
 int16_t getTypeID();
@@ -28,12 +28,42 @@
 
 #define CAN_FIT_IN_DATA(len) (len <= sizeof(decltype(data().getOffset())))
 
+// the bytes in front of the characters of a long string that hold its hash
+#define HASH_PREAMBLE_SIZE sizeof(size_t)
+
+// a long string that has the hash in front of its characters has this bit in the size that its
+// type info records; long strings that were stored before without the hash do not, and are read
+// as they always were
+#define HASHED_LAYOUT_BIT RAW_OBJECT_TAG_BIT
+
 namespace pdb {
 
 inline Handle<char>& String::data() const {
     return *((Handle<char>*)this->storage);
 }
 
+inline bool String::isHashed() const {
+    int32_t info = data().getExactTypeInfoValue();
+    return info < 0 && ((-info) & HASHED_LAYOUT_BIT) != 0;
+}
+
+inline size_t& String::cachedHash() const {
+    return *((size_t*)&(*data()));
+}
+
+inline void String::allocateLong(int len) {
+
+    // the type info tells a deep copy how many bytes to move, so it includes the hash
+    data() = makeObjectWithExtraStorage<char>(HASH_PREAMBLE_SIZE + (len - 1) * sizeof(char));
+    data().setExactTypeInfoValue(-((len + (int)HASH_PREAMBLE_SIZE) | HASHED_LAYOUT_BIT));
+}
+
+inline void String::setUpHash() {
+    if (isHashed()) {
+        cachedHash() = hashMe(c_str(), size() - 1);
+    }
+}
+
 inline String::String() {
 
     // view the Handle as actually storing data
@@ -44,6 +74,12 @@ inline String::String() {
 
 inline size_t String::hash() const {
 
+    if (isHashed()) {
+        size_t code = cachedHash();
+        if (code != 0) {
+            return code;
+        }
+    }
     return hashMe(c_str(), size() - 1);
 }
 
@@ -58,11 +94,11 @@ inline String& String::operator=(const char* toMe) {
         if (data().getExactTypeInfoValue() >= 0) {
             data().setOffset(-1);
         }
-        data() = makeObjectWithExtraStorage<char>((len - 1) * sizeof(char));
-        data().setExactTypeInfoValue(-len);
+        allocateLong(len);
     }
 
     memmove(c_str(), toMe, len);
+    setUpHash();
     return *this;
 }
 
@@ -123,11 +159,11 @@ inline String& String::operator=(const std::string& s) {
         if (data().getExactTypeInfoValue() >= 0) {
             data().setOffset(-1);
         }
-        data() = makeObjectWithExtraStorage<char>((len - 1) * sizeof(char));
-        data().setExactTypeInfoValue(-len);
+        allocateLong(len);
     }
 
     memmove(c_str(), s.c_str(), len);
+    setUpHash();
     return *this;
 }
 
@@ -137,11 +173,11 @@ inline String::String(const char* toMe) {
         data().setExactTypeInfoValue(len);
     } else {
         data().setOffset(-1);
-        data() = makeObjectWithExtraStorage<char>((len - 1) * sizeof(char));
-        data().setExactTypeInfoValue(-len);
+        allocateLong(len);
     }
 
     memmove(c_str(), toMe, len);
+    setUpHash();
 }
 
 inline String::String(const char* toMe, size_t n) {
@@ -151,12 +187,12 @@ inline String::String(const char* toMe, size_t n) {
         data().setExactTypeInfoValue(len);
     } else {
         data().setOffset(-1);
-        data() = makeObjectWithExtraStorage<char>((len - 1) * sizeof(char));
-        data().setExactTypeInfoValue(-len);
+        allocateLong(len);
     }
 
     memmove(c_str(), toMe, len - 1);
     c_str()[len - 1] = 0;
+    setUpHash();
 }
 
 inline String::String(const std::string& s) {
@@ -166,14 +202,17 @@ inline String::String(const std::string& s) {
         data().setExactTypeInfoValue(len);
     } else {
         data().setOffset(-1);
-        data() = makeObjectWithExtraStorage<char>((len - 1) * sizeof(char));
-        data().setExactTypeInfoValue(-len);
+        allocateLong(len);
     }
 
     memmove(c_str(), s.c_str(), len);
+    setUpHash();
 }
 
 inline char& String::operator[](int whichOne) {
+    if (isHashed()) {
+        cachedHash() = 0;
+    }
     return c_str()[whichOne];
 }
 
@@ -186,7 +225,7 @@ inline char* String::c_str() const {
     if (data().getExactTypeInfoValue() >= 0) {
         return (char*)&data();
     } else {
-        return &(*data());
+        return isHashed() ? &(*data()) + HASH_PREAMBLE_SIZE : &(*data());
     }
 }
 
@@ -194,7 +233,8 @@ inline size_t String::size() const {
     if (data().getExactTypeInfoValue() >= 0) {
         return data().getExactTypeInfoValue();
     } else {
-        return -data().getExactTypeInfoValue();
+        size_t bytes = (-data().getExactTypeInfoValue()) & RAW_OBJECT_SIZE_MASK;
+        return isHashed() ? bytes - HASH_PREAMBLE_SIZE : bytes;
     }
 }
 
@@ -205,11 +245,25 @@ inline std::ostream& operator<<(std::ostream& stream, const String& printMe) {
 }
 
 inline bool String::operator==(const String& toMe) {
-    return strcmp(c_str(), toMe.c_str()) == 0;
+
+    // the lengths are at hand, and so are the hashes of long strings
+    size_t mySize = size();
+    if (mySize != toMe.size()) {
+        return false;
+    }
+    if (isHashed() && toMe.isHashed()) {
+        size_t myHash = cachedHash();
+        size_t otherHash = toMe.cachedHash();
+        if (myHash != 0 && otherHash != 0 && myHash != otherHash) {
+            return false;
+        }
+    }
+    return memcmp(c_str(), toMe.c_str(), mySize - 1) == 0;
 }
 
 inline bool String::operator==(const std::string& toMe) {
-    return strcmp(c_str(), toMe.c_str()) == 0;
+    size_t mySize = size();
+    return mySize == toMe.size() + 1 && memcmp(c_str(), toMe.c_str(), mySize - 1) == 0;
 }
 
 inline bool String::operator==(const char* toMe) {
@@ -217,18 +271,17 @@ inline bool String::operator==(const char* toMe) {
 }
 
 inline bool String::operator!=(const String& toMe) {
-    return strcmp(c_str(), toMe.c_str()) != 0;
+    return !(*this == toMe);
 }
 
 inline bool String::operator!=(const std::string& toMe) {
-    return strcmp(c_str(), toMe.c_str()) != 0;
+    return !(*this == toMe);
 }
 
 inline bool String::operator!=(const char* toMe) {
     return strcmp(c_str(), toMe) != 0;
 }
 
-
 inline bool String::endsWith(const std::string& suffix) {
     std::string str = c_str();
     int len1 = str.length();
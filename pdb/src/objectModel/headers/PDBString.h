@@ -37,6 +37,14 @@
 // code for the type inside the array (4B) + the VTble pointer for the Array (8B) + the
 // counter associated with the target of the Handle (4B), for a total size of 44B.  This
 // means that the overhead for the non-PDB-Object string is 64% less than the old implementation.
+//
+// Strings of up to seven characters are stored in place of the Handle's offset, so they need no
+// allocation at all.  Longer strings keep their hash in front of their characters, in the same
+// allocation, so that hashing a join or aggregation key does not rescan it, and so that the hash
+// moves along with the characters when the string is copied to another page.  Such a string marks
+// its layout with RAW_OBJECT_TAG_BIT in the size that its type info records, so that long strings
+// stored without the hash, e.g. in sets and catalog metadata written by an older build, are still
+// read as they were written.
 
 namespace pdb {
 
@@ -45,6 +53,20 @@ class String {
     char storage[sizeof(Handle<char>)];
     Handle<char>& data() const;
 
+    // true if the string is long, and its hash is stored in front of its characters; long strings
+    // that were stored before the hash was added are not
+    bool isHashed() const;
+
+    // the hash stored in front of the characters of a long string, zero if it is not known
+    size_t& cachedHash() const;
+
+    // points the Handle, which must be null or point to our old characters, to a new allocation
+    // for len characters, including the terminating null
+    void allocateLong(int len);
+
+    // computes the hash of a long string once its characters are there
+    void setUpHash();
+
 public:
     String();
     ~String();
@@ -55,6 +77,8 @@ public:
     String(const char* s, size_t n);
     String(const std::string& s);
     String(const String& s);
+    // writing through the returned reference makes a long string forget its hash; the chars
+    // returned by c_str () must not be changed, since the hash would not know about it
     char& operator[](int whichOne);
     operator std::string() const;
     char* c_str() const;
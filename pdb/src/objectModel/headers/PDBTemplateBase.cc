@@ -25,6 +25,11 @@
 #ifndef TEMPLATE_BASE_CC
 #define TEMPLATE_BASE_CC
 
+// a flat object keeps its size in the bits of info above the type code; it has to fit in the 15
+// bits left below the sign bit, larger objects are copied the usual way
+#define FLAT_OBJECT_SIZE_SHIFT 16
+#define FLAT_OBJECT_MAX_SIZE (1 << 15)
+
 namespace pdb {
 
 inline PDBTemplateBase::PDBTemplateBase() {
@@ -61,6 +66,11 @@ void PDBTemplateBase::setup() {
     if (std::is_base_of<Object, ObjType>::value) {
         info = (int16_t)getTypeID<ObjType>();
         // std :: cout << "I'm a pdb Object with info="<< info << std :: endl;
+#ifndef DISABLE_FLAT_DEEP_COPY
+        if (info > 0 && IsFlatObject<ObjType>::value && sizeof(ObjType) < FLAT_OBJECT_MAX_SIZE) {
+            info |= ((int32_t)sizeof(ObjType)) << FLAT_OBJECT_SIZE_SHIFT;
+        }
+#endif
     } else if (std::is_base_of<String, ObjType>::value) {
         info = String_TYPEID;
         // std :: cout << "I am a String object with info=" << info << std :: endl;
@@ -85,8 +95,9 @@ inline void PDBTemplateBase::deleteConstituentObject(void* deleteMe) const {
     } else if (info == Handle_TYPEID) {
         ((Handle<Nothing>*)deleteMe)->~Handle();
 
-        // else if we are not derived from Object, do nothing
-    } else if (info > 0) {
+        // else if we are not derived from Object, or are flat and have a trivial destructor, do
+        // nothing
+    } else if (info > 0 && !isFlatObject()) {
         // we are going to install the vTable pointer for an object of type ObjType into temp
         void* temp = nullptr;
         // std :: cout << "to getVTablePtr for deleteConsitituentObject" << info << std :: endl;
@@ -116,6 +127,12 @@ inline void PDBTemplateBase::setUpAndCopyFromConstituentObject(void* target, voi
         new (target) Handle<Nothing>();
         *((Handle<Nothing>*)target) = *((Handle<Nothing>*)source);
 
+        // if we are a flat Object, our bytes are all there is to copy, except for the vTable
+        // pointer, which the source may have brought from another process
+    } else if (isFlatObject()) {
+        memmove(target, source, info >> FLAT_OBJECT_SIZE_SHIFT);
+        ((Object*)target)->setVTablePtr(VTableMap::getVTablePtr((int16_t)info));
+
         // if we are derived from Object, use the virtual function
     } else if (info > 0) {
 
@@ -138,7 +155,7 @@ inline void PDBTemplateBase::setUpAndCopyFromConstituentObject(void* target, voi
     } else {
 
         // just do a memmove
-        memmove(target, source, -info);
+        memmove(target, source, (-info) & RAW_OBJECT_SIZE_MASK);
     }
 }
 
@@ -152,6 +169,10 @@ inline size_t PDBTemplateBase::getSizeOfConstituentObject(void* ofMe) const {
     } else if (info == Handle_TYPEID) {
         return sizeof(Handle<Nothing>);
 
+        // a flat object remembers its size
+    } else if (isFlatObject()) {
+        return info >> FLAT_OBJECT_SIZE_SHIFT;
+
         // if we are derived from Object, use the virtual function
     } else if (info > 0) {
         // we are going to install the vTable pointer for an object of type ObjType into temp
@@ -168,7 +189,7 @@ inline size_t PDBTemplateBase::getSizeOfConstituentObject(void* ofMe) const {
             return ((Object*)ofMe)->getSize(ofMe);
         }
     } else {
-        return -info;
+        return (-info) & RAW_OBJECT_SIZE_MASK;
     }
 }
 
@@ -179,9 +200,24 @@ inline void PDBTemplateBase::setVTablePtr(void* forMe) const {
         ((Object*)forMe)->setVTablePtr(VTableMap::getVTablePtr((int16_t)info));
 }
 
+inline void PDBTemplateBase::copyFlatObjects(void* target, void* source, size_t count) const {
+
+    // one memmove for all of them, and one vTable lookup
+    size_t objSize = info >> FLAT_OBJECT_SIZE_SHIFT;
+    memmove(target, source, objSize * count);
+    void* vTablePtr = VTableMap::getVTablePtr((int16_t)info);
+    for (size_t i = 0; i < count; i++) {
+        ((Object*)((char*)target + i * objSize))->setVTablePtr(vTablePtr);
+    }
+}
+
 inline bool PDBTemplateBase::descendsFromObject() const {
     return info > 0;
 }
+
+inline bool PDBTemplateBase::isFlatObject() const {
+    return (info >> FLAT_OBJECT_SIZE_SHIFT) > 0;
+}
 }
 
 #include "PDBString.cc"
@@ -19,6 +19,11 @@
 #ifndef TEMPLATE_BASE_H
 #define TEMPLATE_BASE_H
 
+// a non-pdb :: Object records its size as a negative info; the bit below the sign bit of that size
+// is left to the type itself, which may use it to tell two layouts of its bytes apart
+#define RAW_OBJECT_SIZE_MASK 0x3fffffff
+#define RAW_OBJECT_TAG_BIT 0x40000000
+
 namespace pdb {
 
 template <class ObjType>
@@ -38,8 +43,11 @@ class PDBTemplateBase {
 
 private:
     // a number greater than zero indicates a type code associated with a pdb :: Object
-    // a number less than zero indicates a non-pdb :: Object for whom we know the size
+    // a number less than zero indicates a non-pdb :: Object for whom we know the size, in the bits
+    // of RAW_OBJECT_SIZE_MASK
     // a number equal to zero indicates an error; we have no idea as to the type
+    // for a flat pdb :: Object (see IsFlatObject) the type code is in the low 16 bits, and its
+    // size in the bits above them, so that it can be copied without looking up its vTable
     int32_t info;
 
 public:
@@ -69,9 +77,16 @@ public:
     // correctly set the vTable pointer of the object pointed to by forMe
     void setVTablePtr(void* forMe) const;
 
+    // copies count objects that are laid out back to back at source to target; this must only
+    // be called if isFlatObject () is true
+    void copyFlatObjects(void* target, void* source, size_t count) const;
+
     // returns true if the type indicated by info is descended from pdb :: Object
     bool descendsFromObject() const;
 
+    // returns true if the type is a flat pdb :: Object, whose copy is a memmove
+    bool isFlatObject() const;
+
     // returns the type code
     int16_t getTypeCode() const;
 
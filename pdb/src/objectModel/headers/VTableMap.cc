@@ -63,7 +63,7 @@ inline std::string VTableMap::lookupBuiltInType(int16_t objectType) {
 // returns the number of registered built-in objects
 inline int VTableMap::totalBuiltInObjects() {
     int count = 0;
-    for (unsigned int i = 0; i < theVTable->allVTables.size(); i++) {
+    for (unsigned int i = 0; i < VTABLE_MAP_SIZE; i++) {
         if (theVTable->allVTables[i] != nullptr) {
             count = count + 1;
         }
@@ -72,9 +72,9 @@ inline int VTableMap::totalBuiltInObjects() {
 }
 
 inline void VTableMap::listVtableEntries() {
-    for (unsigned int i = 0; i < theVTable->allVTables.size(); i++) {
+    for (unsigned int i = 0; i < VTABLE_MAP_SIZE; i++) {
         if (theVTable->allVTables[i] != nullptr)
-            PDB_COUT << "vtpr " << i << ": " << theVTable->allVTables[i] << std::endl;
+            PDB_COUT << "vtpr " << i << ": " << theVTable->allVTables[i].load() << std::endl;
     }
 }
 
@@ -228,12 +228,10 @@ inline void* VTableMap::getVTablePtr(int16_t objectTypeID) {
         return nullptr;
     }
 
-    // JIANOTE TODO: we may need lock it, otherwise another thread may change it
-    /*
-    // OK, first, we check to see if we have the v table pointer for this guy...
-    // this is done without a lock, so we can be very fast...
-    */
-    void* returnVal = theVTable->allVTables[objectTypeID];
+    // OK, first, we check to see if we have the v table pointer for this guy... this is done
+    // without a lock, so we can be very fast; the acquire pairs with the release that published
+    // the pointer, so the shared library behind it is completely set up
+    void* returnVal = theVTable->allVTables[objectTypeID].load(std::memory_order_acquire);
     if (returnVal != nullptr) {
         return returnVal;
     }
@@ -248,7 +246,7 @@ inline void* VTableMap::getVTablePtr(int16_t objectTypeID) {
     // std :: cout << "got lock at " << ss.str() << " in getVTablePtr" << std :: endl;
     // before we go out to the network for the v table pointer, just verify
     // that another thread has not since gotten it for us
-    returnVal = theVTable->allVTables[objectTypeID];
+    returnVal = theVTable->allVTables[objectTypeID].load(std::memory_order_acquire);
 
     //        pthread_mutex_unlock(&theVTable->myLock);
     if (returnVal != nullptr) {
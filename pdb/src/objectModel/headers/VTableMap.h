@@ -31,11 +31,15 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <atomic>
 #include <algorithm>
 
 // this is the special type ID used for any type that the system does not know about
 #define TYPE_NOT_RECOGNIZED 8191
 
+// the number of type IDs there is room for in the VTableMap
+#define VTABLE_MAP_SIZE 16384
+
 namespace pdb {
 
 class CatalogClient;
@@ -68,6 +72,18 @@ public:
     // look up the vtable using the given catalog
     static void* getVTablePtrUsingCatalog(int16_t objectTypeID);
 
+    // keeps the shared libraries fetched from the catalog in cacheDir, named by the hash of their
+    // contents, so that they are fetched once per node instead of once per process and type
+    static void setSharedLibraryCache(std::string cacheDir);
+
+    // loads every shared library in the cache; this is done at server start, before the backend
+    // is forked, so that neither process has to go to the catalog for the types it has seen before
+    static void preloadSharedLibraryCache();
+
+    // makes sure the vTables of all of the given types are loaded, so that the threads of a job
+    // stage do not have to take turns going to the catalog for them
+    static void prefetchTypes(const std::vector<std::string>& typeNames);
+
     // print out the contents of the vTableMap
     static void listVtableEntries();
     static void listVtableLabels();
@@ -95,8 +111,10 @@ private:
     // we have previously looked for the ID and not been able to find it
     std::map<std::string, int16_t> objectTypeNamesList;
 
-    // the list of all registered object types; the position in the list implies the type ID
-    std::vector<void*> allVTables;
+    // the list of all registered object types; the position in the list implies the type ID.
+    // An entry is only ever set once the shared library it comes from is fully set up, so it can
+    // be read without the lock
+    std::atomic<void*> allVTables[VTABLE_MAP_SIZE];
 
     // this is a pointer to the catalog client that we are using to access the catalog
     CatalogClient* catalog;
@@ -109,6 +127,16 @@ private:
 
     // holds all of the so handles
     std::vector<void*> so_handles;
+
+    // where the shared libraries are cached, empty if they are not
+    std::string sharedLibraryCacheDir;
+
+    // the file in the cache that holds the shared library of each type ID
+    std::map<int16_t, std::string> cachedSharedLibraries;
+
+    // opens a shared library for a type, sets up its global variables and publishes its vTable;
+    // this should only be called while holding myLock
+    static void* loadSharedLibrary(int16_t objectTypeID, std::string sharedLibraryFile);
 };
 
 extern VTableMap* theVTable;
@@ -20,8 +20,10 @@
 #define VTABLEMAP_CAT_LOOKUP_CC
 
 #include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 #include <unistd.h>
-#include <unistd.h>
+#include <fstream>
 #include "PDBDebug.h"
 #include "PDBLogger.h"
 #include <cctype>
@@ -29,6 +31,72 @@
 
 namespace pdb {
 
+// the FNV-1a hash of the contents of a file, used to name the shared libraries in the cache
+static bool hashFileContents(const std::string& fileName, uint64_t& hash) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    hash = 14695981039346656037ULL;
+    char buffer[65536];
+    ssize_t numBytes;
+    while ((numBytes = read(fd, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t i = 0; i < numBytes; i++) {
+            hash ^= (unsigned char)buffer[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+    close(fd);
+    return numBytes == 0;
+}
+
+// the name of the file in the cache that lists which shared library holds each type ID
+static std::string getSharedLibraryCacheIndex(const std::string& cacheDir) {
+    return cacheDir + "/index";
+}
+
+void VTableMap::setSharedLibraryCache(std::string cacheDir) {
+    const LockGuard guard{theVTable->myLock};
+    mkdir(cacheDir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    theVTable->sharedLibraryCacheDir = cacheDir;
+    theVTable->cachedSharedLibraries.clear();
+
+    // read the index, a type that shows up more than once was cached by several processes
+    std::ifstream index(getSharedLibraryCacheIndex(cacheDir));
+    int objectTypeID;
+    std::string fileName;
+    while (index >> objectTypeID >> fileName) {
+        std::string cachedFile = cacheDir + "/" + fileName;
+        if (objectTypeID > 0 && objectTypeID < VTABLE_MAP_SIZE && access(cachedFile.c_str(), R_OK) == 0) {
+            theVTable->cachedSharedLibraries[objectTypeID] = cachedFile;
+        }
+    }
+}
+
+void VTableMap::preloadSharedLibraryCache() {
+    const LockGuard guard{theVTable->myLock};
+    int numLoaded = 0;
+    for (auto& entry : theVTable->cachedSharedLibraries) {
+        if (theVTable->allVTables[entry.first].load(std::memory_order_relaxed) == nullptr &&
+            loadSharedLibrary(entry.first, entry.second) != nullptr) {
+            numLoaded++;
+        }
+    }
+    if (theVTable->logger != nullptr) {
+        theVTable->logger->info(std::string("VTableMap: preloaded ") + std::to_string(numLoaded) +
+                                " shared libraries from " + theVTable->sharedLibraryCacheDir);
+    }
+}
+
+void VTableMap::prefetchTypes(const std::vector<std::string>& typeNames) {
+    for (const std::string& typeName : typeNames) {
+        int16_t objectTypeID = getIDByName(typeName);
+        if (objectTypeID > 0 && objectTypeID != TYPE_NOT_RECOGNIZED) {
+            getVTablePtr(objectTypeID);
+        }
+    }
+}
+
 // note: this should only be called while protected by a lock on the vTableMap
 void* VTableMap::getVTablePtrUsingCatalog(int16_t objectTypeID) {
 
@@ -51,7 +119,19 @@ void* VTableMap::getVTablePtrUsingCatalog(int16_t objectTypeID) {
         return nullptr;
     }
 
-    std::string sharedLibraryFile = "/var/tmp/objectFile.";
+    // if this node has fetched the library before, there is no need to ask the catalog again
+    bool useCache = !theVTable->sharedLibraryCacheDir.empty();
+    if (useCache && theVTable->cachedSharedLibraries.count(objectTypeID) != 0) {
+        void* returnVal =
+            loadSharedLibrary(objectTypeID, theVTable->cachedSharedLibraries[objectTypeID]);
+        if (returnVal != nullptr) {
+            return returnVal;
+        }
+        theVTable->cachedSharedLibraries.erase(objectTypeID);
+    }
+
+    std::string sharedLibraryFile =
+        useCache ? theVTable->sharedLibraryCacheDir + "/fetch." : std::string("/var/tmp/objectFile.");
     sharedLibraryFile += to_string(getpid()) + "." + to_string(objectTypeID) + ".so";
     PDB_COUT << "VTableMap:: to get sharedLibraryFile =" << sharedLibraryFile << std::endl;
     if (theVTable->logger != nullptr) {
@@ -63,7 +143,7 @@ void* VTableMap::getVTablePtrUsingCatalog(int16_t objectTypeID) {
     bool ret = theVTable->catalog->getSharedLibrary(objectTypeID, sharedLibraryFile);
 
     // we should stop here if someone else updated the VTable
-    void* returnVal = theVTable->allVTables[objectTypeID];
+    void* returnVal = theVTable->allVTables[objectTypeID].load(std::memory_order_acquire);
     if (returnVal != nullptr) {
         return returnVal;
     }
@@ -79,10 +159,41 @@ void* VTableMap::getVTablePtrUsingCatalog(int16_t objectTypeID) {
         return nullptr;
     }
 
+    // move the library to its place in the cache; the same contents always end up in the same
+    // file, so processes that fetch a library at the same time simply replace each other's copy
+    uint64_t hash;
+    if (useCache && hashFileContents(sharedLibraryFile, hash)) {
+        char fileName[32];
+        snprintf(fileName, sizeof(fileName), "%016llx.so", (unsigned long long)hash);
+        std::string cachedFile = theVTable->sharedLibraryCacheDir + "/" + fileName;
+        if (rename(sharedLibraryFile.c_str(), cachedFile.c_str()) == 0) {
+            sharedLibraryFile = cachedFile;
+            theVTable->cachedSharedLibraries[objectTypeID] = cachedFile;
+
+            // a single short append, so the lines of different processes never interleave
+            std::string line = to_string(objectTypeID) + " " + fileName + "\n";
+            int fd = open(getSharedLibraryCacheIndex(theVTable->sharedLibraryCacheDir).c_str(),
+                          O_WRONLY | O_APPEND | O_CREAT,
+                          S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+            if (fd >= 0) {
+                if (write(fd, line.c_str(), line.size()) != (ssize_t)line.size() &&
+                    theVTable->logger != nullptr) {
+                    theVTable->logger->error("VTableMap: could not add " + line + " to the index");
+                }
+                close(fd);
+            }
+        }
+    }
+
+    return loadSharedLibrary(objectTypeID, sharedLibraryFile);
+}
+
+// note: this should only be called while protected by a lock on the vTableMap
+void* VTableMap::loadSharedLibrary(int16_t objectTypeID, std::string sharedLibraryFile) {
+
     // open up the shared library
 
     void* so_handle = dlopen(sharedLibraryFile.c_str(), RTLD_LOCAL | RTLD_LAZY);
-    theVTable->so_handles.push_back(so_handle);
 
     if (!so_handle) {
         const char* dlsym_error = dlerror();
@@ -90,50 +201,54 @@ void* VTableMap::getVTablePtrUsingCatalog(int16_t objectTypeID) {
             theVTable->logger->error("Cannot load Stored Data Type library: " + sharedLibraryFile +
                                      " error " + (std::string)dlsym_error + '\n');
         std::cout << "Error == " <<(std::string)dlsym_error << std::endl;
-        // if we were able to open it
+        return nullptr;
+    }
+    theVTable->so_handles.push_back(so_handle);
+
+    // if we were able to open it
+    const char* dlsym_error = dlerror();
+
+    // first we need to correctly set all of the global variables in the shared library
+    typedef void setGlobalVars(Allocator*, VTableMap*, void*, void*);
+    std::string getInstance = "setAllGlobalVariables";
+    PDB_COUT << "to set global variables" << std::endl;
+    setGlobalVars* setGlobalVarsFunc = (setGlobalVars*)dlsym(so_handle, getInstance.c_str());
+    // see if we were able to get the function
+    if ((dlsym_error = dlerror())) {
+        if (theVTable->logger != nullptr)
+            theVTable->logger->error(
+                "Error, can't set global variables in .so file; error is " +
+                (std::string)dlsym_error + "\n");
+        std::cout << "ERROR: we were not able to get the function" << std::endl;
+        return nullptr;
+        // if we were able to, then run it
     } else {
-        const char* dlsym_error = dlerror();
+        setGlobalVarsFunc(mainAllocatorPtr, theVTable, stackBase, stackEnd);
+        PDB_COUT << "Successfully set global variables" << std::endl;
+    }
 
-        // first we need to correctly set all of the global variables in the shared library
-        typedef void setGlobalVars(Allocator*, VTableMap*, void*, void*);
-        std::string getInstance = "setAllGlobalVariables";
-        PDB_COUT << "to set global variables" << std::endl;
-        setGlobalVars* setGlobalVarsFunc = (setGlobalVars*)dlsym(so_handle, getInstance.c_str());
-        // see if we were able to get the function
-        if ((dlsym_error = dlerror())) {
-            if (theVTable->logger != nullptr)
-                theVTable->logger->error(
-                    "Error, can't set global variables in .so file; error is " +
-                    (std::string)dlsym_error + "\n");
-            std::cout << "ERROR: we were not able to get the function" << std::endl;
-            return nullptr;
-            // if we were able to, then run it
-        } else {
-            setGlobalVarsFunc(mainAllocatorPtr, theVTable, stackBase, stackEnd);
-            PDB_COUT << "Successfully set global variables" << std::endl;
-        }
+    // get the function that will give us access to the vTable
+    typedef void* getObjectVTable();
+    getInstance = "getObjectVTable";
+    getObjectVTable* getObjectFunc = (getObjectVTable*)dlsym(so_handle, getInstance.c_str());
 
-        // get the function that will give us access to the vTable
-        typedef void* getObjectVTable();
-        getInstance = "getObjectVTable";
-        getObjectVTable* getObjectFunc = (getObjectVTable*)dlsym(so_handle, getInstance.c_str());
-
-        // see if we were able to get the function
-        if ((dlsym_error = dlerror())) {
-            if (theVTable->logger != nullptr)
-                theVTable->logger->error("Error, can't load function getInstance (); error is " +
-                                         (std::string)dlsym_error + "\n");
-            std::cout << "ERROR: we were not able to load function getObjectVTable" << std::endl;
-            return nullptr;
-            // if we were able to, then run it
-        } else {
-            theVTable->allVTables[objectTypeID] = getObjectFunc();
-            PDB_COUT << "VTablePtr for objectTypeID=" << objectTypeID
-                     << " is set in allVTables to be " << theVTable->allVTables[objectTypeID]
-                     << std::endl;
-        }
+    // see if we were able to get the function
+    if ((dlsym_error = dlerror())) {
+        if (theVTable->logger != nullptr)
+            theVTable->logger->error("Error, can't load function getInstance (); error is " +
+                                     (std::string)dlsym_error + "\n");
+        std::cout << "ERROR: we were not able to load function getObjectVTable" << std::endl;
+        return nullptr;
+        // if we were able to, then run it
     }
-    return theVTable->allVTables[objectTypeID];
+
+    // publish the pointer, the release makes the set up above visible to the readers that do
+    // not take the lock
+    void* returnVal = getObjectFunc();
+    theVTable->allVTables[objectTypeID].store(returnVal, std::memory_order_release);
+    PDB_COUT << "VTablePtr for objectTypeID=" << objectTypeID
+             << " is set in allVTables to be " << returnVal << std::endl;
+    return returnVal;
 }
 
 int16_t VTableMap::lookupTypeNameInCatalog(std::string objectTypeName) {
@@ -45,8 +45,8 @@ VTableMap::VTableMap() {
     ss << &(myLock);
     PDB_COUT << "to initialize lock at " << ss.str() << std::endl;
     pthread_mutex_init(&(myLock), nullptr);
-    for (unsigned int i = 0; i < 16384; i++) {
-        allVTables.push_back(nullptr);
+    for (unsigned int i = 0; i < VTABLE_MAP_SIZE; i++) {
+        allVTables[i].store(nullptr, std::memory_order_relaxed);
     }
 
 // this will add a type identifier for each one of the built-in types
@@ -0,0 +1,239 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef PDB_ASYNC_LOGGER_H
+#define PDB_ASYNC_LOGGER_H
+
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "LogLevel.h"
+#include "SPSCRingBuffer.h"
+
+// the most verbose level that is compiled in; statements above it are removed by the compiler
+#ifndef PDB_COMPILED_LOG_LEVEL
+#ifdef PDB_DEBUG
+#define PDB_COMPILED_LOG_LEVEL TRACE
+#else
+#define PDB_COMPILED_LOG_LEVEL INFO
+#endif
+#endif
+
+// the number of records each thread can have in flight before it has to wait for the flusher
+#ifndef PDB_LOG_BUFFER_RECORDS
+#define PDB_LOG_BUFFER_RECORDS 1024
+#endif
+
+// how often the flusher wakes up on its own, in milliseconds
+#ifndef PDB_LOG_FLUSH_INTERVAL_MS
+#define PDB_LOG_FLUSH_INTERVAL_MS 10
+#endif
+
+namespace pdb {
+
+// a destination for log records; the file is only touched by the flusher and by whoever swaps it
+struct PDBLogSink {
+
+    PDBLogSink(FILE* file) : file(file) {
+        pthread_mutex_init(&lock, nullptr);
+    }
+
+    ~PDBLogSink() {
+        pthread_mutex_destroy(&lock);
+    }
+
+    // the file we write to
+    FILE* file;
+
+    // held while writing to or replacing the file
+    pthread_mutex_t lock;
+};
+
+// one log statement waiting to be written out
+struct PDBLogRecord {
+
+    // where this record goes
+    PDBLogSink* sink = nullptr;
+
+    // true if the message is written as is, without the thread and timestamp prefix
+    bool raw = false;
+
+    // when it was logged
+    time_t time = 0;
+
+    // who logged it
+    pthread_t threadId = 0;
+
+    // the text, its capacity is reused by later records in the same slot
+    std::string message;
+};
+
+// the buffer a single thread logs into; the flusher is its only consumer
+struct PDBThreadLogBuffer {
+
+    PDBThreadLogBuffer() : records(PDB_LOG_BUFFER_RECORDS), retired(false) {}
+
+    // the pending records
+    SPSCRingBuffer<PDBLogRecord> records;
+
+    // set once the owning thread has exited, the buffer is dropped after the next drain
+    std::atomic<bool> retired;
+};
+
+/**
+ * An asynchronous logger: every thread appends records to its own lock-free buffer and a
+ * background thread writes them out. The only lock a logging thread ever takes is the one that
+ * registers its buffer the first time it logs.
+ */
+class PDBAsyncLogger {
+
+public:
+    // returns the process wide logger
+    static PDBAsyncLogger& getInstance();
+
+    // returns true if a statement at this level should be recorded right now
+    static bool isEnabled(LogLevel level) {
+        return level <= runtimeLevel.load(std::memory_order_relaxed);
+    }
+
+    // changes the most verbose level that is recorded, it can not exceed PDB_COMPILED_LOG_LEVEL
+    static void setLogLevel(LogLevel level);
+
+    // returns the sink that writes to stdout
+    PDBLogSink* getStdoutSink();
+
+    /**
+     * Queues a message, this never blocks unless the calling thread's buffer is full
+     * @param sink where the message goes, nullptr for stdout
+     * @param data the message
+     * @param length the length of the message
+     * @param raw if true the message is written without a prefix and without a newline
+     */
+    void log(PDBLogSink* sink, const char* data, size_t length, bool raw = false);
+
+    // writes out everything that was queued before this call
+    void flush();
+
+    /**
+     * Writes out everything that was queued for the sink and flushes its file, once this returns
+     * the flusher only touches the sink again for records logged after the call
+     * @param sink the sink that is about to be closed
+     */
+    void unregisterSink(PDBLogSink* sink);
+
+    ~PDBAsyncLogger();
+
+private:
+    PDBAsyncLogger();
+
+    // returns the buffer of the calling thread, registering it if this is its first record
+    PDBThreadLogBuffer& getThreadBuffer();
+
+    // starts the background flusher if it is not running in this process
+    void startFlusher();
+
+    // the body of the background flusher
+    static void* runFlusher(void* logger);
+
+    // writes out all pending records, must be called with drainLock held
+    void drainAll();
+
+    // writes a single record to its sink
+    void writeRecord(PDBLogRecord& record);
+
+    // wakes up the flusher before its interval is over
+    void wakeFlusher();
+
+    // fork handlers, so that a forked backend gets its own flusher
+    static void prepareFork();
+    static void afterForkParent();
+    static void afterForkChild();
+
+    // the most verbose level currently recorded
+    static std::atomic<int> runtimeLevel;
+
+    // the buffers of all threads that have logged something
+    std::vector<std::shared_ptr<PDBThreadLogBuffer>> buffers;
+
+    // protects buffers
+    pthread_mutex_t registryLock;
+
+    // serializes consumers, so that every buffer has a single consumer at a time
+    pthread_mutex_t drainLock;
+
+    // used to wake up the flusher early
+    pthread_mutex_t wakeLock;
+    pthread_cond_t wakeSignal;
+
+    // the background thread
+    pthread_t flusherThread;
+    std::atomic<bool> flusherRunning;
+    std::atomic<bool> stopping;
+
+    // the default sink
+    PDBLogSink stdoutSink;
+
+    // the last formatted timestamp, only used by whoever holds drainLock
+    time_t lastTime;
+    char lastTimeString[80];
+};
+
+/**
+ * Collects one log statement through operator<< and hands it to the asynchronous logger when it
+ * goes out of scope. Use it through PDB_LOG rather than directly.
+ */
+class PDBLogLine {
+
+public:
+    PDBLogLine(LogLevel level, PDBLogSink* sink = nullptr);
+
+    ~PDBLogLine();
+
+    // the stream to write the statement to
+    std::ostream& stream() {
+        return *out;
+    }
+
+private:
+    // where the statement goes
+    PDBLogSink* sink;
+
+    // the stream we format into, normally the thread's reusable one
+    std::ostringstream* out;
+
+    // only used if this statement is logged while formatting another one
+    std::unique_ptr<std::ostringstream> nestedStream;
+};
+}
+
+// logs a statement at the given level, e.g. PDB_LOG(DEBUG) << "got page " << pageId;
+// the arguments are not evaluated when the level is disabled, and not compiled in when the
+// level is above PDB_COMPILED_LOG_LEVEL
+#define PDB_LOG(level)                                                                         \
+    if ((level) > PDB_COMPILED_LOG_LEVEL || !pdb::PDBAsyncLogger::isEnabled(level))            \
+        ;                                                                                      \
+    else                                                                                       \
+        pdb::PDBLogLine(level).stream()
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <ostream>
 #include <iostream>
+#include "PDBAsyncLogger.h"
 
 /*
  * A class used to disable std::cout and output nothing
@@ -25,8 +26,10 @@ public:
     }
 };
 
+// with PDB_DEBUG the debug messages go through the asynchronous logger instead of
+// taking the std::cout lock on every statement
 #ifdef PDB_DEBUG
-#define PDB_COUT std::cout
+#define PDB_COUT PDB_LOG(DEBUG)
 #else
 #define PDB_COUT NullStream()
 #endif
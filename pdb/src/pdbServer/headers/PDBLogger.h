@@ -28,11 +28,11 @@
 
 #include <memory>
 #include "LogLevel.h"
+#include "PDBAsyncLogger.h"
 
-#include <pthread.h>
 
-
-// used to log client and server activity to a text file
+// used to log client and server activity to a text file; the lines are handed to the
+// PDBAsyncLogger, so writing one never waits for the file
 
 namespace pdb {
 
@@ -102,11 +102,8 @@ public:
     void trace(std::string writeMe);
 
 private:
-    // prohibits two people from writing to the file at the same time
-    pthread_mutex_t fileLock;
-
-    // the location we are writing to
-    FILE* outputFile;
+    // the file we are writing to, shared with the asynchronous logger's flusher
+    std::unique_ptr<PDBLogSink> sink;
 
     bool enabled = true;
 
@@ -0,0 +1,316 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef PDB_ASYNC_LOGGER_CC
+#define PDB_ASYNC_LOGGER_CC
+
+#include <algorithm>
+#include <sched.h>
+#include <sys/time.h>
+
+#include "LockGuard.h"
+#include "PDBAsyncLogger.h"
+
+namespace pdb {
+
+namespace {
+
+// the tags written in front of each statement, indexed by LogLevel
+const char* levelTags[] = {
+    "[OFF] ", "[FATAL] ", "[ERROR] ", "[WARN] ", "[INFO] ", "[DEBUG] ", "[TRACE] "};
+
+// owns the calling thread's buffer and retires it when the thread exits
+struct ThreadLogBufferHolder {
+    std::shared_ptr<PDBThreadLogBuffer> buffer;
+
+    ~ThreadLogBufferHolder() {
+        if (buffer != nullptr) {
+            buffer->retired = true;
+        }
+    }
+};
+
+thread_local ThreadLogBufferHolder myLogBuffer;
+
+// the stream each thread formats its statements into, reused across statements
+thread_local std::ostringstream myFormatStream;
+
+// true while the calling thread is formatting a statement into myFormatStream
+thread_local bool formatStreamInUse = false;
+}
+
+std::atomic<int> PDBAsyncLogger::runtimeLevel(PDB_COMPILED_LOG_LEVEL);
+
+PDBAsyncLogger& PDBAsyncLogger::getInstance() {
+    static PDBAsyncLogger instance;
+    return instance;
+}
+
+PDBAsyncLogger::PDBAsyncLogger()
+    : flusherRunning(false), stopping(false), stdoutSink(stdout), lastTime(0) {
+    lastTimeString[0] = '\0';
+    pthread_mutex_init(&registryLock, nullptr);
+    pthread_mutex_init(&drainLock, nullptr);
+    pthread_mutex_init(&wakeLock, nullptr);
+    pthread_cond_init(&wakeSignal, nullptr);
+    pthread_atfork(prepareFork, afterForkParent, afterForkChild);
+}
+
+PDBAsyncLogger::~PDBAsyncLogger() {
+    stopping = true;
+    if (flusherRunning) {
+        wakeFlusher();
+        pthread_join(flusherThread, nullptr);
+        flusherRunning = false;
+    }
+    {
+        const LockGuard guard{drainLock};
+        drainAll();
+    }
+    pthread_cond_destroy(&wakeSignal);
+    pthread_mutex_destroy(&wakeLock);
+    pthread_mutex_destroy(&drainLock);
+    pthread_mutex_destroy(&registryLock);
+}
+
+void PDBAsyncLogger::setLogLevel(LogLevel level) {
+    runtimeLevel = std::min((int)level, (int)PDB_COMPILED_LOG_LEVEL);
+}
+
+PDBLogSink* PDBAsyncLogger::getStdoutSink() {
+    return &stdoutSink;
+}
+
+PDBThreadLogBuffer& PDBAsyncLogger::getThreadBuffer() {
+    if (myLogBuffer.buffer == nullptr) {
+        myLogBuffer.buffer = std::make_shared<PDBThreadLogBuffer>();
+        const LockGuard guard{registryLock};
+        buffers.push_back(myLogBuffer.buffer);
+    }
+    return *myLogBuffer.buffer;
+}
+
+void PDBAsyncLogger::log(PDBLogSink* sink, const char* data, size_t length, bool raw) {
+
+    if (!flusherRunning.load(std::memory_order_acquire)) {
+        startFlusher();
+    }
+
+    PDBThreadLogBuffer& buffer = getThreadBuffer();
+    time_t now = time(nullptr);
+    pthread_t me = pthread_self();
+    PDBLogSink* target = (sink == nullptr) ? &stdoutSink : sink;
+
+    auto fill = [&](PDBLogRecord& record) {
+        record.sink = target;
+        record.raw = raw;
+        record.time = now;
+        record.threadId = me;
+        record.message.assign(data, length);
+    };
+
+    // if our buffer is full we have to wait for the flusher to catch up, or drain it ourselves
+    // if there is no flusher anymore
+    while (!buffer.records.tryPush(fill)) {
+        if (stopping || !flusherRunning) {
+            flush();
+        } else {
+            wakeFlusher();
+            sched_yield();
+        }
+    }
+}
+
+void PDBAsyncLogger::flush() {
+    const LockGuard guard{drainLock};
+    drainAll();
+}
+
+void PDBAsyncLogger::unregisterSink(PDBLogSink* sink) {
+    const LockGuard guard{drainLock};
+    drainAll();
+    const LockGuard sinkGuard{sink->lock};
+    if (sink->file != nullptr) {
+        fflush(sink->file);
+    }
+}
+
+void PDBAsyncLogger::startFlusher() {
+    const LockGuard guard{registryLock};
+    if (flusherRunning || stopping) {
+        return;
+    }
+    if (pthread_create(&flusherThread, nullptr, runFlusher, this) == 0) {
+        flusherRunning.store(true, std::memory_order_release);
+    }
+}
+
+void* PDBAsyncLogger::runFlusher(void* arg) {
+    PDBAsyncLogger* me = (PDBAsyncLogger*)arg;
+    while (true) {
+        {
+            struct timeval now;
+            gettimeofday(&now, nullptr);
+            long nanos = now.tv_usec * 1000L + PDB_LOG_FLUSH_INTERVAL_MS * 1000000L;
+            struct timespec deadline;
+            deadline.tv_sec = now.tv_sec + nanos / 1000000000L;
+            deadline.tv_nsec = nanos % 1000000000L;
+            const LockGuard guard{me->wakeLock};
+            if (!me->stopping) {
+                pthread_cond_timedwait(&me->wakeSignal, &me->wakeLock, &deadline);
+            }
+        }
+        {
+            const LockGuard guard{me->drainLock};
+            me->drainAll();
+        }
+        if (me->stopping) {
+            return nullptr;
+        }
+    }
+}
+
+void PDBAsyncLogger::wakeFlusher() {
+    const LockGuard guard{wakeLock};
+    pthread_cond_signal(&wakeSignal);
+}
+
+void PDBAsyncLogger::drainAll() {
+
+    // grab the buffers that exist right now, threads registering later are picked up next time
+    std::vector<std::shared_ptr<PDBThreadLogBuffer>> toDrain;
+    {
+        const LockGuard guard{registryLock};
+        toDrain = buffers;
+    }
+
+    std::vector<PDBLogSink*> touchedSinks;
+    bool sawRetired = false;
+    for (auto& buffer : toDrain) {
+        // a retired buffer gets no more records, so once drained it can go
+        sawRetired = sawRetired || buffer->retired;
+        buffer->records.drain([&](PDBLogRecord& record) {
+            writeRecord(record);
+            if (std::find(touchedSinks.begin(), touchedSinks.end(), record.sink) ==
+                touchedSinks.end()) {
+                touchedSinks.push_back(record.sink);
+            }
+        });
+    }
+
+    for (PDBLogSink* sink : touchedSinks) {
+        const LockGuard guard{sink->lock};
+        if (sink->file != nullptr) {
+            fflush(sink->file);
+        }
+    }
+
+    if (sawRetired) {
+        const LockGuard guard{registryLock};
+        buffers.erase(std::remove_if(buffers.begin(),
+                                     buffers.end(),
+                                     [](const std::shared_ptr<PDBThreadLogBuffer>& buffer) {
+                                         return buffer->retired && buffer->records.isEmpty();
+                                     }),
+                      buffers.end());
+    }
+}
+
+void PDBAsyncLogger::writeRecord(PDBLogRecord& record) {
+
+    const LockGuard guard{record.sink->lock};
+    if (record.sink->file == nullptr) {
+        return;
+    }
+
+    if (record.raw) {
+        fwrite(record.message.data(), sizeof(char), record.message.size(), record.sink->file);
+        return;
+    }
+
+    // most records in a drain share the same second, so we only format it when it changes
+    if (record.time != lastTime) {
+        struct tm tstruct;
+        localtime_r(&record.time, &tstruct);
+        strftime(lastTimeString, sizeof(lastTimeString), "[%Y-%m-%d-%X] ", &tstruct);
+        lastTime = record.time;
+    }
+
+    bool hasNewLine = !record.message.empty() && record.message.back() == '\n';
+    fprintf(record.sink->file,
+            hasNewLine ? "[%lu]%s%s" : "[%lu]%s%s\n",
+            (unsigned long)record.threadId,
+            lastTimeString,
+            record.message.c_str());
+}
+
+void PDBAsyncLogger::prepareFork() {
+    // make sure nothing is pending or half written when the address space is copied
+    PDBAsyncLogger& me = getInstance();
+    pthread_mutex_lock(&me.drainLock);
+    me.drainAll();
+    pthread_mutex_lock(&me.registryLock);
+}
+
+void PDBAsyncLogger::afterForkParent() {
+    PDBAsyncLogger& me = getInstance();
+    pthread_mutex_unlock(&me.registryLock);
+    pthread_mutex_unlock(&me.drainLock);
+}
+
+void PDBAsyncLogger::afterForkChild() {
+    PDBAsyncLogger& me = getInstance();
+
+    // only the forking thread exists in the child, the others' buffers will never be filled again
+    for (auto& buffer : me.buffers) {
+        if (buffer != myLogBuffer.buffer) {
+            buffer->retired = true;
+        }
+    }
+
+    // the flusher did not survive the fork, the next record starts a new one
+    me.flusherRunning = false;
+    pthread_mutex_init(&me.wakeLock, nullptr);
+    pthread_cond_init(&me.wakeSignal, nullptr);
+    pthread_mutex_unlock(&me.registryLock);
+    pthread_mutex_unlock(&me.drainLock);
+}
+
+PDBLogLine::PDBLogLine(LogLevel level, PDBLogSink* sink) : sink(sink) {
+    if (formatStreamInUse) {
+        nestedStream = std::unique_ptr<std::ostringstream>(new std::ostringstream());
+        out = nestedStream.get();
+    } else {
+        formatStreamInUse = true;
+        myFormatStream.str("");
+        myFormatStream.clear();
+        out = &myFormatStream;
+    }
+    *out << levelTags[level];
+}
+
+PDBLogLine::~PDBLogLine() {
+    std::string message = out->str();
+    PDBAsyncLogger::getInstance().log(sink, message.data(), message.size());
+    if (nestedStream == nullptr) {
+        formatStreamInUse = false;
+    }
+}
+}
+
+#endif
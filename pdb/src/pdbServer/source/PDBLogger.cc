@@ -42,25 +42,27 @@ PDBLogger::PDBLogger(std::string fName) {
         PDB_COUT << "logs folder created." << std::endl;
     }
 
-    outputFile = fopen(std::string("logs/" + fName).c_str(), "a");
+    FILE* outputFile = fopen(std::string("logs/" + fName).c_str(), "a");
     if (outputFile == nullptr) {
         std::cout << "Unable to open logging file.\n";
         perror(nullptr);
         exit(-1);
     }
 
-    pthread_mutex_init(&fileLock, nullptr);
+    sink = std::unique_ptr<PDBLogSink>(new PDBLogSink(outputFile));
     loglevel = WARN;
     this->enabled = true;
 }
 
 void PDBLogger::open(std::string fName) {
-    const LockGuard guard{fileLock};
-    if (outputFile != nullptr) {
-        fclose(outputFile);
+    // everything logged so far belongs to the old file
+    PDBAsyncLogger::getInstance().flush();
+    const LockGuard guard{sink->lock};
+    if (sink->file != nullptr) {
+        fclose(sink->file);
     }
-    outputFile = fopen((std::string("logs/") + fName).c_str(), "a");
-    if (outputFile == nullptr) {
+    sink->file = fopen((std::string("logs/") + fName).c_str(), "a");
+    if (sink->file == nullptr) {
         std::cout << "Unable to open logging file.\n";
         perror(nullptr);
         exit(-1);
@@ -74,10 +76,14 @@ void PDBLogger::open(std::string fName) {
 
 PDBLogger::~PDBLogger() {
 
-    if (outputFile != nullptr)
-        fclose(outputFile);
-
-    pthread_mutex_destroy(&fileLock);
+    // write out what is still queued for us, then close the file under the sink lock so that
+    // the flusher is never in the middle of a write to it
+    PDBAsyncLogger::getInstance().unregisterSink(sink.get());
+    const LockGuard guard{sink->lock};
+    if (sink->file != nullptr) {
+        fclose(sink->file);
+        sink->file = nullptr;
+    }
 }
 
 // void PDBLogger::writeLn(std :: string writeMe) {
@@ -166,33 +172,14 @@ void PDBLogger::fatal(std::string writeMe) {
 }
 
 
-// Added date/time to the logger
+// the date/time and thread id are added by the asynchronous logger when the line is written
 void PDBLogger::writeLn(std::string writeMe) {
 
     if (!this->enabled) {
         return;
     }
 
-    const LockGuard guard{fileLock};
-
-    // get the current time and date
-    time_t now = time(0);
-    struct tm tstruct;
-    char buf[80];
-    tstruct = *localtime(&now);
-    strftime(buf, sizeof(buf), "[%Y-%m-%d-%X] ", &tstruct);
-
-    // add date and time to the log
-    writeMe = buf + writeMe;
-
-    // JiaNote: to get thread id for debugging
-    pthread_t threadId = pthread_self();
-    if (writeMe[writeMe.length() - 1] != '\n') {
-        fprintf(outputFile, "[%lu]%s\n", threadId, writeMe.c_str());
-    } else {
-        fprintf(outputFile, "[%lu]%s", threadId, writeMe.c_str());
-    }
-    fflush(outputFile);
+    PDBAsyncLogger::getInstance().log(sink.get(), writeMe.data(), writeMe.size());
 }
 
 
@@ -200,8 +187,7 @@ void PDBLogger::write(char* data, unsigned int length) {
     if (!this->enabled) {
         return;
     }
-    const LockGuard guard{fileLock};
-    fwrite(data, sizeof(char), length, outputFile);
+    PDBAsyncLogger::getInstance().log(sink.get(), data, length, true);
 }
 
 // added by Jia
@@ -0,0 +1,153 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef CHUNK_SIZE_TUNER_H
+#define CHUNK_SIZE_TUNER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// the number of bytes a batch should touch, so that it stays in the L2 cache while it goes through
+// the pipeline; this is half of a typical L2, the rest is left to the executors' own state
+#ifndef PIPELINE_TARGET_BATCH_BYTES
+#define PIPELINE_TARGET_BATCH_BYTES (256 * 1024)
+#endif
+
+// the largest chunk size the tuner will pick
+#ifndef MAX_BATCH_SIZE
+#define MAX_BATCH_SIZE 16384
+#endif
+
+// how many batches we measure before we try another chunk size
+#ifndef CHUNK_SIZE_TUNING_WINDOW
+#define CHUNK_SIZE_TUNING_WINDOW 8
+#endif
+
+namespace pdb {
+
+// this tunes the chunk size of a ComputeSource while a pipeline runs.
+//
+// The chunk size is capped so that the bytes a batch touches (its columns, the source objects and
+// whatever the executors allocate) stay within PIPELINE_TARGET_BATCH_BYTES. Below that cap we
+// hill-climb on the measured throughput: we keep growing (or shrinking) the chunk size as long as
+// tuples per second go up, and turn around with a smaller step once they go down.
+class ChunkSizeTuner {
+
+private:
+    // the chunk size we are measuring right now
+    size_t chunkSize;
+
+    // the bounds for the chunk size
+    size_t minChunkSize;
+    size_t maxChunkSize;
+
+    // the average number of bytes a tuple touches, 0 until we have measured a batch
+    double bytesPerTuple = 0;
+
+    // what we measured in the current window
+    size_t windowTuples = 0;
+    uint64_t windowNanos = 0;
+    int windowBatches = 0;
+
+    // the throughput of the last window, in tuples per nanosecond
+    double lastThroughput = 0;
+
+    // the factor we change the chunk size by, and whether we are growing it
+    double step = 2.0;
+    bool growing = true;
+
+public:
+    ChunkSizeTuner(size_t initialChunkSize, size_t minChunkSize, size_t maxChunkSize)
+        : minChunkSize(minChunkSize), maxChunkSize(std::max(minChunkSize, maxChunkSize)) {
+        chunkSize = std::min(std::max(initialChunkSize, this->minChunkSize), this->maxChunkSize);
+    }
+
+    // returns the chunk size the source should use
+    size_t getChunkSize() {
+        return chunkSize;
+    }
+
+    // returns the largest chunk size that keeps a batch within PIPELINE_TARGET_BATCH_BYTES
+    size_t getCacheResidentChunkSize() {
+        if (bytesPerTuple <= 0) {
+            return maxChunkSize;
+        }
+        size_t fits = (size_t)(PIPELINE_TARGET_BATCH_BYTES / bytesPerTuple);
+        return std::min(std::max(fits, minChunkSize), maxChunkSize);
+    }
+
+    // the chunk size had to go down because a batch did not fit into memory, we never go above
+    // this again
+    void limitChunkSize(size_t limit) {
+        maxChunkSize = std::max(limit, (size_t)1);
+        minChunkSize = std::min(minChunkSize, maxChunkSize);
+        chunkSize = std::min(chunkSize, maxChunkSize);
+    }
+
+    // records a batch of numTuples tuples, that touched numBytes bytes and took nanos to process;
+    // returns true if the source should switch to a new chunk size
+    bool recordBatch(size_t numTuples, size_t numBytes, uint64_t nanos) {
+
+        if (numTuples == 0) {
+            return false;
+        }
+
+        // the bytes per tuple change with the data, so we average over the recent batches
+        double batchBytesPerTuple = (double)numBytes / numTuples;
+        if (bytesPerTuple <= 0) {
+            bytesPerTuple = batchBytesPerTuple;
+        } else {
+            bytesPerTuple = 0.75 * bytesPerTuple + 0.25 * batchBytesPerTuple;
+        }
+
+        windowTuples += numTuples;
+        windowNanos += nanos;
+        if (++windowBatches < CHUNK_SIZE_TUNING_WINDOW) {
+            return false;
+        }
+
+        // if the last move made us slower, we go back the other way, in smaller steps
+        double throughput = (double)windowTuples / std::max(windowNanos, (uint64_t)1);
+        if (lastThroughput > 0 && throughput < lastThroughput) {
+            growing = !growing;
+            step = std::max(1.125, std::sqrt(step));
+        }
+        lastThroughput = throughput;
+        windowTuples = 0;
+        windowNanos = 0;
+        windowBatches = 0;
+
+        // move, but never beyond what fits into the cache
+        size_t upper = getCacheResidentChunkSize();
+        size_t next = growing ? (size_t)(chunkSize * step) : (size_t)(chunkSize / step);
+        next = std::min(std::max(next, minChunkSize), upper);
+
+        // if we are stuck at a bound, we will try the other direction next time
+        if (next == chunkSize) {
+            growing = !growing;
+            return false;
+        }
+        chunkSize = next;
+        return true;
+    }
+};
+}
+
+#endif
@@ -38,6 +38,16 @@ public:
     // JiaNote: to enable auto-tuning of batch size in case of failure.
     virtual void setChunkSize(size_t chunkSize) = 0;
 
+    // returns the number of tuples that go into a chunk, or 0 if the source can not tell
+    virtual size_t getChunkSize() {
+        return 0;
+    }
+
+    // returns how many bytes of its input the source reads per tuple, besides the tuple set itself
+    virtual size_t getBytesPerTuple() {
+        return 0;
+    }
+
     virtual ~ComputeSource() {}
 };
 }
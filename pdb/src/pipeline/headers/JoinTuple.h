@@ -595,6 +595,10 @@ public:
         this->chunkSize = chunkSize;
     }
 
+    size_t getChunkSize() override {
+        return this->chunkSize;
+    }
+
     // returns the next tuple set to process, or nullptr if there is not one to process
     TupleSetPtr getNextTupleSet() override {
 
@@ -59,6 +59,10 @@ public:
         this->chunkSize = chunkSize;
     }
 
+    size_t getChunkSize() override {
+        return this->chunkSize;
+    }
+
 
     // returns the next tuple set to process, or nullptr if there is not one to process
     TupleSetPtr getNextTupleSet() override {
@@ -98,6 +102,10 @@ public:
             }
         }
 
+        // the chunk size may have shrunk since the column was filled up last time
+        if ((int)chunkSize < limit) {
+            inputColumn.resize(chunkSize);
+        }
         return output;
     }
 
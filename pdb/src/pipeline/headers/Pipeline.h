@@ -21,8 +21,12 @@
 
 #include "ComputeSource.h"
 #include "ComputeSink.h"
+#include "ChunkSizeTuner.h"
+#include "QueryFailure.h"
 #include "UseTemporaryAllocationBlock.h"
 #include "Handle.h"
+#include <chrono>
+#include <memory>
 #include <queue>
 
 #ifndef MIN_BATCH_SIZE
@@ -41,6 +45,9 @@ struct MemoryHolder {
     // his memory
     void* location;
 
+    // and its size
+    size_t numBytes;
+
     // the iteration where he was last written...
     // we use this beause we canot delete
     int iteration;
@@ -53,6 +60,7 @@ struct MemoryHolder {
 
     MemoryHolder(std::pair<void*, size_t> buildMe) {
         location = buildMe.first;
+        numBytes = buildMe.second;
         makeObjectAllocatorBlock(location, buildMe.second, true);
         outputSink = nullptr;
     }
@@ -90,6 +98,35 @@ private:
     // and here is all of the pages we've not yet written back
     std::queue<MemoryHolderPtr> unwrittenPages;
 
+    // whether we tune the chunk size of the source while we run
+    bool adaptiveChunkSize = true;
+
+    // the chunk size a source gets when none was set for it; only a source with this chunk size is
+    // tuned to larger chunks, any other chunk size was chosen on purpose and is never exceeded
+    size_t defaultChunkSize = 0;
+
+    // the number of output pages that we have filled, and the sum of the fractions of those pages
+    // that hold live data
+    size_t numOutputPages = 0;
+    double sumOfOutputPageUtilization = 0;
+
+    // retires the current page, which has to be the current allocation block
+    void retirePage(MemoryHolderPtr& page, int iteration) {
+
+        // the bytes that were never used and those that were freed again, e.g. the old copies
+        // of a vector that has grown, are both wasted
+        if (page->outputSink != nullptr && page->numBytes > 0) {
+            size_t bytesAvailable = getBytesAvailableInCurrentAllocatorBlock();
+            if (bytesAvailable > page->numBytes) {
+                bytesAvailable = page->numBytes;
+            }
+            sumOfOutputPageUtilization += 1.0 - (double)bytesAvailable / page->numBytes;
+            numOutputPages++;
+        }
+        page->setIteration(iteration);
+        unwrittenPages.push(page);
+    }
+
 public:
     // the first argument is a function to call that gets a new output page...
     // the second arguement is a function to call that deals with a full output page
@@ -110,6 +147,23 @@ public:
         pipeline.push_back(addMe);
     }
 
+    // if true, the chunk size of the source is tuned from the measured batches, see ChunkSizeTuner;
+    // it only grows beyond its initial value if that is defaultChunkSize
+    void setAdaptiveChunkSize(bool adaptiveChunkSize, size_t defaultChunkSize) {
+        this->adaptiveChunkSize = adaptiveChunkSize;
+        this->defaultChunkSize = defaultChunkSize;
+    }
+
+    // the number of output pages that were filled by run ()
+    size_t getNumOutputPages() {
+        return numOutputPages;
+    }
+
+    // the average fraction of an output page that holds live data when it is written back
+    double getOutputPageUtilization() {
+        return numOutputPages == 0 ? 0 : sumOfOutputPageUtilization / numOutputPages;
+    }
+
     ~Pipeline() {
 
         // kill all of the pipeline stages
@@ -205,16 +259,37 @@ public:
         // the iteration counter
         int iteration = 0;
 
+        // tunes the chunk size of the source, if it tells us what it is; a chunk size that was set
+        // on purpose, like the small batches of a join that multiply their tuples, is an upper bound
+        std::unique_ptr<ChunkSizeTuner> tuner;
+        size_t initialChunkSize = dataSource->getChunkSize();
+        if (adaptiveChunkSize && initialChunkSize > 0) {
+            size_t minChunkSize = std::min((size_t)MIN_BATCH_SIZE, initialChunkSize);
+            size_t maxChunkSize =
+                initialChunkSize == defaultChunkSize ? MAX_BATCH_SIZE : initialChunkSize;
+            if (minChunkSize < maxChunkSize) {
+                tuner = std::unique_ptr<ChunkSizeTuner>(
+                    new ChunkSizeTuner(initialChunkSize, minChunkSize, maxChunkSize));
+                dataSource->setChunkSize(tuner->getChunkSize());
+            }
+        }
+
         // while there is still data
         // Jia Note: dataSource->getNextTupleSet() can throw exception for certain data sources like
         // MapTupleSetIterator
         while (true) {
 
+            // we only measure batches that did not run out of memory, since those that did
+            // spent their time on other things and their allocations span several pages
+            auto batchBegin = std::chrono::steady_clock::now();
+            size_t bytesAvailable = getBytesAvailableInCurrentAllocatorBlock();
+            bool measurable = true;
+
             try {
                 curChunk = dataSource->getNextTupleSet();
             } catch (NotEnoughSpace& n) {
-                myRAM->setIteration(iteration);
-                unwrittenPages.push(myRAM);
+                measurable = false;
+                retirePage(myRAM, iteration);
                 myRAM = std::make_shared<MemoryHolder>(getNewPage());
                 if (myRAM->location == nullptr) {
                     std::cout << "ERROR: insufficient memory in heap" << std::endl;
@@ -230,11 +305,17 @@ public:
                     // consider to reduce batch size" << std :: endl;
                     std::cout << "batch size tuned to be " << MIN_BATCH_SIZE << std::endl;
                     dataSource->setChunkSize(MIN_BATCH_SIZE);
+                    if (tuner != nullptr) {
+                        tuner->limitChunkSize(MIN_BATCH_SIZE);
+                    }
                     try {
                         curChunk = dataSource->getNextTupleSet();
                     } catch (NotEnoughSpace& n) {
                         std::cout << "batch size tuned to be 1" << std::endl;
                         dataSource->setChunkSize(1);
+                        if (tuner != nullptr) {
+                            tuner->limitChunkSize(1);
+                        }
                         try {
                             curChunk = dataSource->getNextTupleSet();
                         } catch (NotEnoughSpace& n) {
@@ -247,16 +328,30 @@ public:
             if (curChunk == nullptr) {
                 break;
             }
+
+            // the tuples in this batch, and the bytes of the source that they take up
+            int numTuples = curChunk->getNumRows(0);
+            size_t batchBytes = 0;
+            if (numTuples > 0) {
+                batchBytes =
+                    numTuples * (curChunk->getBytesPerRow() + dataSource->getBytesPerTuple());
+            }
+
             // go through all of the pipeline stages
             for (ComputeExecutorPtr& q : pipeline) {
 
                 try {
                     curChunk = q->process(curChunk);
 
+                } catch (QueryFailure& f) {
+                    // the batch can not be processed, so the query fails; we give back the page,
+                    // and the stage reports why
+                    retirePage(myRAM, iteration);
+                    throw;
                 } catch (NotEnoughSpace& n) {
                     // and get a new page
-                    myRAM->setIteration(iteration);
-                    unwrittenPages.push(myRAM);
+                    measurable = false;
+                    retirePage(myRAM, iteration);
                     myRAM = std::make_shared<MemoryHolder>(getNewPage());
                     if (myRAM->location == nullptr) {
                         std::cout << "ERROR: insufficient memory in heap" << std::endl;
@@ -288,9 +383,9 @@ public:
 
                 // again, we ran out of RAM here, so write back the page and then create a new
                 // output page
+                measurable = false;
                 std::cout << "pipeline runs out of RAM" << std::endl;
-                myRAM->setIteration(iteration);
-                unwrittenPages.push(myRAM);
+                retirePage(myRAM, iteration);
                 myRAM = std::make_shared<MemoryHolder>(getNewPage());
 
                 // and again, try to write back the output
@@ -298,16 +393,32 @@ public:
                 dataSink->writeOut(curChunk, myRAM->outputSink);
             }
 
+            // the batch touched its source, its final columns and whatever was allocated for it
+            if (tuner != nullptr && measurable && numTuples > 0) {
+                int numOutputTuples = curChunk->getNumRows(0);
+                if (numOutputTuples > 0) {
+                    batchBytes += numOutputTuples * curChunk->getBytesPerRow();
+                }
+                size_t bytesLeft = getBytesAvailableInCurrentAllocatorBlock();
+                if (bytesLeft < bytesAvailable) {
+                    batchBytes += bytesAvailable - bytesLeft;
+                }
+                uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now() - batchBegin)
+                                     .count();
+                if (tuner->recordBatch(numTuples, batchBytes, nanos)) {
+                    PDB_COUT << "chunk size tuned to be " << tuner->getChunkSize() << std::endl;
+                    dataSource->setChunkSize(tuner->getChunkSize());
+                }
+            }
+
             // lastly, write back all of the output pages
             iteration++;
             cleanPages(iteration);
         }
 
-        // set the iteration
-        myRAM->setIteration(iteration);
-
-        // and remember the page
-        unwrittenPages.push(myRAM);
+        // set the iteration and remember the page
+        retirePage(myRAM, iteration);
     }
 };
 
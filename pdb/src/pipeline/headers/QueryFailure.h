@@ -0,0 +1,38 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef QUERY_FAILURE_H
+#define QUERY_FAILURE_H
+
+#include <stdexcept>
+#include <string>
+
+namespace pdb {
+
+// thrown by the code that runs inside a pipeline, e.g. a lambda, when the query can not go on
+// with the data it was given, e.g. a key the lambda has no code for; the pipeline gives back its
+// pages and the stage fails the query with what () as the reason, rather than producing a wrong
+// result
+class QueryFailure : public std::runtime_error {
+
+public:
+    explicit QueryFailure(const std::string& errMsg) : std::runtime_error(errMsg) {}
+};
+}
+
+#endif
@@ -22,6 +22,9 @@
 #include "Handle.h"
 #include "PDBVector.h"
 #include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 namespace pdb {
 
@@ -64,80 +67,289 @@ auto tryToObtainPointer(InputType& arg) -> typename std::enable_if_t<!B, InputTy
 class TupleSet;
 typedef std::shared_ptr<TupleSet> TupleSetPtr;
 
+// the most buffers of one column type that a column arena keeps around
+#ifndef PDB_COLUMN_ARENA_MAX_BUFFERS
+#define PDB_COLUMN_ARENA_MAX_BUFFERS 16
+#endif
+
+// column buffers that grew beyond this many rows are freed rather than kept in a column arena
+#ifndef PDB_COLUMN_ARENA_MAX_ROWS
+#define PDB_COLUMN_ARENA_MAX_ROWS 65536
+#endif
+
 // this structure contains type-specific information that will allow us to properly delete and/or
-// fliter
-// a column
+// fliter a column; there is a single instance per column type, see getMaintenanceFuncs ()
 struct MaintenanceFuncs {
 
+    // this creates an empty column
+    void* (*create)();
+
     // this is a deleter for a particular column, stored as a void*
-    std::function<void(void*)> deleter;
+    void (*deleter)(void*);
+
+    // this empties a column, but keeps its memory
+    void (*clear)(void*);
+
+    // this gets the number of rows a column can hold without growing
+    size_t (*getCapacity)(void*);
 
-    // this is a filter function for a particular column
-    std::function<void*(void*, std::vector<bool>&)> filter;
+    // this is a filter function for a particular column, it writes the rows to keep into the
+    // second (empty) column
+    void (*filter)(void*, std::vector<bool>&, void*);
 
-    // this replicates instances of a column to run a join
-    std::function<void*(void*, std::vector<uint32_t>&)> replicate;
+    // this replicates instances of a column to run a join, into the second (empty) column
+    void (*replicate)(void*, std::vector<uint32_t>&, void*);
 
     // JiaNote: this gets count for a particular column
-    std::function<size_t(void*)> getCount;
+    size_t (*getCount)(void*);
 
     // this is a function that creates and returns a pdb :: Vector for a column
-    std::function<Handle<Vector<Handle<Object>>>()> createPDBVector;
+    Handle<Vector<Handle<Object>>> (*createPDBVector)();
 
     // this function writes out the column to a pdb :: Vector
-    std::function<void(Handle<Vector<Handle<Object>>>&, void*, size_t&)> writeToVector;
+    void (*writeToVector)(Handle<Vector<Handle<Object>>>&, void*, size_t&);
 
     // this is the name of the type that we contain
     std::string typeContained;
 
-    // tells us if we need to delete
-    bool mustDelete;
-
     // tells us the serialized size of an object in this column
     size_t serializedSize;
+};
+
+// fills in the maintenance functions for a column type
+template <typename ColType>
+MaintenanceFuncs makeMaintenanceFuncs() {
+
+    MaintenanceFuncs funcs;
+
+    funcs.create = []() { return (void*)new std::vector<ColType>; };
+
+    // the deleter frees the column, correctly taking into account the type of the column...
+    funcs.deleter = [](void* deleteMe) {
+        std::vector<ColType>* killMe = (std::vector<ColType>*)deleteMe;
+        delete killMe;
+    };
+
+    funcs.clear = [](void* clearMe) { ((std::vector<ColType>*)clearMe)->clear(); };
+
+    funcs.getCapacity = [](void* measureMe) {
+        return ((std::vector<ColType>*)measureMe)->capacity();
+    };
+
+    // and the filter filters the column, again correctly taking into account the type of the column
+    funcs.filter = [](void* filter, std::vector<bool>& whichAreValid, void* output) {
+        std::vector<ColType>& filterMe = *((std::vector<ColType>*)filter);
+
+        // count the number of rows that need to be retained
+        int counter = 0;
+        for (auto a : whichAreValid)
+            if (a)
+                counter++;
+
+        // copy the ones that need to be retained over
+        std::vector<ColType>& newVec = *((std::vector<ColType>*)output);
+        newVec.resize(counter);
+        counter = 0;
+        for (int i = 0; i < filterMe.size(); i++) {
+            if (whichAreValid[i])
+                newVec[counter++] = filterMe[i];
+        }
+    };
+
+    funcs.replicate = [](void* replicate, std::vector<uint32_t>& timesToReplicate, void* output) {
+
+        std::vector<ColType>& replicateMe = *((std::vector<ColType>*)replicate);
+
+        // count the number of rows that need to be retained
+        int counter = 0;
+        for (auto& a : timesToReplicate)
+            counter += a;
+
+        // copy the ones that need to be retained over
+        std::vector<ColType>& newVec = *((std::vector<ColType>*)output);
+        newVec.resize(counter);
+        counter = 0;
+        for (int i = 0; i < timesToReplicate.size(); i++) {
+            for (int j = 0; j < timesToReplicate[i]; j++) {
+                newVec[counter] = replicateMe[i];
+                counter++;
+            }
+        }
+    };
+
+    // JiaNote: add getCount to get number of rows for a particular column at runtime
+    funcs.getCount = [](void* countMe) {
+        std::vector<ColType>* toCountRowsOfMe = (std::vector<ColType>*)countMe;
+        return toCountRowsOfMe->size();
+    };
+
+    // this is responsible for writing this column to an output vector
+    if (std::is_base_of<PtrBase, ColType>::value)
+        funcs.writeToVector =
+            [](Handle<Vector<Handle<Object>>>& writeToMe, void* writeMe, size_t& lastWritten) {
+                std::vector<Ptr<Handle<Object>>>& writeMeOut =
+                    *((std::vector<Ptr<Handle<Object>>>*)writeMe);
+                Vector<Handle<Object>>& outputToMe = *writeToMe;
+                for (; lastWritten < writeMeOut.size(); lastWritten++) {
+                    Ptr<Handle<Object>> temp = writeMeOut[lastWritten];
+                    outputToMe.push_back(*(writeMeOut[lastWritten]));
+                }
+            };
+    else
+        funcs.writeToVector =
+            [](Handle<Vector<Handle<Object>>>& writeToMe, void* writeMe, size_t& lastWritten) {
+                std::vector<Handle<Object>>& writeMeOut = *((std::vector<Handle<Object>>*)writeMe);
+                Vector<Handle<Object>>& outputToMe = *writeToMe;
+                for (; lastWritten < writeMeOut.size(); lastWritten++) {
+                    outputToMe.push_back(writeMeOut[lastWritten]);
+                }
+            };
+
+    // finally, this creates a pdb :: Vector to hold the column
+    funcs.createPDBVector = []() {
+        Handle<Vector<Handle<ColType>>> returnVal = makeObject<Vector<Handle<ColType>>>();
+        return unsafeCast<Vector<Handle<Object>>>(returnVal);
+    };
+
+    funcs.typeContained = getTypeName<ColType>();
+    funcs.serializedSize = getSerializedSize<std::is_base_of<PtrBase, ColType>::value, ColType>();
+    return funcs;
+}
+
+// returns the maintenance functions for a column type, they are created the first time we see it
+template <typename ColType>
+const MaintenanceFuncs* getMaintenanceFuncs() {
+    static const MaintenanceFuncs funcs = makeMaintenanceFuncs<ColType>();
+    return &funcs;
+}
+
+// this recycles the column buffers of the tuple sets that one thread processes: a column that is
+// not needed anymore is emptied and kept, and the next column of the same type reuses it, so that
+// a warmed up pipeline does not allocate columns for each batch
+class ColumnArena {
+
+private:
+    // the free buffers of one column type
+    struct FreeList {
+        const MaintenanceFuncs* funcs;
+        std::vector<void*> buffers;
+    };
+
+    // a pipeline only has a few column types, so we simply search this
+    std::vector<FreeList> freeLists;
+
+    FreeList& getFreeList(const MaintenanceFuncs* funcs) {
+        for (auto& freeList : freeLists) {
+            if (freeList.funcs == funcs) {
+                return freeList;
+            }
+        }
+        freeLists.push_back(FreeList{funcs, std::vector<void*>()});
+        return freeLists.back();
+    }
+
+public:
+    // returns the arena of the calling thread
+    static ColumnArena& getArena() {
+        static thread_local ColumnArena arena;
+        return arena;
+    }
+
+    // returns an empty column of the type described by funcs
+    void* acquire(const MaintenanceFuncs* funcs) {
+        FreeList& freeList = getFreeList(funcs);
+        if (freeList.buffers.empty()) {
+            return funcs->create();
+        }
+        void* column = freeList.buffers.back();
+        freeList.buffers.pop_back();
+        return column;
+    }
+
+    // gives back a column that is not needed anymore
+    void release(const MaintenanceFuncs* funcs, void* column) {
+        FreeList& freeList = getFreeList(funcs);
+        if (freeList.buffers.size() >= PDB_COLUMN_ARENA_MAX_BUFFERS ||
+            funcs->getCapacity(column) > PDB_COLUMN_ARENA_MAX_ROWS) {
+            funcs->deleter(column);
+            return;
+        }
+        funcs->clear(column);
+        freeList.buffers.push_back(column);
+    }
+
+    // returns how many emptied columns of the type described by funcs are kept right now
+    size_t getNumBuffers(const MaintenanceFuncs* funcs) {
+        return getFreeList(funcs).buffers.size();
+    }
+
+    ~ColumnArena() {
+        for (auto& freeList : freeLists) {
+            for (void* column : freeList.buffers) {
+                freeList.funcs->deleter(column);
+            }
+        }
+    }
+};
+
+// one column of a tuple set
+struct TupleSetColumn {
+
+    // the column, a std :: vector of the column's type
+    void* data = nullptr;
+
+    // the functions for the column's type, nullptr if there is no column
+    const MaintenanceFuncs* funcs = nullptr;
+
+    // tells us if we need to delete
+    bool mustDelete = false;
 
     // the last value that we wrote if we are writing out this column
     size_t lastWritten = 0;
-
-    // empty constructor
-    MaintenanceFuncs() {}
-
-    // fill all of the fields
-    MaintenanceFuncs(
-        std::function<void(void*)> deleter,
-        std::function<void*(void*, std::vector<bool>&)> filter,
-        std::function<void*(void*, std::vector<uint32_t>&)> replicate,
-        std::function<size_t(void*)> getCount,
-        std::function<Handle<Vector<Handle<Object>>>()> createPDBVector,
-        std::function<void(Handle<Vector<Handle<Object>>>&, void*, size_t&)> writeToVector,
-        bool mustDelete,
-        std::string typeContained,
-        size_t serializedSize)
-        : deleter(deleter),
-          filter(filter),
-          replicate(replicate),
-          getCount(getCount),
-          createPDBVector(createPDBVector),
-          writeToVector(writeToVector),
-          typeContained(typeContained),
-          mustDelete(mustDelete),
-          serializedSize(serializedSize) {}
 };
 
 // this is the basic type that it pushed through the system during query processing
 class TupleSet {
 
 private:
-    // the key of this map is an integer (the identifier of the column)
-    // the value is a pair; the first is a pointer to the column, and the second is a pair of
-    // lambdas.  The first is a deleter (which frees the column) and the second is a condenser
-    // (that filters rows from the column)
-    std::map<int, std::pair<void*, MaintenanceFuncs>> columns;
+    // the columns, indexed by the identifier of the column
+    std::vector<TupleSetColumn> columns;
+
+    // the number of columns that are present
+    int numColumns = 0;
+
+    // returns the slot for the specified column, making room for it if needed
+    TupleSetColumn& getSlot(int whichColumn) {
+        if (whichColumn >= columns.size()) {
+            columns.resize(whichColumn + 1);
+        }
+        return columns[whichColumn];
+    }
+
+    // frees the column in the slot if we own it, so that it can be replaced
+    void releaseColumn(TupleSetColumn& column) {
+        if (column.funcs != nullptr && column.mustDelete) {
+            ColumnArena::getArena().release(column.funcs, column.data);
+        }
+    }
+
+    // puts a column into a slot, the old one must have been released
+    void setColumn(TupleSetColumn& column,
+                   void* data,
+                   const MaintenanceFuncs* funcs,
+                   bool mustDelete,
+                   size_t lastWritten) {
+        numColumns += (funcs != nullptr) - (column.funcs != nullptr);
+        column.data = data;
+        column.funcs = funcs;
+        column.mustDelete = mustDelete;
+        column.lastWritten = lastWritten;
+    }
 
 public:
     // get the number of columns in this TupleSet
     int getNumColumns() {
-        return columns.size();
+        return numColumns;
     }
 
     /* TODO: this will be needed to be able to do joins!!!
@@ -155,8 +367,8 @@ public:
     // this can be used at a later time to re-constitute the tuple set
     std::vector<std::string> getTypeNames() {
         std::vector<std::string> output;
-        for (int i = 0; columns.count(i) != 0; i++) {
-            output.push_back(columns[i].second.typeContained);
+        for (int i = 0; hasColumn(i); i++) {
+            output.push_back(columns[i].funcs->typeContained);
         }
         return output;
     }
@@ -177,11 +389,11 @@ public:
     // return a specified column
     template <typename ColType>
     std::vector<ColType>& getColumn(int whichColumn) {
-        if (columns.count(whichColumn) == 0) {
+        if (!hasColumn(whichColumn)) {
             std::cout << "This is bad. Tried to get column " << whichColumn
                       << " but could not find it.\n";
         }
-        return *((std::vector<ColType>*)columns[whichColumn].first);
+        return *((std::vector<ColType>*)getSlot(whichColumn).data);
     }
 
     // writes out a specified column... the boolean argument is true when we want to start from
@@ -190,37 +402,47 @@ public:
     void writeOutColumn(int whichColumn,
                         Handle<Vector<Handle<Object>>>& writeToMe,
                         bool startFromScratch) {
-        if (columns.count(whichColumn) == 0) {
+        if (!hasColumn(whichColumn)) {
             std::cout << "This is bad. Tried to write out column " << whichColumn
                       << " but could not find it.\n";
         }
-        auto& which = columns[whichColumn];
+        auto& which = getSlot(whichColumn);
 
         // if we we need to start over, then do do
         if (startFromScratch)
-            which.second.lastWritten = 0;
+            which.lastWritten = 0;
 
-        which.second.writeToVector(writeToMe, which.first, which.second.lastWritten);
+        which.funcs->writeToVector(writeToMe, which.data, which.lastWritten);
     }
 
     // use the specified column to build pdb :: Vector of the correct type to hold the output
     // Note: this had better be a Vector <Handle <Something>> or we are going to have problems!!
     Handle<Vector<Handle<Object>>> getOutputVector(int whichColToOutput) {
-        return columns[whichColToOutput].second.createPDBVector();
+        return getSlot(whichColToOutput).funcs->createPDBVector();
+    }
+
+    // gets the number of bytes one row takes up in the columns of this tuple set
+    size_t getBytesPerRow() {
+        size_t bytes = 0;
+        for (auto& column : columns) {
+            if (column.funcs != nullptr) {
+                bytes += column.funcs->serializedSize;
+            }
+        }
+        return bytes;
     }
 
     // see if we have the specified column
     bool hasColumn(int whichColumn) {
-        return columns.count(whichColumn) != 0;
+        return whichColumn >= 0 && whichColumn < columns.size() &&
+            columns[whichColumn].funcs != nullptr;
     }
 
     ~TupleSet() {
 
         // delete all of the columns
         for (auto& a : columns) {
-            auto& res = a.second;
-            if (res.second.mustDelete)
-                res.second.deleter(res.first);
+            releaseColumn(a);
         }
     }
 
@@ -232,18 +454,14 @@ public:
 
             // filter the column, getting a new version
             auto& value = columns[whichColToFilter];
-            auto res = value.second.filter(value.first, usingMe);
+            void* res = ColumnArena::getArena().acquire(value.funcs);
+            value.funcs->filter(value.data, usingMe, res);
 
             // delete the old one, if necessary
-            if (value.second.mustDelete) {
-                value.second.deleter(value.first);
-            }
+            releaseColumn(value);
 
-            // record the new column
-            value.first = res;
-
-            // remember that we need to delete it
-            value.second.mustDelete = true;
+            // record the new column, and remember that we need to delete it
+            setColumn(value, res, value.funcs, true, value.lastWritten);
             return;
         }
 
@@ -257,27 +475,17 @@ public:
                    int whichColToCopyTo,
                    std::vector<uint32_t>& replications) {
 
-        // kill the old one so we don't have a memory leak
-        if (hasColumn(whichColToCopyTo)) {
-            // delete the existing column, if necessary
-            auto& value = columns[whichColToCopyTo];
-            if (value.second.mustDelete) {
-                value.second.deleter(value.first);
-            }
-        }
-
-        // create a copy of the maintenance funcs
-        auto& value = fromMe->columns[whichColInFromMe];
-        MaintenanceFuncs temp = value.second;
-
-        // remember that this is a deep copy... so we need to delete
-        temp.mustDelete = true;
-
         // and go ahead and replicate the column
-        void* newCol = temp.replicate(value.first, replications);
+        TupleSetColumn value = fromMe->getSlot(whichColInFromMe);
+        void* newCol = ColumnArena::getArena().acquire(value.funcs);
+        value.funcs->replicate(value.data, replications, newCol);
 
-        // and go ahead and remember the column
-        columns[whichColToCopyTo] = std::make_pair(newCol, temp);
+        // kill the old one so we don't have a memory leak
+        auto& target = getSlot(whichColToCopyTo);
+        releaseColumn(target);
+
+        // and go ahead and remember the column; this is a deep copy... so we need to delete
+        setColumn(target, newCol, value.funcs, true, value.lastWritten);
     }
 
     // JiaNote: to get number of rows in a particular column
@@ -286,32 +494,23 @@ public:
         if (hasColumn(whichColumn) == false) {
             return -1;
         }
-        return columns[whichColumn].second.getCount(columns[whichColumn].first);
+        return columns[whichColumn].funcs->getCount(columns[whichColumn].data);
     }
 
 
     // copies a column from another TupleSet, deleting the target, if necessary
     void copyColumn(TupleSetPtr fromMe, int whichColInFromMe, int whichColToCopyTo) {
 
-        // kill the old one so we don't have a memory leak
-        if (hasColumn(whichColToCopyTo)) {
+        TupleSetColumn value = fromMe->getSlot(whichColInFromMe);
 
-            // delete the existing column, if necessary
-            auto& value = columns[whichColToCopyTo];
-            if (value.second.mustDelete) {
-                value.second.deleter(value.first);
-            }
+        // kill the old one so we don't have a memory leak
+        auto& target = getSlot(whichColToCopyTo);
+        if (target.data != value.data) {
+            releaseColumn(target);
         }
 
-        // create a copy of the maintenance funcs
-        auto& value = fromMe->columns[whichColInFromMe];
-        MaintenanceFuncs temp = value.second;
-
-        // remember that this is a shallow copy... no need to delete
-        temp.mustDelete = false;
-
-        // and go ahead and remember the column
-        columns[whichColToCopyTo] = std::make_pair(value.first, temp);
+        // and go ahead and remember the column; this is a shallow copy... no need to delete
+        setColumn(target, value.data, value.funcs, false, value.lastWritten);
     }
 
     // creates a new column, adding it to the tuple set
@@ -319,117 +518,12 @@ public:
     void addColumn(int where, std::vector<ColType>* addMe, bool needToDelete) {
 
         // delete the old one, if needed
-        if (columns.count(where) != 0) {
-            auto& value = columns[where];
-            if (value.second.mustDelete) {
-                value.second.deleter(value.first);
-            }
+        auto& target = getSlot(where);
+        if (target.data != addMe) {
+            releaseColumn(target);
         }
 
-        // now, add the new column... this reqires creating three lambdas to deal with
-        // column maintenance.  The first lamba deletes the column, correctly taking into
-        // account the type of the column...
-        std::function<void(void*)> deleter;
-        deleter = [](void* deleteMe) {
-            std::vector<ColType>* killMe = (std::vector<ColType>*)deleteMe;
-            delete killMe;
-        };
-
-        // and the second lambda filters the column, again correctly taking into account
-        // the type of the column
-        std::function<void*(void*, std::vector<bool>&)> filter;
-        filter = [](void* filter, std::vector<bool>& whichAreValid) {
-            std::vector<ColType>& filterMe = *((std::vector<ColType>*)filter);
-
-            // count the number of rows that need to be retained
-            int counter = 0;
-            for (auto a : whichAreValid)
-                if (a)
-                    counter++;
-
-            // copy the ones that need to be retained over
-            std::vector<ColType>* newVec = new std::vector<ColType>(counter);
-            counter = 0;
-            for (int i = 0; i < filterMe.size(); i++) {
-                if (whichAreValid[i])
-                    (*newVec)[counter++] = filterMe[i];
-            }
-
-            // and return the result
-            return (void*)newVec;
-        };
-        std::function<void*(void*, std::vector<uint32_t>&)> replicate;
-        replicate = [](void* replicate, std::vector<uint32_t>& timesToReplicate) {
-
-            std::vector<ColType>& replicateMe = *((std::vector<ColType>*)replicate);
-
-            // count the number of rows that need to be retained
-            int counter = 0;
-            for (auto& a : timesToReplicate)
-                counter += a;
-
-            // copy the ones that need to be retained over
-            std::vector<ColType>* newVec = new std::vector<ColType>(counter);
-            counter = 0;
-            for (int i = 0; i < timesToReplicate.size(); i++) {
-                for (int j = 0; j < timesToReplicate[i]; j++) {
-                    (*newVec)[counter] = replicateMe[i];
-                    counter++;
-                }
-            }
-
-            // and return the result
-            return (void*)newVec;
-        };
-        // JiaNote: add getCount to get number of rows for a particular column at runtime
-        std::function<size_t(void*)> getCount;
-        getCount = [](void* countMe) {
-            std::vector<ColType>* toCountRowsOfMe = (std::vector<ColType>*)countMe;
-            return toCountRowsOfMe->size();
-        };
-
-        // the third lambda is responsible for writing this column to an output vector
-        std::function<void(Handle<Vector<Handle<Object>>>&, void*, size_t&)> writeToVector;
-        if (std::is_base_of<PtrBase, ColType>::value)
-            writeToVector =
-                [](Handle<Vector<Handle<Object>>>& writeToMe, void* writeMe, size_t& lastWritten) {
-                    std::vector<Ptr<Handle<Object>>>& writeMeOut =
-                        *((std::vector<Ptr<Handle<Object>>>*)writeMe);
-                    Vector<Handle<Object>>& outputToMe = *writeToMe;
-                    for (; lastWritten < writeMeOut.size(); lastWritten++) {
-                        Ptr<Handle<Object>> temp = writeMeOut[lastWritten];
-                        outputToMe.push_back(*(writeMeOut[lastWritten]));
-                    }
-                };
-        else
-            writeToVector = [](
-                Handle<Vector<Handle<Object>>>& writeToMe, void* writeMe, size_t& lastWritten) {
-                std::vector<Handle<Object>>& writeMeOut = *((std::vector<Handle<Object>>*)writeMe);
-                Vector<Handle<Object>>& outputToMe = *writeToMe;
-                for (; lastWritten < writeMeOut.size(); lastWritten++) {
-                    outputToMe.push_back(writeMeOut[lastWritten]);
-                }
-            };
-
-
-        // finally, the sixth creates a pdb :: Vector to hold the column
-        std::function<Handle<Vector<Handle<Object>>>()> createPDBVector;
-        createPDBVector = []() {
-            Handle<Vector<Handle<ColType>>> returnVal = makeObject<Vector<Handle<ColType>>>();
-            return unsafeCast<Vector<Handle<Object>>>(returnVal);
-        };
-
-        MaintenanceFuncs myFuncs(
-            deleter,
-            filter,
-            replicate,
-            getCount,
-            createPDBVector,
-            writeToVector,
-            needToDelete,
-            getTypeName<ColType>(),
-            getSerializedSize<std::is_base_of<PtrBase, ColType>::value, ColType>());
-        columns[where] = std::make_pair((void*)addMe, myFuncs);
+        setColumn(target, (void*)addMe, getMaintenanceFuncs<ColType>(), needToDelete, 0);
     }
 };
 }
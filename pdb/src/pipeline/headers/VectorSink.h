@@ -64,17 +64,16 @@ public:
         std::vector<Handle<DataType>>& inputColumn =
             input->getColumn<Handle<DataType>>(whichAttToStore);
 
-        // and aggregate everyone
-        int length = inputColumn.size();
-        for (int i = 0; i < length; i++) {
-            try {
-                myVec.push_back(inputColumn[i]);
-            } catch (NotEnoughSpace& n) {
-
-                // if we got here, we need to erase all of the input that has been processed
-                inputColumn.erase(inputColumn.begin(), inputColumn.begin() + i);
-                throw n;
-            }
+        // and add everyone at once, so that the vector grows at most once per batch
+        size_t sizeBefore = myVec.size();
+        try {
+            myVec.append(inputColumn.data(), inputColumn.size());
+        } catch (NotEnoughSpace& n) {
+
+            // if we got here, we need to erase all of the input that has been processed
+            inputColumn.erase(inputColumn.begin(),
+                              inputColumn.begin() + (myVec.size() - sizeBefore));
+            throw n;
         }
     }
 
@@ -19,14 +19,18 @@
 #ifndef VECTOR_TUPLESET_ITER_H
 #define VECTOR_TUPLESET_ITER_H
 
+#include <algorithm>
+#include <stdint.h>
+
 namespace pdb {
 
 // this class iterates over an input pdb :: Vector, breaking it up into a series of TupleSet objects
 class VectorTupleSetIterator : public ComputeSource {
 
 private:
-    // function to call to get another vector to process
-    std::function<void*()> getAnotherVector;
+    // function to call to get another vector to process, it also sets the range [begin, end) of
+    // the vector that we should process
+    std::function<void*(size_t&, size_t&)> getAnotherVector;
 
     // function to call to free the vector
     std::function<void(void*)> doneWithVector;
@@ -34,9 +38,11 @@ private:
     // this is the vector to process
     Handle<Vector<Handle<Object>>> iterateOverMe;
 
-    // the pointer to the current page holding the vector, and the last page that we previously
-    // processed
-    Record<Vector<Handle<Object>>>*myRec, *lastRec;
+    // the pointer to the current page holding the vector
+    Record<Vector<Handle<Object>>>* myRec;
+
+    // the pages that we previously processed, in the order in which we got them
+    std::vector<Record<Vector<Handle<Object>>>*> lastRecs;
 
     // how many objects to put into a chunk
     size_t chunkSize;
@@ -44,9 +50,30 @@ private:
     // where we are in the chunk
     size_t pos;
 
+    // where our range of the current vector ends
+    size_t endPos;
+
     // and the tuple set we return
     TupleSetPtr output;
 
+    // gets the next vector that has something for us to process; the ones that do not are put in
+    // line to be freed. Returns false if there is no such vector
+    bool getNextVector() {
+        while (true) {
+            myRec = (Record<Vector<Handle<Object>>>*)getAnotherVector(pos, endPos);
+            if (myRec == nullptr) {
+                iterateOverMe = nullptr;
+                return false;
+            }
+            iterateOverMe = myRec->getRootObject();
+            endPos = std::min(endPos, (size_t)iterateOverMe->size());
+            if (pos < endPos) {
+                return true;
+            }
+            lastRecs.push_back(myRec);
+        }
+    }
+
 public:
     // the first param is a callback function that the iterator will call in order to obtain the
     // page holding the next vector to iterate
@@ -56,38 +83,55 @@ public:
     VectorTupleSetIterator(std::function<void*()> getAnotherVector,
                            std::function<void(void*)> doneWithVector,
                            size_t chunkSize)
+        : VectorTupleSetIterator(
+              [getAnotherVector](size_t& begin, size_t& end) -> void* {
+                  begin = 0;
+                  end = SIZE_MAX;
+                  return getAnotherVector();
+              },
+              doneWithVector,
+              chunkSize) {}
+
+    // same as above, except that we only process the range of each vector that getAnotherVector
+    // gives us; this lets several iterators split a page among themselves.  doneWithVector is
+    // called once per range, in the order in which the ranges were obtained
+    VectorTupleSetIterator(std::function<void*(size_t&, size_t&)> getAnotherVector,
+                           std::function<void(void*)> doneWithVector,
+                           size_t chunkSize)
         : getAnotherVector(getAnotherVector), doneWithVector(doneWithVector), chunkSize(chunkSize) {
 
         // create the tuple set that we'll return during iteration
         output = std::make_shared<TupleSet>();
 
         // extract the vector from the input page
-        myRec = (Record<Vector<Handle<Object>>>*)getAnotherVector();
+        if (getNextVector()) {
 
-        if (myRec != nullptr) {
-
-            iterateOverMe = myRec->getRootObject();
             PDB_COUT << "Got iterateOverMe" << std::endl;
             // create the output vector and put it into the tuple set
             std::vector<Handle<Object>>* inputColumn = new std::vector<Handle<Object>>;
             output->addColumn(0, inputColumn, true);
         } else {
 
-            iterateOverMe = nullptr;
             output = nullptr;
         }
-
-        // we are at position zero
-        pos = 0;
-
-        // and we have no data so far
-        lastRec = nullptr;
     }
 
     void setChunkSize(size_t chunkSize) override {
         this->chunkSize = chunkSize;
     }
 
+    size_t getChunkSize() override {
+        return this->chunkSize;
+    }
+
+    // the objects we iterate over are spread over the page holding the vector
+    size_t getBytesPerTuple() override {
+        if (iterateOverMe == nullptr || iterateOverMe->size() == 0) {
+            return 0;
+        }
+        return myRec->numBytes() / iterateOverMe->size();
+    }
+
 
     // returns the next tuple set to process, or nullptr if there is not one to process
     TupleSetPtr getNextTupleSet() override {
@@ -98,47 +142,32 @@ public:
             return nullptr;
         }
 
-        // if we made it here with lastRec being a valid pointer, then it means
+        // if we made it here with lastRecs being non-empty, then it means
         // that we have gone through an entire cycle, and so all of the data that
-        // we will ever reference stored in lastRec has been fluhhed through the
+        // we will ever reference stored in lastRecs has been fluhhed through the
         // pipeline; hence, we can kill it
 
-        if (lastRec != nullptr) {
-            doneWithVector(lastRec);
-            lastRec = nullptr;
+        for (auto rec : lastRecs) {
+            doneWithVector(rec);
         }
+        lastRecs.clear();
 
-        size_t mySize = iterateOverMe->size();
-        if (mySize == 0) {
-            return nullptr;
-        }
-        // see if there are no more items in the vector to iterate over
-        if (pos == mySize) {
-
-            // this means that we got to the end of the vector
-            lastRec = myRec;
-
-            // try to get another vector
-            myRec = (Record<Vector<Handle<Object>>>*)getAnotherVector();
+        // see if there are no more items in our range of the vector to iterate over
+        if (pos == endPos) {
 
-            // if we could not, then we are outta here
-            if (myRec == nullptr)
-                return nullptr;
+            // this means that we got to the end of the range
+            lastRecs.push_back(myRec);
 
-            // and reset everything
-            iterateOverMe = myRec->getRootObject();
-            // JiaNote: we also need to reset mySize
-            mySize = iterateOverMe->size();
-            if (mySize == 0) {
+            // try to get another vector, if we could not, then we are outta here
+            if (!getNextVector()) {
                 return nullptr;
             }
-            pos = 0;
         }
 
         // compute how many slots in the output vector we can fill
-        int numSlotsToIterate = chunkSize;
-        if (numSlotsToIterate + pos > mySize) {
-            numSlotsToIterate = mySize - pos;
+        size_t numSlotsToIterate = chunkSize;
+        if (numSlotsToIterate + pos > endPos) {
+            numSlotsToIterate = endPos - pos;
         }
 
         Vector<Handle<Object>>& myVec = *iterateOverMe;
@@ -147,7 +176,7 @@ public:
         std::vector<Handle<Object>>& inputColumn = output->getColumn<Handle<Object>>(0);
         inputColumn.resize(numSlotsToIterate);
         // fill it up
-        for (int i = 0; i < numSlotsToIterate; i++) {
+        for (size_t i = 0; i < numSlotsToIterate; i++) {
             inputColumn[i] = myVec[pos];
             pos++;
         }
@@ -158,13 +187,15 @@ public:
 
     ~VectorTupleSetIterator() {
 
-        // if lastRec is not a nullptr, then it means that we have not yet freed it
-        if (lastRec != nullptr) {
+        // if lastRecs is not empty, then it means that we have not yet freed them
+        if (!lastRecs.empty()) {
             makeObjectAllocatorBlock(4096, true);
-            doneWithVector(lastRec);
+            for (auto rec : lastRecs) {
+                doneWithVector(rec);
+            }
         }
 
-        lastRec = nullptr;
+        lastRecs.clear();
     }
 };
 }
@@ -26,6 +26,7 @@
 #include "PDBCommunicator.h"
 #include "PDBString.h"
 #include "KeepGoing.h"
+#include "SetScanFetcher.h"
 #include <string>
 #include <memory>
 #include <snappy.h>
@@ -38,7 +39,8 @@ class OutputIterator {
 
 public:
     bool operator!=(const OutputIterator& me) const {
-        if (connection != nullptr || me.connection != nullptr)
+        if (connection != nullptr || me.connection != nullptr || fetcher != nullptr ||
+            me.fetcher != nullptr)
             return true;
         return false;
     }
@@ -56,7 +58,30 @@ public:
     }
 
     void operator++() {
-        if (pos == size - 1) {
+        if (pos == size - 1 && fetcher != nullptr) {
+
+            // the pages come straight from the workers
+            data = nullptr;
+            if (page != nullptr) {
+                free(page);
+                page = nullptr;
+            }
+            while ((page = (Record<Vector<Handle<OutType>>>*)fetcher->nextPage()) != nullptr) {
+                data = page->getRootObject();
+                size = data->size();
+                if (size > 0) {
+                    pos = 0;
+                    return;
+                }
+                data = nullptr;
+                free(page);
+            }
+            if (fetcher->hadError()) {
+                std::cout << "Problem getting data: not all of the pages could be fetched\n";
+            }
+            fetcher = nullptr;
+
+        } else if (pos == size - 1) {
 
             // for allocations
             const UseTemporaryAllocationBlock tempBlock{1024};
@@ -142,6 +167,16 @@ public:
         this->operator++();
     }
 
+    OutputIterator(SetScanFetcherPtr fetcherIn) {
+        connection = nullptr;
+        fetcher = fetcherIn;
+        data = nullptr;
+        page = nullptr;
+
+        // get the ball rolling!!
+        this->operator++();
+    }
+
     OutputIterator() {
         connection = nullptr;
         data = nullptr;
@@ -155,6 +190,12 @@ public:
         if (page != nullptr)
             free(page);
 
+        // stop the fetcher, if we did not get to the end
+        if (fetcher != nullptr) {
+            fetcher->cancel();
+            fetcher = nullptr;
+        }
+
         // nothing to do if we don't have a connection
         if (connection == nullptr)
             return;
@@ -179,6 +220,9 @@ private:
     Handle<Vector<Handle<OutType>>> data;
     Record<Vector<Handle<OutType>>>* page;
     PDBCommunicatorPtr connection;
+
+    // if set, the pages come from here rather than over connection
+    SetScanFetcherPtr fetcher;
 };
 }
 
@@ -30,6 +30,10 @@
 #include "RegisterReplica.h"
 #include "TupleSetExecuteQuery.h"
 #include "ExecuteComputation.h"
+#include "PrepareComputation.h"
+#include "ExecutePreparedComputation.h"
+#include "ReleasePreparedComputation.h"
+#include "BroadcastVariable.h"
 #include "QueryGraphAnalyzer.h"
 #include "Computation.h"
 namespace pdb {
@@ -113,6 +117,18 @@ if (typeName != getTypeName <Type> ()) {
         return returnVal;
     }
 
+    // gets an iterator that fetches the pages of the set from all of the workers holding it in
+    // parallel, rather than through the manager
+    template <class Type>
+    SetIterator<Type> getParallelSetIterator(std::string databaseName,
+                                             std::string setName,
+                                             int windowSize,
+                                             bool compress) {
+        SetIterator<Type> returnVal(myLogger, port, address, databaseName, setName);
+        returnVal.enableParallelRetrieval(windowSize, compress);
+        return returnVal;
+    }
+
     bool deleteSet(std::string databaseName, std::string setName) {
         // this is for query testing stuff
         return simpleRequest<DeleteSet, SimpleRequestResult, bool, String, String>(
@@ -229,6 +245,7 @@ if (typeName != getTypeName <Type> ()) {
             computationsToSend->push_back(computations[i]);
         }
         Handle<ExecuteComputation> executeComputation = makeObject<ExecuteComputation>(tcapString);
+        attachBroadcastVariables(executeComputation);
 
         // this call asks the database to execute the query, and then it inserts the result set name
         // within each of the results, as well as the database connection information
@@ -246,6 +263,9 @@ if (typeName != getTypeName <Type> ()) {
                 124 * 1024,
                 [&](Handle<SimpleRequestResult> result) {
                     if (result != nullptr) {
+                        this->peakMemoryBytes = result->getPeakMemoryBytes();
+                        this->shuffledBytes = result->getShuffledBytes();
+                        this->peakSharedMemoryBytes = result->getPeakSharedMemoryBytes();
                         if (!result->getRes().first) {
                             errMsg = "Error in query: " + result->getRes().second;
                             myLogger->error("Error querying data: " + result->getRes().second);
@@ -274,10 +294,178 @@ if (typeName != getTypeName <Type> ()) {
         this->queryGraph = makeObject<Vector<Handle<Computation>>>();
     }
 
+    // prepares the computations under a name; the scheduler keeps them, the first execution plans
+    // them as usual and the later ones only run the recorded stages
+    template <class... Types>
+    bool prepareComputations(std::string& errMsg,
+                             std::string preparedName,
+                             Handle<Computation> firstParam,
+                             Handle<Types>... args) {
+        queryGraph->push_back(firstParam);
+        return prepareComputations(errMsg, preparedName, args...);
+    }
+
+    bool prepareComputations(std::string& errMsg, std::string preparedName) {
+
+        const UseTemporaryAllocationBlock myBlock{256 * 1024 * 1024};
+        std::vector<Handle<Computation>> computations;
+        std::string tcapString = getTCAP(computations);
+        Handle<PrepareComputation> request = makeObject<PrepareComputation>(preparedName, tcapString);
+        return sendComputations(errMsg, request, computations);
+    }
+
+    // executes the computations prepared under a name, the parameters of this execution are the
+    // broadcast variables registered before it
+    bool executePreparedComputations(std::string& errMsg, std::string preparedName) {
+
+        if (useScheduler == false) {
+            errMsg =
+                "This query must be sent to QuerySchedulerServer, but it seems "
+                "QuerySchedulerServer is not supported";
+            return false;
+        }
+
+        const UseTemporaryAllocationBlock myBlock{256 * 1024 * 1024};
+        Handle<Vector<Handle<BroadcastVariable>>> variables = takeBroadcastVariables();
+        return simpleRequest<ExecutePreparedComputation, SimpleRequestResult, bool>(
+            myLogger,
+            port,
+            address,
+            false,
+            124 * 1024,
+            [&](Handle<SimpleRequestResult> result) { return processResult(errMsg, result); },
+            preparedName,
+            variables);
+    }
+
+    // drops the computations prepared under a name
+    bool releasePreparedComputations(std::string& errMsg, std::string preparedName) {
+        return simpleRequest<ReleasePreparedComputation, SimpleRequestResult, bool>(
+            myLogger,
+            port,
+            address,
+            false,
+            124 * 1024,
+            [&](Handle<SimpleRequestResult> result) {
+                if (result != nullptr) {
+                    if (!result->getRes().first) {
+                        errMsg = "Could not release prepared computations: " + result->getRes().second;
+                        myLogger->error(errMsg);
+                        return false;
+                    }
+                    return true;
+                }
+                errMsg = "Error releasing prepared computations: got nothing back from server";
+                return false;
+            },
+            preparedName);
+    }
+
+    // registers a read-only object with the next execution, which ships it once to every worker;
+    // the computations read it with getBroadcastVariable
+    template <class ObjType>
+    void addBroadcastVariable(std::string name, Handle<ObjType> value) {
+        broadcastVariables.push_back(std::make_pair(name, Handle<Object>(value)));
+    }
+
     void setUseScheduler(bool useScheduler) {
         this->useScheduler = useScheduler;
     }
 
+    // returns the most heap memory the last execution held on a worker, also if it failed
+    size_t getPeakMemoryBytes() {
+        return peakMemoryBytes;
+    }
+
+    // returns the bytes the workers received from each other during the last execution
+    size_t getShuffledBytes() {
+        return shuffledBytes;
+    }
+
+    // returns the most shared memory a worker had in use during the last execution
+    size_t getPeakSharedMemoryBytes() {
+        return peakSharedMemoryBytes;
+    }
+
+private:
+    // copies the registered broadcast variables into an execution request and forgets them, they
+    // are only shipped with a single execution
+    template <class RequestType>
+    void attachBroadcastVariables(Handle<RequestType>& request) {
+        Handle<Vector<Handle<BroadcastVariable>>> variables = takeBroadcastVariables();
+        if (variables != nullptr) {
+            request->setBroadcastVariables(variables);
+        }
+    }
+
+    // copies the registered broadcast variables into a vector and forgets them, returns nullptr if
+    // there are none
+    Handle<Vector<Handle<BroadcastVariable>>> takeBroadcastVariables() {
+        if (broadcastVariables.empty()) {
+            return nullptr;
+        }
+        Handle<Vector<Handle<BroadcastVariable>>> variables =
+            makeObject<Vector<Handle<BroadcastVariable>>>();
+        for (auto& variable : broadcastVariables) {
+            variables->push_back(makeObject<BroadcastVariable>(variable.first, variable.second));
+        }
+        broadcastVariables.clear();
+        return variables;
+    }
+
+    // reads the statistics of an execution from the result of the scheduler, returns false if the
+    // execution failed
+    bool processResult(std::string& errMsg, Handle<SimpleRequestResult> result) {
+        if (result != nullptr) {
+            this->peakMemoryBytes = result->getPeakMemoryBytes();
+            this->shuffledBytes = result->getShuffledBytes();
+            this->peakSharedMemoryBytes = result->getPeakSharedMemoryBytes();
+            if (!result->getRes().first) {
+                errMsg = "Error in query: " + result->getRes().second;
+                myLogger->error("Error querying data: " + result->getRes().second);
+                return false;
+            }
+            return true;
+        }
+        errMsg = "Error getting type name: got nothing back from server";
+        return false;
+    }
+
+    // sends a request about the query graph, followed by its computations, to the scheduler
+    template <class RequestType>
+    bool sendComputations(std::string& errMsg,
+                          Handle<RequestType>& request,
+                          std::vector<Handle<Computation>>& computations) {
+
+        Handle<Vector<Handle<Computation>>> computationsToSend =
+            makeObject<Vector<Handle<Computation>>>();
+        for (size_t i = 0; i < computations.size(); i++) {
+            computationsToSend->push_back(computations[i]);
+        }
+
+        bool success = false;
+        if (useScheduler == true) {
+            success = simpleDoubleRequest<RequestType,
+                                          Vector<Handle<Computation>>,
+                                          SimpleRequestResult,
+                                          bool>(
+                myLogger,
+                port,
+                address,
+                false,
+                124 * 1024,
+                [&](Handle<SimpleRequestResult> result) { return processResult(errMsg, result); },
+                request,
+                computationsToSend);
+        } else {
+            errMsg =
+                "This query must be sent to QuerySchedulerServer, but it seems "
+                "QuerySchedulerServer is not supported";
+        }
+        this->queryGraph = makeObject<Vector<Handle<Computation>>>();
+        return success;
+    }
+
 private:
     // how we connect to the catalog
     CatalogClient myHelper;
@@ -289,6 +477,9 @@ private:
     // JiaNote: the Computation-based query graph to execute
     Handle<Vector<Handle<Computation>>> queryGraph;
 
+    // the broadcast variables registered for the next execution
+    std::vector<std::pair<std::string, Handle<Object>>> broadcastVariables;
+
 
     // connection info
     int port;
@@ -299,6 +490,14 @@ private:
 
     // JiaNote: whether to run in distributed mode
     bool useScheduler;
+
+    // the most heap memory the last execution held on a worker
+    size_t peakMemoryBytes = 0;
+
+    // the bytes shuffled between the workers, and the most shared memory a worker used, during
+    // the last execution
+    size_t shuffledBytes = 0;
+    size_t peakSharedMemoryBytes = 0;
 };
 }
 
@@ -21,6 +21,10 @@
 
 #include "OutputIterator.h"
 #include "SetScan.h"
+#include "SetScanFetcher.h"
+#include "GetSetNodes.h"
+#include "ListOfNodes.h"
+#include "SimpleRequest.h"
 #include <snappy.h>
 
 namespace pdb {
@@ -49,6 +53,14 @@ public:
 
     ~SetIterator() {}
 
+    // instead of going through the manager page by page, begin () will stream the pages from all of
+    // the workers holding the set in parallel, with up to windowSize pages in flight per worker
+    void enableParallelRetrieval(int windowSize, bool compress) {
+        parallelRetrieval = true;
+        this->windowSize = windowSize;
+        this->compress = compress;
+    }
+
     // this basically sets up a connection to the server, and returns it
     OutputIterator<OutType> begin() {
 
@@ -58,6 +70,10 @@ public:
             return OutputIterator<OutType>();
         }
 
+        if (parallelRetrieval) {
+            return beginParallel();
+        }
+
         // establish a connection
         std::string errMsg;
         PDBCommunicatorPtr temp = std::make_shared<PDBCommunicator>();
@@ -84,6 +100,39 @@ public:
     }
 
 private:
+    // asks the manager where the set lives, and starts fetching from there
+    OutputIterator<OutType> beginParallel() {
+
+        std::vector<std::string> nodes;
+        bool found = simpleRequest<GetSetNodes, ListOfNodes, bool>(
+            myLogger,
+            port,
+            serverName,
+            false,
+            1024,
+            [&](Handle<ListOfNodes> result) {
+                if (result == nullptr || result->getHostNames() == nullptr) {
+                    return false;
+                }
+                Vector<String>& hostNames = *result->getHostNames();
+                for (int i = 0; i < hostNames.size(); i++) {
+                    nodes.push_back(hostNames[i]);
+                }
+                return true;
+            },
+            dbName,
+            setName);
+        if (!found) {
+            myLogger->error("output iterator: not able to get the nodes of the set.\n");
+            return OutputIterator<OutType>();
+        }
+
+        SetScanFetcherPtr fetcher =
+            std::make_shared<SetScanFetcher>(myLogger, nodes, dbName, setName, windowSize, compress);
+        fetcher->start();
+        return OutputIterator<OutType>(fetcher);
+    }
+
     // these are used so that the output knows how to connect to the server for iteration
     int port;
     std::string serverName;
@@ -96,6 +145,11 @@ private:
     // true if there is an error
     bool wasError;
 
+    // set by enableParallelRetrieval
+    bool parallelRetrieval = false;
+    int windowSize = DEFAULT_SET_SCAN_WINDOW;
+    bool compress = false;
+
     // allows creation of these objects
     friend class QueryClient;
 };
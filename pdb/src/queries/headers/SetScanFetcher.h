@@ -0,0 +1,274 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef SET_SCAN_FETCHER_H
+#define SET_SCAN_FETCHER_H
+
+#include "PDBCommunicator.h"
+#include "PDBLogger.h"
+#include "InterfaceFunctions.h"
+#include "SetScan.h"
+#include "KeepGoing.h"
+#include "DoneWithResult.h"
+#include "UseTemporaryAllocationBlock.h"
+#include <condition_variable>
+#include <sys/socket.h>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <snappy.h>
+
+// the number of received pages per node that may wait for the consumer, on top of the pages each
+// worker has in flight
+#ifndef SET_SCAN_QUEUED_PAGES_PER_NODE
+#define SET_SCAN_QUEUED_PAGES_PER_NODE 2
+#endif
+
+namespace pdb {
+
+class SetScanFetcher;
+typedef std::shared_ptr<SetScanFetcher> SetScanFetcherPtr;
+
+/**
+ * Streams the pages of a set straight from the workers that store it, with one connection and one
+ * receiving thread per worker. Each worker keeps up to windowSize pages in flight; a page is
+ * acknowledged as soon as it has been received, and the bounded queue between the receiving
+ * threads and the consumer is what eventually holds the workers back.
+ *
+ * The receiving threads do not own an allocator, so every message they send is serialized up
+ * front by the thread that creates the fetcher.
+ */
+class SetScanFetcher {
+
+public:
+    SetScanFetcher(PDBLoggerPtr logger,
+                   std::vector<std::string> nodes,
+                   std::string dbName,
+                   std::string setName,
+                   int windowSize,
+                   bool compress)
+        : logger(logger), nodes(nodes), compress(compress) {
+
+        scanRequest = serialize<SetScan>(dbName, setName, std::max(1, windowSize), compress);
+        keepGoing = serialize<KeepGoing>();
+        doneWithResult = serialize<DoneWithResult>();
+        maxQueuedPages = std::max((size_t)1, nodes.size() * SET_SCAN_QUEUED_PAGES_PER_NODE);
+    }
+
+    ~SetScanFetcher() {
+        cancel();
+        for (void* page : pages) {
+            free(page);
+        }
+        free(scanRequest);
+        free(keepGoing);
+        free(doneWithResult);
+    }
+
+    // starts a receiving thread for every node
+    void start() {
+        std::unique_lock<std::mutex> guard(lock);
+        numRunning = nodes.size();
+        for (auto& node : nodes) {
+            receivers.emplace_back([this, node]() { fetchFrom(node); });
+        }
+    }
+
+    // returns the next page, which the caller has to free, or nullptr once all of the nodes are
+    // done; the pages of different nodes come in no particular order
+    void* nextPage() {
+        std::unique_lock<std::mutex> guard(lock);
+        pageReady.wait(guard, [this]() { return !pages.empty() || numRunning == 0; });
+        if (pages.empty()) {
+            return nullptr;
+        }
+        void* page = pages.front();
+        pages.pop_front();
+        spaceFree.notify_one();
+        return page;
+    }
+
+    // stops all of the receiving threads, telling the workers that we are done with the result
+    void cancel() {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            cancelled = true;
+        }
+        spaceFree.notify_all();
+        for (auto& receiver : receivers) {
+            if (receiver.joinable()) {
+                receiver.join();
+            }
+        }
+        receivers.clear();
+    }
+
+    // returns true if we could not get all of the pages from some node
+    bool hadError() {
+        std::unique_lock<std::mutex> guard(lock);
+        return failed;
+    }
+
+private:
+    // builds a message in a temporary allocation block and copies it out as a record
+    template <class ObjType, class... Args>
+    Record<ObjType>* serialize(Args&&... args) {
+        const UseTemporaryAllocationBlock tempBlock{1024};
+        Handle<ObjType> message = makeObject<ObjType>(args...);
+        Record<ObjType>* record = getRecord(message);
+        Record<ObjType>* copy = (Record<ObjType>*)malloc(record->numBytes());
+        memcpy(copy, record, record->numBytes());
+
+        // resolve the type ID here, so that the receiving threads only ever read it
+        getTypeID<ObjType>();
+        return copy;
+    }
+
+    // hands a page to the consumer, waiting while the queue is full; false if we were cancelled
+    bool push(void* page) {
+        std::unique_lock<std::mutex> guard(lock);
+        spaceFree.wait(guard, [this]() { return cancelled || pages.size() < maxQueuedPages; });
+        if (cancelled) {
+            return false;
+        }
+        pages.push_back(page);
+        pageReady.notify_one();
+        return true;
+    }
+
+    // the body of a receiving thread
+    void fetchFrom(std::string node) {
+
+        std::string errMsg;
+        bool ok = true;
+        bool workerDone = false;
+        size_t pos = node.find(":");
+        int port = std::stoi(node.substr(pos + 1));
+        std::string address = node.substr(0, pos);
+
+        PDBCommunicator communicator;
+        {
+            // socket() is not thread-safe, so we need synchronize here
+            static std::mutex connectLock;
+            std::unique_lock<std::mutex> guard(connectLock);
+            ok = !communicator.connectToInternetServer(logger, port, address, errMsg);
+        }
+        ok = ok && communicator.sendRecord(scanRequest, errMsg);
+
+        while (ok && !isCancelled()) {
+
+            // the worker has nothing left and hangs up once it has said so
+            size_t objSize = communicator.getSizeOfNextObject();
+            if (communicator.getObjectTypeID() == DoneWithResult_TYPEID) {
+                workerDone = true;
+                break;
+            }
+            if (objSize == 0) {
+                errMsg = "connection to " + node + " was closed before the scan was done";
+                ok = false;
+                break;
+            }
+
+            char* bytes = (char*)malloc(objSize);
+            if (!communicator.receiveBytes(bytes, errMsg)) {
+                free(bytes);
+                ok = false;
+                break;
+            }
+
+            void* page = bytes;
+            if (compress) {
+                size_t uncompressedSize = 0;
+                snappy::GetUncompressedLength(bytes, objSize, &uncompressedSize);
+                page = malloc(uncompressedSize);
+                snappy::RawUncompress(bytes, objSize, (char*)page);
+                free(bytes);
+            }
+
+            // the page is ours now, so the worker can go on with the next one
+            ok = communicator.sendRecord(keepGoing, errMsg);
+            if (!push(page)) {
+                free(page);
+                break;
+            }
+        }
+
+        // if we stop early, the worker has to know that we will not acknowledge anything else;
+        // we then read whatever it still had in flight until it hangs up, because closing a
+        // socket with unread data resets the connection before the worker sees our message
+        if (ok && !workerDone && communicator.sendRecord(doneWithResult, errMsg)) {
+            shutdown(communicator.getSocketFD(), SHUT_WR);
+            size_t objSize;
+            while ((objSize = communicator.getSizeOfNextObject()) != 0) {
+                char* bytes = (char*)malloc(objSize);
+                bool received = communicator.receiveBytes(bytes, errMsg);
+                free(bytes);
+                if (!received) {
+                    break;
+                }
+            }
+        }
+        if (!ok) {
+            logger->error("SetScanFetcher: problem fetching from " + node + ": " + errMsg);
+        }
+
+        std::unique_lock<std::mutex> guard(lock);
+        failed = failed || !ok;
+        numRunning--;
+        pageReady.notify_all();
+    }
+
+    bool isCancelled() {
+        std::unique_lock<std::mutex> guard(lock);
+        return cancelled;
+    }
+
+    PDBLoggerPtr logger;
+
+    // the nodes we fetch from, each one as "address:port"
+    std::vector<std::string> nodes;
+
+    // whether the pages come compressed
+    bool compress;
+
+    // the messages we send, serialized when we were created
+    Record<SetScan>* scanRequest;
+    Record<KeepGoing>* keepGoing;
+    Record<DoneWithResult>* doneWithResult;
+
+    // one receiving thread per node
+    std::vector<std::thread> receivers;
+
+    // the received pages that the consumer has not taken yet
+    std::deque<void*> pages;
+    size_t maxQueuedPages;
+
+    // protects everything below, and pages
+    std::mutex lock;
+    std::condition_variable pageReady;
+    std::condition_variable spaceFree;
+    size_t numRunning = 0;
+    bool cancelled = false;
+    bool failed = false;
+};
+}
+
+#endif
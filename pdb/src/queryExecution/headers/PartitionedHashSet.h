@@ -20,6 +20,7 @@
 
 
 #include "AbstractHashSet.h"
+#include "QueryMemoryAccountant.h"
 #include <pthread.h>
 
 namespace pdb {
@@ -52,11 +53,17 @@ private:
     // mutex
     pthread_mutex_t myMutex;
 
+    // the query that the pages are charged to, nullptr if they are not accounted for
+    QueryMemoryAccountantPtr accountant;
+
 public:
     // constructor
-    PartitionedHashSet(std::string myName, size_t pageSize) {
+    PartitionedHashSet(std::string myName,
+                       size_t pageSize,
+                       QueryMemoryAccountantPtr accountant = nullptr) {
         this->setName = myName;
         this->pageSize = pageSize;
+        this->accountant = accountant;
         this->isCleaned = false;
         pthread_mutex_init(&myMutex, nullptr);
     }
@@ -104,9 +111,14 @@ public:
         return retNum;
     }
 
-    // add page
+    // add page, returns nullptr if the heap or the query is out of memory
     void* addPage() {
-        void* block = (void*)malloc(sizeof(char) * pageSize);
+        void* block = nullptr;
+        if (accountant != nullptr) {
+            block = accountant->allocate(sizeof(char) * pageSize, "a page of hash set " + setName);
+        } else {
+            block = (void*)malloc(sizeof(char) * pageSize);
+        }
         if (block != nullptr) {
             pthread_mutex_lock(&myMutex);
             partitionPages.push_back(block);
@@ -119,7 +131,11 @@ public:
     void cleanup() override {
         if (isCleaned == false) {
             for (int i = 0; i < partitionPages.size(); i++) {
-                free(partitionPages[i]);
+                if (accountant != nullptr) {
+                    accountant->deallocate(partitionPages[i], pageSize);
+                } else {
+                    free(partitionPages[i]);
+                }
             }
             isCleaned = true;
 #ifdef PROFILING
@@ -20,6 +20,7 @@
 
 
 #include "PDBVector.h"
+#include "ColumnRange.h"
 #include "SimpleRequest.h"
 #include "SimpleRequestResult.h"
 #include "SimpleSendDataRequest.h"
@@ -30,8 +31,11 @@
 #include "TupleSetJobStage.h"
 #include "HermesExecutionServer.h"
 #include "PartitionedHashSet.h"
+#include "QueryMemoryAccountant.h"
 #include "SetSpecifier.h"
 #include "DataPacket.h"
+#include "WorkStealingPageIterator.h"
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <unordered_map>
@@ -91,6 +95,12 @@ private:
     // vector of nodeId for shuffling
     std::vector<int> nodeIds;
 
+    // the number of pipeline threads running in this process, across all stages
+    static std::atomic<int> numRunningPipelineThreads;
+
+    // the memory of the query on this worker
+    QueryMemoryAccountantPtr memoryAccountant;
+
 
 public:
     // destructor
@@ -105,6 +115,9 @@ public:
                   size_t batchSize,
                   int numThreads);
 
+    // charge the memory of this stage to the query, which the other stages of the query share
+    void setMemoryAccountant(QueryMemoryAccountantPtr memoryAccountant);
+
     // store shuffle data
     bool storeShuffleData(Handle<Vector<Handle<Object>>> data,
                           std::string databaseName,
@@ -131,11 +144,13 @@ public:
     // tuning the backend circular buffer size
     size_t getBackendCircularBufferSize(bool& success, std::string& errMsg);
 
-    // get iterators to scan a user set
-    std::vector<PageCircularBufferIteratorPtr> getUserSetIterators(HermesExecutionServer* server,
-                                                                   int numThreads,
-                                                                   bool& success,
-                                                                   std::string& errMsg);
+    // get iterators to scan a user set, skipping the pages whose zone maps rule out the filter
+    std::vector<PageCircularBufferIteratorPtr> getUserSetIterators(
+        HermesExecutionServer* server,
+        int numThreads,
+        bool& success,
+        std::string& errMsg,
+        Handle<Vector<ColumnRange>> rangeFilter = nullptr);
 
     // get bufferss to scan a user set in a sharing way, so that each iterator is linked to a buffer
     // and will scan all pages
@@ -147,6 +162,19 @@ public:
                            bool& success,
                            std::string& errMsg);
 
+    // split the pages of a user set from the storage's buffers into morsels and move those into a
+    // work-stealing scheduler, one thread per buffer, so that pipeline threads can steal each
+    // other's morsels
+    void feedWorkStealingScheduler(HermesExecutionServer* server,
+                                   std::vector<PageCircularBufferIteratorPtr>& scanIterators,
+                                   WorkStealingSchedulerPtr<PageMorsel> scheduler,
+                                   int& counter,
+                                   PDBBuzzerPtr tempBuzzer);
+
+    // returns true if the stage may run on more threads than it was started with; this is not
+    // the case if the i-th thread has to probe the i-th partition of a hash set
+    bool canAddPipelineThreads(HermesExecutionServer* server);
+
     // create proxy
     DataProxyPtr createProxy(int i, pthread_mutex_t connection_mutex, std::string& errMsg);
 
@@ -0,0 +1,175 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef QUERY_MEMORY_ACCOUNTANT_H
+#define QUERY_MEMORY_ACCOUNTANT_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <pthread.h>
+
+#include "Configuration.h"
+
+namespace pdb {
+
+class QueryMemoryAccountant;
+typedef std::shared_ptr<QueryMemoryAccountant> QueryMemoryAccountantPtr;
+
+/**
+ * Keeps track of the heap memory that one query holds on a worker: the pages its pipelines write
+ * to, the pages of its hash tables, and the blocks its threads allocate objects in.  The stages of
+ * the query reserve memory here before they allocate it and give it back when they free it, so we
+ * know how much the query used at its peak, and we can stop it before it takes more than the query
+ * limit, or before all the queries on the worker together take more than the node limit.
+ *
+ * A query that is refused memory has failed; it keeps failing, so that its threads wind down and
+ * the stage can report the reason.
+ */
+class QueryMemoryAccountant {
+
+public:
+    /**
+     * Creates the accountant of a query
+     * @param jobId - the query
+     * @param queryLimit - the most bytes the query may hold, 0 for no limit
+     * @param nodeLimit - the most bytes all the queries in this process may hold, 0 for no limit
+     * @param spillWaitMs - how long a reservation waits for memory that is about to be freed
+     */
+    QueryMemoryAccountant(std::string jobId,
+                          size_t queryLimit,
+                          size_t nodeLimit,
+                          unsigned int spillWaitMs = DEFAULT_MEMORY_SPILL_WAIT_MS);
+
+    // gives whatever the query still holds back to the node
+    ~QueryMemoryAccountant();
+
+    /**
+     * Reserves memory for the query.  If that would exceed a limit, we first wait for the pages
+     * that other threads of the query are writing out to be freed, and fail the query if they are
+     * not freed in time
+     * @param numBytes - how much memory
+     * @param what - what it is for, this goes into the error message
+     * @return true if the memory is reserved, false if the query has failed
+     */
+    bool reserve(size_t numBytes, const std::string& what);
+
+    // reserves the bytes if that exceeds no limit, without waiting and without failing the query;
+    // this is for memory that the caller can do with less of
+    bool tryReserve(size_t numBytes);
+
+    // fails the query, because it could not get numBytes for what
+    void fail(size_t numBytes, const std::string& what);
+
+    // fails the query for a reason other than memory, its threads wind down the same way
+    void fail(const std::string& errMsg);
+
+    // reserves memory that the query can not do without, whatever the limits, e.g. the blocks its
+    // threads work in; it counts against the limits of the reservations that follow
+    void charge(size_t numBytes);
+
+    // gives back memory that was reserved or charged
+    void release(size_t numBytes);
+
+    // reserves numBytes and mallocs them, zeroed if asked; returns nullptr, and fails the query, if
+    // it can not have them
+    void* allocate(size_t numBytes, const std::string& what, bool zeroed = false);
+
+    // frees memory that allocate () returned
+    void deallocate(void* bytes, size_t numBytes);
+
+    // returns the query this accountant keeps track of
+    std::string getJobId();
+
+    // returns the bytes the query holds
+    size_t getUsedBytes();
+
+    // returns the most bytes the query has held at once
+    size_t getPeakBytes();
+
+    // returns true if the query was refused memory, or failed for another reason
+    bool hasFailed();
+
+    // returns why the query failed, or an empty string
+    std::string getErrMsg();
+
+    // returns the bytes that all the queries in this process hold
+    static size_t getNodeUsedBytes();
+
+private:
+    // the query
+    std::string jobId;
+
+    // the limits, 0 for none
+    size_t queryLimit;
+    size_t nodeLimit;
+
+    // how long a reservation waits for memory to be given back
+    unsigned int spillWaitMs;
+
+    // the bytes the query holds, and the most it has held at once
+    std::atomic<size_t> usedBytes;
+    std::atomic<size_t> peakBytes;
+
+    // whether the query was refused memory
+    std::atomic<bool> failed;
+
+    // the number of reservations that wait for memory to be given back
+    std::atomic<int> numWaiting;
+
+    // protects errMsg, and wakes up the reservations that wait
+    pthread_mutex_t waitingMutex;
+    pthread_cond_t waitingSignal;
+
+    // why the query failed
+    std::string errMsg;
+
+    // the bytes all the queries in this process hold
+    static std::atomic<size_t> nodeUsedBytes;
+};
+
+/**
+ * Charges memory to a query for as long as it lives, e.g. the allocation block of a pipeline
+ * thread.  The accountant may be nullptr, then nothing is charged.
+ */
+class QueryMemoryReservation {
+
+public:
+    QueryMemoryReservation(QueryMemoryAccountantPtr accountant, size_t numBytes)
+        : accountant(accountant), numBytes(numBytes) {
+        if (accountant != nullptr) {
+            accountant->charge(numBytes);
+        }
+    }
+
+    ~QueryMemoryReservation() {
+        if (accountant != nullptr) {
+            accountant->release(numBytes);
+        }
+    }
+
+    QueryMemoryReservation(const QueryMemoryReservation&) = delete;
+    QueryMemoryReservation& operator=(const QueryMemoryReservation&) = delete;
+
+private:
+    QueryMemoryAccountantPtr accountant;
+    size_t numBytes;
+};
+}
+
+#endif
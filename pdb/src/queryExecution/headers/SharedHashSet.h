@@ -20,6 +20,7 @@
 
 
 #include "AbstractHashSet.h"
+#include "QueryMemoryAccountant.h"
 
 namespace pdb {
 
@@ -43,13 +44,24 @@ private:
     // the size of the page
     size_t pageSize;
 
+    // the query that the page is charged to, nullptr if it is not accounted for
+    QueryMemoryAccountantPtr accountant;
+
 
 public:
-    // constructor
-    SharedHashSet(std::string myName, size_t pageSize) {
+    // constructor; the hash set is not valid if the heap or the query has no room for the page,
+    // the caller may then try with a smaller one
+    SharedHashSet(std::string myName, size_t pageSize, QueryMemoryAccountantPtr accountant = nullptr) {
         this->setName = myName;
         this->pageSize = pageSize;
-        this->pageData = (void*)malloc(sizeof(char) * pageSize);
+        if (accountant == nullptr || accountant->tryReserve(pageSize)) {
+            this->accountant = accountant;
+            this->pageData = (void*)malloc(sizeof(char) * pageSize);
+            if (pageData == nullptr && accountant != nullptr) {
+                accountant->release(pageSize);
+                this->accountant = nullptr;
+            }
+        }
         if (pageData == nullptr) {
             std::cout << "SharedHashSet Error: insufficient heap memory" << std::endl;
         }
@@ -97,6 +109,9 @@ public:
         if (pageData != nullptr) {
             free(pageData);
             pageData = nullptr;
+            if (accountant != nullptr) {
+                accountant->release(pageSize);
+            }
         }
     }
 };
@@ -0,0 +1,229 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef TOP_K_THRESHOLD_H
+#define TOP_K_THRESHOLD_H
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include "LockGuard.h"
+
+// how many kept items a pipeline thread sees before it exchanges scores with the other threads
+#ifndef TOP_K_THRESHOLD_SYNC_INTERVAL
+#define TOP_K_THRESHOLD_SYNC_INTERVAL 256
+#endif
+
+namespace pdb {
+
+// orders scores so that the std heap functions give us a min-heap; Score only needs operator<
+template <class Score>
+struct TopKScoreGreater {
+    bool operator()(const Score& lhs, const Score& rhs) const {
+        return rhs < lhs;
+    }
+};
+
+/**
+ * The k best scores seen by all the pipeline threads of one top-K stage on a worker. The smallest
+ * of them is a lower bound on the k-th best score of the whole query, so an item that scores below
+ * it can never make it into the result.
+ */
+template <class Score>
+class TopKSharedThreshold {
+
+public:
+    explicit TopKSharedThreshold(unsigned k) : k(k) {
+        pthread_mutex_init(&lock, nullptr);
+    }
+
+    ~TopKSharedThreshold() {
+        pthread_mutex_destroy(&lock);
+    }
+
+    /**
+     * Adds the scores a thread kept since its last call, and hands back the current threshold
+     * @param scores - the new scores, every score must be added only once
+     * @param threshold - set to the k-th best score, if we have seen k scores
+     * @return true if the threshold was set
+     */
+    bool merge(std::vector<Score>& scores, Score& threshold) {
+        const LockGuard guard{lock};
+        for (Score& score : scores) {
+            pushBounded(best, k, score);
+        }
+        if (best.size() < k) {
+            return false;
+        }
+        threshold = best.front();
+        return true;
+    }
+
+    /**
+     * Returns the threshold shared by all threads that run the given stage on this worker
+     * @param stageName - identifies the stage, e.g. the job id and the stage id
+     * @param k - the number of items the query returns
+     */
+    static std::shared_ptr<TopKSharedThreshold<Score>> getThreshold(std::string stageName,
+                                                                    unsigned k) {
+        static pthread_mutex_t registryLock = PTHREAD_MUTEX_INITIALIZER;
+        static std::map<std::string, std::weak_ptr<TopKSharedThreshold<Score>>> registry;
+
+        const LockGuard guard{registryLock};
+        std::shared_ptr<TopKSharedThreshold<Score>> threshold = registry[stageName].lock();
+        if (threshold == nullptr) {
+            // drop the thresholds of the stages that are done before we add a new one
+            for (auto it = registry.begin(); it != registry.end();) {
+                if (it->second.expired()) {
+                    it = registry.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            threshold = std::make_shared<TopKSharedThreshold<Score>>(k);
+            registry[stageName] = threshold;
+        }
+        return threshold;
+    }
+
+    // adds score to a min-heap that keeps at most k scores
+    static void pushBounded(std::vector<Score>& heap, unsigned k, const Score& score) {
+        if (heap.size() < k) {
+            heap.push_back(score);
+            std::push_heap(heap.begin(), heap.end(), TopKScoreGreater<Score>());
+        } else if (heap.front() < score) {
+            std::pop_heap(heap.begin(), heap.end(), TopKScoreGreater<Score>());
+            heap.back() = score;
+            std::push_heap(heap.begin(), heap.end(), TopKScoreGreater<Score>());
+        }
+    }
+
+private:
+    // the number of scores we keep
+    unsigned k;
+
+    // the best scores so far, as a min-heap
+    std::vector<Score> best;
+
+    // protects best
+    pthread_mutex_t lock;
+};
+
+/**
+ * What a single pipeline thread knows about the k-th best score of a top-K query: the k best
+ * scores it kept itself, and what the other threads on the worker reported the last time it
+ * checked. It is not thread safe, every thread has its own.
+ */
+template <class Score>
+class TopKThreshold {
+
+public:
+    /**
+     * Creates the threshold of a thread
+     * @param stageName - identifies the stage, the threads of a worker that run the same stage
+     * share their scores
+     */
+    explicit TopKThreshold(std::string stageName) : stageName(stageName) {}
+
+    // returns false if an item with this score can not be among the top k anymore
+    bool mayQualify(const Score& score) const {
+        return !known || !(score < threshold);
+    }
+
+    /**
+     * Returns the score an item has to reach to be kept
+     * @param threshold - set to the threshold, if there is one yet
+     * @return true if the threshold was set
+     */
+    bool getThreshold(Score& threshold) const {
+        if (known) {
+            threshold = this->threshold;
+        }
+        return known;
+    }
+
+    /**
+     * Records the score of an item that was kept
+     * @param k - the number of items the query returns, it is the same for all the items
+     * @param score - the score
+     */
+    void add(unsigned k, const Score& score) {
+        if (shared == nullptr) {
+            this->k = k;
+            shared = TopKSharedThreshold<Score>::getThreshold(stageName, k);
+        }
+        if (!mayQualify(score)) {
+            return;
+        }
+        TopKSharedThreshold<Score>::pushBounded(best, k, score);
+        if (best.size() >= k) {
+            raiseTo(best.front());
+        }
+        pending.push_back(score);
+        if (pending.size() >= TOP_K_THRESHOLD_SYNC_INTERVAL) {
+            sync();
+        }
+    }
+
+    // reports the scores kept since the last call, and picks up what the other threads found
+    void sync() {
+        if (shared == nullptr) {
+            return;
+        }
+        Score sharedThreshold;
+        if (shared->merge(pending, sharedThreshold)) {
+            raiseTo(sharedThreshold);
+        }
+        pending.clear();
+    }
+
+private:
+    // makes score the threshold if it is higher than the current one
+    void raiseTo(const Score& score) {
+        if (!known || threshold < score) {
+            threshold = score;
+            known = true;
+        }
+    }
+
+    // the stage we run
+    std::string stageName;
+
+    // the number of items the query returns
+    unsigned k = 0;
+
+    // the best scores this thread has kept, as a min-heap
+    std::vector<Score> best;
+
+    // the scores kept since the last sync
+    std::vector<Score> pending;
+
+    // the lowest score an item needs, only valid if known is true
+    Score threshold;
+    bool known = false;
+
+    // the threshold of all threads running the stage on this worker, set by the first add
+    std::shared_ptr<TopKSharedThreshold<Score>> shared;
+};
+}
+
+#endif
@@ -31,7 +31,7 @@
 #include "PageCircularBufferIterator.h"
 #include "DataProxy.h"
 #include "PageScanner.h"
-#include "PageCircularBufferIterator.h"
+#include "WorkStealingPageIterator.h"
 #include "BlockQueryProcessor.h"
 #include "InterfaceFunctions.h"
 #include "HermesExecutionServer.h"
@@ -46,6 +46,7 @@
 #include "SimpleSendBytesRequest.h"
 #include "ShuffleSink.h"
 #include "PartitionComp.h"
+#include "QueryFailure.h"
 #ifdef ENABLE_COMPRESSION
 #include <snappy.h>
 #endif
@@ -54,6 +55,8 @@
 
 namespace pdb {
 
+std::atomic<int> PipelineStage::numRunningPipelineThreads(0);
+
 PipelineStage::~PipelineStage() {
     this->jobStage = nullptr;
 }
@@ -77,6 +80,12 @@ PipelineStage::PipelineStage(Handle<TupleSetJobStage> stage,
     for (int i = 0; i < numNodes; i++) {
         nodeIds.push_back(i);
     }
+    this->memoryAccountant = make_shared<QueryMemoryAccountant>(
+        stage->getJobId(), conf->getQueryMemoryLimit(), conf->getNodeMemoryLimit());
+}
+
+void PipelineStage::setMemoryAccountant(QueryMemoryAccountantPtr memoryAccountant) {
+    this->memoryAccountant = memoryAccountant;
 }
 
 
@@ -100,9 +109,9 @@ bool PipelineStage::storeShuffleData(Handle<Vector<Handle<Object>>> data,
     if (port <= 0) {
         port = conf->getPort();
     }
-    std::cout << "store shuffle data to address=" << address << " and port=" << port
-              << ", with size = " << data->size() << " to database=" << databaseName
-              << " and set=" << setName << " and type = IntermediateData" << std::endl;
+    PDB_LOG(DEBUG) << "store shuffle data to address=" << address << " and port=" << port
+                   << ", with size = " << data->size() << " to database=" << databaseName
+                   << " and set=" << setName << " and type = IntermediateData" << std::endl;
     return simpleSendDataRequest<StorageAddData, Handle<Object>, SimpleRequestResult, bool>(
         logger,
         port,
@@ -135,9 +144,9 @@ bool PipelineStage::storeCompressedShuffleData(char* bytes,
     if (port <= 0) {
         port = conf->getPort();
     }
-    std::cout << "store shuffle data to address=" << address << " and port=" << port
-              << ", with compressed byte size = " << numBytes << " to database=" << databaseName
-              << " and set=" << setName << " and type = IntermediateData" << std::endl;
+    PDB_LOG(DEBUG) << "store shuffle data to address=" << address << " and port=" << port
+                   << ", with compressed byte size = " << numBytes << " to database=" << databaseName
+                   << " and set=" << setName << " and type = IntermediateData" << std::endl;
     return simpleSendBytesRequest<StorageAddData, SimpleRequestResult, bool>(
         logger,
         port,
@@ -187,8 +196,8 @@ bool PipelineStage::sendData(PDBCommunicatorPtr conn,
         char* compressedBytes = new char[snappy::MaxCompressedLength(size)];
         size_t compressedSize;
         snappy::RawCompress((char*)data, size, compressedBytes, &compressedSize);
-        std::cout << "size before compression is " << size << " and size after compression is "
-                  << compressedSize << std::endl;
+        PDB_LOG(DEBUG) << "size before compression is " << size << " and size after compression is "
+                       << compressedSize << std::endl;
         conn->sendBytes(compressedBytes, compressedSize, errMsg);
         delete[] compressedBytes;
 #else
@@ -219,7 +228,7 @@ size_t PipelineStage::getBackendCircularBufferSize(bool& success, std::string& e
         2 + 2 * numThreads + backendCircularBufferSize) {
         success = false;
         errMsg = "Error: Not enough buffer pool size to run the query! Please reduce number of threads or increase shared memory pool size or reduce default page size and retry";
-        std::cout << errMsg << std::endl;
+        PDB_LOG(ERROR) << errMsg << std::endl;
         return 0;
     }
     backendCircularBufferSize = (conf->getShmSize() / conf->getPageSize() - 4 - 2 * numThreads);
@@ -234,7 +243,11 @@ size_t PipelineStage::getBackendCircularBufferSize(bool& success, std::string& e
 
 // to get iterators to scan a user set
 std::vector<PageCircularBufferIteratorPtr> PipelineStage::getUserSetIterators(
-    HermesExecutionServer* server, int numScanThreads, bool& success, std::string& errMsg) {
+    HermesExecutionServer* server,
+    int numScanThreads,
+    bool& success,
+    std::string& errMsg,
+    Handle<Vector<ColumnRange>> rangeFilter) {
 
     // initialize the data proxy, scanner and set iterators
     PDBCommunicatorPtr communicatorToFrontend = make_shared<PDBCommunicator>();
@@ -256,17 +269,18 @@ std::vector<PageCircularBufferIteratorPtr> PipelineStage::getUserSetIterators(
     if (server->getFunctionality<HermesExecutionServer>().setCurPageScanner(scanner) == false) {
         success = false;
         errMsg = "Error: A job is already running!";
-        std::cout << errMsg << std::endl;
+        PDB_LOG(ERROR) << errMsg << std::endl;
         return iterators;
     }
 
     // get iterators
-    std::cout << "To send GetSetPages message" << std::endl;
+    PDB_LOG(DEBUG) << "To send GetSetPages message" << std::endl;
     iterators = scanner->getSetIterators(nodeId,
                                          jobStage->getSourceContext()->getDatabaseId(),
                                          jobStage->getSourceContext()->getTypeId(),
-                                         jobStage->getSourceContext()->getSetId());
-    std::cout << "GetSetPages message is sent" << std::endl;
+                                         jobStage->getSourceContext()->getSetId(),
+                                         rangeFilter);
+    PDB_LOG(DEBUG) << "GetSetPages message is sent" << std::endl;
 
     // return iterators
     return iterators;
@@ -281,19 +295,19 @@ void PipelineStage::feedSharedBuffers(HermesExecutionServer* server,
                                       PDBBuzzerPtr tempBuzzer,
                                       bool& success,
                                       std::string& errMsg) {
-    std::cout << "to feed shared buffers for " << numPartitions << " partitions" << std::endl;
+    PDB_LOG(DEBUG) << "to feed shared buffers for " << numPartitions << " partitions" << std::endl;
     // get scan iterators
     std::vector<PageCircularBufferIteratorPtr> scanIterators =
         getUserSetIterators(server, 1, success, errMsg);
     int numScanThreads = scanIterators.size();
-    std::cout << "we've got " << numScanThreads << " iterators" << std::endl;
+    PDB_LOG(DEBUG) << "we've got " << numScanThreads << " iterators" << std::endl;
     // start multiple thread to scan the set
     counter = 0;
     for (int i = 0; i < numScanThreads; i++) {
         // each threads get a page and put the page to each source buffer
         PDBWorkerPtr worker =
             server->getFunctionality<HermesExecutionServer>().getWorkers()->getWorker();
-        std::cout << "to run the " << i << "-th scan work..." << std::endl;
+        PDB_LOG(DEBUG) << "to run the " << i << "-th scan work..." << std::endl;
         // start threads
         PDBWorkPtr myWork = make_shared<GenericWork>([&, i](PDBBuzzerPtr callerBuzzer) {
             // setup an output page to store intermediate results and final output
@@ -302,12 +316,12 @@ void PipelineStage::feedSharedBuffers(HermesExecutionServer* server,
             while (iter->hasNext()) {
                 page = iter->next();
                 if (page != nullptr) {
-                    std::cout << "Scanner got a non-null page" << std::endl;
+                    PDB_LOG(DEBUG) << "Scanner got a non-null page" << std::endl;
                     for (int j = 0; j < numPartitions; j++) {
                         page->incRefCount();
                     }
                     for (int j = 0; j < numPartitions; j++) {
-                        std::cout << "add page to the " << j << "-th buffer" << std::endl;
+                        PDB_LOG(DEBUG) << "add page to the " << j << "-th buffer" << std::endl;
                         sourceBuffers[j]->addPageToTail(page);
                     }
                 }
@@ -319,6 +333,58 @@ void PipelineStage::feedSharedBuffers(HermesExecutionServer* server,
     }
 }
 
+// to split user set pages from the buffers fed by the storage into morsels, and to move those into
+// the work-stealing scheduler
+void PipelineStage::feedWorkStealingScheduler(
+    HermesExecutionServer* server,
+    std::vector<PageCircularBufferIteratorPtr>& scanIterators,
+    WorkStealingSchedulerPtr<PageMorsel> scheduler,
+    int& counter,
+    PDBBuzzerPtr tempBuzzer) {
+    int numScanThreads = scanIterators.size();
+    size_t morselSize = conf->getMorselSize();
+    PDB_LOG(DEBUG) << "to feed the work-stealing scheduler from " << numScanThreads
+                   << " iterators with morsels of " << morselSize << " objects" << std::endl;
+    for (int i = 0; i < numScanThreads; i++) {
+        PDBWorkerPtr worker =
+            server->getFunctionality<HermesExecutionServer>().getWorkers()->getWorker();
+        PDBWorkPtr myWork = make_shared<GenericWork>([&, i, scheduler](PDBBuzzerPtr callerBuzzer) {
+            PageCircularBufferIteratorPtr iter = scanIterators.at(i);
+            while (iter->hasNext()) {
+                PDBPagePtr page = iter->next();
+                if (page != nullptr) {
+                    // the morsels are queued for the i-th pipeline thread, but anyone may steal
+                    Record<Vector<Handle<Object>>>* myRec =
+                        (Record<Vector<Handle<Object>>>*)page->getBytes();
+                    WorkStealingPageIterator::submitMorsels(
+                        scheduler, i, page, myRec->getRootObject()->size(), morselSize);
+                }
+            }
+            scheduler->producerDone();
+            callerBuzzer->buzz(PDBAlarm::WorkAllDone, counter);
+        });
+        worker->execute(myWork, tempBuzzer);
+    }
+}
+
+// to check whether the stage may grow while it runs
+bool PipelineStage::canAddPipelineThreads(HermesExecutionServer* server) {
+    if ((this->jobStage->isProbing() == false) || (this->jobStage->getHashSets() == nullptr)) {
+        return true;
+    }
+    Handle<Map<String, String>> hashSetsToProbe = this->jobStage->getHashSets();
+    for (PDBMapIterator<String, String> mapIter = hashSetsToProbe->begin();
+         mapIter != hashSetsToProbe->end();
+         ++mapIter) {
+        std::string hashSetName = (*mapIter).value;
+        AbstractHashSetPtr hashSet = server->getHashSet(hashSetName);
+        if ((hashSet != nullptr) && (hashSet->getHashSetType() == "PartitionedHashSet")) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // to create a data proxy
 DataProxyPtr PipelineStage::createProxy(int i,
                                         pthread_mutex_t connection_mutex,
@@ -381,6 +447,8 @@ void PipelineStage::executePipelineWork(int i,
 #else
     const UseTemporaryAllocationBlock tempBlock{32 * 1024 * 1024};
 #endif
+    const QueryMemoryReservation tempBlockReservation(memoryAccountant,
+                                                      getBytesAvailableInCurrentAllocatorBlock());
 
     PDB_COUT << i << ": to get compute plan" << std::endl;
     Handle<ComputePlan> plan = this->jobStage->getComputePlan();
@@ -388,6 +456,16 @@ void PipelineStage::executePipelineWork(int i,
     PDB_COUT << i << ": to deep copy ComputePlan object" << std::endl;
     Handle<ComputePlan> newPlan = deepCopyToCurrentAllocationBlock<ComputePlan>(plan);
 
+    // the broadcast variables are not copied with the plan, every thread reads the worker's ones;
+    // we hold on to them until this thread is done, even if the next job replaces them; if one
+    // that the plan requires is missing, the query fails and the pipeline below does not run
+    BroadcastVariableMapPtr broadcastVariables =
+        server->getFunctionality<HermesExecutionServer>().getBroadcastVariables();
+    std::string broadcastErrMsg;
+    if (!newPlan->setBroadcastVariables(broadcastVariables.get(), broadcastErrMsg)) {
+        memoryAccountant->fail(broadcastErrMsg);
+    }
+
     bool isHashPartitionedJoinProbing = false;
     Handle<Computation> computation = nullptr;
     std::vector<std::string> buildTheseTupleSets;
@@ -438,8 +516,8 @@ void PipelineStage::executePipelineWork(int i,
                 unsafeCast<PartitionComp<Object, Object>, Computation>(computation);
             scanner = partitioner->getOutputSetScanner();
         } else {
-            std::cout << "Error: we can't support source computation type "
-                      << computation->getComputationType() << std::endl;
+            PDB_LOG(ERROR) << "Error: we can't support source computation type "
+                           << computation->getComputationType() << std::endl;
             return;
         }
 
@@ -474,8 +552,8 @@ void PipelineStage::executePipelineWork(int i,
         if (pagePointer != nullptr) {
             aggregator->setHashTablePointer(hashSet->getPage(i));
         } else {
-            std::cout << "There is no more hash partition for this thread, we simply return"
-                      << std::endl;
+            PDB_LOG(DEBUG) << "There is no more hash partition for this thread, we simply return"
+                           << std::endl;
             return;
         }
     }
@@ -489,11 +567,11 @@ void PipelineStage::executePipelineWork(int i,
              ++mapIter) {
             std::string key = (*mapIter).key;
             std::string hashSetName = (*mapIter).value;
-            std::cout << "to probe " << key << ":" << hashSetName << std::endl;
+            PDB_LOG(DEBUG) << "to probe " << key << ":" << hashSetName << std::endl;
             AbstractHashSetPtr hashSet = server->getHashSet(hashSetName);
             if (hashSet == nullptr) {
-                std::cout << "ERROR in pipeline execution: data not found in hash set "
-                          << hashSetName << "!" << std::endl;
+                PDB_LOG(ERROR) << "ERROR in pipeline execution: data not found in hash set "
+                               << hashSetName << "!" << std::endl;
                 return;
             }
             if (hashSet->getHashSetType() == "SharedHashSet") {
@@ -506,30 +584,31 @@ void PipelineStage::executePipelineWork(int i,
             }
         }
     } else {
-        std::cout << "info contains nothing for this stage" << std::endl;
+        PDB_LOG(DEBUG) << "info contains nothing for this stage" << std::endl;
         if (this->jobStage->isProbing() == true) {
-            std::cout << "this stage needs probing hash tables" << std::endl;
+            PDB_LOG(DEBUG) << "this stage needs probing hash tables" << std::endl;
         } else {
-            std::cout << "this stage doesn't need probing hash tables" << std :: endl;
+            PDB_LOG(DEBUG) << "this stage doesn't need probing hash tables" << std :: endl;
         }
         if (this->jobStage->getHashSets() != nullptr) {
-            std::cout << "we have hash tables prepared for the stage" << std::endl;
+            PDB_LOG(DEBUG) << "we have hash tables prepared for the stage" << std::endl;
         } else {
-            std::cout << "we don't have hash tables prepared for the stage" << std :: endl;
+            PDB_LOG(DEBUG) << "we don't have hash tables prepared for the stage" << std :: endl;
         }
         if (sourceContext->getSetType() == UserSetType) {
-            std::cout << "this stage has a UserSetType source" << std::endl;
+            PDB_LOG(DEBUG) << "this stage has a UserSetType source" << std::endl;
         } else {
-            std::cout << "this stage doesn't have a UserSetType source" << std :: endl;
+            PDB_LOG(DEBUG) << "this stage doesn't have a UserSetType source" << std :: endl;
         }
     }
 
-    std::cout << "source specifier: " << this->jobStage->getSourceTupleSetSpecifier() << std::endl;
-    std::cout << "target specifier: " << this->jobStage->getTargetTupleSetSpecifier() << std::endl;
-    std::cout << "target computation: " << this->jobStage->getTargetComputationSpecifier()
-             << std::endl;
+    PDB_LOG(DEBUG) << "source specifier: " << this->jobStage->getSourceTupleSetSpecifier() << std::endl;
+    PDB_LOG(DEBUG) << "target specifier: " << this->jobStage->getTargetTupleSetSpecifier() << std::endl;
+    PDB_LOG(DEBUG) << "target computation: " << this->jobStage->getTargetComputationSpecifier()
+                  << std::endl;
 
     Handle<JoinComp<Object, Object, Object>> join = nullptr;
+    std::shared_ptr<void> localAggregationState = nullptr;
     std::string targetSpecifier = jobStage->getTargetComputationSpecifier();
     if (targetSpecifier.find("ClusterAggregationComp") != std::string::npos) {
         Handle<Computation> aggComputation =
@@ -541,14 +620,16 @@ void PipelineStage::executePipelineWork(int i,
         aggregate->setNumNodes(jobStage->getNumNodes());
         aggregate->setNumPartitions(numPartitionsInCluster);
         aggregate->setBatchSize(this->batchSize);
+        localAggregationState = aggregate->setUpLocalExecution(
+            jobStage->getJobId() + "_" + std::to_string(jobStage->getStageId()));
     } else if (targetSpecifier.find("JoinComp") != std::string::npos) {
         Handle<Computation> joinComputation =
             newPlan->getPlan()->getNode(targetSpecifier).getComputationHandle();
         join = unsafeCast<JoinComp<Object, Object, Object>, Computation>(joinComputation);
         join->setNumPartitions(this->jobStage->getNumTotalPartitions());
         join->setNumNodes(this->jobStage->getNumNodes());
-        std::cout << "Join set to have " << join->getNumPartitions() << " partitions" << std::endl;
-        std::cout << "Join set to have " << join->getNumNodes() << " nodes" << std::endl;
+        PDB_LOG(DEBUG) << "Join set to have " << join->getNumPartitions() << " partitions" << std::endl;
+        PDB_LOG(DEBUG) << "Join set to have " << join->getNumNodes() << " nodes" << std::endl;
     } else if (targetSpecifier.find("PartitionComp") != std::string::npos) {
         Handle<Computation> partitionComputation =
             newPlan->getPlan()->getNode(targetSpecifier).getComputationHandle();
@@ -564,9 +645,20 @@ void PipelineStage::executePipelineWork(int i,
     char* mem = nullptr;
     if ((this->jobStage->isRepartition() == true) && (this->jobStage->isCombining() == false) &&
         (join == nullptr)) {
-        mem = (char*)malloc(conf->getNetShufflePageSize());
+        // if the query is out of memory, the pipeline gets no page either and stops at once
+        mem = (char*)memoryAccountant->allocate(conf->getNetShufflePageSize(), "a shuffle buffer");
     }
 #endif
+
+    // the size of the pages that the pipeline allocates itself, i.e. that are not in a user set
+    size_t outputPageSize = conf->getShufflePageSize();
+    if ((this->jobStage->isBroadcasting() == true) ||
+        ((this->jobStage->isRepartition() == true) && (this->jobStage->isCombining() == false) &&
+         (join != nullptr))) {
+        outputPageSize = conf->getBroadcastPageSize();
+    } else if (this->jobStage->isRepartition() == false) {
+        outputPageSize = outputSet->getPageSize();
+    }
     newPlan->nullifyPlanPointer();
     PDBPagePtr output = nullptr;
     PipelinePtr curPipeline = newPlan->buildPipeline(
@@ -585,7 +677,7 @@ void PipelineStage::executePipelineWork(int i,
                                    output);
 
                 if (output == nullptr) {
-                    std::cout << "Pipeline Error: insufficient memory in heap" << std::endl;
+                    PDB_LOG(ERROR) << "Pipeline Error: insufficient memory in heap" << std::endl;
                     return std::make_pair(nullptr, 0);
                 }
                 return std::make_pair(output->getBytes(), output->getSize());
@@ -596,9 +688,11 @@ void PipelineStage::executePipelineWork(int i,
                        (sourceContext->getSetType() != UserSetType)) {
 
                 // TODO: move this to Pangea
-                void* myPage = calloc(outputSet->getPageSize(), 1);
+                void* myPage =
+                    memoryAccountant->allocate(outputSet->getPageSize(), "an output page", true);
                 if (myPage == nullptr) {
-                    std::cout << "Pipeline Error: insufficient memory in heap" << std::endl;
+                    PDB_LOG(ERROR) << "Pipeline Error: insufficient memory in heap" << std::endl;
+                    return std::make_pair(nullptr, 0);
                 }
                 return std::make_pair((char*)myPage + headerSize,
                                       outputSet->getPageSize() - headerSize);
@@ -609,9 +703,11 @@ void PipelineStage::executePipelineWork(int i,
                         (this->jobStage->isCombining() == false) && (join != nullptr))) {
                 // TODO: move this to Pangea
                 // join case
-                void* myPage = calloc(conf->getBroadcastPageSize(), 1);
+                void* myPage =
+                    memoryAccountant->allocate(conf->getBroadcastPageSize(), "a broadcast page", true);
                 if (myPage == nullptr) {
-                    std::cout << "Pipeline Error: insufficient memory in heap" << std::endl;
+                    PDB_LOG(ERROR) << "Pipeline Error: insufficient memory in heap" << std::endl;
+                    return std::make_pair(nullptr, 0);
                 }
                 return std::make_pair((char*)myPage + headerSize, conf->getNetBroadcastPageSize());
 
@@ -619,11 +715,13 @@ void PipelineStage::executePipelineWork(int i,
             } else {
                 // TODO: move this to Pangea
                 // aggregation and partition cases
-                std::cout << "to allocate a page for storing partition sink with size=" 
-                          << conf->getShufflePageSize() << std::endl;
-                void* myPage = calloc(conf->getShufflePageSize(), 1);
+                PDB_LOG(DEBUG) << "to allocate a page for storing partition sink with size=" 
+                               << conf->getShufflePageSize() << std::endl;
+                void* myPage =
+                    memoryAccountant->allocate(conf->getShufflePageSize(), "a shuffle page", true);
                 if (myPage == nullptr) {
-                    std::cout << "Pipeline Error: insufficient memory in heap" << std::endl;
+                    PDB_LOG(ERROR) << "Pipeline Error: insufficient memory in heap" << std::endl;
+                    return std::make_pair(nullptr, 0);
                 }
                 return std::make_pair((char*)myPage + headerSize, conf->getNetShufflePageSize());
             }
@@ -641,8 +739,10 @@ void PipelineStage::executePipelineWork(int i,
                 }
 
             } else {
-                free((char*)page - (sizeof(NodeID) + sizeof(DatabaseID) + sizeof(UserTypeID) +
-                                    sizeof(SetID) + sizeof(PageID) + sizeof(int) + sizeof(size_t)));
+                memoryAccountant->deallocate(
+                    (char*)page - (sizeof(NodeID) + sizeof(DatabaseID) + sizeof(UserTypeID) +
+                                   sizeof(SetID) + sizeof(PageID) + sizeof(int) + sizeof(size_t)),
+                    outputPageSize);
             }
         },
 
@@ -687,15 +787,15 @@ void PipelineStage::executePipelineWork(int i,
                                         outputSet->getSetId(),
                                         record->numBytes(),
                                         record);
-                        pageToBroadcast->decRefCount();
-                        if (pageToBroadcast->getRefCount() == 0) {
+                        if (pageToBroadcast->decRefCount() == 0) {
                             pageToBroadcast->freeContent();
+                            memoryAccountant->release(outputPageSize);
                         }
                     } else {
-                        free((char*)page - headerSize);
+                        memoryAccountant->deallocate((char*)page - headerSize, outputPageSize);
                     }
                 } else {
-                    free((char*)page - headerSize);
+                    memoryAccountant->deallocate((char*)page - headerSize, outputPageSize);
                 }
             } else if ((this->jobStage->isRepartition() == true) &&
                        (this->jobStage->isCombining() == false) && (join != nullptr)) {
@@ -729,10 +829,10 @@ void PipelineStage::executePipelineWork(int i,
                             buffer->addPageToTail(pageToSend);
                         }
                     } else {
-                        free((char*)page - headerSize);
+                        memoryAccountant->deallocate((char*)page - headerSize, outputPageSize);
                     }
                 } else {
-                    free((char*)page - headerSize);
+                    memoryAccountant->deallocate((char*)page - headerSize, outputPageSize);
                 }
 
             } else if ((this->jobStage->isRepartition() == true) &&
@@ -762,7 +862,7 @@ void PipelineStage::executePipelineWork(int i,
             } else if ((this->jobStage->isRepartition() == true) &&
                        (this->jobStage->isCombining() == false) && (join == nullptr)) {
                 // to handle aggregation without combining and partitioning
-                std::cout << "to shuffle data on this page" << std::endl;
+                PDB_LOG(DEBUG) << "to shuffle data on this page" << std::endl;
                 Record<Vector<Handle<Vector<Handle<Object>>>>>* record =
                     (Record<Vector<Handle<Vector<Handle<Object>>>>>*)page;
                 if (record != nullptr) {
@@ -775,8 +875,8 @@ void PipelineStage::executePipelineWork(int i,
 #ifdef REUSE_CONNECTION_FOR_AGG_NO_COMBINER
                         Record<Vector<Handle<Object>>>* myRecord =
                             getRecord(objectToShuffle, mem, conf->getNetShufflePageSize());
-                        std::cout << "send " << myRecord->numBytes() << " bytes to node-" << k
-                                  << std::endl;
+                        PDB_LOG(DEBUG) << "send " << myRecord->numBytes() << " bytes to node-" << k
+                                       << std::endl;
                         if (objectToShuffle != nullptr) {
                             // to shuffle data
                             sendData(connections[k],
@@ -806,7 +906,7 @@ void PipelineStage::executePipelineWork(int i,
 #endif
                     }
                 }
-                free((char*)page - headerSize);
+                memoryAccountant->deallocate((char*)page - headerSize, outputPageSize);
 
             } else {
                 if (sourceContext->getSetType() == UserSetType) {
@@ -823,15 +923,44 @@ void PipelineStage::executePipelineWork(int i,
                     memcpy(output->getBytes(), page, output->getSize());
                     proxy->unpinUserPage(
                         nodeId, output->getDbID(), output->getTypeID(), output->getSetID(), output);
-                    free((char*)page - headerSize);
+                    memoryAccountant->deallocate((char*)page - headerSize, outputPageSize);
                 }
             }
         },
 
         info);
-    std::cout << "\nRunning Pipeline\n";
-    curPipeline->run();
+    curPipeline->setAdaptiveChunkSize(conf->getUseAdaptiveChunkSize(), this->batchSize);
+    PDB_LOG(INFO) << "\nRunning Pipeline\n";
+    if (memoryAccountant->hasFailed() == false) {
+        try {
+            curPipeline->run();
+        } catch (QueryFailure& f) {
+            memoryAccountant->fail(f.what());
+        }
+    }
+    PDB_LOG(INFO) << "Pipeline filled " << curPipeline->getNumOutputPages()
+                  << " output pages, with an average utilization of "
+                  << curPipeline->getOutputPageUtilization();
     curPipeline = nullptr;
+
+    // a query that failed, e.g. because it ran out of memory, stops its pipelines, but the scanner
+    // keeps giving us the pages of the user set, so we unpin the rest of them
+    if ((memoryAccountant->hasFailed() == true) && (sourceContext->getSetType() == UserSetType) &&
+        (computation->getComputationType() != "JoinComp")) {
+        PageCircularBufferIteratorPtr iter = iterators.at(i);
+        PDBPagePtr page = nullptr;
+        size_t begin, end;
+        while (iter->nextRange(page, begin, end)) {
+            if (iter->finishRange()) {
+                proxy->unpinUserPage(page->getNodeID(),
+                                     page->getDbID(),
+                                     page->getTypeID(),
+                                     page->getSetID(),
+                                     page,
+                                     false);
+            }
+        }
+    }
     newPlan->nullifyPlanPointer();
 #ifdef REUSE_CONNECTION_FOR_AGG_NO_COMBINER
     makeObjectAllocatorBlock(4 * 1024 * 1024, true);
@@ -844,7 +973,7 @@ void PipelineStage::executePipelineWork(int i,
                  errMsg);
     }
     if (mem != nullptr) {
-        free(mem);
+        memoryAccountant->deallocate(mem, conf->getNetShufflePageSize());
     }
 #endif
 }
@@ -874,6 +1003,8 @@ void PipelineStage::runPipeline(HermesExecutionServer* server,
 #else
     UseTemporaryAllocationBlock tempBlock{32 * 1024 * 1024};
 #endif
+    const QueryMemoryReservation tempBlockReservation(memoryAccountant,
+                                                      getBytesAvailableInCurrentAllocatorBlock());
     bool success;
     std::string errMsg;
     int numPartitions = 0;
@@ -882,6 +1013,9 @@ void PipelineStage::runPipeline(HermesExecutionServer* server,
     std::vector<PageCircularBufferPtr> sourceBuffers;
     // get user set iterators
     std::vector<PageCircularBufferIteratorPtr> iterators;
+    // if morsels are stolen, the iterators filled by the storage feed this scheduler
+    WorkStealingSchedulerPtr<PageMorsel> pageScheduler = nullptr;
+    std::vector<PageCircularBufferIteratorPtr> scanIterators;
     PartitionedHashSetPtr hashSet;
     Handle<SetIdentifier> sourceContext = this->jobStage->getSourceContext();
 
@@ -915,7 +1049,29 @@ void PipelineStage::runPipeline(HermesExecutionServer* server,
 
     if ((sourceContext->getSetType() == UserSetType) &&
         (computation->getComputationType() != "JoinComp")) {
-        iterators = getUserSetIterators(server, numThreads, success, errMsg);
+        // a scan may tell the storage which pages it can skip
+        Handle<Vector<ColumnRange>> rangeFilter = nullptr;
+        if (computation->getComputationType() == "ScanUserSet") {
+            rangeFilter =
+                unsafeCast<ScanUserSet<Object>, Computation>(computation)->getRangeFilter();
+        }
+        iterators = getUserSetIterators(server, numThreads, success, errMsg, rangeFilter);
+        if (conf->getUseWorkStealing() && !iterators.empty()) {
+            // every pipeline thread takes the morsels queued for it and then steals the others';
+            // we also prepare iterators for the threads that may join while the stage runs
+            pageScheduler = make_shared<WorkStealingScheduler<PageMorsel>>(
+                numThreads, DEFAULT_QUEUED_MORSELS_PER_THREAD * numThreads);
+            scanIterators = iterators;
+            iterators.clear();
+            int maxThreads = std::max(numThreads, conf->getMaxPipelineThreads());
+            for (int i = 0; i < maxThreads; i++) {
+                iterators.push_back(
+                    make_shared<WorkStealingPageIterator>(i, pageScheduler, logger));
+            }
+            for (int i = 0; i < scanIterators.size(); i++) {
+                pageScheduler->addProducer();
+            }
+        }
     } else if ((sourceContext->getSetType() == UserSetType) &&
                (computation->getComputationType() == "JoinComp")) {
         int sourceBufferSize = 2;
@@ -950,22 +1106,23 @@ void PipelineStage::runPipeline(HermesExecutionServer* server,
     if (numPartitions > 0) {
         numSourceThreads = numPartitions;
     }
-    std::cout << "to run pipeline with " << numSourceThreads << " threads." << std::endl;
+    PDB_LOG(INFO) << "to run pipeline with " << numSourceThreads << " threads." << std::endl;
     int counter = 0;
 
-    for (int i = 0; i < numSourceThreads; i++) {
+    // to start the i-th pipeline thread
+    auto launchPipelineThread = [&](int i) {
         PDBWorkerPtr worker =
             server->getFunctionality<HermesExecutionServer>().getWorkers()->getWorker();
         PDB_COUT << "to run the " << i << "-th work..." << std::endl;
-        // TODO: start threads
+        numRunningPipelineThreads++;
         PDBWorkPtr myWork = make_shared<GenericWork>([&, i](PDBBuzzerPtr callerBuzzer) {
 
             std::string out = getAllocator().printInactiveBlocks();
             logger->warn(out);
 #ifdef PROFILING
-            std::cout << "print inactive blocks before running pipeline in this worker:"
-                      << std::endl;
-            std::cout << out << std::endl;
+            PDB_LOG(DEBUG) << "print inactive blocks before running pipeline in this worker:"
+                           << std::endl;
+            PDB_LOG(DEBUG) << out << std::endl;
 #endif
             // create a data proxy
             DataProxyPtr proxy = createProxy(i, connection_mutex, errMsg);
@@ -981,22 +1138,32 @@ void PipelineStage::runPipeline(HermesExecutionServer* server,
             getAllocator().setPolicy(AllocatorPolicy::defaultAllocator);
 #ifdef PROFILING
             out = getAllocator().printInactiveBlocks();
-            std::cout << "print inactive blocks after running pipeline in this worker:"
-                      << std::endl;
-            std::cout << out << std::endl;
+            PDB_LOG(DEBUG) << "print inactive blocks after running pipeline in this worker:"
+                           << std::endl;
+            PDB_LOG(DEBUG) << out << std::endl;
 #endif
+            numRunningPipelineThreads--;
             callerBuzzer->buzz(PDBAlarm::WorkAllDone, counter);
+        });
+        worker->execute(myWork, tempBuzzer);
+    };
 
-        }
+    for (int i = 0; i < numSourceThreads; i++) {
+        launchPipelineThread(i);
+    }
 
-                                                     );
-        worker->execute(myWork, tempBuzzer);
+    // start moving the source pages into the work-stealing scheduler
+    int feederCounter = 0;
+    PDBBuzzerPtr feederBuzzer =
+        make_shared<PDBBuzzer>([&](PDBAlarm myAlarm, int& feederCounter) { feederCounter++; });
+    if (pageScheduler != nullptr) {
+        feedWorkStealingScheduler(server, scanIterators, pageScheduler, feederCounter, feederBuzzer);
     }
 
     if ((sourceContext->getSetType() == UserSetType) &&
         (computation->getComputationType() == "JoinComp")) {
         // start the scanning thread
-        std::cout << "start scanning source set and put pages to source buffers" << std::endl;
+        PDB_LOG(DEBUG) << "start scanning source set and put pages to source buffers" << std::endl;
         sourceCounter = 0;
         sourceBuzzer = make_shared<PDBBuzzer>([&](PDBAlarm myAlarm, int& sourceCounter) {
             sourceCounter++;
@@ -1006,13 +1173,13 @@ void PipelineStage::runPipeline(HermesExecutionServer* server,
         std::vector<PageCircularBufferIteratorPtr> scanIterators =
             getUserSetIterators(server, 1, success, errMsg);
         int numScanThreads = scanIterators.size();
-        std::cout << "we've got " << numScanThreads << " iterators" << std::endl;
+        PDB_LOG(DEBUG) << "we've got " << numScanThreads << " iterators" << std::endl;
         // start multiple thread to scan the set
         for (int i = 0; i < numScanThreads; i++) {
             // each threads get a page and put the page to each source buffer
             PDBWorkerPtr worker =
                 server->getFunctionality<HermesExecutionServer>().getWorkers()->getWorker();
-            std::cout << "to run the " << i << "-th scan work..." << std::endl;
+            PDB_LOG(DEBUG) << "to run the " << i << "-th scan work..." << std::endl;
             // start threads
             PDBWorkPtr myWork = make_shared<GenericWork>([&, i](PDBBuzzerPtr callerBuzzer) {
                 // setup an output page to store intermediate results and final output
@@ -1022,12 +1189,12 @@ void PipelineStage::runPipeline(HermesExecutionServer* server,
                 while (iter->hasNext()) {
                     page = iter->next();
                     if (page != nullptr) {
-                        std::cout << "Scanner got a non-null page" << std::endl;
+                        PDB_LOG(DEBUG) << "Scanner got a non-null page" << std::endl;
                         for (int j = 0; j < numPartitions; j++) {
                             page->incRefCount();
                         }
-                        std::cout << "Initialize join source page reference count to "
-                                  << page->getRefCount() << std::endl;
+                        PDB_LOG(DEBUG) << "Initialize join source page reference count to "
+                                       << page->getRefCount() << std::endl;
                         for (int j = 0; j < numPartitions; j++) {
                             sourceBuffers[j]->addPageToTail(page);
                         }
@@ -1043,7 +1210,7 @@ void PipelineStage::runPipeline(HermesExecutionServer* server,
             sourceBuzzer->wait();
         }
         sourceCounter = 0;
-        std::cout << "Scanned all pages, now we close all source buffers" << std::endl;
+        PDB_LOG(DEBUG) << "Scanned all pages, now we close all source buffers" << std::endl;
 
         for (int i = 0; i < numPartitions; i++) {
             PageCircularBufferPtr buffer = sourceBuffers[i];
@@ -1051,10 +1218,35 @@ void PipelineStage::runPipeline(HermesExecutionServer* server,
         }
     }
 
-    while (counter < numSourceThreads) {
+    // while morsels pile up, the stage takes the cores that no other stage is using
+    int numLaunchedThreads = numSourceThreads;
+    if ((pageScheduler != nullptr) && canAddPipelineThreads(server)) {
+        while (counter < numLaunchedThreads) {
+            if ((numLaunchedThreads < (int)iterators.size()) &&
+                (pageScheduler->getNumQueued() > (size_t)numLaunchedThreads) &&
+                (numRunningPipelineThreads < conf->getMaxPipelineThreads())) {
+                PDB_LOG(DEBUG) << "to add the " << numLaunchedThreads << "-th pipeline thread"
+                               << std::endl;
+                launchPipelineThread(numLaunchedThreads);
+                numLaunchedThreads++;
+            } else {
+                tempBuzzer->waitFor(DEFAULT_PARALLELISM_CHECK_INTERVAL_MS);
+            }
+        }
+    }
+
+    while (counter < numLaunchedThreads) {
         tempBuzzer->wait();
     }
 
+    if (pageScheduler != nullptr) {
+        while (feederCounter < scanIterators.size()) {
+            feederBuzzer->wait();
+        }
+        PDB_LOG(INFO) << pageScheduler->getNumStolen() << " source morsels were stolen, "
+                      << numLaunchedThreads << " threads ran the pipeline" << std::endl;
+    }
+
     counter = 0;
     pthread_mutex_destroy(&connection_mutex);
 
@@ -1062,7 +1254,7 @@ void PipelineStage::runPipeline(HermesExecutionServer* server,
     if (server->getFunctionality<HermesExecutionServer>().setCurPageScanner(nullptr) == false) {
         success = false;
         errMsg = "Error: No job is running!";
-        std::cout << errMsg << std::endl;
+        PDB_LOG(ERROR) << errMsg << std::endl;
         return;
     }
 
@@ -1091,12 +1283,12 @@ void PipelineStage::runPipelineWithShuffleSink(HermesExecutionServer* server) {
 #endif
     if (memSize * ((size_t)(1024)) <
         sharedMemPoolSize + (size_t)512 * (size_t)1024 * (size_t)1024) {
-        std::cout << "WARNING: Auto tuning can not work for this case, we use default value"
-                  << std::endl;
+        PDB_LOG(WARN) << "WARNING: Auto tuning can not work for this case, we use default value"
+                      << std::endl;
         tunedHashPageSize = conf->getHashPageSize();
     }
 
-    std::cout << "Tuned combiner page size is " << tunedHashPageSize << std::endl;
+    PDB_LOG(INFO) << "Tuned combiner page size is " << tunedHashPageSize << std::endl;
     conf->setHashPageSize(tunedHashPageSize);
 #endif
 
@@ -1139,8 +1331,8 @@ void PipelineStage::runPipelineWithShuffleSink(HermesExecutionServer* server) {
             std::string out = getAllocator().printInactiveBlocks();
             logger->warn(out);
 #ifdef PROFILING
-            std::cout << "inactive blocks before running combiner in this worker:" << std::endl;
-            std::cout << out << std::endl;
+            PDB_LOG(DEBUG) << "inactive blocks before running combiner in this worker:" << std::endl;
+            PDB_LOG(DEBUG) << out << std::endl;
 #endif
             getAllocator().setPolicy(noReuseAllocator);
 
@@ -1181,6 +1373,8 @@ void PipelineStage::runPipelineWithShuffleSink(HermesExecutionServer* server) {
 #else
             const UseTemporaryAllocationBlock tempBlock{32 * 1024 * 1024};
 #endif
+            const QueryMemoryReservation tempBlockReservation(memoryAccountant,
+                                                              getBytesAvailableInCurrentAllocatorBlock());
             Handle<ComputePlan> plan = this->jobStage->getComputePlan();
             plan->nullifyPlanPointer();
             PDB_COUT << i << ": to deep copy ComputePlan object" << std::endl;
@@ -1206,21 +1400,28 @@ void PipelineStage::runPipelineWithShuffleSink(HermesExecutionServer* server) {
             if (myCombinerPageSize > conf->getShufflePageSize() - 64) {
                 myCombinerPageSize = conf->getShufflePageSize() - 64;
             }
-            void* combinerPage = (void*)calloc(myCombinerPageSize, sizeof(char));
+            void* combinerPage =
+                memoryAccountant->allocate(myCombinerPageSize, "a combiner page", true);
             if (combinerPage == nullptr) {
-                std::cout << "Fatal Error: insufficient memory can be allocated from memory"
-                          << std::endl;
-                exit(-1);
+                PDB_LOG(ERROR) << "Fatal Error: insufficient memory can be allocated from memory"
+                               << std::endl;
+            } else {
+                PDB_LOG(DEBUG) << i << ": load a combiner page with size = " << myCombinerPageSize
+                               << std::endl;
+                combinerProcessor->loadOutputPage(combinerPage, myCombinerPageSize);
             }
-            std::cout << i << ": load a combiner page with size = " << myCombinerPageSize
-                      << std::endl;
-            combinerProcessor->loadOutputPage(combinerPage, myCombinerPageSize);
 
             PageCircularBufferIteratorPtr myIter = combinerIters[i];
             int numPages = 0;
             while (myIter->hasNext()) {
                 PDBPagePtr page = myIter->next();
-                if (page != nullptr) {
+                if ((page != nullptr) && (combinerPage == nullptr)) {
+                    // the query is out of memory, we only free the rest of the pages
+                    if (page->decRefCount() == 0) {
+                        page->freeContent();
+                        memoryAccountant->release(conf->getShufflePageSize());
+                    }
+                } else if (page != nullptr) {
                     // to load input page
                     numPages++;
                     combinerProcessor->loadInputPage(page->getBytes());
@@ -1242,9 +1443,9 @@ void PipelineStage::runPipelineWithShuffleSink(HermesExecutionServer* server) {
                         size_t compressedSize;
                         snappy::RawCompress(
                             (char*)record, record->numBytes(), compressedBytes, &compressedSize);
-                        std::cout << "size before compression is " << record->numBytes()
-                                  << " and size after compression is " << compressedSize
-                                  << std::endl;
+                        PDB_LOG(DEBUG) << "size before compression is " << record->numBytes()
+                                       << " and size after compression is " << compressedSize
+                                       << std::endl;
                         this->storeCompressedShuffleData(
                             compressedBytes,
                             compressedSize,
@@ -1260,67 +1461,71 @@ void PipelineStage::runPipelineWithShuffleSink(HermesExecutionServer* server) {
 
                         // free the output page
                         combinerProcessor->clearOutputPage();
-                        free(combinerPage);
+                        memoryAccountant->deallocate(combinerPage, myCombinerPageSize);
                         // allocate a new page
-                        combinerPage = (void*)malloc(myCombinerPageSize * sizeof(char));
+                        combinerPage =
+                            memoryAccountant->allocate(myCombinerPageSize, "a combiner page");
                         if (combinerPage == nullptr) {
-                            std::cout
-                                << "Fatal Error: insufficient memory can be allocated from memory"
-                                << std::endl;
-                            exit(-1);
+                            PDB_LOG(ERROR)
+                                     << "Fatal Error: insufficient memory can be allocated from memory"
+                                     << std::endl;
+                            break;
                         }
-                        std::cout << "load a combiner page with size = " << myCombinerPageSize
-                                  << std::endl;
+                        PDB_LOG(DEBUG) << "load a combiner page with size = " << myCombinerPageSize
+                                       << std::endl;
                         // load the new page as output vector
                         combinerProcessor->loadOutputPage(combinerPage, myCombinerPageSize);
                     }
                     // unpin the input page
                     // combinerProcessor->clearInputPage();
-                    page->decRefCount();
-                    if (page->getRefCount() == 0) {
+                    if (page->decRefCount() == 0) {
                         page->freeContent();
+                        memoryAccountant->release(conf->getShufflePageSize());
                     }
                 }
             }
-            combinerProcessor->finalize();
-            combinerProcessor->fillNextOutputPage();
-            // send the output page
-            PDB_COUT << "processed " << numPages << " pages" << std::endl;
-            Record<Vector<Handle<Object>>>* record = (Record<Vector<Handle<Object>>>*)combinerPage;
+            // a combiner that ran out of memory has nothing to send
+            if (combinerPage != nullptr) {
+                combinerProcessor->finalize();
+                combinerProcessor->fillNextOutputPage();
+                // send the output page
+                PDB_COUT << "processed " << numPages << " pages" << std::endl;
+                Record<Vector<Handle<Object>>>* record = (Record<Vector<Handle<Object>>>*)combinerPage;
 #ifndef ENABLE_COMPRESSION
-            this->storeShuffleData(record->getRootObject(),
-                                   this->jobStage->getSinkContext()->getDatabase(),
-                                   this->jobStage->getSinkContext()->getSetName(),
-                                   address,
-                                   port,
-                                   false,
-                                   errMsg);
+                this->storeShuffleData(record->getRootObject(),
+                                       this->jobStage->getSinkContext()->getDatabase(),
+                                       this->jobStage->getSinkContext()->getSetName(),
+                                       address,
+                                       port,
+                                       false,
+                                       errMsg);
 #else
-            char* compressedBytes = new char[snappy::MaxCompressedLength(record->numBytes())];
-            size_t compressedSize;
-            snappy::RawCompress(
-                (char*)record, record->numBytes(), compressedBytes, &compressedSize);
-            std::cout << "size before compression is " << record->numBytes()
-                      << " and size after compression is " << compressedSize << std::endl;
-            this->storeCompressedShuffleData(compressedBytes,
-                                             compressedSize,
-                                             this->jobStage->getSinkContext()->getDatabase(),
-                                             this->jobStage->getSinkContext()->getSetName(),
-                                             address,
-                                             port,
-                                             errMsg);
-            delete[] compressedBytes;
+                char* compressedBytes = new char[snappy::MaxCompressedLength(record->numBytes())];
+                size_t compressedSize;
+                snappy::RawCompress(
+                    (char*)record, record->numBytes(), compressedBytes, &compressedSize);
+                PDB_LOG(DEBUG) << "size before compression is " << record->numBytes()
+                               << " and size after compression is " << compressedSize << std::endl;
+                this->storeCompressedShuffleData(compressedBytes,
+                                                 compressedSize,
+                                                 this->jobStage->getSinkContext()->getDatabase(),
+                                                 this->jobStage->getSinkContext()->getSetName(),
+                                                 address,
+                                                 port,
+                                                 errMsg);
+                delete[] compressedBytes;
 
 #endif
 
-            // free the output page
-            combinerProcessor->clearOutputPage();
-            free(combinerPage);
+                // free the output page
+                combinerProcessor->clearOutputPage();
+                memoryAccountant->deallocate(combinerPage, myCombinerPageSize);
+            }
             getAllocator().setPolicy(defaultAllocator);
 #ifdef PROFILING
             out = getAllocator().printInactiveBlocks();
-            std::cout << "inactive blocks after running combiner in this worker:" << std::endl;
-            std::cout << out << std::endl;
+            PDB_LOG(DEBUG) << "inactive blocks after running combiner in this worker:" << std::endl;
+            PDB_LOG(DEBUG) << out << std::endl;
 #endif
             getAllocator().cleanInactiveBlocks((size_t)((size_t)32 * (size_t)1024 * (size_t)1024));
             getAllocator().cleanInactiveBlocks((size_t)((size_t)128 * (size_t)1024 * (size_t)1024));
@@ -1401,11 +1606,13 @@ void PipelineStage::runPipelineWithBroadcastSink(HermesExecutionServer* server)
                 return;
             }
             UseTemporaryAllocationBlock tempBlock{2 * 1024 * 1024};
+            const QueryMemoryReservation tempBlockReservation(memoryAccountant,
+                                                              getBytesAvailableInCurrentAllocatorBlock());
             std::string out = getAllocator().printInactiveBlocks();
             logger->warn(out);
 #ifdef PROFILING
-            std::cout << "inactive blocks before sending data in this worker:" << std::endl;
-            std::cout << out << std::endl;
+            PDB_LOG(DEBUG) << "inactive blocks before sending data in this worker:" << std::endl;
+            PDB_LOG(DEBUG) << out << std::endl;
 #endif
 
             std::string errMsg;
@@ -1439,14 +1646,14 @@ void PipelineStage::runPipelineWithBroadcastSink(HermesExecutionServer* server)
                              jobStage->getSinkContext()->getSetName(),
                              errMsg);
                     // unpin the input page
-                    page->decRefCount();
-                    if (page->getRefCount() == 0) {
+                    if (page->decRefCount() == 0) {
                         page->freeContent();
+                        memoryAccountant->release(conf->getBroadcastPageSize());
                     }
                 }
             }
-            std::cout << "broadcasted " << numPages << " pages to address: " << address
-                      << std::endl;
+            PDB_LOG(INFO) << "broadcasted " << numPages << " pages to address: " << address
+                          << std::endl;
             sendData(communicator,
                      nullptr,
                      DEFAULT_NET_PAGE_SIZE,
@@ -1455,8 +1662,8 @@ void PipelineStage::runPipelineWithBroadcastSink(HermesExecutionServer* server)
                      errMsg);
 #ifdef PROFILING
             out = getAllocator().printInactiveBlocks();
-            std::cout << "inactive blocks after sending data in this worker:" << std::endl;
-            std::cout << out << std::endl;
+            PDB_LOG(DEBUG) << "inactive blocks after sending data in this worker:" << std::endl;
+            PDB_LOG(DEBUG) << out << std::endl;
 #endif
             getAllocator().cleanInactiveBlocks((size_t)((size_t)32 * (size_t)1024 * (size_t)1024));
             getAllocator().cleanInactiveBlocks((size_t)((size_t)128 * (size_t)1024 * (size_t)1024));
@@ -1533,11 +1740,13 @@ void PipelineStage::runPipelineWithHashPartitionSink(HermesExecutionServer* serv
         // start threads
         PDBWorkPtr myWork = make_shared<GenericWork>([&, i](PDBBuzzerPtr callerBuzzer) {
             UseTemporaryAllocationBlock tempBlock{32 * 1024 * 1024};
+            const QueryMemoryReservation tempBlockReservation(memoryAccountant,
+                                                              getBytesAvailableInCurrentAllocatorBlock());
             std::string out = getAllocator().printInactiveBlocks();
             logger->warn(out);
 #ifdef PROFILING
-            std::cout << "inactive blocks before sending data in this worker:" << std::endl;
-            std::cout << out << std::endl;
+            PDB_LOG(DEBUG) << "inactive blocks before sending data in this worker:" << std::endl;
+            PDB_LOG(DEBUG) << out << std::endl;
 #endif
 
             // to combine data for node-i
@@ -1583,13 +1792,27 @@ void PipelineStage::runPipelineWithHashPartitionSink(HermesExecutionServer* serv
             Handle<Object> myMaps = nullptr;
             while (myIter->hasNext()) {
                 PDBPagePtr page = myIter->next();
-                if (page != nullptr) {
+                if ((page != nullptr) && (memoryAccountant->hasFailed() == true)) {
+                    // the query is out of memory, we only free the rest of the pages
+                    if (page->decRefCount() == 0) {
+                        page->freeContent();
+                        memoryAccountant->release(conf->getBroadcastPageSize());
+                    }
+                } else if (page != nullptr) {
                     // to load output page
                     if (output == nullptr) {
                         //use broadcastPageSize for broadcast join and hash partition join
-                        output = (char*)calloc(conf->getNetBroadcastPageSize(), 1);
+                        output = (char*)memoryAccountant->allocate(
+                            conf->getNetBroadcastPageSize(), "a hash partition page", true);
+                        if (output == nullptr) {
+                            if (page->decRefCount() == 0) {
+                                page->freeContent();
+                                memoryAccountant->release(conf->getBroadcastPageSize());
+                            }
+                            continue;
+                        }
                         makeObjectAllocatorBlock(output, conf->getNetBroadcastPageSize(), true);
-                        std::cout << getAllocator().printCurrentBlock() << std::endl;
+                        PDB_LOG(DEBUG) << getAllocator().printCurrentBlock() << std::endl;
                         myMaps = shuffler->createNewOutputContainer();
                     }
                     // get the vector corresponding to the i-th node
@@ -1615,13 +1838,13 @@ void PipelineStage::runPipelineWithHashPartitionSink(HermesExecutionServer* serv
                                     size_t numBytes = myRecord->numBytes();
                                     char* sendBuffer = (char*)malloc(numBytes);
                                     if (sendBuffer == nullptr) {
-                                        std::cout << "Out of memory on heap" << std::endl;
+                                        PDB_LOG(ERROR) << "Out of memory on heap" << std::endl;
                                         exit(-1);
                                     }
                                     memcpy(sendBuffer, output, numBytes);
                                     if (i != myNodeId) {
-                                        std::cout << getAllocator().printCurrentBlock()
-                                                  << std::endl;
+                                        PDB_LOG(DEBUG) << getAllocator().printCurrentBlock()
+                                                       << std::endl;
                                         makeObjectAllocatorBlock(128 * 1024, true);
 
                                         sendData(communicator,
@@ -1643,7 +1866,12 @@ void PipelineStage::runPipelineWithHashPartitionSink(HermesExecutionServer* serv
                                     numPages++;
                                     // free the output page and reload a new output page
                                     myMaps = nullptr;
-                                    buffer = (char*)calloc(conf->getNetBroadcastPageSize(), 1);
+                                    buffer = (char*)memoryAccountant->allocate(
+                                        conf->getNetBroadcastPageSize(), "a hash partition page", true);
+                                    if (buffer == nullptr) {
+                                        // the query is out of memory, we only free the rest of the pages
+                                        break;
+                                    }
                                     makeObjectAllocatorBlock(buffer, conf->getNetBroadcastPageSize(), true);
                                     // redo for current map;
                                     myMaps = shuffler->createNewOutputContainer();
@@ -1652,38 +1880,38 @@ void PipelineStage::runPipelineWithHashPartitionSink(HermesExecutionServer* serv
                             }
                             numMaps++;
                             if ((output != nullptr) && (buffer != nullptr) && (output != buffer)) {
-                                free(output);
+                                memoryAccountant->deallocate(output, conf->getNetBroadcastPageSize());
                                 output = buffer;
                             }
                         }  // for
 
                     }  // if (record != nullptr)
                     // unpin the input page
-                    page->decRefCount();
-                    if (page->getRefCount() == 0) {
+                    if (page->decRefCount() == 0) {
                         page->freeContent();
+                        memoryAccountant->release(conf->getBroadcastPageSize());
                     }
                 }  // if
             }      // while
             // send out the page
             out = getAllocator().printInactiveBlocks();
-            std::cout << "inactive blocks before sending data in this worker:" << std::endl;
-            std::cout << out << std::endl;
+            PDB_LOG(DEBUG) << "inactive blocks before sending data in this worker:" << std::endl;
+            PDB_LOG(DEBUG) << out << std::endl;
             if (myMaps != nullptr) {
                 getRecord(myMaps);
                 Record<Object>* myRecord = (Record<Object>*)output;
                 size_t numBytes = myRecord->numBytes();
                 char* sendBuffer = (char*)malloc(numBytes);
                 if (sendBuffer == nullptr) {
-                    std::cout << "Out of memory on heap" << std::endl;
+                    PDB_LOG(ERROR) << "Out of memory on heap" << std::endl;
                     exit(-1);
                 }
                 memcpy(sendBuffer, output, numBytes);
                 out = getAllocator().printInactiveBlocks();
-                std::cout << "inactive blocks before sending data in this worker:" << std::endl;
-                std::cout << out << std::endl;
+                PDB_LOG(DEBUG) << "inactive blocks before sending data in this worker:" << std::endl;
+                PDB_LOG(DEBUG) << out << std::endl;
                 if (i != myNodeId) {
-                    std::cout << getAllocator().printCurrentBlock() << std::endl;
+                    PDB_LOG(DEBUG) << getAllocator().printCurrentBlock() << std::endl;
                     makeObjectAllocatorBlock(128 * 1024, true);
                     sendData(communicator,
                              sendBuffer,
@@ -1705,12 +1933,12 @@ void PipelineStage::runPipelineWithHashPartitionSink(HermesExecutionServer* serv
                 myMaps = nullptr;
             }
             if (output != nullptr) {
-                free(output);
+                memoryAccountant->deallocate(output, conf->getNetBroadcastPageSize());
                 output = nullptr;
             }
-            std::cout << "HashPartitioned " << numPages << " pages to address: " << address
-                      << std::endl;
-            std::cout << numMaps << " maps are written in total for partition-" << i << std::endl;
+            PDB_LOG(INFO) << "HashPartitioned " << numPages << " pages to address: " << address
+                          << std::endl;
+            PDB_LOG(INFO) << numMaps << " maps are written in total for partition-" << i << std::endl;
             if (i != myNodeId) {
                 makeObjectAllocatorBlock(128 * 1024, true);
                 sendData(communicator,
@@ -1722,8 +1950,8 @@ void PipelineStage::runPipelineWithHashPartitionSink(HermesExecutionServer* serv
             }
 #ifdef PROFILING
             out = getAllocator().printInactiveBlocks();
-            std::cout << "inactive blocks after sending data in this worker:" << std::endl;
-            std::cout << out << std::endl;
+            PDB_LOG(DEBUG) << "inactive blocks after sending data in this worker:" << std::endl;
+            PDB_LOG(DEBUG) << out << std::endl;
 #endif
             getAllocator().cleanInactiveBlocks((size_t)((size_t)32 * (size_t)1024 * (size_t)1024));
             getAllocator().cleanInactiveBlocks((size_t)((size_t)128 * (size_t)1024 * (size_t)1024));
@@ -0,0 +1,227 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef QUERY_MEMORY_ACCOUNTANT_CC
+#define QUERY_MEMORY_ACCOUNTANT_CC
+
+#include "QueryMemoryAccountant.h"
+#include "LockGuard.h"
+#include "PDBDebug.h"
+#include <algorithm>
+#include <cstdlib>
+#include <sys/time.h>
+
+// a reservation that waits for memory also checks this often whether other queries gave some back
+#define MEMORY_WAIT_SLICE_MS 10
+
+namespace pdb {
+
+std::atomic<size_t> QueryMemoryAccountant::nodeUsedBytes(0);
+
+QueryMemoryAccountant::QueryMemoryAccountant(std::string jobId,
+                                             size_t queryLimit,
+                                             size_t nodeLimit,
+                                             unsigned int spillWaitMs)
+    : jobId(jobId),
+      queryLimit(queryLimit),
+      nodeLimit(nodeLimit),
+      spillWaitMs(spillWaitMs),
+      usedBytes(0),
+      peakBytes(0),
+      failed(false),
+      numWaiting(0) {
+    pthread_mutex_init(&waitingMutex, nullptr);
+    pthread_cond_init(&waitingSignal, nullptr);
+}
+
+QueryMemoryAccountant::~QueryMemoryAccountant() {
+    nodeUsedBytes -= usedBytes;
+    pthread_cond_destroy(&waitingSignal);
+    pthread_mutex_destroy(&waitingMutex);
+}
+
+bool QueryMemoryAccountant::tryReserve(size_t numBytes) {
+
+    // first the query, then the node, so that a query over its own limit never takes the node's
+    size_t used = usedBytes;
+    do {
+        if (queryLimit != 0 && used + numBytes > queryLimit) {
+            return false;
+        }
+    } while (!usedBytes.compare_exchange_weak(used, used + numBytes));
+
+    size_t usedOnNode = nodeUsedBytes;
+    do {
+        if (nodeLimit != 0 && usedOnNode + numBytes > nodeLimit) {
+            usedBytes -= numBytes;
+            return false;
+        }
+    } while (!nodeUsedBytes.compare_exchange_weak(usedOnNode, usedOnNode + numBytes));
+
+    size_t peak = peakBytes;
+    while (used + numBytes > peak && !peakBytes.compare_exchange_weak(peak, used + numBytes)) {
+    }
+    return true;
+}
+
+bool QueryMemoryAccountant::reserve(size_t numBytes, const std::string& what) {
+
+    if (failed) {
+        return false;
+    }
+    if (tryReserve(numBytes)) {
+        return true;
+    }
+
+    // the pages that other threads of the query write out are freed soon, so we wait for them
+    // before we give up; release () wakes us when it sees that somebody is waiting
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    long long deadline = now.tv_sec * 1000LL + now.tv_usec / 1000 + spillWaitMs;
+    bool reserved = false;
+    {
+        const LockGuard guard{waitingMutex};
+        numWaiting++;
+        while (!failed) {
+            if (tryReserve(numBytes)) {
+                reserved = true;
+                break;
+            }
+            gettimeofday(&now, nullptr);
+            long long millis = now.tv_sec * 1000LL + now.tv_usec / 1000;
+            if (millis >= deadline) {
+                break;
+            }
+            long long waitMs = std::min(deadline - millis, (long long)MEMORY_WAIT_SLICE_MS);
+            long nanos = now.tv_usec * 1000L + waitMs * 1000000L;
+            struct timespec wakeUp;
+            wakeUp.tv_sec = now.tv_sec + nanos / 1000000000L;
+            wakeUp.tv_nsec = nanos % 1000000000L;
+            pthread_cond_timedwait(&waitingSignal, &waitingMutex, &wakeUp);
+        }
+        numWaiting--;
+    }
+    if (!reserved) {
+        fail(numBytes, what);
+    }
+    return reserved;
+}
+
+void QueryMemoryAccountant::fail(size_t numBytes, const std::string& what) {
+
+    const LockGuard guard{waitingMutex};
+    if (!failed) {
+        size_t used = usedBytes;
+        if (queryLimit != 0 && used + numBytes > queryLimit) {
+            errMsg = "Query " + jobId + " ran out of memory: it needs " +
+                std::to_string(numBytes) + " bytes for " + what + ", but it holds " +
+                std::to_string(used) + " of its limit of " + std::to_string(queryLimit) + " bytes";
+        } else if (nodeLimit != 0 && nodeUsedBytes + numBytes > nodeLimit) {
+            errMsg = "Query " + jobId + " ran out of memory: it needs " +
+                std::to_string(numBytes) + " bytes for " + what + ", but the queries on this " +
+                "worker hold " + std::to_string(nodeUsedBytes) + " of the worker's limit of " +
+                std::to_string(nodeLimit) + " bytes";
+        } else {
+            errMsg = "Query " + jobId + " ran out of memory: the heap has no " +
+                std::to_string(numBytes) + " bytes for " + what;
+        }
+        PDB_LOG(ERROR) << errMsg;
+        failed = true;
+    }
+
+    // the other reservations that wait give up as well
+    pthread_cond_broadcast(&waitingSignal);
+}
+
+void QueryMemoryAccountant::fail(const std::string& errMsg) {
+
+    const LockGuard guard{waitingMutex};
+    if (!failed) {
+        this->errMsg = "Query " + jobId + " failed: " + errMsg;
+        PDB_LOG(ERROR) << this->errMsg;
+        failed = true;
+    }
+    pthread_cond_broadcast(&waitingSignal);
+}
+
+void QueryMemoryAccountant::charge(size_t numBytes) {
+    size_t used = (usedBytes += numBytes);
+    nodeUsedBytes += numBytes;
+    size_t peak = peakBytes;
+    while (used > peak && !peakBytes.compare_exchange_weak(peak, used)) {
+    }
+}
+
+void QueryMemoryAccountant::release(size_t numBytes) {
+    usedBytes -= numBytes;
+    nodeUsedBytes -= numBytes;
+
+    // a waiting reservation counts itself before it tries, so either it sees what we gave back, or
+    // we see it and wake it up
+    if (numWaiting > 0) {
+        const LockGuard guard{waitingMutex};
+        pthread_cond_broadcast(&waitingSignal);
+    }
+}
+
+void* QueryMemoryAccountant::allocate(size_t numBytes, const std::string& what, bool zeroed) {
+    if (!reserve(numBytes, what)) {
+        return nullptr;
+    }
+    void* bytes = zeroed ? calloc(numBytes, 1) : malloc(numBytes);
+    if (bytes == nullptr) {
+        release(numBytes);
+        fail(numBytes, what);
+    }
+    return bytes;
+}
+
+void QueryMemoryAccountant::deallocate(void* bytes, size_t numBytes) {
+    if (bytes != nullptr) {
+        free(bytes);
+        release(numBytes);
+    }
+}
+
+std::string QueryMemoryAccountant::getJobId() {
+    return jobId;
+}
+
+size_t QueryMemoryAccountant::getUsedBytes() {
+    return usedBytes;
+}
+
+size_t QueryMemoryAccountant::getPeakBytes() {
+    return peakBytes;
+}
+
+bool QueryMemoryAccountant::hasFailed() {
+    return failed;
+}
+
+std::string QueryMemoryAccountant::getErrMsg() {
+    const LockGuard guard{waitingMutex};
+    return errMsg;
+}
+
+size_t QueryMemoryAccountant::getNodeUsedBytes() {
+    return nodeUsedBytes;
+}
+}
+
+#endif
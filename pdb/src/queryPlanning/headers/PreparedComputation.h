@@ -0,0 +1,103 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef PREPARED_COMPUTATION_H
+#define PREPARED_COMPUTATION_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "AbstractJobStage.h"
+#include "Computation.h"
+#include "InterfaceFunctions.h"
+#include "PDBVector.h"
+#include "Record.h"
+#include "SetIdentifier.h"
+
+// the space we first try to serialize a round of job stages into, it is doubled until they fit
+#define PREPARED_ROUND_INITIAL_SIZE (1024 * 1024)
+
+namespace pdb {
+
+// the job stages the physical optimizer generated for one round of a prepared computation
+struct PreparedRound {
+
+  // the stages, with their compute plans and aggregation computations taken out
+  std::shared_ptr<Record<Vector<Handle<AbstractJobStage>>>> stages;
+
+  // the intermediate sets the stages need
+  std::shared_ptr<Record<Vector<Handle<SetIdentifier>>>> intermediateSets;
+
+  // for each stage the index of the computation it aggregates with, -1 if it does not aggregate
+  std::vector<int> aggComputations;
+
+  // for each intermediate set true if a later round still reads it, so it can not be removed yet
+  std::vector<bool> keepIntermediateSets;
+};
+
+// a computation graph prepared under a name: it is kept here, the first execution plans it as usual
+// and records the job stages of every round, later executions only bind a copy of the computations
+// to those stages
+class PreparedComputation {
+
+public:
+  PreparedComputation(const std::string &tcap, Handle<Vector<Handle<Computation>>> &computations)
+      : tcap(tcap), computations(toRecord(computations)) {
+    pthread_mutex_init(&executionLock, nullptr);
+  }
+
+  ~PreparedComputation() {
+    pthread_mutex_destroy(&executionLock);
+  }
+
+  // returns true once the job stages were recorded
+  bool isPlanned() {
+    return !jobId.empty();
+  }
+
+  // copies an object to its own malloced Record, the Record is freed with the last shared pointer
+  template <class ObjType>
+  static std::shared_ptr<Record<ObjType>> toRecord(Handle<ObjType> &object) {
+    Record<ObjType> *record = getMallocedRecord(object, PREPARED_ROUND_INITIAL_SIZE);
+    return std::shared_ptr<Record<ObjType>>(record, [](Record<ObjType> *toFree) { free(toFree); });
+  }
+
+  // the TCAP program of the computations
+  std::string tcap;
+
+  // the computations, every execution plans or binds its own copy of them
+  std::shared_ptr<Record<Vector<Handle<Computation>>>> computations;
+
+  // the job the stages were planned for, its database holds the intermediate sets; empty until
+  // the first execution recorded the stages
+  std::string jobId;
+
+  // the recorded rounds, in the order they have to be scheduled
+  std::vector<PreparedRound> rounds;
+
+  // held while the computation runs, the recorded stages and the job database are not shared
+  pthread_mutex_t executionLock;
+};
+
+typedef std::shared_ptr<PreparedComputation> PreparedComputationPtr;
+}
+
+#endif
@@ -77,6 +77,12 @@ private:
                                 std::vector<std::string>& nodesContainingSet,
                                 std::string& errMsg);
 
+    // finds the nodes a scan of the set has to visit, each one as "address:port"
+    bool findNodesToScan(const std::string& databaseName,
+                         const std::string& setName,
+                         std::vector<std::string>& nodesToScan,
+                         std::string& errMsg);
+
     std::function<void(Handle<SimpleRequestResult>, std::string)> generateAckHandler(
         std::vector<std::string>& success, std::vector<std::string>& failures, mutex& lock);
 };
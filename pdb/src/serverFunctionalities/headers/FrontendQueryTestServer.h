@@ -22,6 +22,8 @@
 #include "ServerFunctionality.h"
 #include "QueryBase.h"
 #include "PDBServer.h"
+#include "SetIdentifier.h"
+#include "SimpleRequestResult.h"
 
 namespace pdb {
 
@@ -52,6 +54,16 @@ private:
     // this actually computes a selection query
     void doSelection(std::string setOutputName, Handle<QueryBase>& computeMe);
 
+    // starts measuring a job stage, returns the bytes shuffled to this node so far
+    size_t startStageStats();
+
+    // passes on the bytes shuffled to this node during a job stage and its peak shared memory use,
+    // how much memory the job has held on the backend, and why the stage failed there, if it did,
+    // in the set that the stage returns to the scheduler
+    void setStageResult(Handle<SetIdentifier> result,
+                        size_t shuffledBytesAtStageStart,
+                        Handle<SimpleRequestResult> backendResult);
+
     int tempSetName;
 
     bool isStandalone;
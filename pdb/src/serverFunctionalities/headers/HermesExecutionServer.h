@@ -25,6 +25,10 @@
 #include "PageScanner.h"
 #include "DataTypes.h"
 #include "HashSetManager.h"
+#include "BroadcastVariableMap.h"
+#include "QueryMemoryAccountant.h"
+#include "SimpleRequestResult.h"
+#include "LockGuard.h"
 #include <string>
 
 namespace pdb {
@@ -62,6 +66,8 @@ public:
         this->curScanner = nullptr;
         this->logger = logger;
         this->workers = workers;
+        pthread_mutex_init(&broadcastVariablesMutex, nullptr);
+        pthread_mutex_init(&memoryAccountantMutex, nullptr);
     }
 
     // set the configuration instance;
@@ -145,7 +151,10 @@ public:
     }
 
     // destructor
-    ~HermesExecutionServer() {}
+    ~HermesExecutionServer() {
+        pthread_mutex_destroy(&broadcastVariablesMutex);
+        pthread_mutex_destroy(&memoryAccountantMutex);
+    }
 
     // get hash set
     AbstractHashSetPtr getHashSet(std::string name) {
@@ -167,6 +176,38 @@ public:
         return this->hashSetMgr.getTotalSize();
     }
 
+    // get the broadcast variables of the running job, the caller keeps them alive for as long as
+    // it holds the returned pointer
+    BroadcastVariableMapPtr getBroadcastVariables() {
+        const LockGuard guard{broadcastVariablesMutex};
+        return this->broadcastVariables;
+    }
+
+    // replace the broadcast variables, the old ones are freed once no thread uses them anymore
+    void setBroadcastVariables(BroadcastVariableMapPtr broadcastVariables) {
+        const LockGuard guard{broadcastVariablesMutex};
+        this->broadcastVariables = broadcastVariables;
+    }
+
+    // get the memory accountant of a job, which all the stages of one execution of the job share;
+    // the first stage of an execution starts a new one, the old one lives on in the hash sets that
+    // are still charged to it
+    QueryMemoryAccountantPtr getMemoryAccountant(std::string jobId, int stageId) {
+        const LockGuard guard{memoryAccountantMutex};
+        if (this->memoryAccountant == nullptr || stageId == 0 ||
+            this->memoryAccountant->getJobId() != jobId) {
+            this->memoryAccountant = make_shared<QueryMemoryAccountant>(
+                jobId, conf->getQueryMemoryLimit(), conf->getNodeMemoryLimit());
+        }
+        return this->memoryAccountant;
+    }
+
+    // makes the reply to a job stage, which tells the frontend how much memory the job has held
+    // so far; a stage of a job that ran out of memory has failed, whatever it says itself
+    Handle<SimpleRequestResult> makeStageResult(bool success,
+                                                std::string errMsg,
+                                                QueryMemoryAccountantPtr accountant);
+
 private:
     ConfigurationPtr conf;
     SharedMemPtr shm;
@@ -175,6 +216,18 @@ private:
     PageScannerPtr curScanner;
     pdb::PDBLoggerPtr logger;
     HashSetManager hashSetMgr;
+
+    // the broadcast variables of the running job, nullptr if it has none
+    BroadcastVariableMapPtr broadcastVariables;
+
+    // protects the broadcastVariables pointer
+    pthread_mutex_t broadcastVariablesMutex;
+
+    // the memory accountant of the job that runs, or ran last
+    QueryMemoryAccountantPtr memoryAccountant;
+
+    // protects the memoryAccountant pointer
+    pthread_mutex_t memoryAccountantMutex;
 };
 }
 
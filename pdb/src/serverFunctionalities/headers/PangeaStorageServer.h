@@ -32,6 +32,7 @@
 #include "SharedMem.h"
 #include "TempSet.h"
 #include "PDBWork.h"
+#include <atomic>
 #include <vector>
 #include <string>
 #include <map>
@@ -97,6 +98,10 @@ public:
     // this allocates a new page at the end of the indicated database/set combo
     PDBPagePtr getNewPage(pair<std::string, std::string> databaseAndSet);
 
+    // builds the zone map of a page that was just filled with the objects of a record, if those
+    // objects keep statistics about their attributes (see ZoneMappedObject)
+    void collectZoneMap(pair<std::string, std::string> databaseAndSet, PDBPagePtr page);
+
     // returns a set object referencing the given database/set pair
     SetPtr getSet(std::pair<std::string, std::string> databaseAndSet);
 
@@ -146,6 +151,12 @@ public:
      */
     SharedMemPtr getSharedMem();
 
+    /**
+     * Returns the number of bytes of intermediate data other nodes have shuffled or broadcast to
+     * this one since the server started, as they came over the wire
+     */
+    size_t getShuffledBytesReceived();
+
     /**
      * Returns cache
      */
@@ -374,6 +385,9 @@ private:
     // the instance to shared memory manager
     SharedMemPtr shm;
 
+    // the bytes of intermediate data received from other nodes
+    std::atomic<size_t> shuffledBytesReceived;
+
     // the path for storing TempSet metadata
     std::string metaTempPath;
 
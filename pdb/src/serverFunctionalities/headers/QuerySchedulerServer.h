@@ -38,8 +38,15 @@
 #include "DistributedStorageManagerClient.h"
 #include "StatisticsDB.h"
 #include "RegisterReplica.h"
+#include "SimpleRequestResult.h"
+#include "PreparedComputation.h"
+#include <map>
 #include <vector>
-#include <ExecuteComputation.h>
+#include "ExecuteComputation.h"
+#include "PrepareComputation.h"
+#include "ExecutePreparedComputation.h"
+#include "ReleasePreparedComputation.h"
+#include "SetBroadcastVariables.h"
 
 namespace pdb {
 
@@ -58,6 +65,15 @@ namespace pdb {
  * The scheduling is dynamic and lazy, and only one the JobStages scheduled last time
  * were executed, it will schedule later stages, to maximize the information needed.
  * The JobStages will be dispatched to all workers for execution.
+ *
+ * Iterative applications can instead prepare a computation graph under a name with a
+ * @see pdb::PrepareComputation object. The first execution of it is planned as usual, but the
+ * JobStages of every round are recorded, so that later executions skip the parsing and the
+ * physical planning and only bind the computations they were sent to the recorded JobStages.
+ *
+ * A job can carry broadcast variables, read-only objects such as a model that every computation
+ * needs. They are shipped to each worker once, before the first JobStage, and shared there by all
+ * the pipeline threads instead of being copied with the computations.
  */
 class QuerySchedulerServer : public ServerFunctionality {
 
@@ -152,13 +168,23 @@ protected:
      */
     void initializeForPseudoClusterMode();
 
+    /**
+     * Makes the result of a job for the client, with the statistics the nodes reported for its stages
+     * @param success true if the job succeeded
+     * @param errMsg why it failed, if it did
+     * @return the result
+     */
+    Handle<SimpleRequestResult> makeJobResult(bool success, std::string errMsg);
+
     /**
      * This method is used to schedule dynamic pipeline stages
      * It must be invoked after initialize() and before cleanup()
      * @param stagesToSchedule is a vector of all the stages we want to schedule
      * @param shuffleInfo is the shuffle information for job stages that needs repartitioning
+     * @return false if a stage failed on a node, e.g. because its job ran out of memory there, the
+     * later stages are not scheduled then and stageErrMsg says why
      */
-    void scheduleStages(std::vector<Handle<AbstractJobStage>>& stagesToSchedule,
+    bool scheduleStages(std::vector<Handle<AbstractJobStage>>& stagesToSchedule,
                         std::shared_ptr<ShuffleInfo> shuffleInfo);
 
 
@@ -257,6 +283,84 @@ protected:
     pair<bool, basic_string<char>> executeComputation(Handle<ExecuteComputation> &request,
                                                       PDBCommunicatorPtr &sendUsingMe);
 
+    /**
+     * This method prepares a computation graph under a name, it is followed by the computations
+     * we keep for its executions; a computation prepared under the same name before is dropped
+     * @param request the object that describes the computation
+     * @param sendUsingMe an instance of the PDBCommunicator that points to the client
+     */
+    pair<bool, basic_string<char>> prepareComputation(Handle<PrepareComputation> &request,
+                                                      PDBCommunicatorPtr &sendUsingMe);
+
+    /**
+     * This method executes a prepared computation, binding the broadcast variables of the request
+     * @param request the object that names the prepared computation
+     * @param sendUsingMe an instance of the PDBCommunicator that points to the client
+     */
+    pair<bool, basic_string<char>> executePreparedComputation(Handle<ExecutePreparedComputation> &request,
+                                                              PDBCommunicatorPtr &sendUsingMe);
+
+    /**
+     * This method drops a prepared computation and the database of its job
+     * @param request the object that names the prepared computation
+     * @param sendUsingMe an instance of the PDBCommunicator that points to the client
+     */
+    pair<bool, basic_string<char>> releasePreparedComputation(Handle<ReleasePreparedComputation> &request,
+                                                              PDBCommunicatorPtr &sendUsingMe);
+
+    /**
+     * Parses and plans the computations, then runs the pipeline stages the physical optimizer generates
+     * round by round. It must be invoked after initialize() and before cleanup()
+     * @param tcap the TCAP program of the computations
+     * @param computations the computations
+     * @param dsmClient an instance of the DistributedStorageManagerClient that manages the intermediate sets
+     * @param recordInto if not null the job stages of every round are recorded into it
+     * @param errMsg the error message that is set if we fail
+     * @return true if we succeeded, false otherwise
+     */
+    bool planAndScheduleStages(const std::string &tcap,
+                               Handle<Vector<Handle<Computation>>> &computations,
+                               DistributedStorageManagerClient &dsmClient,
+                               PreparedComputationPtr recordInto,
+                               std::string &errMsg);
+
+    /**
+     * Records the job stages of a round that was just scheduled, taking their compute plans and
+     * aggregation computations out of them
+     * @param computations the computations the stages were planned for
+     * @param jobStages the stages of the round
+     * @param intermediateSets the intermediate sets of the round
+     * @param recordInto where we record the round
+     * @return false if a stage can not be rebound to the computations of a later execution
+     */
+    bool recordRound(Handle<Vector<Handle<Computation>>> &computations,
+                     std::vector<Handle<AbstractJobStage>> &jobStages,
+                     std::vector<Handle<SetIdentifier>> &intermediateSets,
+                     PreparedComputationPtr &recordInto);
+
+    /**
+     * Drops the recorded job stages of a prepared computation and the database of their job, once
+     * no execution uses them anymore
+     * @param prepared the prepared computation
+     * @param errMsg the error message that is set if we fail
+     * @return true if we succeeded, false otherwise
+     */
+    bool removePreparedJob(PreparedComputationPtr &prepared, std::string &errMsg);
+
+    /**
+     * Runs the recorded job stages of a prepared computation, bound to a new set of computations.
+     * It must be invoked after initialize() and before cleanup()
+     * @param prepared the prepared computation
+     * @param computations the copy of the prepared computations for this execution
+     * @param dsmClient an instance of the DistributedStorageManagerClient that manages the intermediate sets
+     * @param errMsg the error message that is set if we fail
+     * @return true if we succeeded, false otherwise
+     */
+    bool scheduleRecordedStages(PreparedComputationPtr &prepared,
+                                Handle<Vector<Handle<Computation>>> &computations,
+                                DistributedStorageManagerClient &dsmClient,
+                                std::string &errMsg);
+
     /**
      * This method registers a replica with statisticsDB per client request
      * @param request the object that describes the computation
@@ -303,6 +407,27 @@ protected:
     void removeUnusedIntermediateSets(DistributedStorageManagerClient &dsmClient,
                                       vector<Handle<SetIdentifier>> &intermediateSets);
 
+    /**
+     * Ships the broadcast variables of the job to every node, where they replace the ones of the
+     * previous job. They are serialized once and the same bytes are sent to all the nodes in parallel
+     * @param variables the variables, nullptr to drop the ones the nodes hold
+     * @param errMsg the error message that is gonna be set, if a node did not get them
+     * @return true if every node got the variables
+     */
+    bool shipBroadcastVariables(Handle<Vector<Handle<BroadcastVariable>>> variables, std::string &errMsg);
+
+    /**
+     * Sends the serialized broadcast variables to one node and waits until it keeps them
+     * @param node the node we are sending them to
+     * @param variables the serialized SetBroadcastVariables message
+     * @param counter the counter that is increased when we are finished with the node
+     * @param callerBuzzer the buzzer that signals that we are finished
+     */
+    void shipBroadcastVariablesToNode(int node,
+                                      Record<SetBroadcastVariables> *variables,
+                                      int &counter,
+                                      PDBBuzzerPtr &callerBuzzer);
+
     /**
      * This method takes in a communicator to a node and issues a request for statistics about the stored sets
      * @param communicator the communicator to the node
@@ -392,6 +517,47 @@ protected:
      * Wraps shuffle information for job stages that needs repartitioning data
      */
     std::shared_ptr<ShuffleInfo> shuffleInfo;
+
+    /**
+     * The prepared computations by the name they were prepared under
+     */
+    std::map<std::string, PreparedComputationPtr> preparedComputations;
+
+    /**
+     * Protects preparedComputations
+     */
+    pthread_mutex_t preparedComputationsMutex;
+
+    /**
+     * True if the nodes may hold the broadcast variables of the running job, cleanup drops them
+     */
+    bool nodesHoldBroadcastVariables;
+
+    /**
+     * Why a job stage of the running job failed on a node, empty if none did
+     */
+    std::string stageErrMsg;
+
+    /**
+     * The most memory the running job has held on a node, as the nodes report it with each stage
+     */
+    size_t peakMemoryBytes;
+
+    /**
+     * The bytes the nodes received from each other while they ran the stages of the running job
+     */
+    size_t shuffledBytes;
+
+    /**
+     * The most shared memory a node had in use while it ran a stage of the running job
+     */
+    size_t peakSharedMemoryBytes;
+
+    /**
+     * Protects stageErrMsg and the statistics of the job, the threads that schedule a stage on the
+     * nodes update them
+     */
+    pthread_mutex_t stageResultMutex;
 };
 }
 
@@ -69,7 +69,7 @@ void DispatcherServer::registerHandlers(PDBServer& forMe) {
             PDB_COUT << "DispatcherAddData handler running" << std::endl;
             // Receive the data to send
             size_t numBytes = sendUsingMe->getSizeOfNextObject();
-            std::cout << "Dispacher received numBytes = " << numBytes << std::endl;
+            PDB_LOG(DEBUG) << "Dispacher received numBytes = " << numBytes << std::endl;
             Handle<Vector<Handle<Object>>> dataToSend;
             char* tempPage = nullptr;
             char* readToHere = nullptr;
@@ -100,11 +100,11 @@ void DispatcherServer::registerHandlers(PDBServer& forMe) {
                 Handle<SimpleRequestResult> response =
                     makeObject<SimpleRequestResult>(false, errMsg);
                 res = sendUsingMe->sendObject(response, errMsg);
-                std::cout << errMsg << std::endl;
+                PDB_LOG(ERROR) << errMsg << std::endl;
                 return make_pair(false, errMsg);
 
             } else {
-                std::cout << "Dispatch to send vector size = " << dataToSend->size() << std::endl;
+                PDB_LOG(DEBUG) << "Dispatch to send vector size = " << dataToSend->size() << std::endl;
             }
             // Check that the type of the data being stored matches what is known to the catalog
             if (!validateTypes(request->getDatabaseName(),
@@ -114,7 +114,7 @@ void DispatcherServer::registerHandlers(PDBServer& forMe) {
                 Handle<SimpleRequestResult> response =
                     makeObject<SimpleRequestResult>(false, errMsg);
                 res = sendUsingMe->sendObject(response, errMsg);
-                std::cout << errMsg << std::endl;
+                PDB_LOG(ERROR) << errMsg << std::endl;
                 return make_pair(false, errMsg);
             }
             Handle<SimpleRequestResult> response = makeObject<SimpleRequestResult>(res, errMsg);
@@ -273,7 +273,7 @@ bool DispatcherServer::validateTypes(const std::string& databaseName,
 
         if (returnValues->size() == 0) {
             errMsg = "Set " + fullSetName + " cannot be found in the catalog";
-            std :: cout << errMsg << std :: endl;
+            PDB_LOG(ERROR) << errMsg << std :: endl;
             return false;
         } else {
             if ((* returnValues)[0].getObjectTypeName() == typeName) {
@@ -282,12 +282,12 @@ bool DispatcherServer::validateTypes(const std::string& databaseName,
             } else {
                 errMsg = "Dispatched type " + typeName + " does not match stored type " +
                         (* returnValues)[0].getObjectTypeName().c_str();
-                std :: cout << errMsg << std :: endl;
+                PDB_LOG(ERROR) << errMsg << std :: endl;
                 return false;
             }
         }
         PDB_COUT << fullSetName << std :: endl;
-        std :: cout << errMsg << std :: endl;
+        PDB_LOG(ERROR) << errMsg << std :: endl;
         return false;
     */
 
@@ -317,16 +317,16 @@ bool DispatcherServer::sendBytes(std::pair<std::string, std::string> setAndDatab
                                  char* bytes,
                                  size_t numBytes) {
 #ifndef ENABLE_COMPRESSION
-    std::cout << "Now only objects or compressed bytes can be dispatched!!" << std::endl;
+    PDB_LOG(ERROR) << "Now only objects or compressed bytes can be dispatched!!" << std::endl;
 #endif
     int port = destination->getPort();
     std::string address = destination->getAddress();
     std::string databaseName = setAndDatabase.second;
     std::string setName = setAndDatabase.first;
     std::string errMsg;
-    std::cout << "store compressed bytes to address=" << address << " and port=" << port
-              << ", with compressed byte size = " << numBytes << " to database=" << databaseName
-              << " and set=" << setName << " and type = IntermediateData" << std::endl;
+    PDB_LOG(DEBUG) << "store compressed bytes to address=" << address << " and port=" << port
+                   << ", with compressed byte size = " << numBytes << " to database=" << databaseName
+                   << " and set=" << setName << " and type = IntermediateData" << std::endl;
     return simpleSendBytesRequest<StorageAddData, SimpleRequestResult, bool>(
         logger,
         port,
@@ -51,6 +51,8 @@
 #include "Configuration.h"
 
 #include "SetScan.h"
+#include "GetSetNodes.h"
+#include "ListOfNodes.h"
 #include "KeepGoing.h"
 #include "DoneWithResult.h"
 
@@ -860,6 +862,37 @@ void DistributedStorageManagerServer::registerHandlers(PDBServer& forMe) {
             ));
 
 
+    // this handler tells a client which nodes to scan, so that it can fetch the pages of a set
+    // straight from the workers instead of going through the SetScan handler below
+    forMe.registerHandler(
+        GetSetNodes_TYPEID,
+        make_shared<SimpleRequestHandler<GetSetNodes>>([&](Handle<GetSetNodes> request,
+                                                           PDBCommunicatorPtr sendUsingMe) {
+            std::string errMsg;
+            std::string dbName = request->getDatabase();
+            std::string setName = request->getSetName();
+            PDB_COUT << "DistributedStorageManager received GetSetNodes message: dbName =" << dbName
+                     << ", setName =" << setName << std::endl;
+
+            std::vector<std::string> nodesToScan;
+            if (!getFunctionality<DistributedStorageManagerServer>().findNodesToScan(
+                    dbName, setName, nodesToScan, errMsg)) {
+                errMsg = "Error in handling GetSetNodes message: Could not find nodes for this set";
+                std::cout << errMsg << std::endl;
+                return make_pair(false, errMsg);
+            }
+
+            const UseTemporaryAllocationBlock tempBlock{1024 + 128 * nodesToScan.size()};
+            Handle<Vector<String>> hostNames = makeObject<Vector<String>>(nodesToScan.size());
+            for (auto& node : nodesToScan) {
+                hostNames->push_back(String(node));
+            }
+            Handle<ListOfNodes> response = makeObject<ListOfNodes>();
+            response->setHostNames(hostNames);
+            bool res = sendUsingMe->sendObject(response, errMsg);
+            return make_pair(res, errMsg);
+        }));
+
     // JiaNote: Below handler is to process SetScan message
     forMe.registerHandler(
         SetScan_TYPEID,
@@ -889,24 +922,12 @@ void DistributedStorageManagerServer::registerHandlers(PDBServer& forMe) {
             */
             // to get all nodes having data for this set
             std::vector<std::string> nodesToBroadcast;
-#ifndef USING_ALL_NODES
-            if (!getFunctionality<DistributedStorageManagerServer>().findNodesContainingSet(
+            if (!getFunctionality<DistributedStorageManagerServer>().findNodesToScan(
                     dbName, setName, nodesToBroadcast, errMsg)) {
                 errMsg = "Error in handling SetScan message: Could not find nodes for this set";
                 std::cout << errMsg << std::endl;
                 return make_pair(false, errMsg);
             }
-#else
-            std::vector<std::string> allNodes;
-            const auto nodes = getFunctionality<ResourceManagerServer>().getAllNodes();
-            for (int i = 0; i < nodes->size(); i++) {
-                std::string address = static_cast<std::string>((*nodes)[i]->getAddress());
-                std::string port = std::to_string((*nodes)[i]->getPort());
-                allNodes.push_back(address + ":" + port);
-            }
-            nodesToBroadcast = allNodes;
-
-#endif
             PDB_COUT << "num nodes for this set" << nodesToBroadcast.size() << std::endl;
 
             // to send SetScan message to slave servers iteratively
@@ -916,20 +937,9 @@ void DistributedStorageManagerServer::registerHandlers(PDBServer& forMe) {
             bool keepGoingSent = false;
             for (int i = 0; i < nodesToBroadcast.size(); i++) {
                 std::string serverName = nodesToBroadcast[i];
-                int port;
-                std::string address;
                 size_t pos = serverName.find(":");
-                if (pos != string::npos) {
-                    port = stoi(serverName.substr(pos + 1, serverName.size()));
-                    address = serverName.substr(0, pos);
-                } else {
-                    if (conf != nullptr) {
-                        port = conf->getPort();
-                    } else {
-                        port = 8108;
-                    }
-                    address = serverName;
-                }
+                int port = stoi(serverName.substr(pos + 1, serverName.size()));
+                std::string address = serverName.substr(0, pos);
 
 
                 PDB_COUT << "to collect data from the " << i
@@ -1057,6 +1067,33 @@ DistributedStorageManagerServer::generateAckHandler(std::vector<std::string>& su
     };
 }
 
+bool DistributedStorageManagerServer::findNodesToScan(const std::string& databaseName,
+                                                      const std::string& setName,
+                                                      std::vector<std::string>& nodesToScan,
+                                                      std::string& errMsg) {
+#ifndef USING_ALL_NODES
+    if (!findNodesContainingSet(databaseName, setName, nodesToScan, errMsg)) {
+        return false;
+    }
+#else
+    nodesToScan.clear();
+    const auto nodes = getFunctionality<ResourceManagerServer>().getAllNodes();
+    for (int i = 0; i < nodes->size(); i++) {
+        std::string address = static_cast<std::string>((*nodes)[i]->getAddress());
+        std::string port = std::to_string((*nodes)[i]->getPort());
+        nodesToScan.push_back(address + ":" + port);
+    }
+#endif
+
+    // nodes without a port listen on the default one
+    for (auto& node : nodesToScan) {
+        if (node.find(":") == string::npos) {
+            node += ":" + std::to_string(conf != nullptr ? conf->getPort() : 8108);
+        }
+    }
+    return true;
+}
+
 bool DistributedStorageManagerServer::findNodesForDatabase(
     const std::string& databaseName,
     std::vector<std::string>& nodesForDatabase,
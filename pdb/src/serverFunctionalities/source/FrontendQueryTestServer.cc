@@ -28,6 +28,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <string>
+#include <tuple>
 #include "PDBDebug.h"
 #include "FrontendQueryTestServer.h"
 #include "SimpleRequestHandler.h"
@@ -65,6 +66,29 @@ FrontendQueryTestServer::FrontendQueryTestServer(bool isStandalone, bool createO
 
 FrontendQueryTestServer::~FrontendQueryTestServer() {}
 
+size_t FrontendQueryTestServer::startStageStats() {
+
+  PangeaStorageServer &storage = getFunctionality<PangeaStorageServer>();
+  storage.getSharedMem()->resetPeakUsedBytes();
+  return storage.getShuffledBytesReceived();
+}
+
+void FrontendQueryTestServer::setStageResult(Handle<SetIdentifier> result,
+                                             size_t shuffledBytesAtStageStart,
+                                             Handle<SimpleRequestResult> backendResult) {
+
+  PangeaStorageServer &storage = getFunctionality<PangeaStorageServer>();
+  result->setStageStats(storage.getShuffledBytesReceived() - shuffledBytesAtStageStart,
+                        storage.getSharedMem()->getPeakUsedBytes());
+  if (backendResult == nullptr) {
+    return;
+  }
+  result->setPeakMemoryBytes(backendResult->getPeakMemoryBytes());
+  if (backendResult->getRes().first == false) {
+    result->setErrMsg(backendResult->getRes().second);
+  }
+}
+
 void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
 
   // to handle a request to execute a job stage for building hash tables for hash partition join
@@ -77,6 +101,8 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
         PDB_COUT << "Frontend got a request for HashPartitionedJoinBuildHTJobStage"
                  << std::endl;
         request->print();
+        size_t shuffledBytesAtStageStart = startStageStats();
+        Handle<SimpleRequestResult> backendResult = nullptr;
 #ifdef EANBLE_LARGE_GRAPH
         makeObjectAllocatorBlock(256 * 1024 * 1024, true);
 #else
@@ -157,7 +183,12 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
         } else {
           PDB_COUT << "Frontend sent request to backend" << std::endl;
           // wait for backend to finish.
-          communicatorToBackend->getNextObject<SimpleRequestResult>(success, errMsg);
+          backendResult =
+              communicatorToBackend->getNextObject<SimpleRequestResult>(success, errMsg);
+          if ((success == true) && (backendResult != nullptr)) {
+            // the stage may have failed at the backend, e.g. because the job ran out of memory
+            std::tie(success, errMsg) = backendResult->getRes();
+          }
           if (!success) {
             std::cout << "Error waiting for backend to finish this job stage. " << errMsg
                       << std::endl;
@@ -170,6 +201,7 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
         Handle<SetIdentifier> result = makeObject<SetIdentifier>(inDatabaseName, inSetName);
         result->setNumPages(inputSet->getNumPages());
         result->setPageSize(inputSet->getPageSize());
+        setStageResult(result, shuffledBytesAtStageStart, backendResult);
         if (success == true) {
           PDB_COUT << "Stage is done. " << std::endl;
           errMsg = std::string("execution complete");
@@ -196,6 +228,8 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
                                                                         bool success;
                                                                         PDB_COUT << "Frontend got a request for BroadcastJoinBuildHTJobStage" << std::endl;
                                                                         request->print();
+                                                                        size_t shuffledBytesAtStageStart = startStageStats();
+                                                                        Handle<SimpleRequestResult> backendResult = nullptr;
 #ifdef ENABLE_LARGE_GRAPH
                                                                         makeObjectAllocatorBlock(256 * 1024 * 1024, true);
 #else
@@ -274,7 +308,12 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
                                                                           } else {
                                                                             PDB_COUT << "Frontend sent request to backend" << std::endl;
                                                                             // wait for backend to finish.
-                                                                            communicatorToBackend->getNextObject<SimpleRequestResult>(success, errMsg);
+                                                                            backendResult =
+                                                                                communicatorToBackend->getNextObject<SimpleRequestResult>(success, errMsg);
+                                                                            if ((success == true) && (backendResult != nullptr)) {
+                                                                              // the stage may have failed at the backend, e.g. because the job ran out of memory
+                                                                              std::tie(success, errMsg) = backendResult->getRes();
+                                                                            }
                                                                             if (!success) {
                                                                               std::cout << "Error waiting for backend to finish this job stage. "
                                                                                         << errMsg << std::endl;
@@ -293,6 +332,7 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
                                                                         Handle<SetIdentifier> result = makeObject<SetIdentifier>(inDatabaseName, inSetName);
                                                                         result->setNumPages(inputSet->getNumPages());
                                                                         result->setPageSize(inputSet->getPageSize());
+                                                                        setStageResult(result, shuffledBytesAtStageStart, backendResult);
                                                                         if (success == true) {
                                                                           PDB_COUT << "Stage is done. " << std::endl;
                                                                           errMsg = std::string("execution complete");
@@ -322,6 +362,8 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
         bool success;
         PDB_COUT << "Frontend got a request for AggregationJobStage" << std::endl;
         request->print();
+        size_t shuffledBytesAtStageStart = startStageStats();
+        Handle<SimpleRequestResult> backendResult = nullptr;
 #ifdef ENABLE_LARGE_GRAPH
         makeObjectAllocatorBlock(256 * 1024 * 1024, true);
 #else
@@ -445,7 +487,12 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
         } else {
           PDB_COUT << "Frontend sent request to backend" << std::endl;
           // wait for backend to finish.
-          communicatorToBackend->getNextObject<SimpleRequestResult>(success, errMsg);
+          backendResult =
+              communicatorToBackend->getNextObject<SimpleRequestResult>(success, errMsg);
+          if ((success == true) && (backendResult != nullptr)) {
+            // the stage may have failed at the backend, e.g. because the job ran out of memory
+            std::tie(success, errMsg) = backendResult->getRes();
+          }
           if (!success) {
             std::cout << "Error waiting for backend to finish this job stage. " << errMsg
                       << std::endl;
@@ -466,6 +513,7 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
           result->setNumPages(inputSet->getNumPages());
           result->setPageSize(inputSet->getPageSize());
         }
+        setStageResult(result, shuffledBytesAtStageStart, backendResult);
         if (success == true) {
           PDB_COUT << "Stage is done. " << std::endl;
           errMsg = std::string("execution complete");
@@ -493,6 +541,8 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
         bool success;
         PDB_COUT << "Frontend got a request for TupleSetJobStage" << std::endl;
         request->print();
+        size_t shuffledBytesAtStageStart = startStageStats();
+        Handle<SimpleRequestResult> backendResult = nullptr;
 #ifdef ENABLE_LARGE_GRAPH
         makeObjectAllocatorBlock(256 * 1024 * 1024, true);
 #else
@@ -673,7 +723,12 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
           } else {
             PDB_COUT << "Frontend sent request to backend" << std::endl;
             // wait for backend to finish.
-            communicatorToBackend->getNextObject<SimpleRequestResult>(success, errMsg);
+            backendResult =
+                communicatorToBackend->getNextObject<SimpleRequestResult>(success, errMsg);
+            if ((success == true) && (backendResult != nullptr)) {
+              // the stage may have failed at the backend, e.g. because the job ran out of memory
+              std::tie(success, errMsg) = backendResult->getRes();
+            }
             if (!success) {
               std::cout << "Error waiting for backend to finish this job stage. "
                         << errMsg << std::endl;
@@ -692,6 +747,7 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
         Handle<SetIdentifier> result = makeObject<SetIdentifier>(outDatabaseName, outSetName);
         result->setNumPages(outputSet->getNumPages());
         result->setPageSize(outputSet->getPageSize());
+        setStageResult(result, shuffledBytesAtStageStart, backendResult);
         if (success == true) {
           PDB_COUT << "Stage is done. " << std::endl;
           errMsg = std::string("execution complete");
@@ -765,11 +821,41 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
         }
         loopingSet->setPinned(true);
         vector<PageIteratorPtr> *pageIters = loopingSet->getIterators();
+
+        // we may have up to windowSize pages out that the client has not acknowledged with a
+        // KeepGoing yet; with a window of one this is the classic page-by-page handshake
+        int windowSize = std::max(1, request->getWindowSize());
+        int credits = windowSize;
+        bool compress = request->isCompressed();
+
+        // waits for the client to acknowledge a page; returns false if the client is done with
+        // the result, or if it went away
+        bool clientDone = false;
+        auto waitForCredit = [&]() -> bool {
+          bool success;
+          if (sendUsingMe->getObjectTypeID() != DoneWithResult_TYPEID) {
+            Handle<KeepGoing> temp =
+                sendUsingMe->getNextObject<KeepGoing>(success, errMsg);
+            PDB_COUT << "Keep going" << std::endl;
+            if (success) {
+              credits++;
+              return true;
+            }
+          } else {
+            Handle<DoneWithResult> temp =
+                sendUsingMe->getNextObject<DoneWithResult>(success, errMsg);
+            PDB_COUT << "Done" << std::endl;
+            clientDone = success;
+          }
+          return false;
+        };
+
         // loop through all pages
         int numIterators = pageIters->size();
-        for (int i = 0; i < numIterators; i++) {
+        bool keepSending = true;
+        for (int i = 0; i < numIterators && keepSending; i++) {
           PageIteratorPtr iter = pageIters->at(i);
-          while (iter->hasNext()) {
+          while (keepSending && iter->hasNext()) {
             PDBPagePtr nextPage = iter->next();
             // send the relevant page.
             if (nextPage != nullptr) {
@@ -778,67 +864,37 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
               Handle<Vector<Handle<Object>>> inputVec = myRec->getRootObject();
               if (inputVec == nullptr) {
                 std::cout << "no vector in this page" << std::endl;
-                // to evict this page
-                PageCachePtr cache = getFunctionality<PangeaStorageServer>().getCache();
-                CacheKey key;
-                key.dbId = nextPage->getDbID();
-                key.typeId = nextPage->getTypeID();
-                key.setId = nextPage->getSetID();
-                key.pageId = nextPage->getPageID();
-                cache->decPageRefCount(key);
-#ifndef REMOVE_SET_WITH_EVICTION
-                cache->evictPage(key);  // try to modify this to something like
-                                                    // evictPageWithoutFlush() or clear set in the
-                                                    // end.
-#endif
-                continue;
               }
 
-              int vecSize = inputVec->size();
-              if (vecSize != 0) {
+              bool sent = false;
+              if (inputVec != nullptr && inputVec->size() != 0) {
                 const UseTemporaryAllocationBlock tempBlock{2048};
-#ifdef ENABLE_COMPRESSION
-                char *newRecord = (char *) calloc(nextPage->getSize(), 1);
-                myRec = getRecord(inputVec, newRecord, nextPage->getSize());
-                char *compressedBytes =
-                    new char[snappy::MaxCompressedLength(myRec->numBytes())];
-                size_t compressedSize;
-                snappy::RawCompress((char *) (myRec),
-                                    myRec->numBytes(),
-                                    compressedBytes,
-                                    &compressedSize);
-                std::cout << "Frontend=>Client: size before compression is "
-                          << myRec->numBytes() << " and size after compression is "
-                          << compressedSize << std::endl;
-                sendUsingMe->sendBytes(compressedBytes, compressedSize, errMsg);
-
-                delete[] compressedBytes;
-                free(newRecord);
-#else
-                if (!sendUsingMe->sendBytes(
-                                    nextPage->getBytes(), nextPage->getSize(), errMsg)) {
-                                return std::make_pair(false, errMsg);
-                            }
-#endif
-                // see whether or not the client wants to see more results
-                bool success;
-                if (sendUsingMe->getObjectTypeID() != DoneWithResult_TYPEID) {
-                  Handle<KeepGoing> temp =
-                      sendUsingMe->getNextObject<KeepGoing>(success, errMsg);
-                  PDB_COUT << "Keep going" << std::endl;
-                  if (!success)
-                    return std::make_pair(false, errMsg);
+                if (compress) {
+                  char *newRecord = (char *) calloc(nextPage->getSize(), 1);
+                  myRec = getRecord(inputVec, newRecord, nextPage->getSize());
+                  char *compressedBytes =
+                      new char[snappy::MaxCompressedLength(myRec->numBytes())];
+                  size_t compressedSize;
+                  snappy::RawCompress((char *) (myRec),
+                                      myRec->numBytes(),
+                                      compressedBytes,
+                                      &compressedSize);
+                  PDB_COUT << "Frontend=>Client: size before compression is "
+                           << myRec->numBytes() << " and size after compression is "
+                           << compressedSize << std::endl;
+                  keepSending = sendUsingMe->sendBytes(compressedBytes, compressedSize, errMsg);
+                  delete[] compressedBytes;
+                  free(newRecord);
                 } else {
-                  Handle<DoneWithResult> temp =
-                      sendUsingMe->getNextObject<DoneWithResult>(success, errMsg);
-                  PDB_COUT << "Done" << std::endl;
-                  if (!success)
-                    return std::make_pair(false, errMsg);
-                  else
-                    return std::make_pair(true, std::string("everything OK!"));
+                  keepSending =
+                      sendUsingMe->sendBytes(nextPage->getBytes(), nextPage->getSize(), errMsg);
                 }
+                sent = true;
               }
-              // to evict this page
+              inputVec = nullptr;
+
+              // the bytes are on the wire, so we can let go of the page before the client
+              // acknowledges it
               PageCachePtr cache = getFunctionality<PangeaStorageServer>().getCache();
               CacheKey key;
               key.dbId = nextPage->getDbID();
@@ -850,13 +906,31 @@ void FrontendQueryTestServer::registerHandlers(PDBServer &forMe) {
               cache->evictPage(key);  // try to modify this to something like
                                                 // evictPageWithoutFlush() or clear set in the end.
 #endif
+
+              // once the window is used up, we wait for the client to catch up
+              if (sent && keepSending && --credits == 0) {
+                keepSending = waitForCredit();
+              }
             } else {
               PDB_COUT << "We've got a null page!!!" << std::endl;
             }
           }
         }
+
+        // collect the acknowledgements for the pages still in flight, so that nothing is left on
+        // the connection once we say that we are done
+        while (keepSending && credits < windowSize) {
+          keepSending = waitForCredit();
+        }
         loopingSet->setPinned(false);
         delete pageIters;
+        if (clientDone) {
+          return std::make_pair(true, std::string("everything OK!"));
+        }
+        if (!keepSending) {
+          return std::make_pair(false, errMsg);
+        }
+
         // tell the caller we are done
         const UseTemporaryAllocationBlock tempBlock{1024};
         Handle<DoneWithResult> temp = makeObject<DoneWithResult>();
@@ -25,6 +25,7 @@
 #include "StoragePagePinned.h"
 #include "StorageNoMorePage.h"
 #include "StorageRemoveHashSet.h"
+#include "SetBroadcastVariables.h"
 #include "SimpleRequestHandler.h"
 #include "SimpleRequestResult.h"
 #include "BackendTestSetScan.h"
@@ -40,6 +41,7 @@
 #include "BroadcastJoinBuildHTJobStage.h"
 #include "HashPartitionedJoinBuildHTJobStage.h"
 #include "PipelineStage.h"
+#include "ParsedTCAPCache.h"
 #include "PartitionedHashSet.h"
 #include "SharedHashSet.h"
 #include "JoinMap.h"
@@ -58,6 +60,9 @@ namespace pdb {
 
 void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
 
+  // the stages of a job, and every execution of a prepared job, ship the same TCAP program, the
+  // backend compiles it once and its threads share the parsed computations
+  ParsedTCAPCache::enable();
 
   // register a handler to process StoragePagePinned messages that are reponses to the same
   // StorageGetSetPages message initiated by the current PageScanner instance.
@@ -204,13 +209,15 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
         PDB_COUT << "Backend got Broadcast JobStage message with Id=" << request->getStageId()
                  << std::endl;
         request->print();
+        QueryMemoryAccountantPtr memoryAccountant =
+            getMemoryAccountant(request->getJobId(), request->getStageId());
 
         // create a SharedHashSet instance
         size_t hashSetSize = conf->getBroadcastPageSize() * (size_t) (request->getNumPages()) *
             JOIN_HASH_TABLE_SIZE_RATIO;
         std::cout << "BroadcastJoinBuildHTJobStage: hashSetSize=" << hashSetSize << std::endl;
         SharedHashSetPtr sharedHashSet =
-            make_shared<SharedHashSet>(request->getHashSetName(), hashSetSize);
+            make_shared<SharedHashSet>(request->getHashSetName(), hashSetSize, memoryAccountant);
         if (sharedHashSet->isValid() == false) {
           hashSetSize = conf->getBroadcastPageSize() * (size_t) (request->getNumPages()) * 1.5;
 #ifdef AUTO_TUNING
@@ -225,17 +232,18 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
 #endif
           std::cout << "BroadcastJoinBuildHTJobStage: tuned hashSetSize to be " << hashSetSize
                     << std::endl;
-          sharedHashSet = make_shared<SharedHashSet>(request->getHashSetName(), hashSetSize);
+          sharedHashSet =
+              make_shared<SharedHashSet>(request->getHashSetName(), hashSetSize, memoryAccountant);
         }
         if (sharedHashSet->isValid() == false) {
           success = false;
           errMsg = "Error: heap memory becomes insufficient";
           std::cout << errMsg << std::endl;
+          memoryAccountant->fail(hashSetSize, "the hash table " + request->getHashSetName());
           // return result to frontend
           PDB_COUT << "to send back reply" << std::endl;
           const UseTemporaryAllocationBlock block{1024};
-          Handle<SimpleRequestResult> response =
-              makeObject<SimpleRequestResult>(success, errMsg);
+          Handle<SimpleRequestResult> response = makeStageResult(success, errMsg, memoryAccountant);
           // return the result
           success = sendUsingMe->sendObject(response, errMsg);
           return make_pair(success, errMsg);
@@ -325,6 +333,7 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
         std::string targetTupleSetSpecifier = request->getTargetTupleSetSpecifier();
         std::string targetComputationSpecifier = request->getTargetComputationSpecifier();
         Handle<ComputePlan> myComputePlan = request->getComputePlan();
+        myComputePlan->prefetchTypes();
         SinkMergerPtr merger = myComputePlan->getMerger(
             sourceTupleSetSpecifier, targetTupleSetSpecifier, targetComputationSpecifier);
         Handle<Object> myMap = merger->createNewOutputContainer();
@@ -364,7 +373,7 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
         // return result to frontend
         PDB_COUT << "to send back reply" << std::endl;
         const UseTemporaryAllocationBlock block1{1024};
-        Handle<SimpleRequestResult> response = makeObject<SimpleRequestResult>(success, errMsg);
+        Handle<SimpleRequestResult> response = makeStageResult(success, errMsg, memoryAccountant);
         // return the result
         success = sendUsingMe->sendObject(response, errMsg);
         return make_pair(success, errMsg);
@@ -379,12 +388,14 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
                                                                getAllocator().cleanInactiveBlocks((size_t) ((size_t) 32 * (size_t) 1024 * (size_t) 1024));
                                                                getAllocator().cleanInactiveBlocks((size_t) ((size_t) 256 * (size_t) 1024 * (size_t) 1024));
                                                                const UseTemporaryAllocationBlock block{32 * 1024 * 1024};
-                                                               bool success;
+                                                               bool success = true;
                                                                std::string errMsg;
 
                                                                std::cout << "Backend got Aggregation JobStage message with Id="
                                                                          << request->getStageId() << std::endl;
                                                                request->print();
+                                                               QueryMemoryAccountantPtr memoryAccountant =
+                                                                   getMemoryAccountant(request->getJobId(), request->getStageId());
 
 #ifdef PROFILING
                                                                std::string out = getAllocator().printInactiveBlocks();
@@ -460,7 +471,7 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
                                                                  std::string setName = sinkSetIdentifier->getSetName();
                                                                  hashSetName = dbName + ":" + setName;
                                                                  aggregationSet =
-                                                                     make_shared<PartitionedHashSet>(hashSetName, this->conf->getHashPageSize());
+                                                                     make_shared<PartitionedHashSet>(hashSetName, this->conf->getHashPageSize(), memoryAccountant);
                                                                  this->addHashSet(hashSetName, aggregationSet);
                                                                }
 
@@ -538,8 +549,9 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
                                                                              // create a new partition
                                                                              outBytes = aggregationSet->addPage();
                                                                              if (outBytes == nullptr) {
+                                                                               // the query is out of memory, we only unpin the rest of the input
                                                                                std::cout << "insufficient memory in heap" << std::endl;
-                                                                               exit(-1);
+                                                                               break;
                                                                              }
                                                                              aggregateProcessor->loadOutputPage(
                                                                                  outBytes, aggregationSet->getPageSize());
@@ -562,8 +574,7 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
                                                                          }
                                                                          // unpin user page
                                                                          // aggregateProcessor->clearInputPage();
-                                                                         page->decRefCount();
-                                                                         if (page->getRefCount() == 0) {
+                                                                         if (page->decRefCount() == 0) {
                                                                            proxy->unpinUserPage(nodeId,
                                                                                                 page->getDbID(),
                                                                                                 page->getTypeID(),
@@ -615,8 +626,12 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
                                                                              continue;
                                                                            }
                                                                            if (aggregationPage == nullptr) {
-                                                                             aggregationPage =
-                                                                                 (void *) malloc(aggregationPageSize * sizeof(char));
+                                                                             aggregationPage = memoryAccountant->allocate(
+                                                                                 aggregationPageSize * sizeof(char), "an aggregation page");
+                                                                             if (aggregationPage == nullptr) {
+                                                                               // the query is out of memory, we only unpin the rest of the input
+                                                                               break;
+                                                                             }
                                                                              aggregateProcessor->loadOutputPage(aggregationPage,
                                                                                                                 aggregationPageSize);
                                                                            }
@@ -666,14 +681,14 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
                                                                                                                output->getSize());
                                                                              }
                                                                              aggregateProcessor->clearOutputPage();
-                                                                             free(aggregationPage);
+                                                                             memoryAccountant->deallocate(aggregationPage, aggregationPageSize);
+                                                                             aggregationPage = nullptr;
                                                                              break;
                                                                            }
                                                                          }
                                                                          // aggregateProcessor->clearInputPage();
                                                                          // unpin the input page
-                                                                         page->decRefCount();
-                                                                         if (page->getRefCount() == 0) {
+                                                                         if (page->decRefCount() == 0) {
                                                                            proxy->unpinUserPage(nodeId,
                                                                                                 page->getDbID(),
                                                                                                 page->getTypeID(),
@@ -726,7 +741,7 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
                                                                                             output);
                                                                        // free aggregation page
                                                                        aggregateProcessor->clearOutputPage();
-                                                                       free(aggregationPage);
+                                                                       memoryAccountant->deallocate(aggregationPage, aggregationPageSize);
                                                                      }  // aggregationPage != nullptr
 
                                                                    }  // request->needsToMaterializeAggOut() == true
@@ -868,7 +883,7 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
                                                                // return result to frontend
                                                                PDB_COUT << "to send back reply" << std::endl;
                                                                const UseTemporaryAllocationBlock block1{1024};
-                                                               Handle<SimpleRequestResult> response = makeObject<SimpleRequestResult>(success, errMsg);
+                                                               Handle<SimpleRequestResult> response = makeStageResult(success, errMsg, memoryAccountant);
                                                                // return the result
                                                                success = sendUsingMe->sendObject(response, errMsg);
                                                                return make_pair(success, errMsg);
@@ -884,12 +899,14 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
           Handle<HashPartitionedJoinBuildHTJobStage> request, PDBCommunicatorPtr sendUsingMe) {
         getAllocator().cleanInactiveBlocks((size_t) ((size_t) 256 * (size_t) 1024 * (size_t) 1024));
         const UseTemporaryAllocationBlock block{32 * 1024 * 1024};
-        bool success;
+        bool success = true;
         std::string errMsg;
 
         std::cout << "Backend got HashPartitionedJoinBuildHTJobStage message with Id="
                   << request->getStageId() << std::endl;
         request->print();
+        QueryMemoryAccountantPtr memoryAccountant =
+            getMemoryAccountant(request->getJobId(), request->getStageId());
 
 #ifdef PROFILING
         std::string out = getAllocator().printInactiveBlocks();
@@ -913,14 +930,25 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
             (double) (numPages) * sizeRatio / (double) (numPartitions);
         // create hash set
         std::string hashSetName = request->getHashSetName();
-        PartitionedHashSetPtr partitionedSet = make_shared<PartitionedHashSet>(hashSetName, hashSetSize);
+        PartitionedHashSetPtr partitionedSet =
+            make_shared<PartitionedHashSet>(hashSetName, hashSetSize, memoryAccountant);
         this->addHashSet(hashSetName, partitionedSet);
         std::cout << "Added hash set for HashPartitionedJoin to probe" << std::endl;
         for (int i = 0; i < numPartitions; i++) {
           void *bytes = partitionedSet->addPage();
           if (bytes == nullptr) {
             std::cout << "Insufficient memory in heap" << std::endl;
-            exit(1);
+            // the query is out of memory, so we give back the partitions we have and fail the stage
+            partitionedSet->cleanup();
+            this->removeHashSet(hashSetName);
+            success = false;
+            errMsg = "Error: heap memory becomes insufficient";
+            const UseTemporaryAllocationBlock block{1024};
+            Handle<SimpleRequestResult> response =
+                makeStageResult(success, errMsg, memoryAccountant);
+            // return the result
+            success = sendUsingMe->sendObject(response, errMsg);
+            return make_pair(success, errMsg);
           }
         }
         // create multiple page circular queues
@@ -953,6 +981,7 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
         std::string targetTupleSetSpecifier = request->getTargetTupleSetSpecifier();
         std::string targetComputationSpecifier = request->getTargetComputationSpecifier();
         Handle<ComputePlan> myComputePlan = request->getComputePlan();
+        myComputePlan->prefetchTypes();
         SinkMergerPtr merger = myComputePlan->getMerger(sourceTupleSetSpecifier,
                                                         targetTupleSetSpecifier,
                                                         targetComputationSpecifier);
@@ -1018,8 +1047,7 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
                   }
                 }
                 // unpin the input page
-                page->decRefCount();
-                if (page->getRefCount() == 0) {
+                if (page->decRefCount() == 0) {
                   proxy->unpinUserPage(nodeId,
                                        page->getDbID(),
                                        page->getTypeID(),
@@ -1170,7 +1198,7 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
         // return result to frontend
         PDB_COUT << "to send back reply" << std::endl;
         const UseTemporaryAllocationBlock block1{1024};
-        Handle<SimpleRequestResult> response = makeObject<SimpleRequestResult>(success, errMsg);
+        Handle<SimpleRequestResult> response = makeStageResult(success, errMsg, memoryAccountant);
         // return the result
         success = sendUsingMe->sendObject(response, errMsg);
         return make_pair(success, errMsg);
@@ -1191,6 +1219,8 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
         request->print();
         bool res = true;
         std::string errMsg;
+        QueryMemoryAccountantPtr memoryAccountant =
+            getMemoryAccountant(request->getJobId(), request->getStageId());
 #ifdef ENABLE_LARGE_GRAPH
         const UseTemporaryAllocationBlock block1{256 * 1024 * 1024};
 #else
@@ -1202,6 +1232,8 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
         std::cout << out << std::endl;
 #endif
         Handle<SetIdentifier> sourceContext = request->getSourceContext();
+        // load the types of the stage once, instead of from each of its pipeline threads
+        request->getComputePlan()->prefetchTypes();
         if (getCurPageScanner() == nullptr) {
           NodeID nodeId = getFunctionality<HermesExecutionServer>().getNodeID();
           pdb::PDBLoggerPtr logger = getFunctionality<HermesExecutionServer>().getLogger();
@@ -1214,6 +1246,7 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
                                                                      nodeId,
                                                                      conf->getBatchSize(),
                                                                      conf->getNumThreads());
+          pipeline->setMemoryAccountant(memoryAccountant);
           if (request->isRepartitionJoin() == true) {
             PDB_COUT << "run pipeline for hash partitioned join" << std::endl;
             pipeline->runPipelineWithHashPartitionSink(this);
@@ -1273,7 +1306,7 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
         }
         PDB_COUT << "to send back reply" << std::endl;
         const UseTemporaryAllocationBlock block2{1024};
-        Handle<SimpleRequestResult> response = makeObject<SimpleRequestResult>(res, errMsg);
+        Handle<SimpleRequestResult> response = makeStageResult(res, errMsg, memoryAccountant);
         // return the result
         res = sendUsingMe->sendObject(response, errMsg);
         return make_pair(res, errMsg);
@@ -1305,6 +1338,48 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
       }));
 
 
+  // register a handler to keep the broadcast variables of a job, they are shared by all pipeline
+  // threads until the next SetBroadcastVariables replaces them
+  forMe.registerHandler(
+      SetBroadcastVariables_TYPEID,
+      make_shared<SimpleRequestHandler<SetBroadcastVariables>>([&](
+          Handle<SetBroadcastVariables> request, PDBCommunicatorPtr sendUsingMe) {
+        std::string errMsg;
+        bool success = true;
+        BroadcastVariableMapPtr variables = nullptr;
+        Handle<Vector<Handle<BroadcastVariable>>> requestVariables = request->getVariables();
+        if (requestVariables != nullptr && requestVariables->size() > 0) {
+
+          // each variable gets its own Record outside of any allocation block, the Records are
+          // freed together with the map
+          variables = BroadcastVariableMapPtr(new BroadcastVariableMap(),
+                                              [](BroadcastVariableMap *toFree) {
+                                                for (auto &variable : *toFree) {
+                                                  free(variable.second);
+                                                }
+                                                delete toFree;
+                                              });
+          for (int i = 0; i < requestVariables->size(); i++) {
+            std::string name = (*requestVariables)[i]->getName();
+            Handle<Object> value = (*requestVariables)[i]->getValue();
+            auto existing = variables->find(name);
+            if (existing != variables->end()) {
+              free(existing->second);
+            }
+            (*variables)[name] = getMallocedRecord(value);
+          }
+        }
+        this->setBroadcastVariables(variables);
+        PDB_COUT << "got " << (variables == nullptr ? 0 : variables->size())
+                 << " broadcast variables" << std::endl;
+        const UseTemporaryAllocationBlock block{1024};
+        Handle<SimpleRequestResult> response = makeObject<SimpleRequestResult>(success, errMsg);
+        // return the result
+        success = sendUsingMe->sendObject(response, errMsg);
+        return make_pair(success, errMsg);
+      }));
+
+
   // register a handler to process the BackendTestSetScan message
   forMe.registerHandler(
       BackendTestSetCopy_TYPEID,
@@ -1462,6 +1537,19 @@ void HermesExecutionServer::registerHandlers(PDBServer &forMe) {
 
       }));
 }
+
+Handle<SimpleRequestResult> HermesExecutionServer::makeStageResult(
+    bool success, std::string errMsg, QueryMemoryAccountantPtr accountant) {
+    if (accountant != nullptr && accountant->hasFailed()) {
+        success = false;
+        errMsg = accountant->getErrMsg();
+    }
+    Handle<SimpleRequestResult> response = makeObject<SimpleRequestResult>(success, errMsg);
+    if (accountant != nullptr) {
+        response->setPeakMemoryBytes(accountant->getPeakBytes());
+    }
+    return response;
+}
 }
 
 #endif
@@ -49,6 +49,7 @@
 #include "StorageExportSet.h"
 #include "StorageRemoveUserSet.h"
 #include "StorageRemoveHashSet.h"
+#include "SetBroadcastVariables.h"
 #include "StorageCleanup.h"
 #include "StorageCollectStats.h"
 #include "StorageCollectStatsResponse.h"
@@ -64,6 +65,7 @@
 #include "PDBFlushProducerWork.h"
 #include "PDBFlushConsumerWork.h"
 #include "ExportableObject.h"
+#include "ZoneMappedObject.h"
 #include "JoinTupleBase.h"
 //#include <hdfs/hdfs.h>
 #include <cstdio>
@@ -111,6 +113,7 @@ PangeaStorageServer::PangeaStorageServer(SharedMemPtr shm,
     this->nodeId = conf->getNodeID();
     this->serverName = conf->getServerName();
     this->shm = shm;
+    this->shuffledBytesReceived = 0;
     this->workers = workers;
     this->conf = conf;
     this->logger = logger;
@@ -216,6 +219,28 @@ PDBPagePtr PangeaStorageServer::getNewPage(pair<std::string, std::string> databa
     }
 }
 
+void PangeaStorageServer::collectZoneMap(pair<std::string, std::string> databaseAndSet,
+                                         PDBPagePtr page) {
+
+    SetPtr whichSet = getSet(databaseAndSet);
+    Record<Vector<Handle<Object>>>* myRec = (Record<Vector<Handle<Object>>>*)(page->getBytes());
+    Vector<Handle<Object>>& objects = *(myRec->getRootObject());
+    size_t numObjects = objects.size();
+
+    // all objects in a set have the same type, so the first one tells us if there is anything to
+    // collect
+    if ((whichSet == nullptr) || (numObjects == 0) ||
+        (dynamic_cast<ZoneMappedObject*>(&(*objects[0])) == nullptr)) {
+        return;
+    }
+    PageZoneMapPtr zoneMap = make_shared<PageZoneMap>();
+    for (size_t i = 0; i < numObjects; i++) {
+        ((ZoneMappedObject*)&(*objects[i]))->addToZoneMap(*zoneMap);
+    }
+    if (zoneMap->isEmpty() == false) {
+        whichSet->setZoneMap(page->getPageID(), zoneMap);
+    }
+}
 
 void PangeaStorageServer::writeBackRecords(pair<std::string, std::string> databaseAndSet,
                                            bool flushOrNot,
@@ -276,6 +301,7 @@ void PangeaStorageServer::writeBackRecords(pair<std::string, std::string> databa
             // comment the following three lines of code to allow Pangea to manage pages
             PDB_COUT << "Write all of the bytes in the record.\n";
             getRecord(data);
+            collectZoneMap(databaseAndSet, myPage);
 
             CacheKey key;
             key.dbId = myPage->getDbID();
@@ -293,6 +319,7 @@ void PangeaStorageServer::writeBackRecords(pair<std::string, std::string> databa
             // comment the following three lines of code to allow Pangea to manage pages
             std::cout << "Writing back a page!!\n";
             getRecord(data);
+            collectZoneMap(databaseAndSet, myPage);
             if (data->size() == 0) {
                 std::cout
                     << "FATAL ERROR: object size is larger than a page, pleases increase page size"
@@ -791,6 +818,49 @@ void PangeaStorageServer::registerHandlers(PDBServer& forMe) {
             return make_pair(success, errMsg);
         }));
 
+    // this handler forwards the broadcast variables of a job to the backend, which keeps them for
+    // the pipelines of the job
+    forMe.registerHandler(
+        SetBroadcastVariables_TYPEID,
+        make_shared<SimpleRequestHandler<SetBroadcastVariables>>([&](
+            Handle<SetBroadcastVariables> request, PDBCommunicatorPtr sendUsingMe) {
+            std::string errMsg;
+            bool success;
+            // the variables can be much larger than a page, so we forward a Record of our own
+            // instead of letting sendObject copy the request
+            Record<SetBroadcastVariables>* record = getMallocedRecord(request);
+            PDBCommunicatorPtr communicatorToBackend = make_shared<PDBCommunicator>();
+            if (communicatorToBackend->connectToLocalServer(
+                    getFunctionality<PangeaStorageServer>().getLogger(),
+                    getFunctionality<PangeaStorageServer>().getPathToBackEndServer(),
+                    errMsg)) {
+                std::cout << errMsg << std::endl;
+                success = false;
+            } else if (!communicatorToBackend->sendRecord(record, errMsg)) {
+                std::cout << errMsg << std::endl;
+                errMsg = std::string("can't send message to backend: ") + errMsg;
+                success = false;
+            } else {
+                PDB_COUT << "Storage sent broadcast variables to backend" << std::endl;
+                // wait for backend to keep them
+                communicatorToBackend->getNextObject<SimpleRequestResult>(success, errMsg);
+                if (!success) {
+                    std::cout << "Error waiting for backend to set broadcast variables. "
+                              << errMsg << std::endl;
+                    errMsg = std::string("backend failed to set broadcast variables: ") + errMsg;
+                }
+            }
+            free(record);
+
+            // make the response
+            const UseTemporaryAllocationBlock tempBlock{1024};
+            Handle<SimpleRequestResult> response = makeObject<SimpleRequestResult>(success, errMsg);
+
+            // return the result
+            success = sendUsingMe->sendObject(response, errMsg);
+            return make_pair(success, errMsg);
+        }));
+
     // this handler requests to export a set to a local file
     forMe.registerHandler(
         StorageExportSet_TYPEID,
@@ -845,6 +915,7 @@ void PangeaStorageServer::registerHandlers(PDBServer& forMe) {
                 // get the record
                 size_t numBytes = sendUsingMe->getSizeOfNextObject();
                 std::cout << "received " << numBytes << " bytes" << std::endl;
+                getFunctionality<PangeaStorageServer>().shuffledBytesReceived += numBytes;
 #ifdef ENABLE_COMPRESSION
                 char* readToHere = new char[numBytes];
 #else
@@ -955,6 +1026,9 @@ void PangeaStorageServer::registerHandlers(PDBServer& forMe) {
 
             // get the record
             size_t numBytes = sendUsingMe->getSizeOfNextObject();
+            if (std::string(request->getType()) == "IntermediateData") {
+                getFunctionality<PangeaStorageServer>().shuffledBytesReceived += numBytes;
+            }
             bool compressedOrNot = request->isCompressed();
             Handle<Vector<Handle<Object>>> objectsToStore = nullptr;
             char* readToHere = nullptr;
@@ -1034,6 +1108,8 @@ void PangeaStorageServer::registerHandlers(PDBServer& forMe) {
                             getFunctionality<PangeaStorageServer>().getNewPage(databaseAndSet);
                         // memory copy
                         memcpy(myPage->getBytes(), readToHere, myRecord->numBytes());
+                        getFunctionality<PangeaStorageServer>().collectZoneMap(databaseAndSet,
+                                                                               myPage);
                         // unpin the page
                         CacheKey key;
                         key.dbId = myPage->getDbID();
@@ -1361,9 +1437,17 @@ void PangeaStorageServer::registerHandlers(PDBServer& forMe) {
                 return make_pair(res, errMsg);
             }
 
+            // the pages whose zone maps rule out the range filter of the scan are skipped
+            ZoneMapFilterPtr filter = nullptr;
+            Handle<Vector<ColumnRange>> rangeFilter = request->getRangeFilter();
+            if ((rangeFilter != nullptr) && (rangeFilter->size() > 0)) {
+                filter = make_shared<ZoneMapFilter>(rangeFilter->c_ptr(),
+                                                    rangeFilter->c_ptr() + rangeFilter->size());
+            }
+
             // use frontend iterators: one iterator for in-memory dirty pages, and one iterator for
             // each file partition
-            std::vector<PageIteratorPtr>* iterators = set->getIterators();
+            std::vector<PageIteratorPtr>* iterators = set->getIterators(filter);
             getFunctionality<PangeaStorageServer>().getCache()->pin(set, MRU, Write);
 
             set->setPinned(true);
@@ -2286,6 +2370,10 @@ SharedMemPtr PangeaStorageServer::getSharedMem() {
     return this->shm;
 }
 
+size_t PangeaStorageServer::getShuffledBytesReceived() {
+    return this->shuffledBytesReceived;
+}
+
 PageCachePtr PangeaStorageServer::getCache() {
     return this->cache;
 }
@@ -29,6 +29,8 @@
 #include "StorageCollectStatsResponse.h"
 #include "Profiling.h"
 #include "RegisterReplica.h"
+#include "LockGuard.h"
+#include <algorithm>
 #include <ctime>
 #include <chrono>
 #include <SimplePhysicalOptimizer/SimplePhysicalNodeFactory.h>
@@ -38,6 +40,8 @@ namespace pdb {
 
 QuerySchedulerServer::~QuerySchedulerServer() {
     pthread_mutex_destroy(&connection_mutex);
+    pthread_mutex_destroy(&preparedComputationsMutex);
+    pthread_mutex_destroy(&stageResultMutex);
 }
 
 QuerySchedulerServer::QuerySchedulerServer(PDBLoggerPtr logger,
@@ -46,6 +50,8 @@ QuerySchedulerServer::QuerySchedulerServer(PDBLoggerPtr logger,
                                            bool pseudoClusterMode,
                                            double partitionToCoreRatio) {
     pthread_mutex_init(&connection_mutex, nullptr);
+    pthread_mutex_init(&preparedComputationsMutex, nullptr);
+    pthread_mutex_init(&stageResultMutex, nullptr);
 
     this->port = 8108;
     this->logger = logger;
@@ -55,6 +61,10 @@ QuerySchedulerServer::QuerySchedulerServer(PDBLoggerPtr logger,
     this->partitionToCoreRatio = partitionToCoreRatio;
     this->statsForOptimization = nullptr;
     this->standardResources = nullptr;
+    this->nodesHoldBroadcastVariables = false;
+    this->peakMemoryBytes = 0;
+    this->shuffledBytes = 0;
+    this->peakSharedMemoryBytes = 0;
 }
 
 
@@ -65,6 +75,8 @@ QuerySchedulerServer::QuerySchedulerServer(int port,
                                            bool pseudoClusterMode,
                                            double partitionToCoreRatio) {
     pthread_mutex_init(&connection_mutex, nullptr);
+    pthread_mutex_init(&preparedComputationsMutex, nullptr);
+    pthread_mutex_init(&stageResultMutex, nullptr);
 
     this->port = port;
     this->logger = logger;
@@ -74,10 +86,23 @@ QuerySchedulerServer::QuerySchedulerServer(int port,
     this->partitionToCoreRatio = partitionToCoreRatio;
     this->statsForOptimization = nullptr;
     this->standardResources = nullptr;
+    this->nodesHoldBroadcastVariables = false;
+    this->peakMemoryBytes = 0;
+    this->shuffledBytes = 0;
+    this->peakSharedMemoryBytes = 0;
 }
 
 void QuerySchedulerServer::cleanup() {
 
+    // drop the broadcast variables of the job, the nodes do not need them anymore
+    if (this->nodesHoldBroadcastVariables) {
+        std::string errMsg;
+        if (!shipBroadcastVariables(nullptr, errMsg)) {
+            PDB_COUT << "Could not drop the broadcast variables: " << errMsg << std::endl;
+        }
+        this->nodesHoldBroadcastVariables = false;
+    }
+
     // delete standard resources if they exist and set them to null
     delete this->standardResources;
     this->standardResources = nullptr;
@@ -87,6 +112,22 @@ void QuerySchedulerServer::cleanup() {
         interGlobalSet = nullptr;
     }
     this->interGlobalSets.clear();
+
+    // forget how the stages of the job went
+    this->stageErrMsg.clear();
+    this->peakMemoryBytes = 0;
+    this->shuffledBytes = 0;
+    this->peakSharedMemoryBytes = 0;
+}
+
+Handle<SimpleRequestResult> QuerySchedulerServer::makeJobResult(bool success, std::string errMsg) {
+
+    Handle<SimpleRequestResult> result = makeObject<SimpleRequestResult>(success, errMsg);
+    const LockGuard guard{stageResultMutex};
+    result->setPeakMemoryBytes(this->peakMemoryBytes);
+    result->setShuffledBytes(this->shuffledBytes);
+    result->setPeakSharedMemoryBytes(this->peakSharedMemoryBytes);
+    return result;
 }
 
 void QuerySchedulerServer::initialize() {
@@ -160,7 +201,7 @@ StatisticsPtr QuerySchedulerServer::getStats() {
 }
 
 
-void QuerySchedulerServer::scheduleStages(std::vector<Handle<AbstractJobStage>>& stagesToSchedule,
+bool QuerySchedulerServer::scheduleStages(std::vector<Handle<AbstractJobStage>>& stagesToSchedule,
                                           std::shared_ptr<ShuffleInfo> shuffleInfo) {
 
     int counter = 0;
@@ -194,7 +235,13 @@ void QuerySchedulerServer::scheduleStages(std::vector<Handle<AbstractJobStage>>&
 
         // reset the counter for the next stage
         counter = 0;
+
+        // the next stages read what this one wrote, so we stop if it failed on a node
+        if (!stageErrMsg.empty()) {
+            return false;
+        }
     }
+    return true;
 }
 
 void QuerySchedulerServer::prepareAndScheduleStage(Handle<AbstractJobStage> &stage,
@@ -336,6 +383,24 @@ bool QuerySchedulerServer::scheduleStage(unsigned long node,
     PDB_COUT << stage->getJobStageType() << " execute: wrote set:" << result->getDatabase()
              << ":" << result->getSetName() << std::endl;
 
+    // keep the statistics of the stage on the node, and why the stage failed there, if it did
+    std::string stageError = result->getErrMsg();
+    {
+        const LockGuard guard{stageResultMutex};
+        this->peakMemoryBytes = std::max(this->peakMemoryBytes, result->getPeakMemoryBytes());
+        this->shuffledBytes += result->getShuffledBytes();
+        this->peakSharedMemoryBytes =
+            std::max(this->peakSharedMemoryBytes, result->getPeakSharedMemoryBytes());
+        if (!stageError.empty() && this->stageErrMsg.empty()) {
+            this->stageErrMsg = stageError;
+        }
+    }
+    if (!stageError.empty()) {
+        std::cout << stage->getJobStageType() << " failed on the " << node
+                  << "-th remote node: " << stageError << std::endl;
+        return false;
+    }
+
     return true;
 }
 
@@ -547,6 +612,96 @@ void QuerySchedulerServer::collectStatsForNode(int node,
     callerBuzzer->buzz(PDBAlarm::WorkAllDone, counter);
 }
 
+bool QuerySchedulerServer::shipBroadcastVariables(Handle<Vector<Handle<BroadcastVariable>>> variables,
+                                                  std::string &errMsg) {
+
+    // from now on cleanup has to drop whatever the nodes got
+    this->nodesHoldBroadcastVariables = variables != nullptr;
+
+    // serialize the message once, every node gets the same bytes; the message itself goes to the
+    // block of the request, which is large enough to hold the variables
+    Handle<SetBroadcastVariables> message = makeObject<SetBroadcastVariables>(variables);
+    Record<SetBroadcastVariables> *record = getMallocedRecord(message);
+    message = nullptr;
+
+    // we use this variable to sync all the nodes
+    int counter = 0;
+    bool failed = false;
+
+    // create the buzzer
+    PDBBuzzerPtr tempBuzzer = make_shared<PDBBuzzer>([&](PDBAlarm myAlarm, int& cnt) {
+        if (myAlarm == PDBAlarm::GenericError) {
+            failed = true;
+        }
+        cnt++;
+    });
+
+    // go through each node
+    for (int node = 0; node < this->standardResources->size(); node++) {
+
+        // grab one worker
+        PDBWorkerPtr myWorker = getWorker();
+
+        // make some work to send the variables to the current node
+        PDBWorkPtr myWork = make_shared<GenericWork>([&, node](PDBBuzzerPtr callerBuzzer) {
+            shipBroadcastVariablesToNode(node, record, counter, callerBuzzer);
+        });
+
+        // execute the work
+        myWorker->execute(myWork, tempBuzzer);
+    }
+
+    // wait until everything is finished
+    while (counter < this->standardResources->size()) {
+        tempBuzzer->wait();
+    }
+    free(record);
+
+    if (failed) {
+        errMsg = "Could not ship the broadcast variables to every node";
+        return false;
+    }
+    return true;
+}
+
+void QuerySchedulerServer::shipBroadcastVariablesToNode(int node,
+                                                        Record<SetBroadcastVariables> *variables,
+                                                        int &counter,
+                                                        PDBBuzzerPtr &callerBuzzer) {
+
+    // the response will be stored here
+    const UseTemporaryAllocationBlock block(1024 * 1024);
+
+    // grab the port and the ip of the node
+    int port = (*(this->standardResources))[node]->getPort();
+    std::string ip = (*(this->standardResources))[node]->getAddress();
+
+    // create PDBCommunicator
+    PDBCommunicatorPtr communicator = getCommunicatorToNode(port, ip);
+    if (communicator == nullptr) {
+        callerBuzzer->buzz(PDBAlarm::GenericError, counter);
+        return;
+    }
+
+    // send the variables and wait until the node keeps them
+    bool success;
+    std::string errMsg;
+    if (!communicator->sendRecord(variables, errMsg)) {
+        logger->error("Could not send the broadcast variables to node " + ip + ": " + errMsg);
+        callerBuzzer->buzz(PDBAlarm::GenericError, counter);
+        return;
+    }
+    Handle<SimpleRequestResult> result = communicator->getNextObject<SimpleRequestResult>(success, errMsg);
+    if (!success || result == nullptr || !result->getRes().first) {
+        logger->error("Node with id=" + std::to_string(node) + " and ip=" + ip +
+                      " did not keep the broadcast variables");
+        callerBuzzer->buzz(PDBAlarm::GenericError, counter);
+        return;
+    }
+
+    callerBuzzer->buzz(PDBAlarm::WorkAllDone, counter);
+}
+
 void QuerySchedulerServer::requestStatistics(PDBCommunicatorPtr &communicator, bool &success, string &errMsg) const {
     Handle<StorageCollectStats> collectStatsMsg = makeObject<StorageCollectStats>();
     success = communicator->sendObject<StorageCollectStats>(collectStatsMsg, errMsg);
@@ -580,6 +735,30 @@ void QuerySchedulerServer::registerHandlers(PDBServer& forMe) {
                 return executeComputation(request, sendUsingMe);
             }));
 
+    // handler to prepare a Computation-based query graph for repeated executions
+    forMe.registerHandler(
+        PrepareComputation_TYPEID,
+        make_shared<SimpleRequestHandler<PrepareComputation>>(
+                [&](Handle<PrepareComputation> request, PDBCommunicatorPtr sendUsingMe) {
+                return prepareComputation(request, sendUsingMe);
+            }));
+
+    // handler to execute a prepared query graph with new computations
+    forMe.registerHandler(
+        ExecutePreparedComputation_TYPEID,
+        make_shared<SimpleRequestHandler<ExecutePreparedComputation>>(
+                [&](Handle<ExecutePreparedComputation> request, PDBCommunicatorPtr sendUsingMe) {
+                return executePreparedComputation(request, sendUsingMe);
+            }));
+
+    // handler to drop a prepared query graph
+    forMe.registerHandler(
+        ReleasePreparedComputation_TYPEID,
+        make_shared<SimpleRequestHandler<ReleasePreparedComputation>>(
+                [&](Handle<ReleasePreparedComputation> request, PDBCommunicatorPtr sendUsingMe) {
+                return releasePreparedComputation(request, sendUsingMe);
+            }));
+
     // handler to register a replica
     forMe.registerHandler(
         RegisterReplica_TYPEID,
@@ -666,9 +845,240 @@ pair<bool, basic_string<char>> QuerySchedulerServer::executeComputation(Handle<E
         this->collectStats();
     }
 
+    // ship the broadcast variables before any stage needs them
+    if (request->getBroadcastVariables() != nullptr &&
+        !shipBroadcastVariables(request->getBroadcastVariables(), errMsg)) {
+      getFunctionality<QuerySchedulerServer>().cleanup();
+      return std::make_pair(false, errMsg);
+    }
+
+    // plan the computations and run them, if that fails we tell the client why, e.g. that the job
+    // ran out of memory on a node
+    if (!planAndScheduleStages(request->getTCAPString(), computations, dsmClient, nullptr, errMsg)) {
+      removeIntermediateSets(dsmClient);
+      Handle<SimpleRequestResult> result = makeJobResult(false, errMsg);
+      sendUsingMe->sendObject(result, errMsg);
+      getFunctionality<QuerySchedulerServer>().cleanup();
+      return std::make_pair(false, errMsg);
+    }
+
+    // removes the rest of the intermediate sets
+    PDB_COUT << "About to remove intermediate sets" << endl;
+    removeIntermediateSets(dsmClient);
+
+    // notify the client that we succeeded
+    PDB_COUT << "About to send back response to client" << std::endl;
+    Handle<SimpleRequestResult> result = makeJobResult(success, errMsg);
+
+    if (!sendUsingMe->sendObject(result, errMsg)) {
+        PDB_COUT << "About to cleanup" << std::endl;
+        getFunctionality<QuerySchedulerServer>().cleanup();
+        return std::make_pair(false, errMsg);
+    }
+
+    PDB_COUT << "About to cleanup" << std::endl;
+    getFunctionality<QuerySchedulerServer>().cleanup();
+    return std::make_pair(true, errMsg);
+}
+
+pair<bool, basic_string<char>> QuerySchedulerServer::prepareComputation(Handle<PrepareComputation> &request,
+                                                                        PDBCommunicatorPtr &sendUsingMe) {
+    // all the stuff will be allocated here
+    const UseTemporaryAllocationBlock block{256 * 1024 * 1024};
+
+    std::string errMsg;
+    bool success;
+
+    // grab the computations of the graph we prepare
+    PDB_COUT << "Got the PrepareComputation object" << std::endl;
+    Handle<Vector<Handle<Computation>>> computations = sendUsingMe->getNextObject<Vector<Handle<Computation>>>(success,
+                                                                                                               errMsg);
+    if (computations != nullptr) {
+
+        // keep the computations, every execution gets its own copy of them; the plan is compiled by
+        // the first execution, since the physical planning needs the statistics of the stages it runs
+        PreparedComputationPtr prepared = make_shared<PreparedComputation>(request->getTCAPString(), computations);
+
+        // a computation prepared again under the same name replaces the old one
+        PreparedComputationPtr replaced;
+        {
+            const LockGuard guard{preparedComputationsMutex};
+            auto it = preparedComputations.find(request->getPreparedName());
+            if (it != preparedComputations.end()) {
+                replaced = it->second;
+            }
+            preparedComputations[request->getPreparedName()] = prepared;
+        }
+        if (replaced != nullptr) {
+            success = removePreparedJob(replaced, errMsg);
+        }
+    } else {
+        success = false;
+    }
+
+    // notify the client
+    Handle<SimpleRequestResult> result = makeObject<SimpleRequestResult>(success, errMsg);
+    if (!sendUsingMe->sendObject(result, errMsg)) {
+        return std::make_pair(false, errMsg);
+    }
+    return std::make_pair(success, errMsg);
+}
+
+pair<bool, basic_string<char>> QuerySchedulerServer::executePreparedComputation(Handle<ExecutePreparedComputation> &request,
+                                                                                PDBCommunicatorPtr &sendUsingMe) {
+    // all the stuff will be allocated here
+    const UseTemporaryAllocationBlock block{256 * 1024 * 1024};
+
+    std::string errMsg;
+    PDB_COUT << "Got the ExecutePreparedComputation object" << std::endl;
+
+    // find the prepared computation
+    PreparedComputationPtr prepared;
+    {
+        const LockGuard guard{preparedComputationsMutex};
+        auto it = preparedComputations.find(request->getPreparedName());
+        if (it != preparedComputations.end()) {
+            prepared = it->second;
+        }
+    }
+
+    // if we can not run it tell the client why
+    if (prepared == nullptr) {
+        errMsg = "There is no computation prepared as " + request->getPreparedName();
+        Handle<SimpleRequestResult> result = makeObject<SimpleRequestResult>(false, errMsg);
+        sendUsingMe->sendObject(result, errMsg);
+        return std::make_pair(false, errMsg);
+    }
+
+    // the recorded stages and the database of the job are only used by one execution at a time
+    const LockGuard executionGuard{prepared->executionLock};
+
+    // the planning and the binding change the computations, so this execution works on a copy
+    Handle<Vector<Handle<Computation>>> keptComputations = prepared->computations->getRootObject();
+    Handle<Vector<Handle<Computation>>> computations =
+            deepCopyToCurrentAllocationBlock<Vector<Handle<Computation>>>(keptComputations);
+
+    // the first execution plans the computation as a new job, the later ones reuse its database
+    DistributedStorageManagerClient dsmClient(this->port, "localhost", logger);
+    bool planned = prepared->isPlanned();
+    if (planned) {
+        this->jobId = prepared->jobId;
+    } else {
+        this->jobId = this->getNextJobId();
+        if (!dsmClient.createDatabase(this->jobId, errMsg)) {
+            PDB_COUT << "Could not crate a database for " << this->jobId << ", cleaning up!" << std::endl;
+            Handle<SimpleRequestResult> result = makeObject<SimpleRequestResult>(false, errMsg);
+            sendUsingMe->sendObject(result, errMsg);
+            getFunctionality<QuerySchedulerServer>().cleanup();
+            return std::make_pair(false, errMsg);
+        }
+    }
+
+    // initialize the standard resources from the resource manager
+    getFunctionality<QuerySchedulerServer>().initialize();
+    this->shuffleInfo = std::make_shared<ShuffleInfo>(this->standardResources, this->partitionToCoreRatio);
+
+    // if we don't have the information about the sets we ask every node to submit them
+    if (this->statsForOptimization == nullptr) {
+        this->collectStats();
+    }
+
+    // ship the broadcast variables before any stage needs them, then either run the recorded stages
+    // or plan the computation and record them
+    bool success;
+    if (request->getBroadcastVariables() != nullptr &&
+        !shipBroadcastVariables(request->getBroadcastVariables(), errMsg)) {
+        success = false;
+    } else if (planned) {
+        success = scheduleRecordedStages(prepared, computations, dsmClient, errMsg);
+    } else {
+        success = planAndScheduleStages(prepared->tcap, computations, dsmClient, prepared, errMsg);
+    }
+
+    // removes the rest of the intermediate sets
+    removeIntermediateSets(dsmClient);
+
+    // if no stages were recorded into the database of this job, because the planning failed or the
+    // stages can not be rebound, the next execution plans again with a new one, so drop this one
+    if (!prepared->isPlanned()) {
+        prepared->rounds.clear();
+        std::string removeErrMsg;
+        if (!dsmClient.removeDatabase(this->jobId, removeErrMsg)) {
+            logger->error("Could not remove the database of job " + this->jobId + ": " + removeErrMsg);
+        }
+    }
+
+    // notify the client, if we failed tell it why
+    Handle<SimpleRequestResult> result = makeJobResult(success, errMsg);
+    if (!sendUsingMe->sendObject(result, errMsg)) {
+        getFunctionality<QuerySchedulerServer>().cleanup();
+        return std::make_pair(false, errMsg);
+    }
+
+    getFunctionality<QuerySchedulerServer>().cleanup();
+    return std::make_pair(success, errMsg);
+}
+
+pair<bool, basic_string<char>> QuerySchedulerServer::releasePreparedComputation(Handle<ReleasePreparedComputation> &request,
+                                                                                PDBCommunicatorPtr &sendUsingMe) {
+    const UseTemporaryAllocationBlock block{1024 * 1024};
+
+    // take the computation out of the map, so no new execution finds it
+    std::string errMsg;
+    bool success;
+    PreparedComputationPtr prepared;
+    {
+        const LockGuard guard{preparedComputationsMutex};
+        auto it = preparedComputations.find(request->getPreparedName());
+        if (it != preparedComputations.end()) {
+            prepared = it->second;
+            preparedComputations.erase(it);
+        }
+    }
+
+    // and drop its job
+    if (prepared != nullptr) {
+        success = removePreparedJob(prepared, errMsg);
+    } else {
+        success = false;
+        errMsg = "There is no computation prepared as " + request->getPreparedName();
+    }
+
+    // notify the client
+    Handle<SimpleRequestResult> result = makeObject<SimpleRequestResult>(success, errMsg);
+    if (!sendUsingMe->sendObject(result, errMsg)) {
+        return std::make_pair(false, errMsg);
+    }
+    return std::make_pair(success, errMsg);
+}
+
+bool QuerySchedulerServer::removePreparedJob(PreparedComputationPtr &prepared, std::string &errMsg) {
+
+    // wait for an execution that still uses the job
+    const LockGuard executionGuard{prepared->executionLock};
+    if (!prepared->isPlanned()) {
+        return true;
+    }
+
+    // drop the database holding the intermediate sets of the job
+    DistributedStorageManagerClient dsmClient(this->port, "localhost", logger);
+    bool success = dsmClient.removeDatabase(prepared->jobId, errMsg);
+    if (!success) {
+        logger->error("Could not remove the database of job " + prepared->jobId + ": " + errMsg);
+    }
+    prepared->jobId.clear();
+    prepared->rounds.clear();
+    return success;
+}
+
+bool QuerySchedulerServer::planAndScheduleStages(const std::string &tcap,
+                                                 Handle<Vector<Handle<Computation>>> &computations,
+                                                 DistributedStorageManagerClient &dsmClient,
+                                                 PreparedComputationPtr recordInto,
+                                                 std::string &errMsg) {
     try {
       // parse the plan and initialize the values we need
-      Handle<ComputePlan> computePlan = makeObject<ComputePlan>(String(request->getTCAPString()), *computations);
+      Handle<ComputePlan> computePlan = makeObject<ComputePlan>(String(tcap), *computations);
       LogicalPlanPtr logicalPlan = computePlan->getPlan();
       AtomicComputationList computationGraph = logicalPlan->getComputations();
       auto sourcesComputations = computationGraph.getAllScanSets();
@@ -686,10 +1096,14 @@ pair<bool, basic_string<char>> QuerySchedulerServer::executeComputation(Handle<E
     }
     catch (pdb::NotEnoughSpace &n) {
 
-      // cleanup since we failed to parse the plan
+      // we failed to parse the plan
       PDB_COUT << "Could not parse the compute plan. About to cleanup" << std::endl;
-      getFunctionality<QuerySchedulerServer>().cleanup();
-      return std::make_pair(false, "Could not parse the compute plan. About to cleanup");
+      errMsg = "Could not parse the compute plan. About to cleanup";
+      return false;
+    }
+
+    if (recordInto != nullptr) {
+        recordInto->rounds.clear();
     }
 
     int jobStageId = 0;
@@ -716,31 +1130,217 @@ pair<bool, basic_string<char>> QuerySchedulerServer::executeComputation(Handle<E
         PROFILER_START(scheduleStages)
 
         PDB_COUT << "To schedule the query to run on the cluster" << std::endl;
-        getFunctionality<QuerySchedulerServer>().scheduleStages(jobStages, shuffleInfo);
+        bool scheduled = getFunctionality<QuerySchedulerServer>().scheduleStages(jobStages, shuffleInfo);
 
         PROFILER_END(scheduleStages)
 
+        // if a stage failed the sets of this round are removed with the rest of the intermediate sets
+        if (!scheduled) {
+            this->interGlobalSets.insert(
+                this->interGlobalSets.end(), intermediateSets.begin(), intermediateSets.end());
+            errMsg = this->stageErrMsg;
+            return false;
+        }
+
+        // if we are preparing the computation remember the round, while the optimizer still knows
+        // which of the intermediate sets are read later
+        if (recordInto != nullptr && !recordRound(computations, jobStages, intermediateSets, recordInto)) {
+            PDB_COUT << "Can not record the job stages, the computation is planned on every execution" << std::endl;
+            recordInto->rounds.clear();
+            recordInto = nullptr;
+        }
+
         // removes the intermediate sets we don't anymore to continue the execution
         removeUnusedIntermediateSets(dsmClient, intermediateSets);
     }
 
-    // removes the rest of the intermediate sets
-    PDB_COUT << "About to remove intermediate sets" << endl;
-    removeIntermediateSets(dsmClient);
+    // the recorded rounds write into the database of this job
+    if (recordInto != nullptr) {
+        recordInto->jobId = this->jobId;
+    }
 
-    // notify the client that we succeeded
-    PDB_COUT << "About to send back response to client" << std::endl;
-    Handle<SimpleRequestResult> result = makeObject<SimpleRequestResult>(success, errMsg);
+    return true;
+}
 
-    if (!sendUsingMe->sendObject(result, errMsg)) {
-        PDB_COUT << "About to cleanup" << std::endl;
-        getFunctionality<QuerySchedulerServer>().cleanup();
-        return std::make_pair(false, errMsg);
+bool QuerySchedulerServer::recordRound(Handle<Vector<Handle<Computation>>> &computations,
+                                       std::vector<Handle<AbstractJobStage>> &jobStages,
+                                       std::vector<Handle<SetIdentifier>> &intermediateSets,
+                                       PreparedComputationPtr &recordInto) {
+    PreparedRound round;
+
+    // take the plan and the aggregation computation out of every stage, each execution binds its own,
+    // the stages were already scheduled so we can modify them
+    for (auto &stage : jobStages) {
+        int aggComputation = -1;
+        switch (stage->getJobStageTypeID()) {
+            case TupleSetJobStage_TYPEID : {
+                Handle<TupleSetJobStage> tupleSetStage = unsafeCast<TupleSetJobStage, AbstractJobStage>(stage);
+                tupleSetStage->setComputePlan(nullptr,
+                                              tupleSetStage->getSourceTupleSetSpecifier(),
+                                              tupleSetStage->getTargetTupleSetSpecifier(),
+                                              tupleSetStage->getTargetComputationSpecifier());
+                break;
+            }
+            case AggregationJobStage_TYPEID : {
+                // find the computation by its position in the vector, the same position holds the
+                // computation of the same type in every execution
+                Handle<AggregationJobStage> aggStage = unsafeCast<AggregationJobStage, AbstractJobStage>(stage);
+                AbstractAggregateComp *agg = &(*aggStage->getAggComputation());
+                for (int i = 0; i < computations->size(); i++) {
+                    if (agg == &(*(*computations)[i])) {
+                        aggComputation = i;
+                        break;
+                    }
+                }
+                if (aggComputation == -1) {
+                    return false;
+                }
+                aggStage->setAggComputation(nullptr);
+                break;
+            }
+            case BroadcastJoinBuildHTJobStage_TYPEID : {
+                Handle<BroadcastJoinBuildHTJobStage> broadcastJoinStage =
+                        unsafeCast<BroadcastJoinBuildHTJobStage, AbstractJobStage>(stage);
+                broadcastJoinStage->setComputePlan(nullptr,
+                                                   broadcastJoinStage->getSourceTupleSetSpecifier(),
+                                                   broadcastJoinStage->getTargetTupleSetSpecifier(),
+                                                   broadcastJoinStage->getTargetComputationSpecifier());
+                break;
+            }
+            case HashPartitionedJoinBuildHTJobStage_TYPEID : {
+                Handle<HashPartitionedJoinBuildHTJobStage> hashPartitionedJoinStage =
+                        unsafeCast<HashPartitionedJoinBuildHTJobStage, AbstractJobStage>(stage);
+                hashPartitionedJoinStage->setComputePlan(nullptr,
+                                                         hashPartitionedJoinStage->getSourceTupleSetSpecifier(),
+                                                         hashPartitionedJoinStage->getTargetTupleSetSpecifier(),
+                                                         hashPartitionedJoinStage->getTargetComputationSpecifier());
+                break;
+            }
+            default: {
+                return false;
+            }
+        }
+        round.aggComputations.push_back(aggComputation);
     }
 
-    PDB_COUT << "About to cleanup" << std::endl;
-    getFunctionality<QuerySchedulerServer>().cleanup();
-    return std::make_pair(true, errMsg);
+    // copy the stages and the intermediate sets out of the allocation block of this request
+    Handle<Vector<Handle<AbstractJobStage>>> stages = makeObject<Vector<Handle<AbstractJobStage>>>();
+    for (auto &stage : jobStages) {
+        stages->push_back(stage);
+    }
+    Handle<Vector<Handle<SetIdentifier>>> sets = makeObject<Vector<Handle<SetIdentifier>>>();
+    for (auto &intermediateSet : intermediateSets) {
+        sets->push_back(intermediateSet);
+        round.keepIntermediateSets.push_back(this->physicalOptimizerPtr->hasConsumers(intermediateSet));
+    }
+    round.stages = PreparedComputation::toRecord(stages);
+    round.intermediateSets = PreparedComputation::toRecord(sets);
+
+    recordInto->rounds.push_back(round);
+    return true;
+}
+
+bool QuerySchedulerServer::scheduleRecordedStages(PreparedComputationPtr &prepared,
+                                                  Handle<Vector<Handle<Computation>>> &computations,
+                                                  DistributedStorageManagerClient &dsmClient,
+                                                  std::string &errMsg) {
+
+    // all the stages of this execution share the plan, we don't parse it here since only the workers need it
+    Handle<ComputePlan> computePlan = makeObject<ComputePlan>(String(prepared->tcap), *computations);
+
+    for (auto &round : prepared->rounds) {
+
+        // copy the recorded stages and bind them to the computations of this execution
+        Handle<Vector<Handle<AbstractJobStage>>> recordedStages = round.stages->getRootObject();
+        Handle<Vector<Handle<AbstractJobStage>>> stages =
+                deepCopyToCurrentAllocationBlock<Vector<Handle<AbstractJobStage>>>(recordedStages);
+
+        std::vector<Handle<AbstractJobStage>> jobStages;
+        for (int i = 0; i < stages->size(); i++) {
+            Handle<AbstractJobStage> stage = (*stages)[i];
+            switch (stage->getJobStageTypeID()) {
+                case TupleSetJobStage_TYPEID : {
+                    Handle<TupleSetJobStage> tupleSetStage = unsafeCast<TupleSetJobStage, AbstractJobStage>(stage);
+                    tupleSetStage->setComputePlan(computePlan,
+                                                  tupleSetStage->getSourceTupleSetSpecifier(),
+                                                  tupleSetStage->getTargetTupleSetSpecifier(),
+                                                  tupleSetStage->getTargetComputationSpecifier());
+                    break;
+                }
+                case AggregationJobStage_TYPEID : {
+                    Handle<AggregationJobStage> aggStage = unsafeCast<AggregationJobStage, AbstractJobStage>(stage);
+                    Handle<Computation> agg = (*computations)[round.aggComputations[i]];
+                    aggStage->setAggComputation(unsafeCast<AbstractAggregateComp, Computation>(agg));
+                    break;
+                }
+                case BroadcastJoinBuildHTJobStage_TYPEID : {
+                    Handle<BroadcastJoinBuildHTJobStage> broadcastJoinStage =
+                            unsafeCast<BroadcastJoinBuildHTJobStage, AbstractJobStage>(stage);
+                    broadcastJoinStage->setComputePlan(computePlan,
+                                                       broadcastJoinStage->getSourceTupleSetSpecifier(),
+                                                       broadcastJoinStage->getTargetTupleSetSpecifier(),
+                                                       broadcastJoinStage->getTargetComputationSpecifier());
+                    break;
+                }
+                case HashPartitionedJoinBuildHTJobStage_TYPEID : {
+                    Handle<HashPartitionedJoinBuildHTJobStage> hashPartitionedJoinStage =
+                            unsafeCast<HashPartitionedJoinBuildHTJobStage, AbstractJobStage>(stage);
+                    hashPartitionedJoinStage->setComputePlan(computePlan,
+                                                             hashPartitionedJoinStage->getSourceTupleSetSpecifier(),
+                                                             hashPartitionedJoinStage->getTargetTupleSetSpecifier(),
+                                                             hashPartitionedJoinStage->getTargetComputationSpecifier());
+                    break;
+                }
+                default: {
+                    break;
+                }
+            }
+            jobStages.push_back(stage);
+        }
+
+        // copy the intermediate sets
+        Handle<Vector<Handle<SetIdentifier>>> recordedSets = round.intermediateSets->getRootObject();
+        Handle<Vector<Handle<SetIdentifier>>> sets =
+                deepCopyToCurrentAllocationBlock<Vector<Handle<SetIdentifier>>>(recordedSets);
+        std::vector<Handle<SetIdentifier>> intermediateSets;
+        for (int i = 0; i < sets->size(); i++) {
+            intermediateSets.push_back((*sets)[i]);
+        }
+
+        /// create intermediate sets
+        createIntermediateSets(dsmClient, intermediateSets);
+
+        /// schedule this job stages
+        PROFILER_START(scheduleStages)
+
+        bool scheduled = getFunctionality<QuerySchedulerServer>().scheduleStages(jobStages, shuffleInfo);
+
+        PROFILER_END(scheduleStages)
+
+        // if a stage failed the sets of this round are removed with the rest of the intermediate sets
+        if (!scheduled) {
+            this->interGlobalSets.insert(
+                this->interGlobalSets.end(), intermediateSets.begin(), intermediateSets.end());
+            errMsg = this->stageErrMsg;
+            return false;
+        }
+
+        // remove the intermediate sets no later round reads, the rest is removed at the end
+        for (int i = 0; i < intermediateSets.size(); i++) {
+            if (round.keepIntermediateSets[i]) {
+                this->interGlobalSets.push_back(intermediateSets[i]);
+                continue;
+            }
+            std::string removeErrMsg;
+            if (!dsmClient.removeTempSet(intermediateSets[i]->getDatabase(),
+                                         intermediateSets[i]->getSetName(),
+                                         "IntermediateData",
+                                         removeErrMsg)) {
+                logger->error("can't remove temp set: " + removeErrMsg);
+            }
+        }
+    }
+    return true;
 }
 
 void QuerySchedulerServer::removeUnusedIntermediateSets(DistributedStorageManagerClient &dsmClient,
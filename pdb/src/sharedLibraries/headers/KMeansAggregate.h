@@ -23,6 +23,7 @@
 #include "AggregateComp.h"
 #include "KMeansDoubleVector.h"
 #include "limits.h"
+#include <float.h>
 #include "KMeansCentroid.h"
 #include "KMeansAggregateOutputType.h"
 
@@ -40,6 +41,9 @@ class KMeansAggregate : public AggregateComp<KMeansAggregateOutputType,
 private:
     Vector<KMeansDoubleVector> model;
 
+    /* The name of the broadcast variable holding the model, empty if the model is embedded */
+    String modelName;
+
 public:
     ENABLE_DEEP_COPY
 
@@ -54,10 +58,29 @@ public:
         }
     }
 
+    /* Reads the model from a broadcast variable, so that it is neither copied into every
+     * thread's computation nor sent with every stage */
+    KMeansAggregate(std::string modelName) {
+        this->modelName = modelName;
+    }
+
+    /* A worker does not run this computation without the broadcast model */
+    void getRequiredBroadcastVariables(std::vector<std::string>& names) override {
+        if (modelName == "") {
+            return;
+        }
+        names.push_back(modelName);
+    }
+
+    /* The points of a whole TupleSet are assigned at once, see computeClusterMembers; the model is
+     * looked up once, when the pipeline is built, and the lambda keeps a pointer to it */
     Lambda<int> getKeyProjection(Handle<KMeansDoubleVector> aggMe) override {
-        return makeLambda(aggMe, [&](Handle<KMeansDoubleVector>& aggMe) {
-            return this->computeClusterMemberOptimized(*aggMe);
-        });
+        Vector<KMeansDoubleVector>* myModel = getModel();
+        return makeBatchLambda<int>(
+            aggMe,
+            [myModel](std::vector<Handle<KMeansDoubleVector>>& points, std::vector<int>& clusters) {
+                computeClusterMembers(*myModel, points, clusters);
+            });
     }
 
     Lambda<KMeansCentroid> getValueProjection(Handle<KMeansDoubleVector> aggMe) override {
@@ -65,11 +88,51 @@ public:
             aggMe, [](Handle<KMeansDoubleVector>& aggMe) { return KMeansCentroid(1, *aggMe); });
     }
 
+    /* Returns the model, either the broadcast one or the embedded one; the broadcast one is only
+     * bound on the workers, everywhere else this returns nullptr for it */
+    Vector<KMeansDoubleVector>* getModel() {
+        if (modelName == "") {
+            return &model;
+        }
+        Handle<Vector<KMeansDoubleVector>> broadcast =
+            getBroadcastVariable<Vector<KMeansDoubleVector>>(modelName);
+        if (broadcast == nullptr) {
+            return nullptr;
+        }
+        return &(*broadcast);
+    }
+
+    /* Compute the membership of a batch of points, as a blocked product against all centroids */
+    void computeClusterMembers(std::vector<Handle<KMeansDoubleVector>>& points,
+                               std::vector<int>& clusters) {
+        computeClusterMembers(*getModel(), points, clusters);
+    }
+
+    static void computeClusterMembers(Vector<KMeansDoubleVector>& myModel,
+                                      std::vector<Handle<KMeansDoubleVector>>& points,
+                                      std::vector<int>& clusters) {
+        size_t modelSize = myModel.size();
+        std::vector<const double*> centroidRows(modelSize);
+        for (size_t i = 0; i < modelSize; i++) {
+            centroidRows[i] = myModel[i].getRawData();
+        }
+        std::vector<const double*> pointRows(points.size());
+        for (size_t i = 0; i < points.size(); i++) {
+            pointRows[i] = points[i]->getRawData();
+        }
+        DistanceKernels::assignNearest(pointRows.data(),
+                                       pointRows.size(),
+                                       centroidRows.data(),
+                                       modelSize,
+                                       NUM_KMEANS_DIMENSIONS,
+                                       clusters.data());
+    }
+
     /* Compute the membership according to squared distance */
     int computeClusterMember(Handle<KMeansDoubleVector> data) {
-        int closestDistance = INT_MAX;
+        double closestDistance = DBL_MAX;
         int cluster = 0;
-        Vector<KMeansDoubleVector>& myModel = this->model;
+        Vector<KMeansDoubleVector>& myModel = *getModel();
         KMeansDoubleVector& myData = *data;
         size_t modelSize = myModel.size();
         for (int j = 0; j < modelSize; j++) {
@@ -86,9 +149,9 @@ public:
 
     /* Another way to compute the membership */
     int computeClusterMemberOptimized(KMeansDoubleVector& data) {
-        int closestDistance = INT_MAX;
+        double closestDistance = DBL_MAX;
         int cluster = 0;
-        Vector<KMeansDoubleVector>& myModel = model;
+        Vector<KMeansDoubleVector>& myModel = *getModel();
         size_t modelSize = myModel.size();
         for (int i = 0; i < modelSize; i++) {
             KMeansDoubleVector& mean = myModel[i];
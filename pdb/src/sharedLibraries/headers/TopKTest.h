@@ -48,18 +48,26 @@ public:
         double* inArray = forMe->getVector().c_ptr();
         unsigned sz = query.size();
         double distance = 0;
+
+        // the score only goes down as we go, so once it is below the k-th best score we have
+        // seen we know the item is out, and the partial score is as good as the full one
+        double minScore;
+        bool canStopEarly = getThreshold(minScore);
         for (int i = 0; i < sz; i++) {
             distance -= (queryArray[i] - inArray[i]) * (queryArray[i] - inArray[i]);
+            if (canStopEarly && distance < minScore) {
+                break;
+            }
         }
         return distance;
     }
 
     // here we simply create a TopKQueue with the given queue size, and add the pair (getScore
-    // (aggMe), aggMe)
+    // (aggMe), aggMe), unless the item can not make it into the result anymore
     Lambda<TopKQueue<double, Handle<EmpWithVector>>> getValueProjection(
         Handle<EmpWithVector> aggMe) override {
         return makeLambda(aggMe, [&](Handle<EmpWithVector>& aggMe) {
-            return TopKQueue<double, Handle<EmpWithVector>>(k, getScore(aggMe), aggMe);
+            return offer(k, getScore(aggMe), aggMe);
         });
     }
 };
@@ -23,6 +23,7 @@
 #include "PDBObject.h"
 #include "DataTypes.h"
 #include "PDBLogger.h"
+#include <atomic>
 #include <memory>
 #include <pthread.h>
 #include <stdlib.h>
@@ -32,6 +33,12 @@ using namespace std;
 class PDBPage;
 typedef shared_ptr<PDBPage> PDBPagePtr;
 
+// the reference count of a page, and whether it is pinned and whether an eviction has claimed it,
+// share one word, so that they change together
+#define PAGE_REF_COUNT_MASK 0x3fffffffu
+#define PAGE_PINNED_BIT 0x40000000u
+#define PAGE_EVICTING_BIT 0x80000000u
+
 /**
  * This class implements PDBPage that is a fixed size (e.g. 64MB) piece of data allocated in shared
  * memory.
@@ -83,52 +90,93 @@ public:
     void preparePage();
 
 
+    // The reference count, the pinned flag and the evicting flag are one atomic word, changed with
+    // compare-and-swap: a page is never seen unpinned with a reference, and a page that an
+    // eviction has claimed is never pinned again through tryPin ().  The acquire and release
+    // orderings make the contents of the page that one thread wrote before unpinning it visible
+    // to the thread that pins it next.
+
+    // Pins the page whether an eviction has claimed it or not; this is only for a page that the
+    // caller already holds a reference to, or that is not in the cache yet.  A page found in the
+    // cache is pinned through tryPin ().
     inline void incRefCount() {
-        pthread_mutex_lock(&this->refCountMutex);
-        this->refCount++;
-        this->pinned = true;
-        pthread_mutex_unlock(&this->refCountMutex);
-    }
-
-    inline void decRefCount() {
-        pthread_mutex_lock(&this->refCountMutex);
-        this->refCount--;
-        if (this->refCount < 0) {
-            // there is a problem:
-            // reference count should always >= 0
-            this->setPinned(false);
-            this->refCount = 0;
-        } else if (this->refCount == 0) {
-            this->setPinned(false);
+        unsigned int old = this->pinState.load(std::memory_order_relaxed);
+        while (!this->pinState.compare_exchange_weak(
+            old, (old + 1) | PAGE_PINNED_BIT, std::memory_order_acq_rel)) {
         }
-        pthread_mutex_unlock(&this->refCountMutex);
+    }
+
+    // returns the reference count that is left
+    inline int decRefCount() {
+        unsigned int old = this->pinState.load(std::memory_order_relaxed);
+        unsigned int now;
+        do {
+            // reference count should always >= 0, so an extra unpin only unpins
+            unsigned int count = old & PAGE_REF_COUNT_MASK;
+            now = (count == 0) ? old : old - 1;
+            if ((now & PAGE_REF_COUNT_MASK) == 0) {
+                now &= ~PAGE_PINNED_BIT;
+            }
+        } while (!this->pinState.compare_exchange_weak(old, now, std::memory_order_acq_rel));
+        return now & PAGE_REF_COUNT_MASK;
+    }
+
+    // Pins a page that is already cached, without any of the locks of the cache.  This fails, and
+    // the caller has to go through the cache, if an eviction has claimed the page.
+    inline bool tryPin() {
+        unsigned int old = this->pinState.load(std::memory_order_relaxed);
+        do {
+            if ((old & PAGE_EVICTING_BIT) != 0) {
+                return false;
+            }
+        } while (!this->pinState.compare_exchange_weak(
+            old, (old + 1) | PAGE_PINNED_BIT, std::memory_order_acq_rel));
+        return true;
+    }
+
+    // Claims a page that nobody has pinned for an eviction, after which tryPin () fails.  This
+    // fails if the page is pinned, or if another eviction has claimed it.
+    inline bool tryStartEviction() {
+        unsigned int old = this->pinState.load(std::memory_order_relaxed);
+        do {
+            if ((old & (PAGE_REF_COUNT_MASK | PAGE_EVICTING_BIT)) != 0) {
+                return false;
+            }
+        } while (!this->pinState.compare_exchange_weak(
+            old, old | PAGE_EVICTING_BIT, std::memory_order_acq_rel));
+        return true;
+    }
+
+    // Claims the page for an eviction whether it is pinned or not.
+    inline void startEviction() {
+        this->pinState.fetch_or(PAGE_EVICTING_BIT, std::memory_order_acq_rel);
+    }
+
+    // Gives up the claim of an eviction that left the page in the cache.
+    inline void endEviction() {
+        this->pinState.fetch_and(~PAGE_EVICTING_BIT, std::memory_order_acq_rel);
     }
 
     inline void freeContent() {
-        pthread_mutex_lock(&this->refCountMutex);
-        if (this->rawBytes != nullptr) {
-            free(this->rawBytes);
-            this->rawBytes = nullptr;
+        char* bytes = __atomic_exchange_n(&this->rawBytes, nullptr, __ATOMIC_ACQ_REL);
+        if (bytes != nullptr) {
+            free(bytes);
         }
-        pthread_mutex_unlock(&this->refCountMutex);
     }
 
     // this is to increment the reference count embeded in page bytes
     inline int incEmbeddedNumObjects() {
-        pthread_mutex_lock(&this->refCountMutex);
         char* refCountBytes =
             this->rawBytes + (sizeof(NodeID) + sizeof(DatabaseID) + sizeof(UserTypeID) +
                               sizeof(SetID) + sizeof(PageID));
-        *((int*)refCountBytes) = *((int*)refCountBytes) + 1;
-        pthread_mutex_unlock(&this->refCountMutex);
-        return *((int*)refCountBytes);
+        return __atomic_add_fetch((int*)refCountBytes, 1, __ATOMIC_ACQ_REL);
     }
 
     inline int getEmbeddedNumObjects() {
         char* refCountBytes =
             this->rawBytes + (sizeof(NodeID) + sizeof(DatabaseID) + sizeof(UserTypeID) +
                               sizeof(SetID) + sizeof(PageID));
-        return *((int*)refCountBytes);
+        return __atomic_load_n((int*)refCountBytes, __ATOMIC_ACQUIRE);
     }
 
     inline void setNumObjects(int numObjects) {
@@ -258,12 +306,12 @@ public:
 
     // To return the reference count of this page.
     int getRefCount() {
-        return this->refCount;
+        return this->pinState.load(std::memory_order_acquire) & PAGE_REF_COUNT_MASK;
     }
 
     // To reset the reference count of this page.
     void resetRefCount() {
-        this->refCount = 0;
+        this->pinState.fetch_and(~PAGE_REF_COUNT_MASK, std::memory_order_acq_rel);
     }
 
 
@@ -271,23 +319,28 @@ public:
     // Page is pinned if reference count > 0.
     // Once page is unpinned, we can flush the page to disk, or evict the page from cache.
     bool isPinned() {
-        return this->pinned;
+        return (this->pinState.load(std::memory_order_acquire) & PAGE_PINNED_BIT) != 0;
+    }
+
+    // Return whether an eviction has claimed the page.
+    bool isEvicting() {
+        return (this->pinState.load(std::memory_order_acquire) & PAGE_EVICTING_BIT) != 0;
     }
 
     // Return whether page is dirty (i.e. hasn't been flushed to disk yet).
     bool isDirty() {
-        return this->dirty;
+        return this->dirty.load(std::memory_order_acquire);
     }
 
 
     // Return whether page is in flush
     bool isInFlush() {
-        return this->inFlush;
+        return this->inFlush.load(std::memory_order_acquire);
     }
 
     // Return whether page is in eviction
     bool isInEviction() {
-        return this->inEviction;
+        return this->inEviction.load(std::memory_order_acquire);
     }
 
     unsigned int getPageSeqInPartition() const {
@@ -367,22 +420,26 @@ public:
 
     // To set whether the page is pinned or not.
     void setPinned(bool isPinned) {
-        this->pinned = isPinned;
+        if (isPinned) {
+            this->pinState.fetch_or(PAGE_PINNED_BIT, std::memory_order_acq_rel);
+        } else {
+            this->pinState.fetch_and(~PAGE_PINNED_BIT, std::memory_order_acq_rel);
+        }
     }
 
     // To set whether the page is dirty or not.
     void setDirty(bool dirty) {
-        this->dirty = dirty;
+        this->dirty.store(dirty, std::memory_order_release);
     }
 
     // To set whether the page is in flush or not.
     void setInFlush(bool inFlush) {
-        this->inFlush = inFlush;
+        this->inFlush.store(inFlush, std::memory_order_release);
     }
 
     // To set whether the page is in eviction or not
     void setInEviction(bool inEviction) {
-        this->inEviction = inEviction;
+        this->inEviction.store(inEviction, std::memory_order_release);
     }
 
     void setPageSeqInPartition(unsigned int pageSeqInPartition) {
@@ -415,14 +472,13 @@ private:
     SetID setID;
     PageID pageID;
     size_t size;
-    int refCount;
-    bool pinned;
-    bool dirty;
-    pthread_mutex_t refCountMutex;
+    // the reference count, and the PAGE_PINNED_BIT and PAGE_EVICTING_BIT flags
+    std::atomic<unsigned int> pinState;
+    std::atomic<bool> dirty;
     pthread_rwlock_t flushLock;
     long accessSequenceId;
-    bool inFlush;
-    bool inEviction;
+    std::atomic<bool> inFlush;
+    std::atomic<bool> inEviction;
 
     // Below info can only be filled when the page has been loaded to cache after flushed to a disk
     // file.
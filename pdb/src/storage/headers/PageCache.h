@@ -31,6 +31,7 @@
 #include "SharedMem.h"
 #include "PageCircularBuffer.h"
 #include "LocalitySet.h"
+#include <atomic>
 #include <unordered_map>
 #include <memory>
 #include <queue>
@@ -314,8 +315,8 @@ private:
     bool inEviction;
     pdb::PDBWorkerQueuePtr workers;
     pdb::PDBWorkPtr evictWork;
-    long accessCount;
-    pthread_mutex_t countLock;
+    // stamps every page access, so that the eviction can tell recently used pages apart
+    std::atomic<long> accessCount;
     SharedMemPtr shm;
     PageCircularBufferPtr flushBuffer;
     CacheStrategy strategy;
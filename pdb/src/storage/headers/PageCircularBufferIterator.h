@@ -56,6 +56,18 @@ public:
      */
     PDBPagePtr next() override;
 
+    /**
+     * Return the next page together with the range [begin, end) of objects in its root vector
+     * that the caller should process; by default this is the whole page, with end set to SIZE_MAX.
+     * It returns false if there are no more pages.
+     */
+    virtual bool nextRange(PDBPagePtr& page, size_t& begin, size_t& end);
+
+    /**
+     * Called once the caller is done with the oldest range it got from nextRange().
+     * Return true if no one else is working on the page of that range, so that it can be unpinned.
+     */
+    virtual bool finishRange();
 
     /**
      * Return the ID of this iterator.
@@ -31,6 +31,8 @@
 #include "SharedMem.h"
 #include "DataTypes.h"
 #include "StoragePagePinned.h"
+#include "PDBVector.h"
+#include "ColumnRange.h"
 #include <string.h>
 #include <pthread.h>
 #include <memory>
@@ -65,11 +67,14 @@ public:
      * Obtain a set of iterators given the specified set information and number of threads.
      * Each iterator work as a consumer, retrieving a page from the concurrent blocking buffer,
      * each time when next() is invoked.
+     * If a range filter is given, the frontend skips the pages whose zone maps rule it out.
      */
-    vector<PageCircularBufferIteratorPtr> getSetIterators(NodeID nodeId,
-                                                          DatabaseID dbId,
-                                                          UserTypeID typeId,
-                                                          SetID setId);
+    vector<PageCircularBufferIteratorPtr> getSetIterators(
+        NodeID nodeId,
+        DatabaseID dbId,
+        UserTypeID typeId,
+        SetID setId,
+        pdb::Handle<pdb::Vector<pdb::ColumnRange>> rangeFilter = nullptr);
 
     /**
      * To receive PagePinned objects from frontend.
@@ -0,0 +1,111 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef PAGE_ZONE_MAP_H
+#define PAGE_ZONE_MAP_H
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "ColumnRange.h"
+
+class PageZoneMap;
+typedef std::shared_ptr<PageZoneMap> PageZoneMapPtr;
+
+// the ranges a page has to overlap to be scanned
+typedef std::vector<pdb::ColumnRange> ZoneMapFilter;
+typedef std::shared_ptr<ZoneMapFilter> ZoneMapFilterPtr;
+
+/**
+ * The zone map of a page: the smallest and the largest value of some attributes over all
+ * objects on the page.  It is built when the page is written, and lets a scan with range
+ * predicates on those attributes skip the page without pinning it.
+ */
+class PageZoneMap {
+
+public:
+    // widens the range of an attribute so that it covers [minValue, maxValue]
+    void add(const char* name,
+             pdb::ColumnType type,
+             uint32_t width,
+             const void* minValue,
+             const void* maxValue) {
+        for (pdb::ColumnRange& range : ranges) {
+            if (strcmp(range.name, name) == 0) {
+                range.add(minValue, maxValue);
+                return;
+            }
+        }
+        pdb::ColumnRange range;
+        range.init(name, type, width);
+        range.add(minValue, maxValue);
+        ranges.push_back(range);
+    }
+
+    // returns false if no object on the page can be in every range of the filter; attributes
+    // the zone map knows nothing about never rule a page out
+    bool mayMatch(const ZoneMapFilter& filter) const {
+        for (const pdb::ColumnRange& predicate : filter) {
+            for (const pdb::ColumnRange& range : ranges) {
+                if (strcmp(range.name, predicate.name) == 0 && range.type == predicate.type &&
+                    !range.overlaps(predicate)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    const std::vector<pdb::ColumnRange>& getRanges() const {
+        return ranges;
+    }
+
+    bool isEmpty() const {
+        return ranges.empty();
+    }
+
+    // the number of bytes serialize () writes
+    size_t getSerializedSize() const {
+        return sizeof(unsigned int) + ranges.size() * sizeof(pdb::ColumnRange);
+    }
+
+    // writes the zone map to buffer, which must have getSerializedSize () bytes
+    void serialize(char* buffer) const {
+        *((unsigned int*)buffer) = ranges.size();
+        memcpy(buffer + sizeof(unsigned int),
+               ranges.data(),
+               ranges.size() * sizeof(pdb::ColumnRange));
+    }
+
+    // reads a zone map written by serialize (), and returns the bytes it took up
+    size_t deserialize(const char* buffer) {
+        unsigned int numRanges = *((const unsigned int*)buffer);
+        ranges.resize(numRanges);
+        memcpy(ranges.data(),
+               buffer + sizeof(unsigned int),
+               numRanges * sizeof(pdb::ColumnRange));
+        return getSerializedSize();
+    }
+
+private:
+    // one range per attribute
+    std::vector<pdb::ColumnRange> ranges;
+};
+
+#endif
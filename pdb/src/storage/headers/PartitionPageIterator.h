@@ -34,19 +34,22 @@ class PartitionPageIterator : public PageIteratorInterface {
 
 public:
     /**
-     * To create a new PartitionPageIterator instance
+     * To create a new PartitionPageIterator instance, if a filter is given, the pages whose zone
+     * maps rule it out are skipped
      */
     PartitionPageIterator(PageCachePtr cache,
                           PDBFilePtr file,
                           FilePartitionID partitionId,
-                          UserSet* set = nullptr);
+                          UserSet* set = nullptr,
+                          ZoneMapFilterPtr filter = nullptr);
     /*
      * To support polymorphism.
      */
     ~PartitionPageIterator(){};
 
     /**
-     * To return the next page. If there is no more page, return nullptr.
+     * To return the next page. If there is no more page, or the next page is skipped, return
+     * nullptr.
      */
     PDBPagePtr next();
 
@@ -65,6 +68,7 @@ private:
     unsigned int numPages;
     unsigned int numIteratedPages;
     UserSet* set;
+    ZoneMapFilterPtr filter;
 };
 
 
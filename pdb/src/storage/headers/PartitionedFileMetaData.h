@@ -26,6 +26,7 @@
 #define SRC_CPP_MAIN_DATABASE_HEADERS_PARTITIONEDFILEMETADATA_H_
 
 #include "DataTypes.h"
+#include "PageZoneMap.h"
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -204,6 +205,33 @@ public:
         return pageIndexes;
     }
 
+    // Set the zone map of a page, replacing the one it had
+    void setZoneMap(PageID pageId, PageZoneMapPtr zoneMap) {
+        pthread_mutex_lock(&indexMutex);
+        this->zoneMaps[pageId] = zoneMap;
+        pthread_mutex_unlock(&indexMutex);
+    }
+
+    // Return the zone map of a page, or nullptr if it has none
+    PageZoneMapPtr getZoneMap(PageID pageId) {
+        PageZoneMapPtr zoneMap = nullptr;
+        pthread_mutex_lock(&indexMutex);
+        auto search = this->zoneMaps.find(pageId);
+        if (search != this->zoneMaps.end()) {
+            zoneMap = search->second;
+        }
+        pthread_mutex_unlock(&indexMutex);
+        return zoneMap;
+    }
+
+    // Return a snapshot of the zone maps of all pages that have one
+    unordered_map<PageID, PageZoneMapPtr> getZoneMaps() {
+        pthread_mutex_lock(&indexMutex);
+        unordered_map<PageID, PageZoneMapPtr> snapshot = this->zoneMaps;
+        pthread_mutex_unlock(&indexMutex);
+        return snapshot;
+    }
+
 private:
     // Metadata version
     unsigned short version;
@@ -218,6 +246,8 @@ private:
     // a map of PageID to PageIndex
     unordered_map<PageID, PageIndex>* pageIndexes = nullptr;
     unordered_map<PageIndex, PageID, PageIndexHash, PageIndexEqual>* pageIds = nullptr;
+    // the min/max of some attributes on each page, for the pages whose objects keep them
+    unordered_map<PageID, PageZoneMapPtr> zoneMaps;
     pthread_mutex_t metaMutex;
     pthread_mutex_t indexMutex;
 };
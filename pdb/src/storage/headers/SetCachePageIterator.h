@@ -38,8 +38,8 @@ typedef shared_ptr<SetCachePageIterator> SetCachePageIteratorPtr;
 class SetCachePageIterator : public PageIteratorInterface {
 public:
     // NOTE: the constructor can only be invoked in UserSet::getIterators(), where it will be
-    // protected by lockDirtyPageSet();
-    SetCachePageIterator(PageCachePtr cache, UserSet* set);
+    // protected by lockDirtyPageSet(); pages whose zone maps rule out the filter are skipped
+    SetCachePageIterator(PageCachePtr cache, UserSet* set, ZoneMapFilterPtr filter = nullptr);
     virtual ~SetCachePageIterator();
 
     /**
@@ -54,7 +54,7 @@ public:
 
     /**
      * Returns the next page in the input buffer.
-     * If there is no more page, returns nullptr.
+     * If there is no more page, or the next page is skipped, returns nullptr.
      */
     PDBPagePtr next() override;
 
@@ -66,6 +66,7 @@ public:
 private:
     PageCachePtr cache;
     UserSet* set;
+    ZoneMapFilterPtr filter;
     std::unordered_map<PageID, FileSearchKey>::iterator iter;
 };
 
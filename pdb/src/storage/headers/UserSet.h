@@ -193,9 +193,24 @@ public:
      * The set of iterators will include:
      * -- 1 iterator to scan data in input buffer;
      * -- K iterators to scan data in file partitions, assuming there are K partitions.
+     * If a filter is given, the iterators skip the pages whose zone maps rule it out.
      * IMPORTANT: user needs to delete the returned vector!!!
      */
-    virtual vector<PageIteratorPtr>* getIterators();
+    virtual vector<PageIteratorPtr>* getIterators(ZoneMapFilterPtr filter = nullptr);
+
+    /**
+     * Set the zone map of a page in this set, it is kept in the meta data of the file.
+     */
+    void setZoneMap(PageID pageId, PageZoneMapPtr zoneMap) {
+        this->file->getMetaData()->setZoneMap(pageId, zoneMap);
+    }
+
+    /**
+     * Return the zone map of a page in this set, or nullptr if the page has none.
+     */
+    PageZoneMapPtr getZoneMap(PageID pageId) {
+        return this->file->getMetaData()->getZoneMap(pageId);
+    }
 
     /**
      * Get page from set.
@@ -0,0 +1,112 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef WORK_STEALING_PAGE_ITERATOR_H
+#define WORK_STEALING_PAGE_ITERATOR_H
+
+#include "PageCircularBufferIterator.h"
+#include "WorkStealingScheduler.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+using namespace std;
+
+/**
+ * A source page that was split into morsels; whoever finishes its last morsel unpins it.
+ */
+struct MorselSourcePage {
+    MorselSourcePage(PDBPagePtr page, int numMorsels) : page(page), numMorselsLeft(numMorsels) {}
+
+    PDBPagePtr page;
+
+    // the morsels of this page that are not finished yet
+    std::atomic<int> numMorselsLeft;
+};
+typedef shared_ptr<MorselSourcePage> MorselSourcePagePtr;
+
+/**
+ * A range [begin, end) of objects in the root vector of a source page, this is the unit of work
+ * that pipeline threads take from the work-stealing scheduler.
+ */
+struct PageMorsel {
+    MorselSourcePagePtr source = nullptr;
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+class WorkStealingPageIterator;
+typedef shared_ptr<WorkStealingPageIterator> WorkStealingPageIteratorPtr;
+
+/**
+ * This iterates over the morsels a pipeline thread takes from a work-stealing scheduler.
+ * Consumers that only look at whole pages must not use it, since a page may be split among
+ * several threads; use nextRange () and finishRange () instead.
+ */
+class WorkStealingPageIterator : public PageCircularBufferIterator {
+public:
+    WorkStealingPageIterator(unsigned int id,
+                             pdb::WorkStealingSchedulerPtr<PageMorsel> scheduler,
+                             pdb::PDBLoggerPtr logger);
+    ~WorkStealingPageIterator();
+
+    /**
+     * Return true if there is another morsel to process, blocks until we know.
+     */
+    bool hasNext() override;
+
+    /**
+     * Return the page of the next morsel, or nullptr if the scheduler is drained.
+     */
+    PDBPagePtr next() override;
+
+    /**
+     * Return the page and the object range of the next morsel.
+     */
+    bool nextRange(PDBPagePtr& page, size_t& begin, size_t& end) override;
+
+    /**
+     * Finish the oldest morsel handed out, return true if it was the last one of its page.
+     */
+    bool finishRange() override;
+
+    /**
+     * Split a source page with the given number of objects into morsels of morselSize objects,
+     * and queue them for the given pipeline thread; an empty page still makes one morsel, so that
+     * someone unpins it.
+     */
+    static void submitMorsels(pdb::WorkStealingSchedulerPtr<PageMorsel> scheduler,
+                              int homeWorker,
+                              PDBPagePtr page,
+                              size_t numObjects,
+                              size_t morselSize);
+
+private:
+    // takes the next morsel and remembers it until it is finished
+    PageMorsel takeNext();
+
+    pdb::WorkStealingSchedulerPtr<PageMorsel> scheduler;
+
+    // the morsel hasNext () has taken from the scheduler but next () has not returned yet
+    PageMorsel nextMorsel;
+
+    // the morsels handed out but not finished yet, oldest first
+    std::deque<PageMorsel> inFlight;
+};
+
+#endif
@@ -0,0 +1,35 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef ZONE_MAPPED_OBJECT_H
+#define ZONE_MAPPED_OBJECT_H
+
+#include "Object.h"
+#include "PageZoneMap.h"
+
+// An object that knows the min/max of some of its attributes, e.g. a columnar block.  When such
+// objects are written to a page, the storage merges what they report into the zone map of the
+// page, so that selective scans can skip the page (see ScanUserSet :: addRangeFilter).
+class ZoneMappedObject : public pdb::Object {
+
+public:
+    // widens the ranges of the zone map so that they cover the attributes of this object
+    virtual void addToZoneMap(PageZoneMap& zoneMap) = 0;
+};
+
+#endif
@@ -85,12 +85,16 @@ void PDBFlushConsumerWork::execute(PDBBuzzerPtr callerBuzzer) {
                 PDB_COUT << "page with PageID " << page->getPageID()
                          << " appended to partition with PartitionID " << this->partitionId << "\n";
             }
+// claim the page, so that nobody pins it while we free it
 #ifndef UNPIN_FOR_NON_ZERO_REF_COUNT
-            if ((page->getRawBytes() != nullptr) && (page->getRefCount() == 0) &&
-                (page->isInEviction() == true)) {
+            bool toEvict = (page->isInEviction() == true) && (page->tryStartEviction() == true);
 #else
-            if ((page->getRawBytes() != nullptr) && (page->isInEviction() == true)) {
+            bool toEvict = page->isInEviction();
+            if (toEvict == true) {
+                page->startEviction();
+            }
 #endif
+            if ((page->getRawBytes() != nullptr) && (toEvict == true)) {
 
                 // remove the page from cache!
                 PDB_COUT << "to free the page!\n";
@@ -100,12 +104,8 @@ void PDBFlushConsumerWork::execute(PDBBuzzerPtr callerBuzzer) {
                 page->setOffset(0);
                 page->setRawBytes(nullptr);
             }
-// remove the page from cache!
-#ifndef UNPIN_FOR_NON_ZERO_REF_COUNT
-            if ((page->getRefCount() == 0) && (page->isInEviction() == true)) {
-#else
-            if (page->isInEviction() == true) {
-#endif
+            // remove the page from cache!
+            if (toEvict == true) {
                 this->server->getCache()->removePage(key);
             } else {
                 page->setInFlush(false);
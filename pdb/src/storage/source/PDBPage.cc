@@ -45,13 +45,12 @@ PDBPage::PDBPage(char* dataIn,
     this->numObjects = numObjectsIn;
     this->curAppendOffset = sizeof(NodeID) + sizeof(DatabaseID) + sizeof(UserTypeID) +
         sizeof(SetID) + sizeof(PageID) + sizeof(int) + sizeof(size_t);
-    this->refCount = 0;
-    this->pinned = true;
+    this->pinState = PAGE_PINNED_BIT;
     this->dirty = false;
     this->inFlush = false;
+    this->inEviction = false;
     this->partitionId = (FilePartitionID)(-1);
     this->pageSeqInPartition = (unsigned int)(-1);
-    pthread_mutex_init(&(this->refCountMutex), nullptr);
     pthread_rwlock_init(&(this->flushLock), nullptr);
     this->internalOffset = internalOffset;
     char* refCountBytes = this->rawBytes +
@@ -83,20 +82,18 @@ PDBPage::PDBPage(char* dataIn, size_t offset, int internalOffset) {
     this->numObjects = *((int*)cur);
     cur = cur + sizeof(int);
     this->size = *((size_t*)cur);
-    this->refCount = 0;
-    this->pinned = true;
+    this->pinState = PAGE_PINNED_BIT;
     this->dirty = false;
     this->inFlush = false;
+    this->inEviction = false;
     this->partitionId = (FilePartitionID)(-1);
     this->pageSeqInPartition = (unsigned int)(-1);
-    pthread_mutex_init(&(this->refCountMutex), nullptr);
     pthread_rwlock_init(&(this->flushLock), nullptr);
 }
 
 
 PDBPage::~PDBPage() {
     freePage();
-    pthread_mutex_destroy(&(this->refCountMutex));
     pthread_rwlock_destroy(&(this->flushLock));
 }
 
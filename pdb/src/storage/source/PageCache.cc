@@ -42,7 +42,6 @@ PageCache::PageCache(ConfigurationPtr conf,
     this->cache = new unordered_map<CacheKey, PDBPagePtr, CacheKeyHash, CacheKeyEqual>();
     this->conf = conf;
     this->workers = workers;
-    pthread_mutex_init(&this->countLock, nullptr);
     pthread_mutex_init(&this->cacheMutex, nullptr);
     pthread_mutex_init(&this->evictionMutex, nullptr);
     pthread_rwlock_init(&this->evictionAndFlushLock, nullptr);
@@ -52,22 +51,22 @@ PageCache::PageCache(ConfigurationPtr conf,
     this->size = 0;
     this->warnSize = (this->maxSize) * WARN_THRESHOLD;
 
-    std::cout << "maxSize=" << maxSize << std::endl;
+    PDB_LOG(DEBUG) << "maxSize=" << maxSize << std::endl;
 
     this->evictStopSize = (this->maxSize) * EVICT_STOP_THRESHOLD;
 
-    std::cout << "evictStopSize=" << evictStopSize << std::endl;
+    PDB_LOG(DEBUG) << "evictStopSize=" << evictStopSize << std::endl;
 
     if (this->evictStopSize >= (shm->getShmSize() - 6 * conf->getMaxPageSize())) {
         this->evictStopSize = shm->getShmSize() - 6 * conf->getMaxPageSize();
-        std::cout << "evictStopSize=" << evictStopSize << std::endl;
+        PDB_LOG(DEBUG) << "evictStopSize=" << evictStopSize << std::endl;
         if (this->evictStopSize <= conf->getMaxPageSize()) {
             this->evictStopSize = conf->getMaxPageSize();
-            std::cout << "evictStopSize=" << evictStopSize << std::endl;
+            PDB_LOG(DEBUG) << "evictStopSize=" << evictStopSize << std::endl;
         }
     }
-    std::cout << "PageCache: EVICT_STOP_SIZE is automatically tuned to be " << this->evictStopSize
-              << std::endl;
+    PDB_LOG(INFO) << "PageCache: EVICT_STOP_SIZE is automatically tuned to be " << this->evictStopSize
+                  << std::endl;
     this->flushBuffer = flushBuffer;
     this->logger = logger;
     this->shm = shm;
@@ -86,7 +85,6 @@ PageCache::PageCache(ConfigurationPtr conf,
 
 PageCache::~PageCache() {
     delete this->cache;
-    pthread_mutex_destroy(&this->countLock);
     pthread_mutex_destroy(&this->cacheMutex);
     pthread_mutex_destroy(&this->evictionMutex);
     pthread_rwlock_destroy(&this->evictionAndFlushLock);
@@ -126,8 +124,8 @@ char* PageCache::allocateBufferFromSharedMemoryBlocking(size_t size, int& alignO
     while (data == nullptr) {
         this->logger->info("LRUPageCache: out of memory in off-heap pool, start eviction.");
 #ifdef PROFILING_CACHE
-        std::cout << "Out of memory in shared memory pool, trying to allocate " << size << " data"
-                  << std::endl;
+        PDB_LOG(ERROR) << "Out of memory in shared memory pool, trying to allocate " << size << " data"
+                       << std::endl;
 #endif
         if (this->inEviction == false) {
             this->evict();
@@ -184,7 +182,7 @@ PDBPagePtr PageCache::buildAndCachePageFromFileHandle(int handle,
     char* buffer = allocateBufferFromSharedMemoryBlocking(size, offset);
     ssize_t readSize = read(handle, buffer, size);
     if (readSize <= 0) {
-        std::cout << "PageCache: Read failed" << std::endl;
+        PDB_LOG(ERROR) << "PageCache: Read failed" << std::endl;
         return nullptr;
     }
     PDBPagePtr page = make_shared<PDBPage>(
@@ -219,7 +217,7 @@ PDBPagePtr PageCache::buildPageFromSharedMemoryData(PDBFilePtr file,
                                            numObjects);
     if (page == nullptr) {
         this->logger->error("Fatal Error: PageCache: out of memory in heap.");
-        std::cout << "FATAL ERROR: PageCache out of memory" << std::endl;
+        PDB_LOG(ERROR) << "FATAL ERROR: PageCache out of memory" << std::endl;
         exit(-1);
     }
     page->setNumObjects(numObjects);
@@ -314,6 +312,7 @@ bool PageCache::freePage(PDBPagePtr curPage) {
         return false;
     }
     size_t pageSizeAllocated = this->cache->at(key)->getRawSize() + 512;
+    curPage->startEviction();
     cache->erase(key);
     this->size -= pageSizeAllocated;
     pthread_mutex_unlock(&this->cacheMutex);
@@ -345,11 +344,44 @@ PDBPagePtr PageCache::getPage(PartitionedFilePtr file,
         partitionId = pageIndex.partitionId;
         pageSeqInPartition = pageIndex.pageSeqInPartition;
     }
+    // re-pinning a page that is already cached does not wait for an eviction that is in progress:
+    // it only holds cacheMutex for the lookup, and the page is pinned by a compare-and-swap that
+    // fails if the eviction has claimed it, and then we go the slow way below
+    pthread_mutex_lock(&this->cacheMutex);
+    auto cached = this->cache->find(key);
+    if ((cached != this->cache->end()) && (cached->second != nullptr) &&
+        (cached->second->tryPin() == true)) {
+        page = cached->second;
+        pthread_mutex_unlock(&this->cacheMutex);
+        page->setAccessSequenceId(this->accessCount++);
+        if (set != nullptr) {
+            set->updateCachedPage(page);
+        }
+        return page;
+    }
+    pthread_mutex_unlock(&this->cacheMutex);
+
     // Assumption: At one time, for a page, only one thread will try to load it.
     // Above assumption is guaranteed by the front-end scan model.
     pthread_mutex_lock(&this->evictionMutex);
     this->evictionLock();
     pthread_mutex_lock(&this->cacheMutex);
+
+    // a page that an eviction has claimed stays in the cache until the eviction has freed it and
+    // removed it, so we pin it only through tryPin (); if that fails we wait for the page to be
+    // gone, and then load it again like any page that is not cached
+    auto claimed = this->cache->find(key);
+    while ((claimed != this->cache->end()) && (claimed->second != nullptr) &&
+           (claimed->second->tryPin() == false)) {
+        pthread_mutex_unlock(&this->cacheMutex);
+        this->evictionUnlock();
+        pthread_mutex_unlock(&this->evictionMutex);
+        sched_yield();
+        pthread_mutex_lock(&this->evictionMutex);
+        this->evictionLock();
+        pthread_mutex_lock(&this->cacheMutex);
+        claimed = this->cache->find(key);
+    }
     if (this->containsPage(key) != true) {
         pthread_mutex_unlock(&this->cacheMutex);
         this->evictionUnlock();
@@ -358,35 +390,27 @@ PDBPagePtr PageCache::getPage(PartitionedFilePtr file,
         if (page == nullptr) {
             return nullptr;
         }
-        pthread_mutex_lock(&this->countLock);
-        page->setAccessSequenceId(this->accessCount);
-        this->accessCount++;
-        pthread_mutex_unlock(&this->countLock);
+        page->setAccessSequenceId(this->accessCount++);
 
+        // the page is pinned before it is cached, so that no eviction can claim it in between
         pthread_mutex_lock(&this->evictionMutex);
-        this->cachePage(page, set);
-        page->setPinned(true);
         page->setDirty(false);
         page->incRefCount();
+        this->cachePage(page, set);
         pthread_mutex_unlock(&this->evictionMutex);
     } else {
         page = this->cache->at(key);
         pthread_mutex_unlock(&this->cacheMutex);
         if (page == nullptr) {
-            std::cout << "WARNING: PartitionPageIterator get nullptr in cache.\n" << std::endl;
+            PDB_LOG(WARN) << "WARNING: PartitionPageIterator get nullptr in cache.\n" << std::endl;
             logger->warn("PartitionPageIterator get nullptr in cache.");
             this->evictionUnlock();
             pthread_mutex_unlock(&this->evictionMutex);
             return nullptr;
         }
-        page->setPinned(true);
-        page->incRefCount();
         this->evictionUnlock();
         pthread_mutex_unlock(&this->evictionMutex);
-        pthread_mutex_lock(&this->countLock);
-        page->setAccessSequenceId(this->accessCount);
-        this->accessCount++;
-        pthread_mutex_unlock(&this->countLock);
+        page->setAccessSequenceId(this->accessCount++);
         if (set != nullptr) {
             set->updateCachedPage(page);
         }
@@ -408,22 +432,25 @@ PDBPagePtr PageCache::getPage(CacheKey key, LocalitySet* set) {
     pthread_mutex_lock(&this->cacheMutex);
     if (this->containsPage(key) != true) {
         pthread_mutex_unlock(&this->cacheMutex);
-        std::cout << "WARNING: SetCachePageIterator get nullptr in cache.\n" << std::endl;
+        PDB_LOG(WARN) << "WARNING: SetCachePageIterator get nullptr in cache.\n" << std::endl;
         logger->warn("SetCachePageIterator get nullptr in cache.");
         return nullptr;
     } else {
         PDBPagePtr page = this->cache->at(key);
         pthread_mutex_unlock(&this->cacheMutex);
         if (page == nullptr) {
-            std::cout << "WARNING: SetCachePageIterator get nullptr in cache.\n" << std::endl;
+            PDB_LOG(WARN) << "WARNING: SetCachePageIterator get nullptr in cache.\n" << std::endl;
             logger->warn("SetCachePageIterator get nullptr in cache.");
             return nullptr;
         }
-        page->incRefCount();
-        pthread_mutex_lock(&this->countLock);
-        page->setAccessSequenceId(this->accessCount);
-        this->accessCount++;
-        pthread_mutex_unlock(&this->countLock);
+        // a page that an eviction has claimed is about to be freed, so it can not be pinned
+        if (page->tryPin() == false) {
+            PDB_LOG(WARN) << "WARNING: SetCachePageIterator get evicted page in cache.\n"
+                          << std::endl;
+            logger->warn("SetCachePageIterator get evicted page in cache.");
+            return nullptr;
+        }
+        page->setAccessSequenceId(this->accessCount++);
         if (set != nullptr) {
             set->updateCachedPage(page);
         }
@@ -455,10 +482,7 @@ PDBPagePtr PageCache::getNewPageNonBlocking(NodeID nodeId,
                                            shm->computeOffset(pageData),
                                            internalOffset);
 
-    pthread_mutex_lock(&this->countLock);
-    page->setAccessSequenceId(this->accessCount);
-    this->accessCount++;
-    pthread_mutex_unlock(&this->countLock);
+    page->setAccessSequenceId(this->accessCount++);
     page->setPinned(true);
     page->setDirty(true);
     pthread_mutex_lock(&evictionMutex);
@@ -498,10 +522,7 @@ PDBPagePtr PageCache::getNewPage(NodeID nodeId, CacheKey key, LocalitySet* set,
                                            shm->computeOffset(pageData),
                                            internalOffset);
 
-    pthread_mutex_lock(&this->countLock);
-    page->setAccessSequenceId(this->accessCount);
-    this->accessCount++;
-    pthread_mutex_unlock(&this->countLock);
+    page->setAccessSequenceId(this->accessCount++);
     page->setPinned(true);
     page->setDirty(true);
     pthread_mutex_lock(&evictionMutex);
@@ -643,7 +664,8 @@ bool PageCache::evictPage(CacheKey key, bool tryFlushOrNot) {
     if (this->containsPage(key) == true) {
         PDBPagePtr page = this->cache->at(key);
 #ifndef UNPIN_FOR_NON_ZERO_REF_COUNT
-        if (page->getRefCount() > 0) {
+        // claim the page, so that nobody pins it while we free it
+        if (page->tryStartEviction() == false) {
             cout << "can't be unpinned due to non-zero reference count " << page->getRefCount()
                  << "with DatabaseID=" << page->getDbID() << ", TypeID=" << page->getTypeID()
                  << ", SetID=" << page->getSetID() << ", PageID=" << page->getPageID() << "\n";
@@ -662,18 +684,20 @@ bool PageCache::evictPage(CacheKey key, bool tryFlushOrNot) {
                 ((page->getDbID() != 0) || (page->getTypeID() != 1)) &&
                 ((page->getDbID() != 0) || (page->getTypeID() != 2))) {
 #ifdef PROFILING_CACHE
-                std::cout << "going to unpin a dirty page...\n";
+                PDB_LOG(DEBUG) << "going to unpin a dirty page...\n";
 #endif
                 // update counter
                 page->setInFlush(true);
                 page->setInEviction(true);
+                // the flushing thread claims the page again before it frees it
+                page->endEviction();
                 // flush the page
                 // first we release the lock so that the flushing thread can run.
                 this->flushBuffer->addPageToTail(page);
 
             } else if (page->isInFlush() == false) {
 #ifdef PROFILING_CACHE
-                std::cout << "going to unpin a clean page...\n";
+                PDB_LOG(DEBUG) << "going to unpin a clean page...\n";
 #endif
                 // free the page
                 // We use flush lock (which is a read write lock) to synchronize with getPage() that
@@ -683,6 +707,7 @@ bool PageCache::evictPage(CacheKey key, bool tryFlushOrNot) {
                 // checking for loading may get evicted before it is pinned.
                 // Add flush lock is to guard for similar scenarios.
                 this->flushLock();
+                page->startEviction();
                 this->shm->free(page->getRawBytes() - page->getInternalOffset(),
                                 page->getRawSize() + 512);
 
@@ -690,12 +715,15 @@ bool PageCache::evictPage(CacheKey key, bool tryFlushOrNot) {
                 page->setRawBytes(nullptr);
                 removePage(key);
                 this->flushUnlock();
+            } else {
+                // it is being flushed, and stays in the cache until then
+                page->endEviction();
             }
 #ifdef PROFILING_CACHE
-            std::cout << "Storage server: evicting page from cache for dbId:" << page->getDbID()
-                      << ", typeID:" << page->getTypeID() << ", setID=" << page->getSetID()
-                      << ", pageID: " << page->getPageID() << ", tryFlushing=" << tryFlushOrNot
-                      << ".\n";
+            PDB_LOG(DEBUG) << "Storage server: evicting page from cache for dbId:" << page->getDbID()
+                           << ", typeID:" << page->getTypeID() << ", setID=" << page->getSetID()
+                           << ", pageID: " << page->getPageID() << ", tryFlushing=" << tryFlushOrNot
+                           << ".\n";
 #endif
         }
 
@@ -738,8 +766,8 @@ void PageCache::evict() {
         return;
     }
 #ifdef PROFILING_CACHE
-    std::cout << "Storage server: starting cache eviction to get more room with used size= "
-              << this->size << "!\n";
+    PDB_LOG(INFO) << "Storage server: starting cache eviction to get more room with used size= "
+                  << this->size << "!\n";
 #endif
     pthread_mutex_lock(&this->evictionMutex);
     this->inEviction = true;
@@ -798,11 +826,11 @@ void PageCache::evict() {
                  ((curPage->isDirty() == true) && (curPage->isInFlush() == false)))) {
                 cachedPages->push(curPage);
 #ifdef PROFILING_CACHE
-                std::cout << "Add to eviction queue: curPage->getRefCount()="
-                          << curPage->getRefCount() << ", curPage->isDirty()=" << curPage->isDirty()
-                          << ", curPage->isInFlush)=" << curPage->isInFlush()
-                          << ", curPage->dbId=" << curPage->getDbID()
-                          << ", curPage->setId=" << curPage->getSetID() << std::endl;
+                PDB_LOG(DEBUG) << "Add to eviction queue: curPage->getRefCount()="
+                               << curPage->getRefCount() << ", curPage->isDirty()=" << curPage->isDirty()
+                               << ", curPage->isInFlush)=" << curPage->isInFlush()
+                               << ", curPage->dbId=" << curPage->getDbID()
+                               << ", curPage->setId=" << curPage->getSetID() << std::endl;
 #endif
             } else {
                 // do nothing
@@ -819,10 +847,10 @@ void PageCache::evict() {
             }
             if (this->evictPage(page) == true) {
 #ifdef PROFILING
-                std::cout << "Storage server: evicted page from cache passively for dbId:"
-                          << page->getDbID() << ", typeID:" << page->getTypeID()
-                          << ", setID=" << page->getSetID() << ", pageID: " << page->getPageID()
-                          << ".\n";
+                PDB_LOG(DEBUG) << "Storage server: evicted page from cache passively for dbId:"
+                               << page->getDbID() << ", typeID:" << page->getTypeID()
+                               << ", setID=" << page->getSetID() << ", pageID: " << page->getPageID()
+                               << ".\n";
 #endif
                 this->logger->debug(
                     std::string("Storage server: evicting page from cache for pageID:") +
@@ -837,7 +865,7 @@ void PageCache::evict() {
     this->inEviction = false;
     pthread_mutex_unlock(&this->evictionMutex);
 #ifdef PROFILING
-    std::cout << "Storage server: finished cache eviction!\n";
+    PDB_LOG(INFO) << "Storage server: finished cache eviction!\n";
 #endif
     logger->debug("Storage server: finished cache eviction!\n");
 }
@@ -23,6 +23,7 @@
 #include "PageCircularBufferIterator.h"
 #include "PageCircularBuffer.h"
 #include <iostream>
+#include <stdint.h>
 using namespace std;
 PageCircularBufferIterator::PageCircularBufferIterator(unsigned int id,
                                                        PageCircularBufferPtr buffer,
@@ -55,6 +56,23 @@ bool PageCircularBufferIterator::hasNext() {
     return ret;
 }
 
+bool PageCircularBufferIterator::nextRange(PDBPagePtr& page, size_t& begin, size_t& end) {
+    while (hasNext()) {
+        page = next();
+        if (page != nullptr) {
+            begin = 0;
+            end = SIZE_MAX;
+            return true;
+        }
+    }
+    return false;
+}
+
+// a page we hand out is never shared with another iterator
+bool PageCircularBufferIterator::finishRange() {
+    return true;
+}
+
 unsigned int PageCircularBufferIterator::getId() {
     return this->id;
 }
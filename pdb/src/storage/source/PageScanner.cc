@@ -110,18 +110,23 @@ bool PageScanner::sendPagePinnedAck(pdb::PDBCommunicatorPtr myCommunicator,
 }
 
 
-vector<PageCircularBufferIteratorPtr> PageScanner::getSetIterators(NodeID nodeId,
-                                                                   DatabaseID dbId,
-                                                                   UserTypeID typeId,
-                                                                   SetID setId) {
+vector<PageCircularBufferIteratorPtr> PageScanner::getSetIterators(
+    NodeID nodeId,
+    DatabaseID dbId,
+    UserTypeID typeId,
+    SetID setId,
+    pdb::Handle<pdb::Vector<pdb::ColumnRange>> rangeFilter) {
     // create an GetSetPages object
     string errMsg;
-    const pdb::UseTemporaryAllocationBlock myBlock{1024};
+    size_t filterSize =
+        (rangeFilter == nullptr) ? 0 : rangeFilter->size() * sizeof(pdb::ColumnRange);
+    const pdb::UseTemporaryAllocationBlock myBlock{1024 + filterSize};
     pdb::Handle<pdb::StorageGetSetPages> getSetPagesRequest =
         pdb::makeObject<pdb::StorageGetSetPages>();
     getSetPagesRequest->setDatabaseID(dbId);
     getSetPagesRequest->setUserTypeID(typeId);
     getSetPagesRequest->setSetID(setId);
+    getSetPagesRequest->setRangeFilter(rangeFilter);
 
     vector<PageCircularBufferIteratorPtr> vec;
     // send request to storage
@@ -25,11 +25,13 @@
 PartitionPageIterator::PartitionPageIterator(PageCachePtr cache,
                                              PDBFilePtr file,
                                              FilePartitionID partitionId,
-                                             UserSet* set) {
+                                             UserSet* set,
+                                             ZoneMapFilterPtr filter) {
     this->cache = cache;
     this->file = file;
     this->partitionId = partitionId;
     this->set = set;
+    this->filter = filter;
     if ((this->type = file->getFileType()) == FileType::SequenceFileType) {
         this->sequenceFile = dynamic_pointer_cast<SequenceFile>(file);
         this->partitionedFile = nullptr;
@@ -59,6 +61,16 @@ PDBPagePtr PartitionPageIterator::next() {
             PDB_COUT << "PartitionedPageIterator: curTypeId=" << this->partitionedFile->getTypeId()
                      << ",curSetId=" << this->partitionedFile->getSetId()
                      << ",curPageId=" << curPageId << "\n";
+            // skip the page without loading it if its zone map rules out the filter
+            if (this->filter != nullptr) {
+                PageZoneMapPtr zoneMap =
+                    this->partitionedFile->getMetaData()->getZoneMap(curPageId);
+                if ((zoneMap != nullptr) && (zoneMap->mayMatch(*(this->filter)) == false)) {
+                    PDB_COUT << "PartitionedPageIterator: skipped pageId=" << curPageId << "\n";
+                    this->numIteratedPages++;
+                    return nullptr;
+                }
+            }
 // page is pinned (ref count ++)
 #ifdef USE_LOCALITY_SET
             pageToReturn = cache->getPage(this->partitionedFile,
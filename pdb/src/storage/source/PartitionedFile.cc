@@ -354,6 +354,10 @@ int PartitionedFile::appendPageDirect(FilePartitionID partitionId, PDBPagePtr pa
  * - PartitionId for the 1st page
  * - PageSeqIdInPartition for the 1st page
  * - ...
+ * - NumZoneMaps
+ * - PageId for the 1st zone map
+ * - The 1st zone map
+ * - ...
  */
 int PartitionedFile::writeMeta() {
     pthread_mutex_lock(&this->fileMutex);
@@ -378,6 +382,17 @@ int PartitionedFile::writeMeta() {
     for (i = 0; i < numPages; i++) {
         metaSize += sizeof(PageID) + sizeof(FilePartitionID) + sizeof(unsigned int);
     }
+    // we only keep the zone maps of the pages that are in the file
+    unordered_map<PageID, PageZoneMapPtr> zoneMaps = this->metaData->getZoneMaps();
+    for (auto iter = zoneMaps.begin(); iter != zoneMaps.end();) {
+        if (this->metaData->getPageIndexes()->count(iter->first) == 0) {
+            iter = zoneMaps.erase(iter);
+        } else {
+            metaSize += sizeof(PageID) + iter->second->getSerializedSize();
+            iter++;
+        }
+    }
+    metaSize += sizeof(unsigned int);
     // write meta size to meta partition
     fseek(this->metaFile, 0, SEEK_SET);
     fwrite((size_t*)(&metaSize), sizeof(size_t), 1, this->metaFile);
@@ -430,6 +445,15 @@ int PartitionedFile::writeMeta() {
         cur = cur + sizeof(unsigned int);
     }
 
+    *((unsigned int*)cur) = zoneMaps.size();
+    cur = cur + sizeof(unsigned int);
+    for (auto& zoneMap : zoneMaps) {
+        *((PageID*)cur) = zoneMap.first;
+        cur = cur + sizeof(PageID);
+        zoneMap.second->serialize(cur);
+        cur = cur + zoneMap.second->getSerializedSize();
+    }
+
     // write meta data
     fseek(this->metaFile, sizeof(size_t), SEEK_SET);
     int ret = this->writeData(this->metaFile, (void*)buffer, metaSize);
@@ -693,6 +717,10 @@ void PartitionedFile::buildMetaDataFromMetaPartition(SharedMemPtr shm) {
          * - FilePartitionID for the 1st page
          * - PageSeqIdInPartition for the 1st page
          * - ...
+         * - NumZoneMaps (files written before zone maps end right before it)
+         * - pageId for the 1st zone map
+         * - The 1st zone map
+         * - ...
      */
     // Open meta partition for reading
     if (this->openMeta() == false) {
@@ -794,6 +822,19 @@ void PartitionedFile::buildMetaDataFromMetaPartition(SharedMemPtr shm) {
         this->metaData->addPageIndex(pageId, partitionId, pageSeqInPartition);
     }
 
+    // parse and set zone maps
+    if (cur < buf + size) {
+        unsigned int numZoneMaps = (unsigned int)(*(unsigned int*)cur);
+        cur = cur + sizeof(unsigned int);
+        for (i = 0; i < numZoneMaps; i++) {
+            pageId = (PageID)(*(PageID*)cur);
+            cur = cur + sizeof(PageID);
+            PageZoneMapPtr zoneMap = make_shared<PageZoneMap>();
+            cur = cur + zoneMap->deserialize(cur);
+            this->metaData->setZoneMap(pageId, zoneMap);
+        }
+    }
+
     free(buf);
 }
 
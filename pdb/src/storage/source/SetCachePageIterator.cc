@@ -32,9 +32,12 @@
 // NOTE: the constructor can only be invoked in UserSet::getIterators(), where it will be protected
 // by lockDirtyPageSet();
 
-SetCachePageIterator::SetCachePageIterator(PageCachePtr cache, UserSet* set) {
+SetCachePageIterator::SetCachePageIterator(PageCachePtr cache,
+                                           UserSet* set,
+                                           ZoneMapFilterPtr filter) {
     this->cache = cache;
     this->set = set;
+    this->filter = filter;
     this->iter = this->set->getDirtyPageSet()->begin();
 }
 
@@ -54,6 +57,23 @@ PDBPagePtr SetCachePageIterator::end() {
 PDBPagePtr SetCachePageIterator::next() {
     this->cache->evictionLock();
     if (this->iter != this->set->getDirtyPageSet()->end()) {
+        // skip the page without pinning it if its zone map rules out the filter
+        if (this->filter != nullptr) {
+            PageZoneMapPtr zoneMap = this->set->getZoneMap(this->iter->first);
+            if ((zoneMap != nullptr) && (zoneMap->mayMatch(*(this->filter)) == false)) {
+                PDB_COUT << "SetCachePageIterator: skipped pageId=" << this->iter->first << "\n";
+                bool inCache = this->iter->second.inCache;
+                this->cache->evictionUnlock();
+                if (inCache == true) {
+                    ++iter;
+                } else {
+                    this->set->lockDirtyPageSet();
+                    this->iter = this->set->getDirtyPageSet()->erase(this->iter);
+                    this->set->unlockDirtyPageSet();
+                }
+                return nullptr;
+            }
+        }
         if (this->iter->second.inCache == true) {
             CacheKey key;
             key.dbId = this->set->getDbID();
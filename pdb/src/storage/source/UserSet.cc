@@ -170,7 +170,7 @@ int UserSet::getNumPages() {
  * -- 1 iterator to scan data in page cache;
  * -- K iterators to scan data in file partitions, assuming there are K partitions.
  */
-vector<PageIteratorPtr>* UserSet::getIterators() {
+vector<PageIteratorPtr>* UserSet::getIterators(ZoneMapFilterPtr filter) {
 
     this->cleanDirtyPageSet();
     this->lockDirtyPageSet();
@@ -178,7 +178,7 @@ vector<PageIteratorPtr>* UserSet::getIterators() {
     PageIteratorPtr iterator = nullptr;
     if (dirtyPagesInPageCache->size() > 0) {
         PDB_COUT << "dirtyPages size=" << dirtyPagesInPageCache->size() << std::endl;
-        iterator = make_shared<SetCachePageIterator>(this->pageCache, this);
+        iterator = make_shared<SetCachePageIterator>(this->pageCache, this, filter);
         if (iterator != nullptr) {
             retVec->push_back(iterator);
         }
@@ -198,7 +198,7 @@ vector<PageIteratorPtr>* UserSet::getIterators() {
                          << partitionedFile->getMetaData()->getPartition(i)->getNumPages()
                          << std::endl;
                 iterator = make_shared<PartitionPageIterator>(
-                    this->pageCache, file, (FilePartitionID)i, this);
+                    this->pageCache, file, (FilePartitionID)i, this, filter);
                 retVec->push_back(iterator);
             }
         }
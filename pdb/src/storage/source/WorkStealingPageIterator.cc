@@ -0,0 +1,96 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef WORK_STEALING_PAGE_ITERATOR_CC
+#define WORK_STEALING_PAGE_ITERATOR_CC
+
+#include "WorkStealingPageIterator.h"
+
+WorkStealingPageIterator::WorkStealingPageIterator(
+    unsigned int id,
+    pdb::WorkStealingSchedulerPtr<PageMorsel> scheduler,
+    pdb::PDBLoggerPtr logger)
+    : PageCircularBufferIterator(id, nullptr, logger) {
+    this->scheduler = scheduler;
+}
+
+WorkStealingPageIterator::~WorkStealingPageIterator() {}
+
+bool WorkStealingPageIterator::hasNext() {
+    if (this->nextMorsel.source != nullptr) {
+        return true;
+    }
+    return this->scheduler->getTask(getId(), this->nextMorsel);
+}
+
+PageMorsel WorkStealingPageIterator::takeNext() {
+    PageMorsel morsel = this->nextMorsel;
+    this->nextMorsel = PageMorsel();
+    this->inFlight.push_back(morsel);
+    return morsel;
+}
+
+PDBPagePtr WorkStealingPageIterator::next() {
+    if (this->nextMorsel.source == nullptr && !hasNext()) {
+        return nullptr;
+    }
+    return takeNext().source->page;
+}
+
+bool WorkStealingPageIterator::nextRange(PDBPagePtr& page, size_t& begin, size_t& end) {
+    if (this->nextMorsel.source == nullptr && !hasNext()) {
+        return false;
+    }
+    PageMorsel morsel = takeNext();
+    page = morsel.source->page;
+    begin = morsel.begin;
+    end = morsel.end;
+    return true;
+}
+
+bool WorkStealingPageIterator::finishRange() {
+    if (this->inFlight.empty()) {
+        return true;
+    }
+    MorselSourcePagePtr source = this->inFlight.front().source;
+    this->inFlight.pop_front();
+    return --source->numMorselsLeft == 0;
+}
+
+void WorkStealingPageIterator::submitMorsels(pdb::WorkStealingSchedulerPtr<PageMorsel> scheduler,
+                                             int homeWorker,
+                                             PDBPagePtr page,
+                                             size_t numObjects,
+                                             size_t morselSize) {
+    int numMorsels = (numObjects + morselSize - 1) / morselSize;
+    if (numMorsels == 0) {
+        numMorsels = 1;
+    }
+
+    // the last morsel runs to the end of the page, anyone may steal the morsels from homeWorker
+    MorselSourcePagePtr source = make_shared<MorselSourcePage>(page, numMorsels);
+    for (int j = 0; j < numMorsels; j++) {
+        PageMorsel morsel;
+        morsel.source = source;
+        morsel.begin = j * morselSize;
+        morsel.end = (j == numMorsels - 1) ? SIZE_MAX : (j + 1) * morselSize;
+        scheduler->submit(homeWorker, morsel);
+    }
+}
+
+#endif
@@ -0,0 +1,385 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef PDB_UTILITIES_DISTANCE_KERNELS_H
+#define PDB_UTILITIES_DISTANCE_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// the AVX2/FMA kernels are compiled for their own target and picked at runtime, so the rest of the
+// code does not need to be built with -mavx2; define PDB_DISABLE_SIMD_KERNELS to always use the
+// scalar ones
+#if !defined(PDB_DISABLE_SIMD_KERNELS) && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define PDB_SIMD_KERNELS
+#include <immintrin.h>
+#endif
+
+// the number of points we assign at once, their partial scores stay in L1
+#ifndef PDB_KERNEL_POINT_BLOCK
+#define PDB_KERNEL_POINT_BLOCK 64
+#endif
+
+// the number of dimensions of a block, the slice of every centroid we need for a block of points
+// stays in L2 while we go over the points
+#ifndef PDB_KERNEL_DIMENSION_BLOCK
+#define PDB_KERNEL_DIMENSION_BLOCK 512
+#endif
+
+namespace pdb {
+
+/**
+ * Dense double kernels for the machine learning built-ins (KMeans, GMM). Every kernel has a scalar
+ * version and an AVX2/FMA version; the latter is used if the CPU supports it.
+ *
+ * The batched kernels work on arrays of pointers to rows, so that they can run directly on the
+ * objects of a TupleSet column without copying them into a matrix first.
+ */
+class DistanceKernels {
+
+public:
+    // returns true if the AVX2/FMA kernels are used
+    static bool isSIMDEnabled() {
+        return simdEnabled();
+    }
+
+    // switches between the AVX2/FMA and the scalar kernels, e.g. to compare them; the AVX2/FMA ones
+    // can only be enabled if the CPU supports them
+    static void setSIMDEnabled(bool enabled) {
+        simdEnabled() = enabled && simdSupported();
+    }
+
+    // returns the dot product of a and b
+    static double dot(const double* a, const double* b, size_t n) {
+#ifdef PDB_SIMD_KERNELS
+        if (simdEnabled()) {
+            return dotAVX2(a, b, n);
+        }
+#endif
+        return dotScalar(a, b, n);
+    }
+
+    // returns the squared euclidean distance between a and b
+    static double squaredDistance(const double* a, const double* b, size_t n) {
+#ifdef PDB_SIMD_KERNELS
+        if (simdEnabled()) {
+            return squaredDistanceAVX2(a, b, n);
+        }
+#endif
+        return squaredDistanceScalar(a, b, n);
+    }
+
+    /**
+     * Returns x' A x for a symmetric matrix A of which only the upper triangle is read
+     * @param matrix A, row major, n x n
+     * @param x the vector
+     * @param n the number of dimensions
+     */
+    static double quadraticFormUpper(const double* matrix, const double* x, size_t n) {
+        double result = 0;
+        for (size_t i = 0; i < n; i++) {
+            const double* row = matrix + i * n;
+            double rest = (i + 1 < n) ? dot(row + i + 1, x + i + 1, n - i - 1) : 0;
+            result += x[i] * (row[i] * x[i] + 2.0 * rest);
+        }
+        return result;
+    }
+
+    /**
+     * Computes scores[p * scoreStride + c] += scale * (points[p] . centroids[c]) over the
+     * dimensions [from, from + count) for every point and every centroid
+     */
+    static void dotBlock(const double* const* points,
+                         size_t numPoints,
+                         const double* const* centroids,
+                         size_t numCentroids,
+                         size_t from,
+                         size_t count,
+                         double scale,
+                         double* scores,
+                         size_t scoreStride) {
+#ifdef PDB_SIMD_KERNELS
+        if (simdEnabled()) {
+            dotBlockAVX2(points, numPoints, centroids, numCentroids, from, count, scale, scores,
+                         scoreStride);
+            return;
+        }
+#endif
+        for (size_t p = 0; p < numPoints; p++) {
+            for (size_t c = 0; c < numCentroids; c++) {
+                scores[p * scoreStride + c] +=
+                    scale * dotScalar(points[p] + from, centroids[c] + from, count);
+            }
+        }
+    }
+
+    /**
+     * Assigns every point to its closest centroid. The distances are computed for a block of
+     * points against all centroids at once as ||c||^2 - 2 p.c, a blocked matrix product; ||p||^2 is
+     * the same for every centroid, so it does not change which one is the closest
+     * @param points the points
+     * @param numPoints the number of points
+     * @param centroids the centroids
+     * @param numCentroids the number of centroids
+     * @param dim the number of dimensions of points and centroids
+     * @param assignment gets the index of the closest centroid of every point
+     */
+    static void assignNearest(const double* const* points,
+                              size_t numPoints,
+                              const double* const* centroids,
+                              size_t numCentroids,
+                              size_t dim,
+                              int* assignment) {
+
+        if (numCentroids == 0) {
+            std::fill(assignment, assignment + numPoints, 0);
+            return;
+        }
+
+        std::vector<double> centroidNorms(numCentroids);
+        for (size_t c = 0; c < numCentroids; c++) {
+            centroidNorms[c] = dot(centroids[c], centroids[c], dim);
+        }
+
+        std::vector<double> scores(PDB_KERNEL_POINT_BLOCK * numCentroids);
+        for (size_t first = 0; first < numPoints; first += PDB_KERNEL_POINT_BLOCK) {
+            size_t blockSize = std::min((size_t)PDB_KERNEL_POINT_BLOCK, numPoints - first);
+
+            // every score starts as the norm of its centroid
+            for (size_t p = 0; p < blockSize; p++) {
+                std::copy(centroidNorms.begin(), centroidNorms.end(),
+                          scores.begin() + p * numCentroids);
+            }
+
+            // and we subtract twice the dot products, one slice of the dimensions at a time
+            for (size_t from = 0; from < dim; from += PDB_KERNEL_DIMENSION_BLOCK) {
+                size_t count = std::min((size_t)PDB_KERNEL_DIMENSION_BLOCK, dim - from);
+                dotBlock(points + first, blockSize, centroids, numCentroids, from, count, -2.0,
+                         scores.data(), numCentroids);
+            }
+
+            for (size_t p = 0; p < blockSize; p++) {
+                const double* myScores = scores.data() + p * numCentroids;
+                assignment[first + p] =
+                    (int)(std::min_element(myScores, myScores + numCentroids) - myScores);
+            }
+        }
+    }
+
+private:
+    // returns true if the CPU supports the AVX2/FMA kernels
+    static bool simdSupported() {
+#ifdef PDB_SIMD_KERNELS
+        static const bool supported =
+            __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+    // whether we currently use the AVX2/FMA kernels
+    static bool& simdEnabled() {
+        static bool enabled = simdSupported();
+        return enabled;
+    }
+
+    // the scalar kernels keep four independent sums, so that the additions do not wait on each
+    // other
+    static double dotScalar(const double* a, const double* b, size_t n) {
+        double sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            sum0 += a[i] * b[i];
+            sum1 += a[i + 1] * b[i + 1];
+            sum2 += a[i + 2] * b[i + 2];
+            sum3 += a[i + 3] * b[i + 3];
+        }
+        for (; i < n; i++) {
+            sum0 += a[i] * b[i];
+        }
+        return (sum0 + sum1) + (sum2 + sum3);
+    }
+
+    static double squaredDistanceScalar(const double* a, const double* b, size_t n) {
+        double sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            double diff0 = a[i] - b[i];
+            double diff1 = a[i + 1] - b[i + 1];
+            double diff2 = a[i + 2] - b[i + 2];
+            double diff3 = a[i + 3] - b[i + 3];
+            sum0 += diff0 * diff0;
+            sum1 += diff1 * diff1;
+            sum2 += diff2 * diff2;
+            sum3 += diff3 * diff3;
+        }
+        for (; i < n; i++) {
+            double diff = a[i] - b[i];
+            sum0 += diff * diff;
+        }
+        return (sum0 + sum1) + (sum2 + sum3);
+    }
+
+#ifdef PDB_SIMD_KERNELS
+    __attribute__((target("avx2,fma"))) static double horizontalSum(__m256d v) {
+        __m128d low = _mm256_castpd256_pd128(v);
+        __m128d high = _mm256_extractf128_pd(v, 1);
+        low = _mm_add_pd(low, high);
+        __m128d swapped = _mm_unpackhi_pd(low, low);
+        return _mm_cvtsd_f64(_mm_add_sd(low, swapped));
+    }
+
+    __attribute__((target("avx2,fma"))) static double dotAVX2(const double* a,
+                                                              const double* b,
+                                                              size_t n) {
+        __m256d sum0 = _mm256_setzero_pd();
+        __m256d sum1 = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), sum0);
+            sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), sum1);
+        }
+        for (; i + 4 <= n; i += 4) {
+            sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), sum0);
+        }
+        double sum = horizontalSum(_mm256_add_pd(sum0, sum1));
+        for (; i < n; i++) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+    __attribute__((target("avx2,fma"))) static double squaredDistanceAVX2(const double* a,
+                                                                          const double* b,
+                                                                          size_t n) {
+        __m256d sum0 = _mm256_setzero_pd();
+        __m256d sum1 = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256d diff0 = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+            __m256d diff1 = _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4));
+            sum0 = _mm256_fmadd_pd(diff0, diff0, sum0);
+            sum1 = _mm256_fmadd_pd(diff1, diff1, sum1);
+        }
+        for (; i + 4 <= n; i += 4) {
+            __m256d diff = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+            sum0 = _mm256_fmadd_pd(diff, diff, sum0);
+        }
+        double sum = horizontalSum(_mm256_add_pd(sum0, sum1));
+        for (; i < n; i++) {
+            double diff = a[i] - b[i];
+            sum += diff * diff;
+        }
+        return sum;
+    }
+
+    // the register block: four points against two centroids, eight accumulators, so that every
+    // value we load is used by two or four multiply-adds
+    __attribute__((target("avx2,fma"))) static void dotBlockAVX2(const double* const* points,
+                                                                 size_t numPoints,
+                                                                 const double* const* centroids,
+                                                                 size_t numCentroids,
+                                                                 size_t from,
+                                                                 size_t count,
+                                                                 double scale,
+                                                                 double* scores,
+                                                                 size_t scoreStride) {
+        size_t p = 0;
+        for (; p + 4 <= numPoints; p += 4) {
+            const double* p0 = points[p] + from;
+            const double* p1 = points[p + 1] + from;
+            const double* p2 = points[p + 2] + from;
+            const double* p3 = points[p + 3] + from;
+            size_t c = 0;
+            for (; c + 2 <= numCentroids; c += 2) {
+                const double* c0 = centroids[c] + from;
+                const double* c1 = centroids[c + 1] + from;
+                __m256d s00 = _mm256_setzero_pd(), s01 = _mm256_setzero_pd();
+                __m256d s10 = _mm256_setzero_pd(), s11 = _mm256_setzero_pd();
+                __m256d s20 = _mm256_setzero_pd(), s21 = _mm256_setzero_pd();
+                __m256d s30 = _mm256_setzero_pd(), s31 = _mm256_setzero_pd();
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    __m256d vc0 = _mm256_loadu_pd(c0 + i);
+                    __m256d vc1 = _mm256_loadu_pd(c1 + i);
+                    __m256d vp = _mm256_loadu_pd(p0 + i);
+                    s00 = _mm256_fmadd_pd(vp, vc0, s00);
+                    s01 = _mm256_fmadd_pd(vp, vc1, s01);
+                    vp = _mm256_loadu_pd(p1 + i);
+                    s10 = _mm256_fmadd_pd(vp, vc0, s10);
+                    s11 = _mm256_fmadd_pd(vp, vc1, s11);
+                    vp = _mm256_loadu_pd(p2 + i);
+                    s20 = _mm256_fmadd_pd(vp, vc0, s20);
+                    s21 = _mm256_fmadd_pd(vp, vc1, s21);
+                    vp = _mm256_loadu_pd(p3 + i);
+                    s30 = _mm256_fmadd_pd(vp, vc0, s30);
+                    s31 = _mm256_fmadd_pd(vp, vc1, s31);
+                }
+                double d00 = horizontalSum(s00), d01 = horizontalSum(s01);
+                double d10 = horizontalSum(s10), d11 = horizontalSum(s11);
+                double d20 = horizontalSum(s20), d21 = horizontalSum(s21);
+                double d30 = horizontalSum(s30), d31 = horizontalSum(s31);
+                for (; i < count; i++) {
+                    d00 += p0[i] * c0[i];
+                    d01 += p0[i] * c1[i];
+                    d10 += p1[i] * c0[i];
+                    d11 += p1[i] * c1[i];
+                    d20 += p2[i] * c0[i];
+                    d21 += p2[i] * c1[i];
+                    d30 += p3[i] * c0[i];
+                    d31 += p3[i] * c1[i];
+                }
+                double* row = scores + p * scoreStride + c;
+                row[0] += scale * d00;
+                row[1] += scale * d01;
+                row += scoreStride;
+                row[0] += scale * d10;
+                row[1] += scale * d11;
+                row += scoreStride;
+                row[0] += scale * d20;
+                row[1] += scale * d21;
+                row += scoreStride;
+                row[0] += scale * d30;
+                row[1] += scale * d31;
+            }
+
+            // an odd centroid is done one point at a time
+            for (; c < numCentroids; c++) {
+                for (size_t q = p; q < p + 4; q++) {
+                    scores[q * scoreStride + c] +=
+                        scale * dotAVX2(points[q] + from, centroids[c] + from, count);
+                }
+            }
+        }
+
+        // and so are the points that do not fill a register block
+        for (; p < numPoints; p++) {
+            for (size_t c = 0; c < numCentroids; c++) {
+                scores[p * scoreStride + c] +=
+                    scale * dotAVX2(points[p] + from, centroids[c] + from, count);
+            }
+        }
+    }
+#endif
+};
+}
+
+#endif
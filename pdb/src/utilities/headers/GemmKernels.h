@@ -0,0 +1,248 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef PDB_UTILITIES_GEMM_KERNELS_H
+#define PDB_UTILITIES_GEMM_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "DistanceKernels.h"
+
+// the register block of the inner kernel, MR rows of A times NR columns of B
+#define PDB_GEMM_MR 4
+#define PDB_GEMM_NR 8
+
+// the cache blocks: a KC x NR sliver of B stays in L1, an MC x KC block of A stays in L2 and a
+// KC x NC panel of B stays in L3
+#ifndef PDB_GEMM_KC
+#define PDB_GEMM_KC 256
+#endif
+
+#ifndef PDB_GEMM_MC
+#define PDB_GEMM_MC 96
+#endif
+
+#ifndef PDB_GEMM_NC
+#define PDB_GEMM_NC 2048
+#endif
+
+namespace pdb {
+
+/**
+ * A cache-blocked dense matrix multiply for row-major double matrices, used to multiply matrix
+ * blocks in place. A and B are packed into contiguous slivers one cache block at a time, and a
+ * register-blocked kernel accumulates each MR x NR tile of C. Like the distance kernels it has a
+ * scalar and an AVX2/FMA inner kernel, and the DistanceKernels switch decides which one is used.
+ */
+class GemmKernels {
+
+public:
+    /**
+     * Computes C += op(A) * B, where op(A) is A or its transpose
+     * @param m the number of rows of op(A) and C
+     * @param n the number of columns of B and C
+     * @param k the number of columns of op(A) and rows of B
+     * @param a A, row-major; it is m x k, or k x m if transposeA is set
+     * @param lda the distance between two rows of A
+     * @param transposeA if true we multiply by the transpose of A
+     * @param b B, row-major k x n
+     * @param ldb the distance between two rows of B
+     * @param c C, row-major m x n, the product is added to it
+     * @param ldc the distance between two rows of C
+     */
+    static void multiplyAccumulate(size_t m,
+                                   size_t n,
+                                   size_t k,
+                                   const double* a,
+                                   size_t lda,
+                                   bool transposeA,
+                                   const double* b,
+                                   size_t ldb,
+                                   double* c,
+                                   size_t ldc) {
+
+        if (m == 0 || n == 0 || k == 0) {
+            return;
+        }
+
+        // the packing buffers are reused by every multiply on this thread
+        static thread_local std::vector<double> packedA;
+        static thread_local std::vector<double> packedB;
+
+        size_t panelCols = std::min((size_t)PDB_GEMM_NC, roundUp(n, PDB_GEMM_NR));
+        size_t blockRows = std::min((size_t)PDB_GEMM_MC, roundUp(m, PDB_GEMM_MR));
+        size_t depth = std::min((size_t)PDB_GEMM_KC, k);
+        packedA.resize(blockRows * depth);
+        packedB.resize(depth * panelCols);
+
+        bool simd = DistanceKernels::isSIMDEnabled();
+        for (size_t jc = 0; jc < n; jc += PDB_GEMM_NC) {
+            size_t nc = std::min((size_t)PDB_GEMM_NC, n - jc);
+            for (size_t pc = 0; pc < k; pc += PDB_GEMM_KC) {
+                size_t kc = std::min((size_t)PDB_GEMM_KC, k - pc);
+                packB(b + pc * ldb + jc, ldb, kc, nc, packedB.data());
+                for (size_t ic = 0; ic < m; ic += PDB_GEMM_MC) {
+                    size_t mc = std::min((size_t)PDB_GEMM_MC, m - ic);
+                    packA(a, lda, transposeA, ic, pc, mc, kc, packedA.data());
+                    for (size_t jr = 0; jr < nc; jr += PDB_GEMM_NR) {
+                        size_t nr = std::min((size_t)PDB_GEMM_NR, nc - jr);
+                        const double* bSliver = packedB.data() + jr * kc;
+                        for (size_t ir = 0; ir < mc; ir += PDB_GEMM_MR) {
+                            size_t mr = std::min((size_t)PDB_GEMM_MR, mc - ir);
+                            const double* aSliver = packedA.data() + ir * kc;
+                            double* cTile = c + (ic + ir) * ldc + jc + jr;
+                            if (mr == PDB_GEMM_MR && nr == PDB_GEMM_NR) {
+                                tile(simd, kc, aSliver, bSliver, cTile, ldc);
+                            } else {
+                                // the edges go through a full tile on the side
+                                double edge[PDB_GEMM_MR * PDB_GEMM_NR] = {0};
+                                tile(simd, kc, aSliver, bSliver, edge, PDB_GEMM_NR);
+                                for (size_t i = 0; i < mr; i++) {
+                                    for (size_t j = 0; j < nr; j++) {
+                                        cTile[i * ldc + j] += edge[i * PDB_GEMM_NR + j];
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    static size_t roundUp(size_t value, size_t multiple) {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    // copies a kc x nc panel of B into slivers of NR columns, each stored row after row; the
+    // columns past nc are zero
+    static void packB(const double* b, size_t ldb, size_t kc, size_t nc, double* packed) {
+        for (size_t j = 0; j < nc; j += PDB_GEMM_NR) {
+            size_t nr = std::min((size_t)PDB_GEMM_NR, nc - j);
+            for (size_t p = 0; p < kc; p++) {
+                const double* row = b + p * ldb + j;
+                size_t q = 0;
+                for (; q < nr; q++) {
+                    packed[q] = row[q];
+                }
+                for (; q < PDB_GEMM_NR; q++) {
+                    packed[q] = 0;
+                }
+                packed += PDB_GEMM_NR;
+            }
+        }
+    }
+
+    // copies the mc x kc block of op(A) that starts at (row, col) into slivers of MR rows, each
+    // stored column after column; the rows past mc are zero
+    static void packA(const double* a,
+                      size_t lda,
+                      bool transposeA,
+                      size_t row,
+                      size_t col,
+                      size_t mc,
+                      size_t kc,
+                      double* packed) {
+        for (size_t i = 0; i < mc; i += PDB_GEMM_MR) {
+            size_t mr = std::min((size_t)PDB_GEMM_MR, mc - i);
+            for (size_t p = 0; p < kc; p++) {
+                size_t q = 0;
+                for (; q < mr; q++) {
+                    packed[q] = transposeA ? a[(col + p) * lda + row + i + q]
+                                           : a[(row + i + q) * lda + col + p];
+                }
+                for (; q < PDB_GEMM_MR; q++) {
+                    packed[q] = 0;
+                }
+                packed += PDB_GEMM_MR;
+            }
+        }
+    }
+
+    static void tile(
+        bool simd, size_t kc, const double* a, const double* b, double* c, size_t ldc) {
+#ifdef PDB_SIMD_KERNELS
+        if (simd) {
+            tileAVX2(kc, a, b, c, ldc);
+            return;
+        }
+#endif
+        tileScalar(kc, a, b, c, ldc);
+    }
+
+    // C[MR x NR] += the packed A sliver times the packed B sliver
+    static void tileScalar(size_t kc, const double* a, const double* b, double* c, size_t ldc) {
+        double sums[PDB_GEMM_MR][PDB_GEMM_NR] = {{0}};
+        for (size_t p = 0; p < kc; p++) {
+            for (size_t i = 0; i < PDB_GEMM_MR; i++) {
+                double value = a[i];
+                for (size_t j = 0; j < PDB_GEMM_NR; j++) {
+                    sums[i][j] += value * b[j];
+                }
+            }
+            a += PDB_GEMM_MR;
+            b += PDB_GEMM_NR;
+        }
+        for (size_t i = 0; i < PDB_GEMM_MR; i++) {
+            for (size_t j = 0; j < PDB_GEMM_NR; j++) {
+                c[i * ldc + j] += sums[i][j];
+            }
+        }
+    }
+
+#ifdef PDB_SIMD_KERNELS
+    // the same with the whole 4 x 8 tile in eight registers
+    __attribute__((target("avx2,fma"))) static void tileAVX2(
+        size_t kc, const double* a, const double* b, double* c, size_t ldc) {
+        __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+        __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+        __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+        __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+        for (size_t p = 0; p < kc; p++) {
+            __m256d b0 = _mm256_loadu_pd(b);
+            __m256d b1 = _mm256_loadu_pd(b + 4);
+            __m256d a0 = _mm256_broadcast_sd(a);
+            c00 = _mm256_fmadd_pd(a0, b0, c00);
+            c01 = _mm256_fmadd_pd(a0, b1, c01);
+            __m256d a1 = _mm256_broadcast_sd(a + 1);
+            c10 = _mm256_fmadd_pd(a1, b0, c10);
+            c11 = _mm256_fmadd_pd(a1, b1, c11);
+            __m256d a2 = _mm256_broadcast_sd(a + 2);
+            c20 = _mm256_fmadd_pd(a2, b0, c20);
+            c21 = _mm256_fmadd_pd(a2, b1, c21);
+            __m256d a3 = _mm256_broadcast_sd(a + 3);
+            c30 = _mm256_fmadd_pd(a3, b0, c30);
+            c31 = _mm256_fmadd_pd(a3, b1, c31);
+            a += PDB_GEMM_MR;
+            b += PDB_GEMM_NR;
+        }
+        __m256d* sums[PDB_GEMM_MR][2] = {{&c00, &c01}, {&c10, &c11}, {&c20, &c21}, {&c30, &c31}};
+        for (size_t i = 0; i < PDB_GEMM_MR; i++) {
+            double* row = c + i * ldc;
+            _mm256_storeu_pd(row, _mm256_add_pd(_mm256_loadu_pd(row), *sums[i][0]));
+            _mm256_storeu_pd(row + 4, _mm256_add_pd(_mm256_loadu_pd(row + 4), *sums[i][1]));
+        }
+    }
+#endif
+};
+}
+
+#endif
@@ -0,0 +1,102 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef PDB_UTILITIES_SPSC_RING_BUFFER_H
+#define PDB_UTILITIES_SPSC_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace pdb {
+
+/**
+ * A bounded, lock-free ring buffer for exactly one producer thread and one consumer thread.
+ * The slots are allocated once and reused, so a slot type that keeps its capacity across
+ * assignments (e.g. std::string) does not touch the heap in steady state.
+ */
+template <typename T>
+class SPSCRingBuffer {
+
+public:
+    /**
+     * Creates the buffer
+     * @param capacity the number of slots, rounded up to a power of two
+     */
+    explicit SPSCRingBuffer(size_t capacity) : head(0), tail(0) {
+        size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        slots.resize(rounded);
+        mask = rounded - 1;
+    }
+
+    /**
+     * Producer side: fills the next free slot in place
+     * @param fill called with a reference to the slot to fill
+     * @return false if the buffer is full, in which case fill is not called
+     */
+    template <typename Filler>
+    bool tryPush(Filler&& fill) {
+        size_t curTail = tail.load(std::memory_order_relaxed);
+        if (curTail - head.load(std::memory_order_acquire) > mask) {
+            return false;
+        }
+        fill(slots[curTail & mask]);
+        tail.store(curTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Consumer side: hands every slot published so far to consume, then releases them
+     * @param consume called with a reference to each filled slot, oldest first
+     * @return the number of slots consumed
+     */
+    template <typename Consumer>
+    size_t drain(Consumer&& consume) {
+        size_t curHead = head.load(std::memory_order_relaxed);
+        size_t curTail = tail.load(std::memory_order_acquire);
+        for (size_t i = curHead; i != curTail; i++) {
+            consume(slots[i & mask]);
+        }
+        head.store(curTail, std::memory_order_release);
+        return curTail - curHead;
+    }
+
+    // returns true if the consumer has caught up with the producer
+    bool isEmpty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    // the preallocated slots
+    std::vector<T> slots;
+
+    // capacity - 1, used to wrap the indexes
+    size_t mask;
+
+    // next slot to consume, written only by the consumer
+    alignas(64) std::atomic<size_t> head;
+
+    // next slot to fill, written only by the producer
+    alignas(64) std::atomic<size_t> tail;
+};
+}
+
+#endif
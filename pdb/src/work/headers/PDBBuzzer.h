@@ -65,6 +65,10 @@ public:
     // blocks until someone calls buzz
     void wait();
 
+    // blocks until someone calls buzz or the given time is over; unlike wait (), an earlier buzz
+    // does not make this return right away, so it can be used to poll
+    void waitFor(unsigned int milliseconds);
+
     // constructor, destructor
     PDBBuzzer();
     PDBBuzzer(std::nullptr_t nullp);
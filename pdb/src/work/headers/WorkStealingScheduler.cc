@@ -0,0 +1,169 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef WORK_STEALING_SCHEDULER_CC
+#define WORK_STEALING_SCHEDULER_CC
+
+#include <sched.h>
+#include "LockGuard.h"
+#include "WorkStealingScheduler.h"
+
+namespace pdb {
+
+template <class TaskType>
+WorkStealingScheduler<TaskType>::WorkStealingScheduler(int numWorkers, size_t maxQueuedTasks)
+    : numQueued(0), numProducers(0), numStolen(0), maxQueuedTasks(maxQueuedTasks) {
+
+    for (int i = 0; i < numWorkers; i++) {
+        std::unique_ptr<WorkerDeque> deque(new WorkerDeque());
+        pthread_mutex_init(&deque->lock, nullptr);
+        deques.push_back(std::move(deque));
+    }
+    pthread_mutex_init(&waitLock, nullptr);
+    pthread_cond_init(&taskAvailable, nullptr);
+    pthread_cond_init(&spaceAvailable, nullptr);
+}
+
+template <class TaskType>
+WorkStealingScheduler<TaskType>::~WorkStealingScheduler() {
+    for (auto& deque : deques) {
+        pthread_mutex_destroy(&deque->lock);
+    }
+    pthread_mutex_destroy(&waitLock);
+    pthread_cond_destroy(&taskAvailable);
+    pthread_cond_destroy(&spaceAvailable);
+}
+
+template <class TaskType>
+void WorkStealingScheduler<TaskType>::addProducer() {
+    numProducers++;
+}
+
+template <class TaskType>
+void WorkStealingScheduler<TaskType>::producerDone() {
+    const LockGuard guard{waitLock};
+    numProducers--;
+    if (numProducers == 0) {
+        pthread_cond_broadcast(&taskAvailable);
+    }
+}
+
+template <class TaskType>
+void WorkStealingScheduler<TaskType>::submit(int homeWorker, TaskType task) {
+
+    // reserve a slot, waiting while all of them are taken; the count goes up before the task
+    // becomes visible, so that it never goes below zero
+    size_t queued = numQueued.load();
+    while (true) {
+        if (queued >= maxQueuedTasks) {
+            const LockGuard guard{waitLock};
+            while (numQueued >= maxQueuedTasks) {
+                pthread_cond_wait(&spaceAvailable, &waitLock);
+            }
+            queued = numQueued.load();
+            continue;
+        }
+        if (numQueued.compare_exchange_weak(queued, queued + 1)) {
+            break;
+        }
+    }
+    WorkerDeque& deque = *deques[homeWorker % deques.size()];
+    {
+        const LockGuard guard{deque.lock};
+        deque.tasks.push_back(std::move(task));
+    }
+
+    const LockGuard guard{waitLock};
+    pthread_cond_signal(&taskAvailable);
+}
+
+template <class TaskType>
+bool WorkStealingScheduler<TaskType>::tryTake(int worker, TaskType& task) {
+
+    int numWorkers = deques.size();
+
+    // our own deque first, newest task first since its page is most likely still in cache
+    WorkerDeque& mine = *deques[worker % numWorkers];
+    {
+        const LockGuard guard{mine.lock};
+        if (!mine.tasks.empty()) {
+            task = std::move(mine.tasks.back());
+            mine.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // then steal the oldest task of the next worker that has any
+    for (int i = 1; i < numWorkers; i++) {
+        WorkerDeque& victim = *deques[(worker + i) % numWorkers];
+        const LockGuard guard{victim.lock};
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            numStolen++;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <class TaskType>
+bool WorkStealingScheduler<TaskType>::getTask(int worker, TaskType& task) {
+
+    while (true) {
+        if (tryTake(worker, task)) {
+            // wake up the producers if we just made room
+            if (numQueued-- >= maxQueuedTasks) {
+                const LockGuard guard{waitLock};
+                pthread_cond_broadcast(&spaceAvailable);
+            }
+            return true;
+        }
+
+        const LockGuard guard{waitLock};
+        if (numQueued == 0) {
+            if (numProducers == 0) {
+                return false;
+            }
+            pthread_cond_wait(&taskAvailable, &waitLock);
+        } else {
+            // a task is being pushed right now, give its producer a chance to finish
+            pthread_mutex_unlock(&waitLock);
+            sched_yield();
+            pthread_mutex_lock(&waitLock);
+        }
+    }
+}
+
+template <class TaskType>
+int WorkStealingScheduler<TaskType>::getNumWorkers() {
+    return deques.size();
+}
+
+template <class TaskType>
+size_t WorkStealingScheduler<TaskType>::getNumQueued() {
+    return numQueued;
+}
+
+template <class TaskType>
+size_t WorkStealingScheduler<TaskType>::getNumStolen() {
+    return numStolen;
+}
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef WORK_STEALING_SCHEDULER_H
+#define WORK_STEALING_SCHEDULER_H
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <pthread.h>
+
+// this encapsulates a work-stealing scheduler: every worker owns a deque of tasks, takes the
+// newest task from its own deque and, once that is empty, steals the oldest task from another
+// worker's deque; so no worker sits idle while any task is still queued.
+//
+// Tasks are produced by one or more producers (for example the threads that receive source pages
+// from the storage), each of which registers through addProducer () and signs off through
+// producerDone (). The scheduler is drained once every producer is done and every queued task
+// has been taken.
+
+namespace pdb {
+
+template <class TaskType>
+class WorkStealingScheduler;
+
+template <class TaskType>
+using WorkStealingSchedulerPtr = std::shared_ptr<WorkStealingScheduler<TaskType>>;
+
+template <class TaskType>
+class WorkStealingScheduler {
+
+public:
+    // creates a scheduler with one deque per worker; at most maxQueuedTasks tasks are queued
+    // across all deques, after which submit () blocks until a worker takes one
+    WorkStealingScheduler(int numWorkers, size_t maxQueuedTasks);
+
+    ~WorkStealingScheduler();
+
+    // registers a producer, this must happen before the workers start taking tasks
+    void addProducer();
+
+    // a producer will not submit anything anymore
+    void producerDone();
+
+    // queues a task on the deque of the given worker, blocks while the scheduler is full
+    void submit(int homeWorker, TaskType task);
+
+    // gets the next task for the given worker, first from its own deque and then by stealing
+    // from the others; blocks while there is nothing to take but some producer is still running.
+    // Returns false once the scheduler is drained.
+    bool getTask(int worker, TaskType& task);
+
+    // returns the number of workers; a worker id beyond that shares the deque of id % numWorkers
+    int getNumWorkers();
+
+    // returns the number of tasks that are queued right now
+    size_t getNumQueued();
+
+    // returns how many tasks were taken from another worker's deque so far
+    size_t getNumStolen();
+
+private:
+    // the deque of one worker, padded so that two deques never share a cache line
+    struct alignas(64) WorkerDeque {
+        pthread_mutex_t lock;
+        std::deque<TaskType> tasks;
+    };
+
+    // tries to take a task without blocking
+    bool tryTake(int worker, TaskType& task);
+
+    // the deques, one per worker
+    std::vector<std::unique_ptr<WorkerDeque>> deques;
+
+    // the number of tasks that are queued right now
+    std::atomic<size_t> numQueued;
+
+    // the number of producers that have not signed off yet
+    std::atomic<int> numProducers;
+
+    // the number of stolen tasks
+    std::atomic<size_t> numStolen;
+
+    // the limit on queued tasks
+    size_t maxQueuedTasks;
+
+    // only used to sleep, never while taking or submitting a task
+    pthread_mutex_t waitLock;
+    pthread_cond_t taskAvailable;
+    pthread_cond_t spaceAvailable;
+};
+}
+
+#include "WorkStealingScheduler.cc"
+
+#endif
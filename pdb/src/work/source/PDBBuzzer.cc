@@ -21,6 +21,7 @@
 
 #include "PDBBuzzer.h"
 #include <iostream>
+#include <sys/time.h>
 
 
 PDBBuzzer::PDBBuzzer() {
@@ -78,6 +79,22 @@ void PDBBuzzer::wait() {
     pthread_mutex_unlock(&waitingMutex);
 }
 
+void PDBBuzzer::waitFor(unsigned int milliseconds) {
+
+    // compute the deadline
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    long nanos = now.tv_usec * 1000L + milliseconds * 1000000L;
+    struct timespec deadline;
+    deadline.tv_sec = now.tv_sec + nanos / 1000000000L;
+    deadline.tv_nsec = nanos % 1000000000L;
+
+    // wait until there is a buzz or we are out of time
+    pthread_mutex_lock(&waitingMutex);
+    pthread_cond_timedwait(&waitingSignal, &waitingMutex, &deadline);
+    pthread_mutex_unlock(&waitingMutex);
+}
+
 PDBBuzzer::PDBBuzzer(std::function<void(PDBAlarm)> noStringFuncIn) {
     pthread_cond_init(&waitingSignal, nullptr);
     pthread_mutex_init(&waitingMutex, nullptr);
@@ -0,0 +1,254 @@
+#!/usr/bin/python -u
+#  ========================================================================
+#  Copyright 2018 Rice University
+#
+#  Licensed under the Apache License, Version 2.0 (the "License");
+#  you may not use this file except in compliance with the License.
+#  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+#  ========================================================================
+#
+# Runs the StandardTPCHBench queries on a pseudo cluster and reports, for every query, the
+# latency, the bytes shuffled between the workers and the peak shared memory use of the workers
+# as JSON. If a baseline report is given, the run fails when a query got slower than allowed.
+#
+# example:
+#   scripts/tpchBenchmark.py --scale-factor 1 --dbgen ~/tpch-dbgen/dbgen --output tpch.json
+#   scripts/tpchBenchmark.py --skip-load --output new.json --baseline tpch.json
+import subprocess
+import time
+import sys
+import os
+import re
+import json
+import glob
+import shutil
+import argparse
+
+# the queries we have in applications/StandardTPCHBench
+all_queries = ['01', '02', '03', '04', '06', '12', '13', '14', '17', '22']
+
+# parses the command line arguments
+parser = argparse.ArgumentParser(description='Script for benchmarking the TPC-H queries of PlinyCompute.')
+parser.add_argument('--scale-factor', type=str, default="0.2",
+                    help='TPC-H scale factor of the data (default: 0.2)')
+parser.add_argument('--dbgen', type=str,
+                    help='path of the TPC-H dbgen executable used to generate the data, without it the '
+                         'scale 0.2 tables are downloaded')
+parser.add_argument('--skip-load', action='store_true',
+                    help='do not restart the cluster nor load the data, the tables are already stored')
+parser.add_argument('--queries', type=str, default=",".join(all_queries),
+                    help='comma separated list of queries to run (default: all)')
+parser.add_argument('--repetitions', type=int, default=3,
+                    help='number of measured runs of each query (default: 3)')
+parser.add_argument('--warmup', type=int, default=1,
+                    help='number of unmeasured runs of each query before the measured ones (default: 1)')
+parser.add_argument('--num-threads', type=int, default=1,
+                    help="number of processors for each worker node (default: 1)")
+parser.add_argument('--shared-mem', type=int, default=2048,
+                    help="amount of memory in Mbytes for each worker node (default: 2048)")
+parser.add_argument('--output', type=str, default="tpchBenchmark.json",
+                    help='file the JSON report is written to (default: tpchBenchmark.json)')
+parser.add_argument('--baseline', type=str,
+                    help='JSON report of an earlier run to compare against')
+parser.add_argument('--tolerance', type=float, default=0.1,
+                    help='how much slower than the baseline a query may get, as a fraction (default: 0.1)')
+
+args = vars(parser.parse_args())
+
+class BColor:
+    HEADER = '\033[95m'
+    OK_BLUE = '\033[94m'
+    OK_GREEN = '\033[92m'
+    FAIL = '\033[91m'
+    END_C = '\033[0m'
+
+scale_factor = args['scale_factor']
+thread_num = str(args['num_threads'])
+shared_memory_size = str(args['shared_mem'])
+queries = [q.strip().zfill(2) for q in args['queries'].split(',') if len(q.strip()) > 0]
+tables_dir = 'tables_scale_' + scale_factor
+logs_dir = 'tpchBenchmarkLogs'
+
+tables = ['customer.tbl', 'nation.tbl',
+          'part.tbl', 'region.tbl',
+          'lineitem.tbl', 'orders.tbl',
+          'partsupp.tbl', 'supplier.tbl'
+          ]
+
+for query in queries:
+    if query not in all_queries:
+        print(BColor.FAIL + "Query " + query + " does not exist, use some of: " + ",".join(all_queries) + BColor.END_C)
+        sys.exit(1)
+
+# the stdout files of the worker nodes, where they print the statistics of each job stage
+def worker_logs():
+    return sorted(glob.glob(os.path.join(logs_dir, 'worker*.out')))
+
+# Launches a pseudo cluster, simulating worker nodes as processes listening on different ports,
+# with the output of every worker going to its own file
+def start_pseudo_cluster():
+    for executable in ['bin/pdb-manager', 'bin/pdb-worker']:
+        if (os.path.isfile(executable) == False):
+            print(BColor.FAIL + "PlinyCompute executable '" + executable + "' does not exist." + BColor.END_C)
+            sys.exit(1)
+
+    if os.path.isdir(logs_dir):
+        shutil.rmtree(logs_dir)
+    os.makedirs(logs_dir)
+
+    print(BColor.OK_BLUE + "starts a pdb-manager process" + BColor.END_C)
+    subprocess.Popen(['bin/pdb-manager', 'localhost', '8108', 'Y'],
+                     stdout=open(os.path.join(logs_dir, 'manager.out'), 'w'), stderr=subprocess.STDOUT)
+    print(BColor.OK_BLUE + "waiting 9 seconds for pdb-manager to be launched..." + BColor.END_C)
+    time.sleep(9)
+
+    num = 0
+    with open('conf/serverlist.test') as f:
+        for each_line in f:
+            each_line = each_line.strip()
+            if "#" not in each_line and len(each_line) > 0:
+                num = num + 1
+                print(BColor.OK_BLUE + "starts a pdb-worker node at " + each_line + " as worker no. " + str(num) + BColor.END_C)
+                subprocess.Popen(['bin/pdb-worker', thread_num, shared_memory_size, 'localhost:8108', each_line],
+                                 stdout=open(os.path.join(logs_dir, 'worker' + str(num) + '.out'), 'w'),
+                                 stderr=subprocess.STDOUT)
+                print(BColor.OK_BLUE + "waiting 9 seconds for pdb-worker to be launched..." + BColor.END_C)
+                time.sleep(9)
+
+# makes sure the tables of the requested scale factor are in tables_dir
+def prepare_tables():
+    if os.path.isdir(tables_dir) and set(listdir_tbl(tables_dir)) == set(tables):
+        return
+
+    if args['dbgen'] is not None:
+        # dbgen looks for its dists.dss next to it and writes the tables to its working directory
+        dbgen = os.path.abspath(args['dbgen'])
+        print(BColor.OK_BLUE + "generates the TPC-H tables at scale " + scale_factor + BColor.END_C)
+        subprocess.check_call([dbgen, '-f', '-s', scale_factor], cwd=os.path.dirname(dbgen))
+        if not os.path.isdir(tables_dir):
+            os.makedirs(tables_dir)
+        for table in tables:
+            shutil.move(os.path.join(os.path.dirname(dbgen), table), os.path.join(tables_dir, table))
+
+    elif scale_factor == "0.2":
+        os.system('wget https://www.dropbox.com/s/cl67ercyd0cm32p/tables_scale_0.2.tar.bz2?dl=0 -O tables_scale_0.2.tar.bz2')
+        os.system('tar xvf tables_scale_0.2.tar.bz2')
+        os.system('rm -rf tables_scale_0.2.tar.bz2')
+
+    else:
+        print(BColor.FAIL + "Only the scale 0.2 tables can be downloaded, use --dbgen for scale " + scale_factor + BColor.END_C)
+        sys.exit(1)
+
+    if (set(listdir_tbl(tables_dir)) != set(tables)):
+        print(BColor.FAIL + "The content of the directory '" + tables_dir + "' is incorrect!" + BColor.END_C)
+        sys.exit(1)
+
+def listdir_tbl(directory):
+    return [f for f in os.listdir(directory) if f.endswith('.tbl')]
+
+# starts a clean cluster, then loads and partitions the tables
+def load_data():
+    prepare_tables()
+    subprocess.call(['bash', './scripts/internal/cleanupNode.sh', 'force'])
+    print(BColor.OK_BLUE + "waiting 5 seconds for server to be fully cleaned up..." + BColor.END_C)
+    time.sleep(5)
+    start_pseudo_cluster()
+    subprocess.check_call(['bin/tpchDataLoader', tables_dir])
+    subprocess.check_call(['bin/tpchDataPartitioner'])
+
+# runs a query once and returns its measurements
+def run_query(query, register_libraries):
+    command = ['bin/RunQuery' + query]
+    if register_libraries:
+        command.append('Y')
+
+    output = subprocess.check_output(command).decode()
+
+    match = re.search(r'#TimeDuration for query execution: ([0-9.eE+-]+) Second', output)
+    if match is None:
+        raise RuntimeError("RunQuery" + query + " did not report its execution time")
+    # the statistics of the job stages, as the manager collected them from the workers
+    stats = re.search(r'#StageStats shuffledBytes=(\d+) peakSharedMemory=(\d+) peakQueryMemory=(\d+)', output)
+    if stats is None:
+        raise RuntimeError("RunQuery" + query + " did not report its stage statistics")
+    return {'latency': float(match.group(1)),
+            'shuffledBytes': int(stats.group(1)),
+            'peakSharedMemory': int(stats.group(2)),
+            'peakQueryMemory': int(stats.group(3))}
+
+def median(values):
+    values = sorted(values)
+    middle = len(values) // 2
+    if len(values) % 2 == 1:
+        return values[middle]
+    return (values[middle - 1] + values[middle]) / 2.0
+
+# runs the warmup and the measured runs of a query and summarizes them
+def benchmark_query(query):
+    print(BColor.HEADER + "RUN query " + query + BColor.END_C)
+    runs = []
+    for i in range(args['warmup'] + args['repetitions']):
+        # the libraries of a query are registered by its first run
+        run = run_query(query, i == 0)
+        if i >= args['warmup']:
+            runs.append(run)
+        print("  run " + str(i + 1) + ": " + str(run['latency']) + " seconds")
+
+    latencies = [run['latency'] for run in runs]
+    return {'runs': runs,
+            'latency': {'min': min(latencies), 'median': median(latencies), 'max': max(latencies)},
+            'shuffledBytes': max(run['shuffledBytes'] for run in runs),
+            'peakSharedMemory': max(run['peakSharedMemory'] for run in runs),
+            'peakQueryMemory': max(run['peakQueryMemory'] for run in runs)}
+
+# returns the queries whose median latency got worse than the tolerance allows
+def compare_with_baseline(report, baseline):
+    regressions = []
+    print(BColor.HEADER + "COMPARISON WITH " + args['baseline'] + BColor.END_C)
+    for query, result in sorted(report['queries'].items()):
+        if query not in baseline['queries']:
+            continue
+        old = baseline['queries'][query]['latency']['median']
+        new = result['latency']['median']
+        change = (new - old) / old if old > 0 else 0.0
+        line = "  Q%s: %.3f s -> %.3f s (%+.1f%%)" % (query, old, new, change * 100)
+        if change > args['tolerance']:
+            regressions.append(query)
+            print(BColor.FAIL + line + " REGRESSION" + BColor.END_C)
+        else:
+            print(BColor.OK_GREEN + line + BColor.END_C)
+    return regressions
+
+if not args['skip_load']:
+    load_data()
+elif len(worker_logs()) == 0:
+    print(BColor.FAIL + "--skip-load needs a cluster started by an earlier run of this script" + BColor.END_C)
+    sys.exit(1)
+
+report = {'scaleFactor': scale_factor,
+          'numThreads': args['num_threads'],
+          'sharedMem': args['shared_mem'],
+          'warmup': args['warmup'],
+          'repetitions': args['repetitions'],
+          'queries': {}}
+
+for query in queries:
+    report['queries'][query] = benchmark_query(query)
+
+with open(args['output'], 'w') as f:
+    json.dump(report, f, indent=2, sort_keys=True)
+print(BColor.OK_BLUE + "report written to " + args['output'] + BColor.END_C)
+
+if args['baseline'] is not None:
+    with open(args['baseline']) as f:
+        baseline = json.load(f)
+    if len(compare_with_baseline(report, baseline)) > 0:
+        sys.exit(1)
@@ -31,15 +31,22 @@
 using namespace pdb;
 int main(int argc, char* argv[]) {
 
-    if (argc != 5) {
+    if (argc != 5 && argc != 6) {
         std::cout << "Usage: #dataSizeToAdd[MB] #managerIP #registerSharedLibs[Y/N] ";
-        std::cout << "#createDBAndSet[Y/N]\n";
+        std::cout << "#createDBAndSet[Y/N] [#numNodes]\n";
+        std::cout << "the data size is per node, so the workload grows with the cluster\n";
         return 0;
     }
 
+    // the number of workers, the data we add is scaled by it
+    unsigned numNodes = 1;
+    if (argc == 6) {
+        numNodes = atoi(argv[5]);
+    }
+
     // here is how many MB to add
-    unsigned numOfMb = atoi(argv[1]);
-    std::cout << "Will add " << numOfMb << " MB of data.\n";
+    unsigned numOfMb = atoi(argv[1]) * numNodes;
+    std::cout << "Will add " << numOfMb << " MB of data for " << numNodes << " node(s).\n";
 
     // the IP address of the manager
     std::string managerIP = argv[2];
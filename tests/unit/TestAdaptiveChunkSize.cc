@@ -0,0 +1,221 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+// Pipeline throughput with fixed and adaptive chunk sizes, for a narrow and a wide schema
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <stdlib.h>
+#include "Allocator.h"
+#include "Configuration.h"
+#include "Handle.h"
+#include "InterfaceFunctions.h"
+#include "Object.h"
+#include "Record.h"
+#include "PDBVector.h"
+#include "MyEmployee.h"
+#include "Ptr.h"
+#include "ComputeExecutor.h"
+#include "Pipeline.h"
+#include "ComputeSink.h"
+#include "SimpleComputeExecutor.h"
+#include "VectorTupleSetIterator.h"
+
+using namespace pdb;
+
+#define INPUT_PAGE_SIZE (16 * 1024 * 1024)
+#define OUTPUT_PAGE_SIZE (64 * 1024 * 1024)
+
+/**
+ * A sink that counts the rows it sees and keeps the last column of every batch in its container
+ */
+template <typename ColType>
+class CountingSink : public ComputeSink {
+
+private:
+    int whichColumn;
+
+public:
+    size_t numRows = 0;
+
+    CountingSink(int whichColumn) : whichColumn(whichColumn) {}
+
+    Handle<Object> createNewOutputContainer() override {
+        return makeObject<Vector<ColType>>();
+    }
+
+    void writeOut(TupleSetPtr writeMe, Handle<Object>& writeToMe) override {
+        Handle<Vector<ColType>> out = unsafeCast<Vector<ColType>>(writeToMe);
+        std::vector<ColType>& column = writeMe->getColumn<ColType>(whichColumn);
+        for (auto& value : column) {
+            out->push_back(value);
+        }
+        numRows += column.size();
+    }
+};
+
+/**
+ * Fills pages with vectors of MyEmployee, which the pipelines below iterate over
+ */
+std::vector<Record<Vector<Handle<Object>>>*> generateInput(int numPages, size_t& numTuples) {
+
+    std::vector<Record<Vector<Handle<Object>>>*> pages;
+    numTuples = 0;
+    for (int i = 0; i < numPages; i++) {
+        void* page = malloc(INPUT_PAGE_SIZE);
+        makeObjectAllocatorBlock(page, INPUT_PAGE_SIZE, true);
+        Handle<Vector<Handle<Object>>> employees = makeObject<Vector<Handle<Object>>>(10);
+        try {
+            while (true) {
+                Handle<MyEmployee> employee =
+                    makeObject<MyEmployee>(numTuples % 100, numTuples * 100);
+                employees->push_back(employee);
+                numTuples++;
+            }
+        } catch (NotEnoughSpace& e) {
+        }
+        pages.push_back(getRecord(employees));
+    }
+    makeObjectAllocatorBlock(4096, true);
+    return pages;
+}
+
+/**
+ * Runs one pipeline over the input and returns the tuples per second
+ * @param wide if true each tuple creates a new object, otherwise it is projected to ints
+ * @param finalChunkSizeOut set to the chunk size of the source at the end
+ */
+double runPipeline(std::vector<Record<Vector<Handle<Object>>>*>& input,
+                   bool wide,
+                   size_t chunkSize,
+                   bool adaptive,
+                   size_t& numRowsOut,
+                   size_t& finalChunkSizeOut) {
+
+    size_t nextPage = 0;
+    ComputeSourcePtr source = std::make_shared<VectorTupleSetIterator>(
+        [&]() -> void* { return nextPage < input.size() ? input[nextPage++] : nullptr; },
+        [](void*) {},
+        chunkSize);
+
+    std::shared_ptr<CountingSink<int>> narrowSink = std::make_shared<CountingSink<int>>(1);
+    std::shared_ptr<CountingSink<Handle<MyEmployee>>> wideSink =
+        std::make_shared<CountingSink<Handle<MyEmployee>>>(1);
+
+    Pipeline myPipeline([]() -> std::pair<void*, size_t> {
+                            return std::make_pair(malloc(OUTPUT_PAGE_SIZE), OUTPUT_PAGE_SIZE);
+                        },
+                        [](void* page) { free(page); },
+                        [](void* page) { free(page); },
+                        source,
+                        wide ? (ComputeSinkPtr)wideSink : (ComputeSinkPtr)narrowSink);
+    myPipeline.setAdaptiveChunkSize(adaptive, DEFAULT_BATCH_SIZE);
+
+    if (wide) {
+        TupleSetPtr output = std::make_shared<TupleSet>();
+        myPipeline.addStage(std::make_shared<SimpleComputeExecutor>(
+            output, [output](TupleSetPtr input) {
+                std::vector<Handle<Object>>& in = input->getColumn<Handle<Object>>(0);
+                std::vector<Handle<MyEmployee>>* out = new std::vector<Handle<MyEmployee>>;
+                out->reserve(in.size());
+                for (auto& object : in) {
+                    Handle<MyEmployee> employee = unsafeCast<MyEmployee, Object>(object);
+                    out->push_back(makeObject<MyEmployee>(employee->getAge() / 2,
+                                                          2 * employee->getSalary()));
+                }
+                output->addColumn(1, out, true);
+                return output;
+            }));
+    } else {
+        TupleSetPtr output = std::make_shared<TupleSet>();
+        myPipeline.addStage(std::make_shared<SimpleComputeExecutor>(
+            output, [output](TupleSetPtr input) {
+                std::vector<Handle<Object>>& in = input->getColumn<Handle<Object>>(0);
+                std::vector<int>* out = new std::vector<int>;
+                out->reserve(in.size());
+                for (auto& object : in) {
+                    Handle<MyEmployee> employee = unsafeCast<MyEmployee, Object>(object);
+                    out->push_back(employee->getAge() + employee->getSalary());
+                }
+                output->addColumn(1, out, true);
+                return output;
+            }));
+    }
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    myPipeline.run();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    numRowsOut = wide ? wideSink->numRows : narrowSink->numRows;
+    finalChunkSizeOut = source->getChunkSize();
+    double seconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / 1e9;
+    std::cout << (wide ? "wide  " : "narrow") << " schema, "
+              << (adaptive ? "adaptive from " : "fixed at ") << chunkSize << ": "
+              << (size_t)(numRowsOut / seconds) << " tuples/sec, final chunk size "
+              << source->getChunkSize() << std::endl;
+    return numRowsOut / seconds;
+}
+
+int main(int argc, char* argv[]) {
+
+    int numPages = 8;
+    if (argc == 2) {
+        numPages = atoi(argv[1]);
+    }
+
+    size_t numTuples;
+    std::vector<Record<Vector<Handle<Object>>>*> input = generateInput(numPages, numTuples);
+    std::cout << numTuples << " employees on " << numPages << " pages" << std::endl;
+
+    for (bool wide : {false, true}) {
+        for (size_t chunkSize : {10, 100, 1000, 10000}) {
+            size_t numRows;
+            size_t finalChunkSize;
+            runPipeline(input, wide, chunkSize, false, numRows, finalChunkSize);
+            if (numRows != numTuples) {
+                std::cout << "ERROR: expected " << numTuples << " rows, got " << numRows
+                          << std::endl;
+                return 1;
+            }
+        }
+        // the default chunk size is tuned freely, one that was set on purpose is an upper bound
+        for (size_t chunkSize : {(size_t)DEFAULT_BATCH_SIZE, (size_t)50}) {
+            size_t numRows;
+            size_t finalChunkSize;
+            runPipeline(input, wide, chunkSize, true, numRows, finalChunkSize);
+            if (numRows != numTuples) {
+                std::cout << "ERROR: expected " << numTuples << " rows, got " << numRows
+                          << std::endl;
+                return 1;
+            }
+            if (chunkSize != DEFAULT_BATCH_SIZE && finalChunkSize > chunkSize) {
+                std::cout << "ERROR: the chunk size grew from " << chunkSize << " to "
+                          << finalChunkSize << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    for (auto page : input) {
+        free(page);
+    }
+    return 0;
+}
@@ -0,0 +1,215 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "qunit.h"
+#include "Handle.h"
+#include "PDBVector.h"
+#include "InterfaceFunctions.h"
+#include "UseTemporaryAllocationBlock.h"
+
+// checks that freed chunks are reused from the list for their size, and that objects in blocks
+// that are no longer active are found and their blocks freed, and times allocating and freeing
+// small chunks, freeing chunks from many inactive blocks, and switching to temporary blocks
+
+using namespace pdb;
+
+template <class F>
+long long timeIt(F f) {
+    auto begin = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+}
+
+// the number of inactive blocks, as printInactiveBlocks reports it
+int numInactives() {
+    std::string out = getAllocator().printInactiveBlocks();
+    return std::stoi(out.substr(out.find('=') + 1));
+}
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    makeObjectAllocatorBlock(64 * 1024 * 1024, true);
+    Allocator& allocator = getAllocator();
+
+    // a freed chunk is given back for a request of its size
+    size_t bytesBefore = getBytesAvailableInCurrentAllocatorBlock();
+    void* sixtyFour = allocator.getRAM(60);
+    void* thirtyTwo = allocator.getRAM(28);
+    allocator.freeRAM(sixtyFour);
+    allocator.freeRAM(thirtyTwo);
+    QUNIT_IS_EQUAL(bytesBefore, getBytesAvailableInCurrentAllocatorBlock());
+    QUNIT_IS_EQUAL(0, getNumObjectsInCurrentAllocatorBlock());
+    QUNIT_IS_TRUE(allocator.getRAM(28) == thirtyTwo);
+
+    // and a smaller request gets the smallest chunk that fits
+    allocator.freeRAM(thirtyTwo);
+    QUNIT_IS_TRUE(allocator.getRAM(20) == thirtyTwo);
+    QUNIT_IS_TRUE(allocator.getRAM(20) == sixtyFour);
+    QUNIT_IS_EQUAL(2, getNumObjectsInCurrentAllocatorBlock());
+
+    // a large request looks for a chunk that fits among the chunks of its power of two
+    void* big = allocator.getRAM(5000);
+    void* smaller = allocator.getRAM(3000);
+    void* smallest = allocator.getRAM(2100);
+    allocator.freeRAM(big);
+    allocator.freeRAM(smaller);
+    allocator.freeRAM(smallest);
+    QUNIT_IS_TRUE(allocator.getRAM(2500) == smaller);
+    QUNIT_IS_TRUE(allocator.getRAM(2000) == smallest);
+    size_t bytesLeft = getBytesAvailableInCurrentAllocatorBlock();
+    QUNIT_IS_TRUE(allocator.getRAM(9000) != big);
+    QUNIT_IS_TRUE(getBytesAvailableInCurrentAllocatorBlock() < bytesLeft);
+    QUNIT_IS_TRUE(allocator.getRAM(4500) == big);
+
+    // a new block forgets the free chunks of the old one
+    allocator.freeRAM(thirtyTwo);
+    makeObjectAllocatorBlock(1024 * 1024, true);
+    QUNIT_IS_TRUE(allocator.getRAM(28) != thirtyTwo);
+    QUNIT_IS_TRUE(allocator.isManaged(sixtyFour));
+    QUNIT_IS_EQUAL(5, getNumObjectsInAllocatorBlock(sixtyFour));
+
+    // objects in blocks that are no longer active are found, and their blocks are freed when the
+    // last of them goes away
+    const int numBlocks = 200;
+    std::vector<Handle<Vector<int>>> inOldBlocks;
+    for (int i = 0; i < numBlocks; i++) {
+        makeObjectAllocatorBlock(i % 2 == 0 ? 1024 * 1024 : 4096, true);
+        inOldBlocks.push_back(makeObject<Vector<int>>(10));
+        inOldBlocks.back()->push_back(i);
+    }
+    makeObjectAllocatorBlock(64 * 1024 * 1024, true);
+    QUNIT_IS_EQUAL(numBlocks + 2, numInactives());
+    bool allFound = true;
+    for (int i = 0; i < numBlocks; i++) {
+        void* target = inOldBlocks[i].getTarget();
+        allFound = allFound && allocator.isManaged(target) &&
+            getNumObjectsInAllocatorBlock(target) == 2 && (*inOldBlocks[i])[0] == i;
+    }
+    QUNIT_IS_TRUE(allFound);
+    std::shuffle(inOldBlocks.begin(), inOldBlocks.end(), std::mt19937(7));
+    inOldBlocks.resize(numBlocks / 2);
+    QUNIT_IS_EQUAL(numBlocks / 2 + 2, numInactives());
+    inOldBlocks.clear();
+    QUNIT_IS_EQUAL(2, numInactives());
+
+    // the micro benchmarks: allocating and freeing small chunks of mixed sizes in the active block
+    const int numChunks = 1000000;
+    makeObjectAllocatorBlock((size_t)256 * 1024 * 1024, true);
+    std::mt19937 random(11);
+    std::vector<size_t> sizes;
+    for (int i = 0; i < numChunks; i++) {
+        sizes.push_back(8 + 4 * (random() % 64));
+    }
+    std::vector<void*> chunks(numChunks);
+    long long firstTime = timeIt([&]() {
+        for (int i = 0; i < numChunks; i++) {
+            chunks[i] = allocator.getRAM(sizes[i]);
+        }
+    });
+    std::vector<int> order(numChunks);
+    for (int i = 0; i < numChunks; i++) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), random);
+    std::vector<size_t> newSizes(sizes.begin(), sizes.begin() + numChunks / 2);
+    std::shuffle(newSizes.begin(), newSizes.end(), random);
+    long long churnTime = timeIt([&]() {
+        for (int i = 0; i < numChunks / 2; i++) {
+            allocator.freeRAM(chunks[order[i]]);
+        }
+        for (int i = 0; i < numChunks / 2; i++) {
+            chunks[order[i]] = allocator.getRAM(newSizes[i]);
+        }
+    });
+    QUNIT_IS_EQUAL(numChunks, getNumObjectsInCurrentAllocatorBlock());
+    for (int i = 0; i < numChunks; i++) {
+        allocator.freeRAM(chunks[i]);
+    }
+    QUNIT_IS_EQUAL(0, getNumObjectsInCurrentAllocatorBlock());
+
+    // and freeing chunks that are spread over many inactive blocks
+    const int numInactiveBlocks = 2000;
+    const int chunksPerBlock = 500;
+    std::vector<void*> oldChunks;
+    for (int i = 0; i < numInactiveBlocks; i++) {
+        makeObjectAllocatorBlock(chunksPerBlock * 64, true);
+        for (int j = 0; j < chunksPerBlock; j++) {
+            oldChunks.push_back(allocator.getRAM(40));
+        }
+    }
+    makeObjectAllocatorBlock(1024 * 1024, true);
+    QUNIT_IS_EQUAL(numInactiveBlocks + 2, numInactives());
+    std::shuffle(oldChunks.begin(), oldChunks.end(), random);
+    long long inactiveTime = timeIt([&]() {
+        for (void* chunk : oldChunks) {
+            allocator.freeRAM(chunk);
+        }
+    });
+    QUNIT_IS_EQUAL(2, numInactives());
+
+    // the free chunks of a block are still there after a temporary block was used, which starts
+    // without any
+    void* outer = allocator.getRAM(28);
+    allocator.getRAM(28);
+    allocator.freeRAM(outer);
+    {
+        const UseTemporaryAllocationBlock tempBlock{1024 * 1024};
+        QUNIT_IS_TRUE(allocator.getRAM(28) != outer);
+        QUNIT_IS_EQUAL(1024 * 1024 - 2 * sizeof(size_t) - sizeof(unsigned) - 32,
+                       getBytesAvailableInCurrentAllocatorBlock());
+    }
+    QUNIT_IS_TRUE(allocator.getRAM(28) == outer);
+
+    // and switching to a temporary block and back, while the active block has free chunks
+    const int numTempBlocks = 100000;
+    std::vector<void*> freed;
+    for (int i = 0; i < 1000; i++) {
+        freed.push_back(allocator.getRAM(8 + 4 * (i % 256)));
+    }
+    for (void* chunk : freed) {
+        allocator.freeRAM(chunk);
+    }
+    long long tempBlockTime = timeIt([&]() {
+        for (int i = 0; i < numTempBlocks; i++) {
+            const UseTemporaryAllocationBlock tempBlock{4096};
+            allocator.getRAM(16);
+        }
+    });
+
+    std::cout << "Duration to allocate " << numChunks << " small chunks: " << firstTime << " ns."
+              << std::endl;
+    std::cout << "Duration to free and reallocate " << numChunks / 2
+              << " small chunks: " << churnTime << " ns." << std::endl;
+    std::cout << "Duration to free " << oldChunks.size() << " chunks from " << numInactiveBlocks
+              << " inactive blocks: " << inactiveTime << " ns." << std::endl;
+
+    std::cout << "Duration to use " << numTempBlocks << " temporary blocks: " << tempBlockTime
+              << " ns." << std::endl;
+
+    return qunit.errors();
+}
@@ -0,0 +1,153 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "qunit.h"
+#include "Ptr.h"
+#include "TupleSet.h"
+
+// runs batches through tuple sets the way a pipeline does: the columns a filter or a join makes
+// come from the column arena of the thread, so after the first batch no new column is created,
+// the arena never keeps more than PDB_COLUMN_ARENA_MAX_BUFFERS columns of a type nor a column
+// that grew beyond PDB_COLUMN_ARENA_MAX_ROWS, and the columns still hold the right rows
+
+#define NUM_BATCHES 64
+#define NUM_ROWS 1000
+
+using namespace pdb;
+
+// a source column for one batch, the i-th row holds batch * NUM_ROWS + i
+std::vector<int>* makeBatch(int batch, int numRows) {
+    std::vector<int>* column = new std::vector<int>(numRows);
+    for (int i = 0; i < numRows; i++) {
+        (*column)[i] = batch * NUM_ROWS + i;
+    }
+    return column;
+}
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    // every thread has its own arena, so we start from an empty one
+    std::thread pipelineThread([&]() {
+        ColumnArena& arena = ColumnArena::getArena();
+        const MaintenanceFuncs* intFuncs = getMaintenanceFuncs<int>();
+        QUNIT_IS_EQUAL(0, arena.getNumBuffers(intFuncs));
+
+        std::vector<bool> keepEven(NUM_ROWS);
+        for (int i = 0; i < NUM_ROWS; i++) {
+            keepEven[i] = (i % 2 == 0);
+        }
+        std::vector<uint32_t> twice(NUM_ROWS / 2, 2);
+
+        // the column the arena hands out next, or nullptr if it would have to create one
+        auto peek = [&]() -> void* {
+            if (arena.getNumBuffers(intFuncs) == 0) {
+                return nullptr;
+            }
+            void* column = arena.acquire(intFuncs);
+            arena.release(intFuncs, column);
+            return column;
+        };
+
+        // how many columns the filters and joins took from the arena
+        int numReused = 0;
+        int numWrongRows = 0;
+        for (int batch = 0; batch < NUM_BATCHES; batch++) {
+
+            // the source column is the only one that a batch allocates
+            TupleSetPtr input = std::make_shared<TupleSet>();
+            input->addColumn(0, makeBatch(batch, NUM_ROWS), true);
+            void* next = peek();
+            input->filterColumn(0, keepEven);
+            numReused += (next != nullptr) && (next == &input->getColumn<int>(0));
+
+            // a join replicates the filtered rows into another tuple set
+            TupleSetPtr output = std::make_shared<TupleSet>();
+            next = peek();
+            output->replicate(input, 0, 2, twice);
+            numReused += (next != nullptr) && (next == &output->getColumn<int>(2));
+
+            QUNIT_IS_EQUAL(NUM_ROWS / 2, input->getNumRows(0));
+            QUNIT_IS_EQUAL(NUM_ROWS, output->getNumRows(2));
+            std::vector<int>& filtered = input->getColumn<int>(0);
+            std::vector<int>& replicated = output->getColumn<int>(2);
+            for (int i = 0; i < NUM_ROWS / 2; i++) {
+                int expected = batch * NUM_ROWS + 2 * i;
+                numWrongRows += (filtered[i] != expected) + (replicated[2 * i] != expected) +
+                    (replicated[2 * i + 1] != expected);
+            }
+        }
+        QUNIT_IS_EQUAL(0, numWrongRows);
+
+        // only the first filter had to create a column, all others were reused from the arena
+        QUNIT_IS_EQUAL(2 * NUM_BATCHES - 1, numReused);
+
+        // every batch hands one more source column to the arena, but it keeps only so many
+        QUNIT_IS_EQUAL(PDB_COLUMN_ARENA_MAX_BUFFERS, arena.getNumBuffers(intFuncs));
+
+        // a column that grew too much is freed instead of kept
+        while (arena.getNumBuffers(intFuncs) > 0) {
+            intFuncs->deleter(arena.acquire(intFuncs));
+        }
+        {
+            TupleSet big;
+            big.addColumn(0, makeBatch(0, PDB_COLUMN_ARENA_MAX_ROWS + 1), true);
+        }
+        QUNIT_IS_EQUAL(0, arena.getNumBuffers(intFuncs));
+        {
+            TupleSet small;
+            small.addColumn(0, makeBatch(0, PDB_COLUMN_ARENA_MAX_ROWS), true);
+        }
+        QUNIT_IS_EQUAL(1, arena.getNumBuffers(intFuncs));
+
+        // a column that comes back from the arena is empty
+        std::vector<int>* reused = (std::vector<int>*)arena.acquire(intFuncs);
+        QUNIT_IS_EQUAL(0, reused->size());
+        intFuncs->deleter(reused);
+
+        // replacing an owned column gives its buffer back, replacing a shallow copy does not
+        TupleSetPtr source = std::make_shared<TupleSet>();
+        source->addColumn(0, makeBatch(1, NUM_ROWS), true);
+        TupleSet tupleSet;
+        tupleSet.addColumn(3, makeBatch(2, NUM_ROWS), true);
+        QUNIT_IS_EQUAL(1, tupleSet.getNumColumns());
+        QUNIT_IS_FALSE(tupleSet.hasColumn(0));
+        QUNIT_IS_TRUE(tupleSet.hasColumn(3));
+        tupleSet.copyColumn(source, 0, 3);
+        QUNIT_IS_EQUAL(1, arena.getNumBuffers(intFuncs));
+        QUNIT_IS_EQUAL(1 * NUM_ROWS + 7, tupleSet.getColumn<int>(3)[7]);
+        tupleSet.addColumn(3, makeBatch(3, NUM_ROWS), true);
+        QUNIT_IS_EQUAL(1, arena.getNumBuffers(intFuncs));
+        QUNIT_IS_EQUAL(3 * NUM_ROWS + 7, tupleSet.getColumn<int>(3)[7]);
+        QUNIT_IS_EQUAL(1 * NUM_ROWS + 7, source->getColumn<int>(0)[7]);
+        tupleSet.replicate(source, 0, 3, twice);
+        QUNIT_IS_EQUAL(1, arena.getNumBuffers(intFuncs));
+        QUNIT_IS_EQUAL(NUM_ROWS, tupleSet.getNumRows(3));
+        QUNIT_IS_EQUAL(1 * NUM_ROWS + 3, tupleSet.getColumn<int>(3)[7]);
+        QUNIT_IS_EQUAL(1, tupleSet.getNumColumns());
+    });
+    pipelineThread.join();
+
+    return qunit.errors();
+}
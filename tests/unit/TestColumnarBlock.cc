@@ -0,0 +1,110 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <iostream>
+#include <string>
+
+#include "qunit.h"
+#include "Handle.h"
+#include "InterfaceFunctions.h"
+#include "UseTemporaryAllocationBlock.h"
+#include "ColumnarBlock.h"
+
+// checks ColumnarBlock: the rows are split into columns and put back together unchanged, every
+// column is contiguous, and the minimum and maximum of each column are kept up to date
+
+using namespace pdb;
+
+struct TestRow {
+    int key;
+    double price;
+    FixedString<10> date;
+    FixedString<40> comment;
+
+    static void describeColumns(ColumnSchema<TestRow>& schema) {
+        schema.add("key", &TestRow::key);
+        schema.add("price", &TestRow::price);
+        schema.add("date", &TestRow::date);
+        schema.add("comment", &TestRow::comment);
+    }
+};
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    makeObjectAllocatorBlock(16 * 1024 * 1024, true);
+
+    const int numRows = 999;
+    Handle<ColumnarBlock<TestRow>> block = makeObject<ColumnarBlock<TestRow>>(numRows);
+    QUNIT_IS_EQUAL(4, block->getColumns().size());
+    for (int i = 0; i < numRows; i++) {
+        TestRow row;
+        // the keys go up and down, so both the minimum and the maximum move
+        row.key = (i % 2 == 0) ? i : -i;
+        row.price = i * 0.25;
+        row.date = (i % 3 == 0) ? "1998-12-01" : "1992-01-02";
+        row.comment = "row " + std::to_string(i);
+        block->push_back(row);
+    }
+    QUNIT_IS_EQUAL(numRows, block->size());
+    QUNIT_IS_TRUE(block->isFull());
+
+    // a deep copy takes the columns with it
+    Handle<ColumnarBlock<TestRow>> copy;
+    {
+        UseTemporaryAllocationBlock tempBlock{1024 * 1024};
+        copy = deepCopyToCurrentAllocationBlock<ColumnarBlock<TestRow>>(block);
+    }
+    block = nullptr;
+
+    // the columns hold the fields in row order
+    const int* keys = copy->getColumn(&TestRow::key);
+    const double* prices = copy->getColumn(&TestRow::price);
+    const FixedString<10>* dates = copy->getColumn(&TestRow::date);
+    double priceSum = 0;
+    int late = 0;
+    for (int i = 0; i < numRows; i++) {
+        priceSum += prices[i];
+        late += (dates[i] > "1995-01-01");
+    }
+    QUNIT_IS_EQUAL(numRows * (numRows - 1) / 8.0, priceSum);
+    QUNIT_IS_EQUAL(numRows / 3, late);
+    QUNIT_IS_EQUAL(-997, keys[997]);
+
+    // and the rows come back whole
+    TestRow row = copy->getRow(500);
+    QUNIT_IS_EQUAL(500, row.key);
+    QUNIT_IS_EQUAL(125.0, row.price);
+    QUNIT_IS_TRUE(row.date == "1992-01-02");
+    QUNIT_IS_TRUE(row.comment == "row 500");
+
+    // the statistics
+    QUNIT_IS_EQUAL(-997, copy->getMin(&TestRow::key));
+    QUNIT_IS_EQUAL(998, copy->getMax(&TestRow::key));
+    QUNIT_IS_EQUAL(0.0, copy->getMin(&TestRow::price));
+    QUNIT_IS_EQUAL(998 * 0.25, copy->getMax(&TestRow::price));
+    QUNIT_IS_TRUE(copy->getMin(&TestRow::date) == "1992-01-02");
+    QUNIT_IS_TRUE(copy->getMax(&TestRow::date) == "1998-12-01");
+
+    // the comments are too wide to keep statistics for
+    QUNIT_IS_FALSE(copy->getColumns()[3].hasStats);
+    QUNIT_IS_TRUE(copy->getColumns()[2].hasStats);
+
+    return qunit.errors();
+}
@@ -0,0 +1,147 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "qunit.h"
+#include "DistanceKernels.h"
+
+// checks the distance kernels against the obvious loops, with and without the SIMD versions, on
+// sizes that do not line up with the register and cache blocks
+
+using namespace pdb;
+
+bool closeTo(double expected, double actual) {
+    return std::fabs(expected - actual) <= 1e-9 * std::max(1.0, std::fabs(expected));
+}
+
+void checkKernels(QUnit::UnitTest& qunit, std::mt19937& generator) {
+
+    std::uniform_real_distribution<double> values(-10.0, 10.0);
+
+    // dot and squaredDistance, the odd sizes leave a tail after the vector loop
+    for (size_t n : {0, 1, 3, 4, 7, 33, 1001}) {
+        std::vector<double> a(n), b(n);
+        double expectedDot = 0, expectedDistance = 0;
+        for (size_t i = 0; i < n; i++) {
+            a[i] = values(generator);
+            b[i] = values(generator);
+            expectedDot += a[i] * b[i];
+            expectedDistance += (a[i] - b[i]) * (a[i] - b[i]);
+        }
+        QUNIT_IS_TRUE(closeTo(expectedDot, DistanceKernels::dot(a.data(), b.data(), n)));
+        QUNIT_IS_TRUE(
+            closeTo(expectedDistance, DistanceKernels::squaredDistance(a.data(), b.data(), n)));
+    }
+
+    // x'Ax only reads the upper triangle, so we put garbage in the lower one
+    for (size_t n : {1, 2, 5, 17}) {
+        std::vector<double> matrix(n * n), x(n);
+        for (size_t i = 0; i < n; i++) {
+            x[i] = values(generator);
+            for (size_t j = i; j < n; j++) {
+                matrix[i * n + j] = values(generator);
+            }
+            for (size_t j = 0; j < i; j++) {
+                matrix[i * n + j] = 1e6;
+            }
+        }
+        double expected = 0;
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                double entry = (i <= j) ? matrix[i * n + j] : matrix[j * n + i];
+                expected += x[i] * entry * x[j];
+            }
+        }
+        QUNIT_IS_TRUE(
+            closeTo(expected, DistanceKernels::quadraticFormUpper(matrix.data(), x.data(), n)));
+    }
+
+    // the blocked assignment has to find the same nearest centroids as a plain search, the
+    // sizes cross both the point block and the dimension block
+    for (size_t dim : {1, 6, 700}) {
+        for (size_t numCentroids : {1, 3, 10}) {
+            size_t numPoints = PDB_KERNEL_POINT_BLOCK + 13;
+            std::vector<std::vector<double>> points(numPoints, std::vector<double>(dim));
+            std::vector<std::vector<double>> centroids(numCentroids, std::vector<double>(dim));
+            std::vector<const double*> pointRows, centroidRows;
+            for (auto& point : points) {
+                for (auto& value : point) {
+                    value = values(generator);
+                }
+                pointRows.push_back(point.data());
+            }
+            for (auto& centroid : centroids) {
+                for (auto& value : centroid) {
+                    value = values(generator);
+                }
+                centroidRows.push_back(centroid.data());
+            }
+
+            std::vector<int> assignment(numPoints);
+            DistanceKernels::assignNearest(pointRows.data(), numPoints, centroidRows.data(),
+                                           numCentroids, dim, assignment.data());
+
+            int wrong = 0;
+            for (size_t p = 0; p < numPoints; p++) {
+                double best = -1;
+                double chosen = 0;
+                for (size_t c = 0; c < numCentroids; c++) {
+                    double distance = 0;
+                    for (size_t i = 0; i < dim; i++) {
+                        distance += (points[p][i] - centroids[c][i]) *
+                            (points[p][i] - centroids[c][i]);
+                    }
+                    if (best < 0 || distance < best) {
+                        best = distance;
+                    }
+                    if ((int)c == assignment[p]) {
+                        chosen = distance;
+                    }
+                }
+                // ties may go either way, so we only check that the chosen one is as close
+                if (!closeTo(best, chosen)) {
+                    wrong++;
+                }
+            }
+            QUNIT_IS_EQUAL(0, wrong);
+        }
+    }
+}
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+    std::mt19937 generator(42);
+
+    bool simd = DistanceKernels::isSIMDEnabled();
+    std::cout << "SIMD kernels available: " << (simd ? "yes" : "no") << std::endl;
+
+    DistanceKernels::setSIMDEnabled(false);
+    checkKernels(qunit, generator);
+
+    if (simd) {
+        DistanceKernels::setSIMDEnabled(true);
+        checkKernels(qunit, generator);
+    }
+
+    return qunit.errors();
+}
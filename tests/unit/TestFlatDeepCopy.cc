@@ -0,0 +1,137 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <iostream>
+#include <string>
+
+#include "qunit.h"
+#include "Handle.h"
+#include "PDBVector.h"
+#include "InterfaceFunctions.h"
+#include "Employee.h"
+#include "FixedString.h"
+
+// checks that flat objects are recognized, and that deep copying them and vectors of them with a
+// memmove gives the same objects, with working vTables, as the member by member copy
+
+using namespace pdb;
+
+// only primitive members, so it is flat
+class FlatPoint : public Object {
+
+public:
+    int id = 0;
+    double x = 0;
+    double y = 0;
+    FixedString<8> tag;
+
+    ENABLE_DEEP_COPY
+
+    FlatPoint() {}
+
+    FlatPoint(int id, double x, double y) : id(id), x(x), y(y) {
+        tag = std::to_string(id % 100);
+    }
+
+    virtual double norm() {
+        return x * x + y * y;
+    }
+};
+
+// the members are flat but it inherits its deep copy methods, so its size is not known to be
+// sizeof (FlatPointWithoutDeepCopy)
+class FlatPointWithoutDeepCopy : public FlatPoint {
+
+public:
+    int extra = 0;
+};
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    // which types are flat
+    QUNIT_IS_TRUE(IsFlatObject<FlatPoint>::value);
+    QUNIT_IS_FALSE(IsFlatObject<FlatPointWithoutDeepCopy>::value);
+    QUNIT_IS_FALSE(IsFlatObject<Employee>::value);
+    QUNIT_IS_FALSE(IsFlatObject<Vector<FlatPoint>>::value);
+    QUNIT_IS_FALSE(IsFlatObject<Object>::value);
+    QUNIT_IS_FALSE(IsFlatObject<int>::value);
+
+    makeObjectAllocatorBlock(16 * 1024 * 1024, true);
+
+    PDBTemplateBase flatInfo;
+    flatInfo.setup<FlatPoint>();
+    PDBTemplateBase employeeInfo;
+    employeeInfo.setup<Employee>();
+    QUNIT_IS_FALSE(employeeInfo.isFlatObject());
+    QUNIT_IS_TRUE(employeeInfo.descendsFromObject());
+    QUNIT_IS_EQUAL(getTypeID<Employee>(), employeeInfo.getTypeCode());
+    if (getTypeID<FlatPoint>() > 0) {
+        QUNIT_IS_TRUE(flatInfo.isFlatObject());
+        QUNIT_IS_TRUE(flatInfo.descendsFromObject());
+        QUNIT_IS_EQUAL(getTypeID<FlatPoint>(), flatInfo.getTypeCode());
+        QUNIT_IS_EQUAL(sizeof(FlatPoint), flatInfo.getSizeOfConstituentObject(nullptr));
+    }
+
+    // a single object and a vector of them, in the first block
+    Handle<FlatPoint> point = makeObject<FlatPoint>(7, 3.0, 4.0);
+    const int numPoints = 1000;
+    Handle<Vector<FlatPoint>> points = makeObject<Vector<FlatPoint>>();
+    for (int i = 0; i < numPoints; i++) {
+        points->push_back(FlatPoint(i, i, -i));
+    }
+    Handle<Vector<Handle<Employee>>> employees = makeObject<Vector<Handle<Employee>>>();
+    for (int i = 0; i < 10; i++) {
+        employees->push_back(makeObject<Employee>("Joe " + std::to_string(i), i));
+    }
+
+    // copy everything to a second block
+    makeObjectAllocatorBlock(16 * 1024 * 1024, true);
+    Handle<FlatPoint> pointCopy = deepCopyToCurrentAllocationBlock<FlatPoint>(point);
+    Handle<Vector<FlatPoint>> pointsCopy =
+        deepCopyToCurrentAllocationBlock<Vector<FlatPoint>>(points);
+    Handle<Vector<Handle<Employee>>> employeesCopy =
+        deepCopyToCurrentAllocationBlock<Vector<Handle<Employee>>>(employees);
+
+    QUNIT_IS_TRUE(getAllocator().contains(pointCopy.getTarget()));
+    QUNIT_IS_EQUAL(7, pointCopy->id);
+    QUNIT_IS_EQUAL(25.0, pointCopy->norm());
+    QUNIT_IS_TRUE(std::string("7") == (std::string)pointCopy->tag);
+
+    QUNIT_IS_EQUAL(numPoints, pointsCopy->size());
+    bool allEqual = true;
+    for (int i = 0; i < numPoints; i++) {
+        FlatPoint& copied = (*pointsCopy)[i];
+        allEqual = allEqual && copied.id == i && copied.x == i && copied.y == -i &&
+            copied.norm() == 2.0 * i * i && (std::string)copied.tag == std::to_string(i % 100);
+    }
+    QUNIT_IS_TRUE(allEqual);
+
+    // objects that are not flat still go member by member
+    QUNIT_IS_EQUAL(10, employeesCopy->size());
+    QUNIT_IS_TRUE(*((*employeesCopy)[3]->getName()) == "Joe 3");
+
+    // the copies do not depend on the originals
+    (*points)[5].x = 100;
+    point->id = 8;
+    QUNIT_IS_EQUAL(5.0, (*pointsCopy)[5].x);
+    QUNIT_IS_EQUAL(7, pointCopy->id);
+
+    return qunit.errors();
+}
@@ -0,0 +1,124 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "qunit.h"
+#include "Handle.h"
+#include "InterfaceFunctions.h"
+#include "UseTemporaryAllocationBlock.h"
+#include "FixedString.h"
+#include "FlatRowBlock.h"
+
+// checks FixedString and FlatRowBlock: rows go in and come out unchanged, they sit back to back
+// in memory, and a deep copy of a block moves them with the block
+
+using namespace pdb;
+
+struct TestRow {
+    int key;
+    double price;
+    FixedString<1> flag;
+    FixedString<10> date;
+};
+
+void checkFixedString(QUnit::UnitTest& qunit) {
+
+    FixedString<10> date("1994-01-01");
+    QUNIT_IS_EQUAL(10, date.size());
+    QUNIT_IS_TRUE(date == "1994-01-01");
+    QUNIT_IS_TRUE(date >= "1994-01-01");
+    QUNIT_IS_TRUE(date < "1995-10-01");
+    QUNIT_IS_TRUE(date > std::string("1993-12-31"));
+    QUNIT_IS_TRUE(date.startsWith("1994"));
+    QUNIT_IS_TRUE(date.endsWith("-01"));
+    QUNIT_IS_TRUE(std::string(date) == "1994-01-01");
+
+    // a shorter string is smaller than any string it is a prefix of
+    FixedString<10> year("1994");
+    QUNIT_IS_TRUE(year < date);
+    QUNIT_IS_TRUE(year != date);
+    QUNIT_IS_FALSE(year.startsWith("1994-"));
+
+    // longer values are truncated
+    FixedString<4> truncated(std::string("PROMO BURNISHED"));
+    QUNIT_IS_EQUAL(4, truncated.size());
+    QUNIT_IS_TRUE(truncated == "PROM");
+
+    // the same characters hash the same as a String
+    String asString("MAIL");
+    QUNIT_IS_EQUAL(asString.hash(), FixedString<10>("MAIL").hash());
+
+    FixedString<10> empty;
+    QUNIT_IS_EQUAL(0, empty.size());
+    QUNIT_IS_TRUE(empty == "");
+}
+
+void checkFlatRowBlock(QUnit::UnitTest& qunit) {
+
+    const int numRows = 1000;
+    Handle<FlatRowBlock<TestRow>> block = makeObject<FlatRowBlock<TestRow>>(16);
+    for (int i = 0; i < numRows; i++) {
+        TestRow row;
+        row.key = i;
+        row.price = i * 0.5;
+        row.flag = (i % 2 == 0) ? "A" : "N";
+        row.date = (i < numRows / 2) ? "1994-01-01" : "1996-06-30";
+        block->push_back(row);
+    }
+    QUNIT_IS_EQUAL(numRows, block->size());
+
+    // the rows are contiguous
+    QUNIT_IS_TRUE(block->end() - block->begin() == numRows);
+    QUNIT_IS_TRUE(&(*block)[numRows - 1] == block->getRows() + numRows - 1);
+
+    // a copy of the block to another allocation block takes the rows with it
+    Handle<FlatRowBlock<TestRow>> copy;
+    {
+        UseTemporaryAllocationBlock tempBlock{1024 * 1024};
+        copy = deepCopyToCurrentAllocationBlock<FlatRowBlock<TestRow>>(block);
+    }
+    block = nullptr;
+
+    double priceSum = 0;
+    int flagged = 0;
+    int early = 0;
+    for (const TestRow& row : *copy) {
+        priceSum += row.price;
+        flagged += (row.flag == "A");
+        early += (row.date < "1995-01-01");
+    }
+    QUNIT_IS_EQUAL(numRows * (numRows - 1) / 4.0, priceSum);
+    QUNIT_IS_EQUAL(numRows / 2, flagged);
+    QUNIT_IS_EQUAL(numRows / 2, early);
+    QUNIT_IS_EQUAL(numRows - 1, (*copy)[numRows - 1].key);
+}
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    makeObjectAllocatorBlock(16 * 1024 * 1024, true);
+
+    checkFixedString(qunit);
+    checkFlatRowBlock(qunit);
+
+    return qunit.errors();
+}
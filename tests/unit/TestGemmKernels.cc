@@ -0,0 +1,102 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "qunit.h"
+#include "GemmKernels.h"
+
+// checks the blocked matrix multiply against the obvious triple loop, with and without the SIMD
+// kernel, on shapes that leave partial register tiles and cross the cache blocks
+
+using namespace pdb;
+
+int multiplyAndCount(std::mt19937& generator, size_t m, size_t n, size_t k, bool transposeA) {
+
+    std::uniform_real_distribution<double> values(-1.0, 1.0);
+
+    // A is m x k, or k x m when transposed; we leave some padding at the end of every row to check
+    // the leading dimensions
+    size_t aRows = transposeA ? k : m;
+    size_t aCols = transposeA ? m : k;
+    size_t lda = aCols + 3, ldb = n + 1, ldc = n + 2;
+    std::vector<double> a(aRows * lda), b(k * ldb), c(m * ldc), expected(m * ldc);
+    for (auto& value : a) {
+        value = values(generator);
+    }
+    for (auto& value : b) {
+        value = values(generator);
+    }
+    for (size_t i = 0; i < c.size(); i++) {
+        c[i] = expected[i] = values(generator);
+    }
+
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < n; j++) {
+            for (size_t p = 0; p < k; p++) {
+                double aValue = transposeA ? a[p * lda + i] : a[i * lda + p];
+                expected[i * ldc + j] += aValue * b[p * ldb + j];
+            }
+        }
+    }
+
+    GemmKernels::multiplyAccumulate(
+        m, n, k, a.data(), lda, transposeA, b.data(), ldb, c.data(), ldc);
+
+    int wrong = 0;
+    for (size_t i = 0; i < c.size(); i++) {
+        if (std::fabs(c[i] - expected[i]) > 1e-9 * std::max(1.0, std::fabs(expected[i]))) {
+            wrong++;
+        }
+    }
+    return wrong;
+}
+
+void checkKernels(QUnit::UnitTest& qunit, std::mt19937& generator) {
+    size_t shapes[][3] = {{1, 1, 1},
+                          {4, 8, 16},
+                          {5, 9, 3},
+                          {PDB_GEMM_MC + 7, 19, PDB_GEMM_KC + 5},
+                          {33, PDB_GEMM_NR * 3 + 1, 70}};
+    for (auto& shape : shapes) {
+        QUNIT_IS_EQUAL(0, multiplyAndCount(generator, shape[0], shape[1], shape[2], false));
+        QUNIT_IS_EQUAL(0, multiplyAndCount(generator, shape[0], shape[1], shape[2], true));
+    }
+}
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+    std::mt19937 generator(7);
+
+    bool simd = DistanceKernels::isSIMDEnabled();
+    std::cout << "SIMD kernels available: " << (simd ? "yes" : "no") << std::endl;
+
+    DistanceKernels::setSIMDEnabled(false);
+    checkKernels(qunit, generator);
+
+    if (simd) {
+        DistanceKernels::setSIMDEnabled(true);
+        checkKernels(qunit, generator);
+    }
+
+    return qunit.errors();
+}
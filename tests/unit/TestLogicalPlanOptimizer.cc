@@ -0,0 +1,293 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "qunit.h"
+#include "AtomicComputationClasses.h"
+#include "LogicalPlanOptimizer.h"
+
+// checks the rewrites of the TCAP optimizer on small hand built plans: identical applies are
+// merged, a filter over one side of a join is moved in front of the hash of that side, and the
+// attributes nobody reads are pruned
+
+typedef std::vector<std::string> Atts;
+typedef std::map<std::string, std::string> Info;
+
+TupleSpec makeSpec(std::string setName, Atts atts) {
+    AttList list;
+    list.getAtts() = atts;
+    return TupleSpec(setName, list);
+}
+
+void addScan(AtomicComputationList& plan, std::string out, std::string att, std::string comp) {
+    TupleSpec output = makeSpec(out, {att});
+    plan.addAtomicComputation(std::make_shared<ScanSet>(output, "db", "set", comp));
+}
+
+void addApply(AtomicComputationList& plan,
+              std::string out,
+              Atts outAtts,
+              std::string in,
+              Atts inAtts,
+              Atts projAtts,
+              std::string comp,
+              std::string lambda,
+              Info info) {
+    TupleSpec input = makeSpec(in, inAtts);
+    TupleSpec output = makeSpec(out, outAtts);
+    TupleSpec projection = makeSpec(in, projAtts);
+    KeyValueList pairs;
+    for (auto& pair : info) {
+        pairs.appendkeyValuePair(pair.first, pair.second);
+    }
+    plan.addAtomicComputation(
+        std::make_shared<ApplyLambda>(input, output, projection, comp, lambda, pairs));
+}
+
+void addFilter(AtomicComputationList& plan,
+               std::string out,
+               std::string in,
+               std::string boolAtt,
+               Atts projAtts,
+               std::string comp) {
+    TupleSpec input = makeSpec(in, {boolAtt});
+    TupleSpec output = makeSpec(out, projAtts);
+    TupleSpec projection = makeSpec(in, projAtts);
+    plan.addAtomicComputation(std::make_shared<ApplyFilter>(input, output, projection, comp));
+}
+
+void addOutput(AtomicComputationList& plan, std::string in, std::string att, std::string comp) {
+    TupleSpec input = makeSpec(in, {att});
+    TupleSpec output = makeSpec("out_" + in, {});
+    TupleSpec projection = makeSpec(in, {att});
+    plan.addAtomicComputation(
+        std::make_shared<WriteSet>(input, output, projection, "db", "out", comp));
+}
+
+// JOIN (scanL -> key -> HASHLEFT, scanR -> key -> HASHRIGHT) -> the predicate -> FILTER -> OUTPUT
+// where the predicate is computed from in0 or from both in0 and in1
+void makeJoinPlan(AtomicComputationList& plan, bool predicateOverBothSides) {
+    std::string join = "JoinComp_2";
+    addScan(plan, "scanL", "in0", "ScanUserSet_0");
+    addScan(plan, "scanR", "in1", "ScanUserSet_1");
+    addApply(plan, "keyL", {"in0", "k0"}, "scanL", {"in0"}, {"in0"}, join, "attAccess_1", {});
+    addApply(plan, "keyR", {"in1", "k1"}, "scanR", {"in1"}, {"in1"}, join, "attAccess_2", {});
+
+    TupleSpec hashLIn = makeSpec("keyL", {"k0"});
+    TupleSpec hashLOut = makeSpec("hashedL", {"in0", "h0"});
+    TupleSpec hashLProj = makeSpec("keyL", {"in0"});
+    plan.addAtomicComputation(
+        std::make_shared<HashLeft>(hashLIn, hashLOut, hashLProj, join, "=="));
+    TupleSpec hashRIn = makeSpec("keyR", {"k1"});
+    TupleSpec hashROut = makeSpec("hashedR", {"in1", "h1"});
+    TupleSpec hashRProj = makeSpec("keyR", {"in1"});
+    plan.addAtomicComputation(
+        std::make_shared<HashRight>(hashRIn, hashROut, hashRProj, join, "=="));
+
+    TupleSpec joinOut = makeSpec("joined", {"in0", "in1"});
+    TupleSpec joinLIn = makeSpec("hashedL", {"h0"});
+    TupleSpec joinRIn = makeSpec("hashedR", {"h1"});
+    TupleSpec joinLProj = makeSpec("hashedL", {"in0"});
+    TupleSpec joinRProj = makeSpec("hashedR", {"in1"});
+    plan.addAtomicComputation(
+        std::make_shared<ApplyJoin>(joinOut, joinLIn, joinRIn, joinLProj, joinRProj, join));
+
+    Atts predicateInputs{"in0"};
+    if (predicateOverBothSides) {
+        predicateInputs.push_back("in1");
+    }
+    addApply(plan,
+             "withBool",
+             {"in0", "in1", "bool"},
+             "joined",
+             predicateInputs,
+             {"in0", "in1"},
+             join,
+             "native_lambda_3",
+             {{"lambdaType", "native_lambda"}});
+    addFilter(plan, "filtered", "withBool", "bool", {"in0", "in1"}, join);
+    addApply(plan,
+             "result",
+             {"out"},
+             "filtered",
+             {"in0", "in1"},
+             {},
+             join,
+             "native_lambda_4",
+             {{"lambdaType", "native_lambda"}});
+    addOutput(plan, "result", "out", "WriteUserSet_3");
+}
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    Info getAge{{"lambdaType", "attAccess"},
+                {"inputTypeName", "Employee"},
+                {"attName", "age"},
+                {"attTypeName", "int"}};
+    Info getSalary{{"lambdaType", "attAccess"},
+                   {"inputTypeName", "Employee"},
+                   {"attName", "salary"},
+                   {"attTypeName", "double"}};
+
+    // two selections over the same scan accessing the same attribute don't share the access, the
+    // shared tuple set would have to be materialized
+    {
+        AtomicComputationList plan;
+        addScan(plan, "scan", "in0", "ScanUserSet_0");
+        addApply(plan, "age1", {"in0", "a1"}, "scan", {"in0"}, {"in0"}, "Sel_1", "att_0", getAge);
+        addFilter(plan, "filtered1", "age1", "a1", {"in0"}, "Sel_1");
+        addOutput(plan, "filtered1", "in0", "WriteUserSet_3");
+        addApply(plan, "age2", {"a2"}, "scan", {"in0"}, {}, "Sel_2", "att_0", getAge);
+        addFilter(plan, "filtered2", "age2", "a2", {"a2"}, "Sel_2");
+        addOutput(plan, "filtered2", "a2", "WriteUserSet_4");
+
+        LogicalPlanOptimizer optimizer(plan);
+        AtomicComputationList optimized = optimizer.optimize();
+        QUNIT_IS_EQUAL(0, optimizer.getNumEliminated());
+        QUNIT_IS_EQUAL(2, optimized.getConsumingAtomicComputations("scan").size());
+        QUNIT_IS_EQUAL(1, optimized.getConsumingAtomicComputations("age1").size());
+        QUNIT_IS_EQUAL(7, optimized.getAllComputations().size());
+    }
+
+    // but if the output of the first access already has two consumers, the second one reads it
+    {
+        AtomicComputationList plan;
+        addScan(plan, "scan", "in0", "ScanUserSet_0");
+        addApply(plan, "age1", {"in0", "a1"}, "scan", {"in0"}, {"in0"}, "Sel_1", "att_0", getAge);
+        addFilter(plan, "filtered1", "age1", "a1", {"in0"}, "Sel_1");
+        addOutput(plan, "filtered1", "in0", "WriteUserSet_3");
+        addFilter(plan, "filtered3", "age1", "a1", {"a1"}, "Sel_3");
+        addOutput(plan, "filtered3", "a1", "WriteUserSet_5");
+        addApply(plan, "age2", {"a2"}, "scan", {"in0"}, {}, "Sel_2", "att_0", getAge);
+        addFilter(plan, "filtered2", "age2", "a2", {"a2"}, "Sel_2");
+        addOutput(plan, "filtered2", "a2", "WriteUserSet_4");
+
+        LogicalPlanOptimizer optimizer(plan);
+        AtomicComputationList optimized = optimizer.optimize();
+        QUNIT_IS_EQUAL(1, optimizer.getNumEliminated());
+        QUNIT_IS_EQUAL(1, optimized.getConsumingAtomicComputations("scan").size());
+        QUNIT_IS_EQUAL(3, optimized.getConsumingAtomicComputations("age1").size());
+        AtomicComputationPtr second = optimized.getProducingAtomicComputation("filtered2");
+        QUNIT_IS_EQUAL("age1", second->getInputName());
+        QUNIT_IS_EQUAL("a1", second->getInput().getAtts()[0]);
+        QUNIT_IS_EQUAL("a1", second->getOutput().getAtts()[0]);
+        QUNIT_IS_EQUAL(8, optimized.getAllComputations().size());
+    }
+
+    // a different attribute, or a native lambda of another computation, is not the same thing
+    {
+        Info native{{"lambdaType", "native_lambda"}};
+        AtomicComputationList plan;
+        addScan(plan, "scan", "in0", "ScanUserSet_0");
+        addApply(plan, "age", {"a"}, "scan", {"in0"}, {}, "Sel_1", "att_0", getAge);
+        addApply(plan, "salary", {"s"}, "scan", {"in0"}, {}, "Sel_2", "att_0", getSalary);
+        addApply(plan, "n1", {"n1"}, "scan", {"in0"}, {}, "Sel_3", "native_lambda_0", native);
+        addApply(plan, "n2", {"n2"}, "scan", {"in0"}, {}, "Sel_4", "native_lambda_0", native);
+        for (std::string set : {"age", "salary", "n1", "n2"}) {
+            addOutput(plan, set, set == "age" ? "a" : set == "salary" ? "s" : set, "Write");
+        }
+
+        LogicalPlanOptimizer optimizer(plan);
+        AtomicComputationList optimized = optimizer.optimize();
+        QUNIT_IS_EQUAL(0, optimizer.getNumEliminated());
+        QUNIT_IS_EQUAL(4, optimized.getConsumingAtomicComputations("scan").size());
+    }
+
+    // a filter over the left side of a join is moved in front of the left hash
+    {
+        AtomicComputationList plan;
+        makeJoinPlan(plan, false);
+
+        LogicalPlanOptimizer optimizer(plan);
+        AtomicComputationList optimized = optimizer.optimize();
+        QUNIT_IS_EQUAL(1, optimizer.getNumPushedDown());
+
+        AtomicComputationPtr predicate = optimized.getProducingAtomicComputation("withBool");
+        QUNIT_IS_EQUAL("keyL", predicate->getInputName());
+        QUNIT_IS_EQUAL("in0", predicate->getInput().getAtts()[0]);
+        AtomicComputationPtr filter = optimized.getProducingAtomicComputation("filtered");
+        QUNIT_IS_EQUAL("withBool", filter->getInputName());
+        AtomicComputationPtr hash = optimized.getProducingAtomicComputation("hashedL");
+        QUNIT_IS_EQUAL("filtered", hash->getInputName());
+        QUNIT_IS_EQUAL("filtered", hash->getProjection().getSetName());
+        QUNIT_IS_EQUAL("k0", hash->getInput().getAtts()[0]);
+        QUNIT_IS_TRUE(hash->getProjection().getAtts() == Atts{"in0"});
+
+        // the key survives the filter since the hash reads it, the bool does not
+        QUNIT_IS_TRUE(filter->getOutput().getAtts() == (Atts{"in0", "k0"}));
+        QUNIT_IS_TRUE(predicate->getOutput().getAtts() == (Atts{"in0", "k0", "bool"}));
+
+        // and whatever followed the filter now follows the join
+        AtomicComputationPtr result = optimized.getProducingAtomicComputation("result");
+        QUNIT_IS_EQUAL("joined", result->getInputName());
+        QUNIT_IS_EQUAL("joined", result->getProjection().getSetName());
+        QUNIT_IS_EQUAL(1, optimized.getConsumingAtomicComputations("joined").size());
+    }
+
+    // but not if it looks at both sides
+    {
+        AtomicComputationList plan;
+        makeJoinPlan(plan, true);
+
+        LogicalPlanOptimizer optimizer(plan);
+        AtomicComputationList optimized = optimizer.optimize();
+        QUNIT_IS_EQUAL(0, optimizer.getNumPushedDown());
+        AtomicComputationPtr predicate = optimized.getProducingAtomicComputation("withBool");
+        QUNIT_IS_EQUAL("joined", predicate->getInputName());
+        QUNIT_IS_EQUAL("keyL", optimized.getProducingAtomicComputation("hashedL")->getInputName());
+    }
+
+    // the attributes nobody reads are not carried along
+    {
+        AtomicComputationList plan;
+        addScan(plan, "scan", "in0", "ScanUserSet_0");
+        addApply(plan, "age", {"in0", "a"}, "scan", {"in0"}, {"in0"}, "Sel_1", "att_0", getAge);
+        addApply(plan,
+                 "salary",
+                 {"in0", "a", "s"},
+                 "age",
+                 {"in0"},
+                 {"in0", "a"},
+                 "Sel_1",
+                 "att_1",
+                 getSalary);
+        addFilter(plan, "filtered", "salary", "a", {"in0", "a", "s"}, "Sel_1");
+        addOutput(plan, "filtered", "s", "WriteUserSet_2");
+
+        LogicalPlanOptimizer optimizer(plan);
+        AtomicComputationList optimized = optimizer.optimize();
+        QUNIT_IS_EQUAL(3, optimizer.getNumPruned());
+        AtomicComputationPtr filter = optimized.getProducingAtomicComputation("filtered");
+        QUNIT_IS_TRUE(filter->getProjection().getAtts() == Atts{"s"});
+        QUNIT_IS_TRUE(filter->getOutput().getAtts() == Atts{"s"});
+        AtomicComputationPtr salary = optimized.getProducingAtomicComputation("salary");
+        QUNIT_IS_TRUE(salary->getProjection().getAtts() == Atts{"a"});
+        QUNIT_IS_TRUE(salary->getOutput().getAtts() == (Atts{"a", "s"}));
+
+        // the salary apply reads in0, so age has to keep it
+        AtomicComputationPtr age = optimized.getProducingAtomicComputation("age");
+        QUNIT_IS_TRUE(age->getOutput().getAtts() == (Atts{"in0", "a"}));
+    }
+
+    return qunit.errors();
+}
@@ -0,0 +1,204 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "qunit.h"
+#include "Configuration.h"
+#include "PDBPage.h"
+#include "WorkStealingPageIterator.h"
+
+// a test case for splitting source pages into morsels: pages are cut into DEFAULT_MORSEL_SIZE
+// ranges, pipeline threads take them through work-stealing page iterators the way a scan does,
+// and more threads join while the stage runs, like PipelineStage::runPipeline adds them; every
+// object is processed exactly once and whoever finishes the last morsel of a page unpins it, once
+
+#define PAGE_SIZE 4096
+#define NUM_START_THREADS 2
+#define MAX_THREADS 6
+#define NUM_FEEDERS 2
+#define NUM_PAGES 40
+
+using namespace pdb;
+
+// what the pipeline threads saw of one source page
+struct PageStats {
+    size_t numObjects = 0;
+    std::unique_ptr<std::atomic<int>[]> timesProcessed;
+    std::atomic<int> timesUnpinned{0};
+};
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    PDBLoggerPtr logger = make_shared<PDBLogger>("testMorselSplitting.log");
+    std::vector<char*> pageBytes;
+    std::vector<PDBPagePtr> pages;
+    std::vector<PageStats> stats(NUM_PAGES);
+    for (int i = 0; i < NUM_PAGES; i++) {
+        char* bytes = (char*)malloc(PAGE_SIZE);
+        pageBytes.push_back(bytes);
+        pages.push_back(make_shared<PDBPage>(bytes, 0, 1, 1, 1, i, PAGE_SIZE, 0));
+
+        // empty pages, pages that fill their last morsel exactly, and pages that spill into one more
+        size_t sizes[] = {0,
+                          1,
+                          DEFAULT_MORSEL_SIZE - 1,
+                          DEFAULT_MORSEL_SIZE,
+                          DEFAULT_MORSEL_SIZE + 1,
+                          3 * DEFAULT_MORSEL_SIZE + 17};
+        stats[i].numObjects = sizes[i % 6] + (i / 6) * DEFAULT_MORSEL_SIZE;
+        stats[i].timesProcessed.reset(new std::atomic<int>[stats[i].numObjects + 1]);
+        for (size_t j = 0; j <= stats[i].numObjects; j++) {
+            stats[i].timesProcessed[j] = 0;
+        }
+    }
+
+    // a page is cut into full morsels, the last one runs to the end of the page
+    WorkStealingSchedulerPtr<PageMorsel> single =
+        make_shared<WorkStealingScheduler<PageMorsel>>(1, 16);
+    single->addProducer();
+    std::thread splitter([&]() {
+        WorkStealingPageIterator::submitMorsels(
+            single, 0, pages[5], 3 * DEFAULT_MORSEL_SIZE + 17, DEFAULT_MORSEL_SIZE);
+        WorkStealingPageIterator::submitMorsels(single, 0, pages[0], 0, DEFAULT_MORSEL_SIZE);
+        single->producerDone();
+    });
+    std::vector<PageMorsel> morsels;
+    PageMorsel morsel;
+    while (single->getTask(0, morsel)) {
+        morsels.push_back(morsel);
+    }
+    splitter.join();
+    QUNIT_IS_EQUAL(5, morsels.size());
+    for (int i = 0; i < 4; i++) {
+        QUNIT_IS_TRUE(morsels[i].source->page == pages[5]);
+        QUNIT_IS_EQUAL(i * DEFAULT_MORSEL_SIZE, morsels[i].begin);
+    }
+    QUNIT_IS_EQUAL(DEFAULT_MORSEL_SIZE, morsels[0].end);
+    QUNIT_IS_EQUAL(SIZE_MAX, morsels[3].end);
+    QUNIT_IS_EQUAL(4, morsels[0].source->numMorselsLeft);
+
+    // an empty page still makes one morsel, so that someone unpins it
+    QUNIT_IS_TRUE(morsels[4].source->page == pages[0]);
+    QUNIT_IS_EQUAL(1, morsels[4].source->numMorselsLeft);
+    morsels.clear();
+
+    // the feeders split the pages among the first pipeline threads, as the storage hands them out
+    WorkStealingSchedulerPtr<PageMorsel> scheduler = make_shared<WorkStealingScheduler<PageMorsel>>(
+        NUM_START_THREADS, DEFAULT_QUEUED_MORSELS_PER_THREAD * NUM_START_THREADS);
+    for (int i = 0; i < NUM_FEEDERS; i++) {
+        scheduler->addProducer();
+    }
+    std::vector<std::thread> feeders;
+    for (int i = 0; i < NUM_FEEDERS; i++) {
+        feeders.emplace_back([&, i]() {
+            for (int j = i; j < NUM_PAGES; j += NUM_FEEDERS) {
+                WorkStealingPageIterator::submitMorsels(
+                    scheduler, i, pages[j], stats[j].numObjects, DEFAULT_MORSEL_SIZE);
+            }
+            scheduler->producerDone();
+        });
+    }
+
+    // a pipeline thread asks for its next range before it lets go of the last one, like the
+    // vector source of a scan does
+    std::atomic<int> numRunning(0);
+    std::atomic<int> numMorselsTaken(0);
+    auto runPipelineThread = [&](int id) {
+        WorkStealingPageIterator iter(id, scheduler, logger);
+        PDBPagePtr page, lastPage = nullptr;
+        size_t begin, end;
+        while (iter.nextRange(page, begin, end)) {
+            if (lastPage != nullptr && iter.finishRange()) {
+                stats[lastPage->getPageID()].timesUnpinned++;
+            }
+            PageStats& myStats = stats[page->getPageID()];
+            for (size_t j = begin; j < std::min(end, myStats.numObjects); j++) {
+                myStats.timesProcessed[j]++;
+            }
+            numMorselsTaken++;
+            usleep(200);
+            lastPage = page;
+        }
+        if (lastPage != nullptr && iter.finishRange()) {
+            stats[lastPage->getPageID()].timesUnpinned++;
+        }
+        numRunning--;
+    };
+
+    std::vector<std::thread> pipelineThreads;
+    for (int i = 0; i < NUM_START_THREADS; i++) {
+        numRunning++;
+        pipelineThreads.emplace_back(runPipelineThread, i);
+    }
+
+    // while morsels pile up the stage grows, the new threads steal from the first ones
+    int numLaunched = NUM_START_THREADS;
+    while (numRunning > 0) {
+        if ((numLaunched < MAX_THREADS) && (scheduler->getNumQueued() > (size_t)numLaunched)) {
+            numRunning++;
+            pipelineThreads.emplace_back(runPipelineThread, numLaunched);
+            numLaunched++;
+        } else {
+            usleep(1000);
+        }
+    }
+    for (auto& thread : feeders) {
+        thread.join();
+    }
+    for (auto& thread : pipelineThreads) {
+        thread.join();
+    }
+    QUNIT_IS_TRUE(numLaunched > NUM_START_THREADS);
+    QUNIT_IS_TRUE(scheduler->getNumStolen() > 0);
+
+    // every object was processed once, and every page was unpinned once
+    int numMorsels = 0;
+    for (int i = 0; i < NUM_PAGES; i++) {
+        int numWrong = 0;
+        for (size_t j = 0; j < stats[i].numObjects; j++) {
+            if (stats[i].timesProcessed[j] != 1) {
+                numWrong++;
+            }
+        }
+        QUNIT_IS_EQUAL(0, numWrong);
+        QUNIT_IS_EQUAL(1, stats[i].timesUnpinned);
+        numMorsels += std::max((size_t)1,
+                               (stats[i].numObjects + DEFAULT_MORSEL_SIZE - 1) / DEFAULT_MORSEL_SIZE);
+    }
+    QUNIT_IS_EQUAL(numMorsels, numMorselsTaken);
+
+    // an iterator of a drained scheduler has nothing left to hand out
+    WorkStealingPageIterator drained(0, scheduler, logger);
+    QUNIT_IS_FALSE(drained.hasNext());
+    QUNIT_IS_TRUE(drained.next() == nullptr);
+
+    pages.clear();
+    for (char* bytes : pageBytes) {
+        free(bytes);
+    }
+    return qunit.errors();
+}
@@ -0,0 +1,191 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "qunit.h"
+#include "PDBPage.h"
+
+// stresses pinning, unpinning and evicting a page from many threads at once: the reference count
+// never goes wrong, a page is pinned whenever it has a reference, the last unpin is seen by exactly
+// one thread, and a page that an eviction has claimed is never pinned until it is given back
+
+#define PAGE_SIZE 4096
+#define NUM_THREADS 8
+
+// what the pinners expect to find on the page, and what the evictor leaves on it while it has it
+#define PAGE_CONTENT 0x5a
+#define EVICTED_CONTENT 0x00
+
+template <class F>
+long long timeIt(F f) {
+    auto begin = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+}
+
+template <class F>
+void runThreads(int numThreads, F f) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; i++) {
+        threads.emplace_back(f, i);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    char* bytes = (char*)malloc(PAGE_SIZE);
+    PDBPagePtr page = make_shared<PDBPage>(bytes, 0, 1, 1, 1, 1, PAGE_SIZE, 0);
+    char* body = (char*)page->getBytes();
+    memset(body, PAGE_CONTENT, page->getSize());
+
+    // a new page is pinned, with no references
+    QUNIT_IS_TRUE(page->isPinned());
+    QUNIT_IS_EQUAL(0, page->getRefCount());
+    page->incRefCount();
+    page->incRefCount();
+    QUNIT_IS_EQUAL(1, page->decRefCount());
+    QUNIT_IS_TRUE(page->isPinned());
+    QUNIT_IS_EQUAL(0, page->decRefCount());
+    QUNIT_IS_FALSE(page->isPinned());
+
+    // an extra unpin does not take the count below zero
+    QUNIT_IS_EQUAL(0, page->decRefCount());
+    QUNIT_IS_EQUAL(0, page->getRefCount());
+
+    // a pinned page can not be claimed, and a claimed page can not be pinned
+    QUNIT_IS_TRUE(page->tryPin());
+    QUNIT_IS_FALSE(page->tryStartEviction());
+    page->decRefCount();
+    QUNIT_IS_TRUE(page->tryStartEviction());
+    QUNIT_IS_TRUE(page->isEvicting());
+    QUNIT_IS_FALSE(page->tryStartEviction());
+    QUNIT_IS_FALSE(page->tryPin());
+    QUNIT_IS_EQUAL(0, page->getRefCount());
+    page->endEviction();
+    QUNIT_IS_TRUE(page->tryPin());
+    QUNIT_IS_EQUAL(0, page->decRefCount());
+
+    // many threads pinning and unpinning at once
+    const int numRounds = 1000000;
+    bool alwaysPinned = true;
+    long long pinTime = timeIt([&]() {
+        runThreads(NUM_THREADS, [&](int) {
+            bool pinned = true;
+            for (int i = 0; i < numRounds; i++) {
+                page->incRefCount();
+                pinned = pinned && page->isPinned();
+                page->decRefCount();
+            }
+            if (!pinned) {
+                alwaysPinned = false;
+            }
+        });
+    });
+    QUNIT_IS_TRUE(alwaysPinned);
+    QUNIT_IS_EQUAL(0, page->getRefCount());
+    QUNIT_IS_FALSE(page->isPinned());
+
+    // exactly one thread sees the last unpin
+    const int numHandoffs = 20000;
+    int numLastUnpins = 0;
+    for (int i = 0; i < numHandoffs; i++) {
+        for (int j = 0; j < NUM_THREADS; j++) {
+            page->incRefCount();
+        }
+        std::atomic<int> sawZero(0);
+        runThreads(4, [&](int t) {
+            for (int j = t; j < NUM_THREADS; j += 4) {
+                if (page->decRefCount() == 0) {
+                    sawZero++;
+                }
+            }
+        });
+        numLastUnpins += sawZero;
+    }
+    QUNIT_IS_EQUAL(numHandoffs, numLastUnpins);
+
+    // pinners and an evictor racing: while the evictor has the page, it wipes the page, and nobody
+    // who pinned it may see that
+    std::atomic<bool> stop(false);
+    std::atomic<int> numPinnersInside(0);
+    std::atomic<long> numPins(0);
+    std::atomic<long> numEvictions(0);
+    std::atomic<long> numBadReads(0);
+    std::atomic<long> numBadEvictions(0);
+    std::thread evictor([&]() {
+        while (!stop) {
+            if (page->tryStartEviction()) {
+                if (numPinnersInside != 0 || page->getRefCount() != 0) {
+                    numBadEvictions++;
+                }
+                memset(body, EVICTED_CONTENT, 64);
+                memset(body, PAGE_CONTENT, 64);
+                numEvictions++;
+                page->endEviction();
+            }
+        }
+    });
+    runThreads(NUM_THREADS - 1, [&](int) {
+        for (int i = 0; i < numRounds / 4; i++) {
+            if (page->tryPin()) {
+                numPinnersInside++;
+                for (int j = 0; j < 64; j++) {
+                    if (body[j] != PAGE_CONTENT) {
+                        numBadReads++;
+                        break;
+                    }
+                }
+                numPinnersInside--;
+                page->decRefCount();
+                numPins++;
+            }
+        }
+    });
+    stop = true;
+    evictor.join();
+    QUNIT_IS_EQUAL(0, numBadReads);
+    QUNIT_IS_EQUAL(0, numBadEvictions);
+    QUNIT_IS_TRUE(numPins > 0);
+    QUNIT_IS_TRUE(numEvictions > 0);
+    QUNIT_IS_EQUAL(0, page->getRefCount());
+    QUNIT_IS_FALSE(page->isEvicting());
+
+    // an eviction that frees the page keeps it claimed, and the content is freed only once
+    QUNIT_IS_TRUE(page->tryStartEviction());
+    runThreads(NUM_THREADS, [&](int) { page->freeContent(); });
+    QUNIT_IS_TRUE(page->getRawBytes() == nullptr);
+    QUNIT_IS_FALSE(page->tryPin());
+
+    std::cout << "Duration to pin and unpin a page " << NUM_THREADS * numRounds << " times from "
+              << NUM_THREADS << " threads: " << pinTime << " ns." << std::endl;
+    std::cout << numPins << " pins raced " << numEvictions << " evictions." << std::endl;
+
+    return qunit.errors();
+}
@@ -0,0 +1,197 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "qunit.h"
+#include "QueryMemoryAccountant.h"
+
+// checks that a query is held to its own limit and to the limit of the worker, that it remembers
+// its peak, that a reservation over a limit waits for memory that other threads give back before
+// the query fails, and that a failed query stays failed
+
+using namespace pdb;
+
+#define KB 1024
+#define NUM_THREADS 8
+
+template <class F>
+long long timeIt(F f) {
+    auto begin = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+}
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    // without limits everything is reserved, and the peak is the most held at once
+    {
+        QueryMemoryAccountant accountant("job0", 0, 0, 0);
+        QUNIT_IS_TRUE(accountant.reserve(100 * KB, "a page"));
+        QUNIT_IS_TRUE(accountant.reserve(50 * KB, "a page"));
+        accountant.release(100 * KB);
+        QUNIT_IS_TRUE(accountant.reserve(10 * KB, "a page"));
+        QUNIT_IS_EQUAL(60 * KB, accountant.getUsedBytes());
+        QUNIT_IS_EQUAL(150 * KB, accountant.getPeakBytes());
+        QUNIT_IS_EQUAL(60 * KB, QueryMemoryAccountant::getNodeUsedBytes());
+        QUNIT_IS_FALSE(accountant.hasFailed());
+    }
+
+    // what a query still holds goes back to the worker with its accountant
+    QUNIT_IS_EQUAL(0, QueryMemoryAccountant::getNodeUsedBytes());
+
+    // a query that would go over its limit fails, and stays failed
+    {
+        QueryMemoryAccountant accountant("job1", 100 * KB, 0, 0);
+        QUNIT_IS_TRUE(accountant.reserve(60 * KB, "a page"));
+        QUNIT_IS_FALSE(accountant.tryReserve(60 * KB));
+        QUNIT_IS_FALSE(accountant.hasFailed());
+        QUNIT_IS_FALSE(accountant.reserve(60 * KB, "a shuffle page"));
+        QUNIT_IS_TRUE(accountant.hasFailed());
+        QUNIT_IS_TRUE(accountant.getErrMsg().find("job1") != std::string::npos);
+        QUNIT_IS_TRUE(accountant.getErrMsg().find("a shuffle page") != std::string::npos);
+        QUNIT_IS_EQUAL(60 * KB, accountant.getUsedBytes());
+        QUNIT_IS_FALSE(accountant.reserve(1, "a page"));
+        QUNIT_IS_TRUE(accountant.allocate(1, "a page") == nullptr);
+        accountant.release(60 * KB);
+    }
+
+    // memory a query can not do without is charged over the limit, and counts against it
+    {
+        QueryMemoryAccountantPtr accountant =
+            std::make_shared<QueryMemoryAccountant>("job2", 100 * KB, 0, 0);
+        {
+            QueryMemoryReservation block(accountant, 200 * KB);
+            QUNIT_IS_EQUAL(200 * KB, QueryMemoryAccountant::getNodeUsedBytes());
+            QUNIT_IS_FALSE(accountant->tryReserve(1));
+        }
+        QUNIT_IS_TRUE(accountant->tryReserve(100 * KB));
+        QUNIT_IS_EQUAL(200 * KB, accountant->getPeakBytes());
+        accountant->release(100 * KB);
+        QueryMemoryReservation nothing(nullptr, 200 * KB);
+        QUNIT_IS_EQUAL(0, QueryMemoryAccountant::getNodeUsedBytes());
+    }
+
+    // the queries on a worker share its limit
+    {
+        QueryMemoryAccountant first("job3", 0, 100 * KB, 0);
+        QueryMemoryAccountant second("job4", 0, 100 * KB, 0);
+        void* bytes = first.allocate(80 * KB, "a hash table", true);
+        QUNIT_IS_TRUE(bytes != nullptr);
+        QUNIT_IS_FALSE(second.tryReserve(30 * KB));
+        QUNIT_IS_EQUAL(0, second.getUsedBytes());
+        QUNIT_IS_FALSE(second.reserve(30 * KB, "a page"));
+        QUNIT_IS_TRUE(second.getErrMsg().find("worker") != std::string::npos);
+        QUNIT_IS_FALSE(first.hasFailed());
+        first.deallocate(bytes, 80 * KB);
+        QUNIT_IS_TRUE(first.tryReserve(100 * KB));
+        first.release(100 * KB);
+        QUNIT_IS_EQUAL(100 * KB, first.getPeakBytes());
+        QUNIT_IS_EQUAL(0, QueryMemoryAccountant::getNodeUsedBytes());
+    }
+
+    // a reservation over the limit waits for the pages that another thread is writing out
+    {
+        QueryMemoryAccountant accountant("job5", 100 * KB, 0, 5000);
+        QUNIT_IS_TRUE(accountant.reserve(100 * KB, "a page"));
+        std::thread writer([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            accountant.release(100 * KB);
+        });
+        bool reserved = false;
+        long long waitTime = timeIt([&]() { reserved = accountant.reserve(100 * KB, "a page"); });
+        writer.join();
+        QUNIT_IS_TRUE(reserved);
+        QUNIT_IS_FALSE(accountant.hasFailed());
+        QUNIT_IS_TRUE(waitTime < 5000);
+        QUNIT_IS_EQUAL(100 * KB, accountant.getPeakBytes());
+        accountant.release(100 * KB);
+    }
+
+    // if nothing is given back in time the query fails
+    {
+        QueryMemoryAccountant accountant("job6", 100 * KB, 0, 100);
+        QUNIT_IS_TRUE(accountant.reserve(100 * KB, "a page"));
+        bool reserved = true;
+        long long waitTime = timeIt([&]() { reserved = accountant.reserve(1, "a page"); });
+        QUNIT_IS_FALSE(reserved);
+        QUNIT_IS_TRUE(accountant.hasFailed());
+        QUNIT_IS_TRUE(waitTime >= 90);
+        accountant.release(100 * KB);
+    }
+
+    // many threads taking and giving back pages under a limit that fits all of them at once
+    std::atomic<int> numRefused(0);
+    {
+        QueryMemoryAccountant accountant("job7", NUM_THREADS * 64 * KB, 0, 5000);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < NUM_THREADS; t++) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < 100000; i++) {
+                    if (!accountant.reserve(64 * KB, "a page")) {
+                        numRefused++;
+                        return;
+                    }
+                    accountant.release(64 * KB);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        QUNIT_IS_EQUAL(0, numRefused);
+        QUNIT_IS_EQUAL(0, accountant.getUsedBytes());
+        QUNIT_IS_TRUE(accountant.getPeakBytes() <= NUM_THREADS * 64 * KB);
+        QUNIT_IS_EQUAL(0, QueryMemoryAccountant::getNodeUsedBytes());
+    }
+
+    // and twice as many pages as fit, so that threads wait for each other
+    {
+        QueryMemoryAccountant accountant("job8", NUM_THREADS * 32 * KB, 0, 5000);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < NUM_THREADS; t++) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < 2000; i++) {
+                    if (!accountant.reserve(64 * KB, "a page")) {
+                        numRefused++;
+                        return;
+                    }
+                    std::this_thread::yield();
+                    accountant.release(64 * KB);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        QUNIT_IS_EQUAL(0, numRefused);
+        QUNIT_IS_FALSE(accountant.hasFailed());
+        QUNIT_IS_EQUAL(0, accountant.getUsedBytes());
+        QUNIT_IS_TRUE(accountant.getPeakBytes() <= NUM_THREADS * 32 * KB);
+    }
+    QUNIT_IS_EQUAL(0, QueryMemoryAccountant::getNodeUsedBytes());
+
+    return qunit.errors();
+}
@@ -0,0 +1,143 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <iostream>
+#include <string>
+
+#include "qunit.h"
+#include "Handle.h"
+#include "InterfaceFunctions.h"
+#include "StringDictionary.h"
+#include "DictionaryEncoder.h"
+
+// checks that a StringDictionary gives every distinct string one code and gives it back, that it
+// stops growing once it is full, that grouping on the codes gives the groups of the strings, and
+// that a DictionaryEncoder fails the query on a string the dictionary does not know
+
+using namespace pdb;
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    makeObjectAllocatorBlock(16 * 1024 * 1024, true);
+
+    // codes are handed out in order, and a string keeps its code
+    Handle<StringDictionary> dictionary = makeObject<StringDictionary>();
+    QUNIT_IS_EQUAL(0, dictionary->encode(String("A")));
+    QUNIT_IS_EQUAL(1, dictionary->encode(String("N")));
+    QUNIT_IS_EQUAL(2, dictionary->encode(String("a status longer than seven characters")));
+    QUNIT_IS_EQUAL(1, dictionary->encode(String("N")));
+    QUNIT_IS_EQUAL(3, dictionary->size());
+    int32_t code = NO_DICTIONARY_CODE;
+    QUNIT_IS_TRUE(dictionary->getCode(String("a status longer than seven characters"), code));
+    QUNIT_IS_EQUAL(2, code);
+    QUNIT_IS_FALSE(dictionary->getCode(String("R"), code));
+    QUNIT_IS_EQUAL(2, code);
+    QUNIT_IS_EQUAL(3, dictionary->size());
+    QUNIT_IS_TRUE(dictionary->decode(0) == "A");
+    QUNIT_IS_TRUE(dictionary->decode(2) == "a status longer than seven characters");
+
+    // a full dictionary still finds what it has, but takes nothing new
+    Handle<StringDictionary> small = makeObject<StringDictionary>(2);
+    small->encode(String("F"));
+    small->encode(String("O"));
+    QUNIT_IS_TRUE(small->isFull());
+    QUNIT_IS_EQUAL(NO_DICTIONARY_CODE, small->encode(String("P")));
+    QUNIT_IS_EQUAL(1, small->encode(String("O")));
+    QUNIT_IS_EQUAL(2, small->size());
+
+    // the dictionary is shipped to the workers, so it has to work after a deep copy
+    makeObjectAllocatorBlock(16 * 1024 * 1024, true);
+    Handle<StringDictionary> copy = deepCopyToCurrentAllocationBlock<StringDictionary>(dictionary);
+    QUNIT_IS_EQUAL(3, copy->size());
+    QUNIT_IS_TRUE(copy->getCode(String("N"), code));
+    QUNIT_IS_EQUAL(1, code);
+    QUNIT_IS_TRUE(copy->decode(2) == "a status longer than seven characters");
+
+    // grouping rows on the codes of their flags gives the same groups as grouping on the strings
+    std::string flags[] = {"A", "N", "R"};
+    std::string statuses[] = {"F", "O"};
+    Handle<StringDictionary> lineItemDictionary = makeObject<StringDictionary>();
+    for (std::string& flag : flags) {
+        lineItemDictionary->encode(String(flag));
+    }
+    for (std::string& status : statuses) {
+        lineItemDictionary->encode(String(status));
+    }
+    Handle<Map<String, int>> byString = makeObject<Map<String, int>>();
+    Handle<Map<int, int>> byCode = makeObject<Map<int, int>>();
+    for (int i = 0; i < 3000; i++) {
+        String flag(flags[i % 3]);
+        String status(statuses[i % 2]);
+        String key(flags[i % 3] + statuses[i % 2]);
+        int32_t flagCode, statusCode;
+        lineItemDictionary->getCode(flag, flagCode);
+        lineItemDictionary->getCode(status, statusCode);
+        int code = flagCode * 2 + statusCode - 3;
+        if (byString->count(key) == 0) {
+            (*byString)[key] = 0;
+        }
+        (*byString)[key]++;
+        if (byCode->count(code) == 0) {
+            (*byCode)[code] = 0;
+        }
+        (*byCode)[code]++;
+    }
+    QUNIT_IS_EQUAL(5, lineItemDictionary->size());
+    QUNIT_IS_EQUAL(byString->size(), byCode->size());
+    bool sameGroups = true;
+    for (auto entry : *byCode) {
+        int flagCode = entry.key / 2;
+        int statusCode = entry.key % 2 + 3;
+        String key(std::string(lineItemDictionary->decode(flagCode)) +
+                   std::string(lineItemDictionary->decode(statusCode)));
+        sameGroups = sameGroups && (*byString)[key] == entry.value;
+    }
+    QUNIT_IS_TRUE(sameGroups);
+
+    // a Map finds a value with one probe, and says so if there is none
+    QUNIT_IS_TRUE(byCode->lookup(0) != nullptr);
+    QUNIT_IS_EQUAL(500, *byCode->lookup(0));
+    QUNIT_IS_TRUE(byCode->lookup(7) == nullptr);
+    QUNIT_IS_TRUE(byString->lookup(String("RO")) != nullptr);
+    QUNIT_IS_TRUE(byString->lookup(String("RX")) == nullptr);
+
+    // the encoder gives the codes, and fails the query on a string without one, and when it has
+    // no dictionary at all
+    DictionaryEncoder encoder(lineItemDictionary);
+    QUNIT_IS_EQUAL(2, encoder(String("R")));
+    QUNIT_IS_EQUAL(4, encoder(String("O")));
+    bool failed = false;
+    try {
+        encoder(String("X"));
+    } catch (QueryFailure& f) {
+        failed = std::string(f.what()).find("'X'") != std::string::npos;
+    }
+    QUNIT_IS_TRUE(failed);
+    DictionaryEncoder unbound;
+    failed = false;
+    try {
+        unbound(String("R"));
+    } catch (QueryFailure& f) {
+        failed = true;
+    }
+    QUNIT_IS_TRUE(failed);
+
+    return qunit.errors();
+}
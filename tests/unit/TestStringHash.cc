@@ -0,0 +1,200 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "qunit.h"
+#include "Handle.h"
+#include "PDBString.h"
+#include "PDBVector.h"
+#include "PDBMap.h"
+#include "InterfaceFunctions.h"
+
+// checks that short strings stay inline, that long strings carry their hash with them, including
+// to other pages, and times hashing and comparing strings against rescanning their characters
+
+using namespace pdb;
+
+// the hash of the characters, computed the way String did before it cached it
+size_t rescan(String& s) {
+    return hashMe(s.c_str(), s.size() - 1);
+}
+
+template <class F>
+long long timeIt(F f) {
+    auto begin = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+}
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    makeObjectAllocatorBlock(64 * 1024 * 1024, true);
+
+    // short strings do not allocate
+    size_t bytesBefore = getBytesAvailableInCurrentAllocatorBlock();
+    String flag("R");
+    String code("5-LOW");
+    String empty;
+    QUNIT_IS_EQUAL(bytesBefore, getBytesAvailableInCurrentAllocatorBlock());
+    QUNIT_IS_EQUAL(2, flag.size());
+    QUNIT_IS_EQUAL(6, code.size());
+    QUNIT_IS_EQUAL(1, empty.size());
+    QUNIT_IS_EQUAL(rescan(flag), flag.hash());
+    QUNIT_IS_EQUAL(rescan(empty), empty.hash());
+
+    // long ones do, and know their hash
+    String comment("furiously regular deposits sleep");
+    String sameComment(std::string("furiously regular deposits sleep"));
+    String otherComment("furiously regular deposits sleeq");
+    QUNIT_IS_EQUAL(33, comment.size());
+    QUNIT_IS_EQUAL(rescan(comment), comment.hash());
+    QUNIT_IS_EQUAL(comment.hash(), sameComment.hash());
+    QUNIT_IS_TRUE(comment == sameComment);
+    QUNIT_IS_TRUE(comment != otherComment);
+    QUNIT_IS_FALSE(comment == code);
+    QUNIT_IS_TRUE(comment == "furiously regular deposits sleep");
+    QUNIT_IS_TRUE(comment == std::string("furiously regular deposits sleep"));
+    QUNIT_IS_TRUE(comment != std::string("furiously regular deposits"));
+    QUNIT_IS_TRUE(std::string(comment) == "furiously regular deposits sleep");
+    QUNIT_IS_TRUE(String("5-LOW and more", 5) == code);
+
+    // assigning between short and long strings
+    String changing("short");
+    changing = "this one is not short at all";
+    QUNIT_IS_EQUAL(rescan(changing), changing.hash());
+    changing = std::string("tiny");
+    QUNIT_IS_TRUE(changing == "tiny");
+    changing = comment;
+    QUNIT_IS_TRUE(changing == comment);
+    QUNIT_IS_EQUAL(comment.hash(), changing.hash());
+
+    // changing a character makes the string forget its hash
+    String edited("another long string to edit");
+    edited[0] = 'A';
+    QUNIT_IS_EQUAL(rescan(edited), edited.hash());
+    QUNIT_IS_TRUE(edited == "Another long string to edit");
+
+    // a long string in the layout that was stored before the hash, without it, reads as before
+    const char* oldChars = "written before strings had a hash";
+    int oldLen = strlen(oldChars) + 1;
+    String old;
+    Handle<char>& oldData = *((Handle<char>*)&old);
+    oldData.setOffset(-1);
+    oldData = makeObjectWithExtraStorage<char>(oldLen - 1);
+    oldData.setExactTypeInfoValue(-oldLen);
+    memmove(&(*oldData), oldChars, oldLen);
+    QUNIT_IS_EQUAL(oldLen, old.size());
+    QUNIT_IS_TRUE(old == oldChars);
+    QUNIT_IS_TRUE(old == String(oldChars));
+    QUNIT_IS_TRUE(String(oldChars) == old);
+    QUNIT_IS_EQUAL(rescan(old), old.hash());
+    QUNIT_IS_EQUAL(String(oldChars).hash(), old.hash());
+    Handle<Vector<String>> oldKeys = makeObject<Vector<String>>();
+    oldKeys->push_back(old);
+    oldKeys->push_back(comment);
+
+    // the hashes move to another page along with the characters
+    const int numStrings = 100000;
+    Handle<Vector<String>> keys = makeObject<Vector<String>>(numStrings);
+    for (int i = 0; i < numStrings; i++) {
+        if (i % 2 == 0) {
+            keys->push_back(String(std::to_string(i)));
+        } else {
+            keys->push_back(String("customer key number " + std::to_string(i)));
+        }
+    }
+    makeObjectAllocatorBlock(64 * 1024 * 1024, true);
+    Handle<Vector<String>> copies = deepCopyToCurrentAllocationBlock<Vector<String>>(keys);
+    bool allEqual = true;
+    for (int i = 0; i < numStrings; i++) {
+        String& copy = (*copies)[i];
+        allEqual = allEqual && copy == (*keys)[i] && copy.hash() == rescan(copy) &&
+            copy.hash() == (*keys)[i].hash();
+    }
+    QUNIT_IS_TRUE(allEqual);
+    Handle<Vector<String>> oldCopies = deepCopyToCurrentAllocationBlock<Vector<String>>(oldKeys);
+    QUNIT_IS_TRUE((*oldCopies)[0] == oldChars);
+    QUNIT_IS_EQUAL(oldLen, (*oldCopies)[0].size());
+    QUNIT_IS_EQUAL(old.hash(), (*oldCopies)[0].hash());
+    QUNIT_IS_TRUE((*oldCopies)[1] == comment);
+    QUNIT_IS_EQUAL(comment.hash(), (*oldCopies)[1].hash());
+
+    // and they work as map keys
+    Handle<Map<String, int>> counts = makeObject<Map<String, int>>();
+    for (int i = 0; i < numStrings; i++) {
+        (*counts)[(*copies)[i]] = i;
+    }
+    QUNIT_IS_EQUAL(numStrings, counts->size());
+    QUNIT_IS_EQUAL(7, (*counts)[String("customer key number 7")]);
+    QUNIT_IS_EQUAL(8, (*counts)[String("8")]);
+
+    // the micro benchmarks: hashing, and comparing strings that are equal and that are not
+    const int numRounds = 20;
+    Vector<String>& myKeys = *copies;
+    size_t sum = 0;
+    long long rescanTime = timeIt([&]() {
+        for (int r = 0; r < numRounds; r++) {
+            for (int i = 0; i < numStrings; i++) {
+                sum += rescan(myKeys[i]);
+            }
+        }
+    });
+    long long hashTime = timeIt([&]() {
+        for (int r = 0; r < numRounds; r++) {
+            for (int i = 0; i < numStrings; i++) {
+                sum -= myKeys[i].hash();
+            }
+        }
+    });
+    QUNIT_IS_EQUAL(0, sum);
+
+    int numMatches = 0;
+    long long equalTime = timeIt([&]() {
+        for (int r = 0; r < numRounds; r++) {
+            for (int i = 0; i < numStrings; i++) {
+                numMatches += myKeys[i] == (*keys)[i];
+            }
+        }
+    });
+    long long notEqualTime = timeIt([&]() {
+        for (int r = 0; r < numRounds; r++) {
+            for (int i = 1; i < numStrings; i++) {
+                numMatches += myKeys[i] == myKeys[i - 1];
+            }
+        }
+    });
+    QUNIT_IS_EQUAL(numRounds * numStrings, numMatches);
+
+    std::cout << "Duration to rescan and hash " << numRounds * numStrings
+              << " strings: " << rescanTime << " ns." << std::endl;
+    std::cout << "Duration to hash " << numRounds * numStrings << " strings: " << hashTime
+              << " ns." << std::endl;
+    std::cout << "Duration to compare " << numRounds * numStrings
+              << " equal strings: " << equalTime << " ns." << std::endl;
+    std::cout << "Duration to compare " << numRounds * (numStrings - 1)
+              << " different strings: " << notEqualTime << " ns." << std::endl;
+
+    return qunit.errors();
+}
@@ -0,0 +1,140 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "qunit.h"
+#include "Handle.h"
+#include "InterfaceFunctions.h"
+#include "TopKQueue.h"
+#include "TopKThreshold.h"
+
+// checks the threshold the threads of a top-K stage share: it never passes the k-th best score of
+// the scores that were added, and a per-worker queue merged on the client gives the true top k
+
+using namespace pdb;
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    makeObjectAllocatorBlock(16 * 1024 * 1024, true);
+
+    // an empty and a singleton queue report their size
+    TopKQueue<double, int> emptyQueue(3);
+    QUNIT_IS_EQUAL(0, emptyQueue.size());
+    TopKQueue<double, int> singleton(3, 1.5, 7);
+    QUNIT_IS_EQUAL(1, singleton.size());
+
+    // a single thread, k = 3: no threshold until three scores are kept
+    TopKThreshold<double> single("job_1_single");
+    double threshold = 0;
+    QUNIT_IS_FALSE(single.getThreshold(threshold));
+    QUNIT_IS_TRUE(single.mayQualify(-100.0));
+    single.add(3, 5.0);
+    single.add(3, 1.0);
+    QUNIT_IS_FALSE(single.getThreshold(threshold));
+    single.add(3, 3.0);
+    QUNIT_IS_TRUE(single.getThreshold(threshold));
+    QUNIT_IS_EQUAL(1.0, threshold);
+    single.add(3, 4.0);
+    single.getThreshold(threshold);
+    QUNIT_IS_EQUAL(3.0, threshold);
+    QUNIT_IS_FALSE(single.mayQualify(2.0));
+    QUNIT_IS_TRUE(single.mayQualify(3.0));
+
+    // scores below the threshold are not added
+    single.add(3, 0.5);
+    single.getThreshold(threshold);
+    QUNIT_IS_EQUAL(3.0, threshold);
+
+    // four threads of one stage each see a quarter of the scores 0 .. 3999, and learn from the
+    // others when they sync; no thread may ever get a threshold above the true 10th best score
+    // the pipeline keeps the threshold of a stage alive while its threads run, we do it here
+    TopKThreshold<double> keeper("job_1_shared");
+    keeper.add(10, -1.0);
+    const int numThreads = 4;
+    const int numScores = 4000;
+    std::vector<double> finalThresholds(numThreads, 0);
+    std::vector<bool> hasThreshold(numThreads, false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++) {
+        threads.emplace_back([&, t]() {
+            TopKThreshold<double> mine("job_1_shared");
+            for (int i = t; i < numScores; i += numThreads) {
+                double score = i;
+                if (mine.mayQualify(score)) {
+                    mine.add(10, score);
+                }
+            }
+            mine.sync();
+            double value;
+            hasThreshold[t] = mine.getThreshold(value);
+            finalThresholds[t] = value;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int t = 0; t < numThreads; t++) {
+        QUNIT_IS_TRUE(hasThreshold[t]);
+        QUNIT_IS_TRUE(finalThresholds[t] <= numScores - 10);
+    }
+
+    // after everyone synced, a thread of the same stage that joins late starts from their threshold
+    TopKThreshold<double> late("job_1_shared");
+    late.add(10, 0.0);
+    late.sync();
+    QUNIT_IS_TRUE(late.getThreshold(threshold));
+    QUNIT_IS_EQUAL(numScores - 10, threshold);
+
+    // another stage does not see those scores
+    TopKThreshold<double> other("job_2_shared");
+    other.add(10, 0.0);
+    other.sync();
+    QUNIT_IS_FALSE(other.getThreshold(threshold));
+
+    // two workers' queues of the best three merge into the best three overall
+    Handle<TopKQueue<double, int>> first = makeObject<TopKQueue<double, int>>(3);
+    Handle<TopKQueue<double, int>> second = makeObject<TopKQueue<double, int>>(3);
+    double firstScores[] = {9.0, 2.0, 7.0, 4.0};
+    double secondScores[] = {8.0, 1.0, 6.0};
+    for (double score : firstScores) {
+        int value = (int)score;
+        first->insert(score, value);
+    }
+    for (double score : secondScores) {
+        int value = (int)score;
+        second->insert(score, value);
+    }
+    Handle<TopKQueue<double, int>> merged = makeObject<TopKQueue<double, int>>(3);
+    *merged + *first;
+    *merged + *second;
+    QUNIT_IS_EQUAL(3, merged->size());
+    double lowest = 100;
+    for (unsigned i = 0; i < merged->size(); i++) {
+        lowest = std::min(lowest, (*merged)[i].getScore());
+        QUNIT_IS_EQUAL((int)(*merged)[i].getScore(), (*merged)[i].getValue());
+    }
+    QUNIT_IS_EQUAL(7.0, lowest);
+
+    return qunit.errors();
+}
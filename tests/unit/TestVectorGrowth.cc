@@ -0,0 +1,151 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "qunit.h"
+#include "Handle.h"
+#include "PDBVector.h"
+#include "InterfaceFunctions.h"
+#include "UseTemporaryAllocationBlock.h"
+#include "Employee.h"
+
+// checks that vectors grow in place when they are the last thing in the allocation block, and
+// that reserve, makeRoomFor and append keep the contents intact when they have to move
+
+using namespace pdb;
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    makeObjectAllocatorBlock(16 * 1024 * 1024, true);
+
+    // nothing else is allocated, so the array never moves and leaves no dead space behind
+    const int numInts = 100000;
+    size_t bytesBefore = getBytesAvailableInCurrentAllocatorBlock();
+    Handle<Vector<int>> ints = makeObject<Vector<int>>();
+    int* firstLocation = ints->c_ptr();
+    for (int i = 0; i < numInts; i++) {
+        ints->push_back(i);
+    }
+    QUNIT_IS_TRUE(firstLocation == ints->c_ptr());
+    QUNIT_IS_EQUAL(numInts, ints->size());
+    QUNIT_IS_EQUAL(numInts, ints->capacity());
+    size_t bytesUsed = bytesBefore - getBytesAvailableInCurrentAllocatorBlock();
+    QUNIT_IS_TRUE(bytesUsed < numInts * sizeof(int) + 1024);
+    bool allEqual = true;
+    for (int i = 0; i < numInts; i++) {
+        allEqual = allEqual && (*ints)[i] == i;
+    }
+    QUNIT_IS_TRUE(allEqual);
+
+    // once something else is allocated behind it, it has to move, and then it doubles
+    Handle<Vector<int>> other = makeObject<Vector<int>>(10);
+    QUNIT_IS_FALSE(getAllocator().tryToGrowInPlace(ints.getTarget(), 1024 * 1024));
+    ints->push_back(numInts);
+    QUNIT_IS_FALSE(firstLocation == ints->c_ptr());
+    QUNIT_IS_EQUAL(numInts + 1, ints->size());
+    QUNIT_IS_EQUAL(2 * numInts, ints->capacity());
+    QUNIT_IS_EQUAL(numInts, (*ints)[numInts]);
+    QUNIT_IS_EQUAL(numInts - 1, (*ints)[numInts - 1]);
+
+    // reserve is exact, and never shrinks
+    other->reserve(5);
+    QUNIT_IS_EQUAL(10, other->capacity());
+    other->reserve(1000);
+    QUNIT_IS_EQUAL(1000, other->capacity());
+    QUNIT_IS_EQUAL(0, other->size());
+
+    // a range of ints, then a vector appended to another one and to itself
+    std::vector<int> values;
+    for (int i = 0; i < 500; i++) {
+        values.push_back(i * 3);
+    }
+    other->append(values.data(), values.size());
+    QUNIT_IS_EQUAL(500, other->size());
+    QUNIT_IS_EQUAL(1497, (*other)[499]);
+    other->append(*other);
+    QUNIT_IS_EQUAL(1000, other->size());
+    QUNIT_IS_EQUAL(1000, other->capacity());
+    QUNIT_IS_EQUAL(3, (*other)[501]);
+    ints->append(*other);
+    QUNIT_IS_EQUAL(numInts + 1001, ints->size());
+    QUNIT_IS_EQUAL(1497, (*ints)[numInts + 1000]);
+
+    // a range out of the middle of a vector appended to itself, while it has to move
+    Handle<Vector<int>> blocker = makeObject<Vector<int>>(10);
+    int* oldLocation = other->c_ptr();
+    other->append(other->c_ptr() + 500, 300);
+    QUNIT_IS_FALSE(oldLocation == other->c_ptr());
+    QUNIT_IS_EQUAL(1300, other->size());
+    QUNIT_IS_EQUAL(0, (*other)[1000]);
+    QUNIT_IS_EQUAL(897, (*other)[1299]);
+
+    // handles are added one at a time, so that they are counted
+    Handle<Vector<Handle<Employee>>> employees = makeObject<Vector<Handle<Employee>>>();
+    std::vector<Handle<Employee>> newEmployees;
+    for (int i = 0; i < 100; i++) {
+        newEmployees.push_back(makeObject<Employee>("Joe " + std::to_string(i), i));
+    }
+    employees->append(newEmployees.data(), newEmployees.size());
+    QUNIT_IS_EQUAL(100, employees->size());
+    QUNIT_IS_TRUE(*((*employees)[42]->getName()) == "Joe 42");
+    QUNIT_IS_EQUAL(2, newEmployees[42].getRefCount());
+
+    // if not everything fits, whatever does is added before we run out of RAM
+    makeObjectAllocatorBlock(64 * 1024, true);
+    Handle<Vector<Handle<Employee>>> fewEmployees = makeObject<Vector<Handle<Employee>>>(50);
+    std::vector<Handle<Employee>> tooMany;
+    {
+        const UseTemporaryAllocationBlock tempBlock{16 * 1024 * 1024};
+        for (int i = 0; i < 10000; i++) {
+            tooMany.push_back(makeObject<Employee>("Jane " + std::to_string(i), i));
+        }
+    }
+    bool outOfRAM = false;
+    try {
+        fewEmployees->append(tooMany.data(), tooMany.size());
+    } catch (NotEnoughSpace& n) {
+        outOfRAM = true;
+    }
+    QUNIT_IS_TRUE(outOfRAM);
+    QUNIT_IS_TRUE(fewEmployees->size() >= 50);
+    QUNIT_IS_TRUE(fewEmployees->size() < tooMany.size());
+    size_t last = fewEmployees->size() - 1;
+    QUNIT_IS_TRUE(*((*fewEmployees)[last]->getName()) == "Jane " + std::to_string(last));
+
+    // and the same when the items come from the vector itself
+    for (int i = 0; i < 5; i++) {
+        fewEmployees->pop_back();
+    }
+    outOfRAM = false;
+    last = fewEmployees->size();
+    try {
+        fewEmployees->append(fewEmployees->c_ptr(), fewEmployees->size());
+    } catch (NotEnoughSpace& n) {
+        outOfRAM = true;
+    }
+    QUNIT_IS_TRUE(outOfRAM);
+    QUNIT_IS_TRUE(fewEmployees->size() > last);
+    QUNIT_IS_TRUE(*((*fewEmployees)[last]->getName()) == "Jane 0");
+
+    return qunit.errors();
+}
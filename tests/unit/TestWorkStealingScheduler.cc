@@ -0,0 +1,129 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "qunit.h"
+#include "WorkStealingScheduler.h"
+
+// a test case for the work-stealing scheduler: two producers queue all their tasks on the first
+// worker, one slow worker owns them and the others have to steal to get anything done; and many
+// producers racing for the last free slots never queue more tasks than the scheduler allows
+
+using namespace pdb;
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    const int numWorkers = 4;
+    const int numProducers = 2;
+    const long numTasksPerProducer = 10000;
+
+    WorkStealingScheduler<long> scheduler(numWorkers, 16);
+    for (int i = 0; i < numProducers; i++) {
+        scheduler.addProducer();
+    }
+
+    std::atomic<long> sum(0);
+    std::vector<std::atomic<long>> tasksPerWorker(numWorkers);
+    for (auto& count : tasksPerWorker) {
+        count = 0;
+    }
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numProducers; i++) {
+        threads.emplace_back([&]() {
+            for (long j = 1; j <= numTasksPerProducer; j++) {
+                scheduler.submit(0, j);
+            }
+            scheduler.producerDone();
+        });
+    }
+    for (int i = 0; i < numWorkers; i++) {
+        threads.emplace_back([&, i]() {
+            long task;
+            while (scheduler.getTask(i, task)) {
+                sum += task;
+                tasksPerWorker[i]++;
+                if (i == 0) {
+                    usleep(10);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // every task ran exactly once
+    QUNIT_IS_EQUAL(sum, numProducers * numTasksPerProducer * (numTasksPerProducer + 1) / 2);
+
+    // the other workers did their share by stealing
+    QUNIT_IS_TRUE(scheduler.getNumStolen() > 0);
+    for (int i = 1; i < numWorkers; i++) {
+        QUNIT_IS_TRUE(tasksPerWorker[i] > 0);
+    }
+
+    // a drained scheduler does not hand out anything anymore
+    long task;
+    QUNIT_IS_FALSE(scheduler.getTask(0, task));
+
+    // producers that all find a free slot at the same time still only fill the queue up to its
+    // bound, the rest wait until a worker takes a task
+    const int numRacingProducers = 16;
+    const size_t maxQueuedTasks = 8;
+    WorkStealingScheduler<long> bounded(numWorkers, maxQueuedTasks);
+    std::atomic<long> numSubmitted(0);
+    threads.clear();
+    for (int i = 0; i < numRacingProducers; i++) {
+        bounded.addProducer();
+    }
+    for (int i = 0; i < numRacingProducers; i++) {
+        threads.emplace_back([&, i]() {
+            for (long j = 0; j < 100; j++) {
+                bounded.submit(i, j);
+                numSubmitted++;
+            }
+            bounded.producerDone();
+        });
+    }
+    usleep(200000);
+    QUNIT_IS_EQUAL(maxQueuedTasks, numSubmitted);
+
+    // once the workers run every task gets through
+    std::atomic<long> numTaken(0);
+    for (int i = 0; i < numWorkers; i++) {
+        threads.emplace_back([&, i]() {
+            long task;
+            while (bounded.getTask(i, task)) {
+                numTaken++;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    QUNIT_IS_EQUAL(numRacingProducers * 100, numTaken);
+
+    return qunit.errors();
+}
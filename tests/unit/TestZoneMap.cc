@@ -0,0 +1,128 @@
+/*****************************************************************************
+ *                                                                           *
+ *  Copyright 2018 Rice University                                           *
+ *                                                                           *
+ *  Licensed under the Apache License, Version 2.0 (the "License");          *
+ *  you may not use this file except in compliance with the License.         *
+ *  You may obtain a copy of the License at                                  *
+ *                                                                           *
+ *      http://www.apache.org/licenses/LICENSE-2.0                           *
+ *                                                                           *
+ *  Unless required by applicable law or agreed to in writing, software      *
+ *  distributed under the License is distributed on an "AS IS" BASIS,        *
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ *  See the License for the specific language governing permissions and      *
+ *  limitations under the License.                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+#include <iostream>
+#include <string>
+
+#include "qunit.h"
+#include "Handle.h"
+#include "InterfaceFunctions.h"
+#include "ColumnarBlock.h"
+#include "PageZoneMap.h"
+
+// checks the zone maps built from ColumnarBlocks: a page is only ruled out by a range filter if
+// none of its blocks can hold a matching value, and the zone map survives being written out
+
+using namespace pdb;
+
+struct TestRow {
+    int key;
+    FixedString<10> date;
+
+    static void describeColumns(ColumnSchema<TestRow>& schema) {
+        schema.add("key", &TestRow::key);
+        schema.add("date", &TestRow::date);
+    }
+};
+
+// makes a block holding the keys [firstKey, firstKey + numRows) shipped on the given date
+Handle<ColumnarBlock<TestRow>> makeBlock(int firstKey, int numRows, std::string date) {
+    Handle<ColumnarBlock<TestRow>> block = makeObject<ColumnarBlock<TestRow>>(numRows);
+    for (int i = 0; i < numRows; i++) {
+        TestRow row;
+        row.key = firstKey + i;
+        row.date = date;
+        block->push_back(row);
+    }
+    return block;
+}
+
+// returns a filter on key alone
+ZoneMapFilter keyFilter(const int* lower, const int* upper) {
+    return ZoneMapFilter{ColumnRange::make("key", lower, upper)};
+}
+
+int main() {
+
+    QUnit::UnitTest qunit(std::cerr, QUnit::verbose);
+
+    makeObjectAllocatorBlock(16 * 1024 * 1024, true);
+
+    // a page with keys [100, 150) and [300, 350), shipped in 1994 and 1996
+    PageZoneMap zoneMap;
+    QUNIT_IS_TRUE(zoneMap.isEmpty());
+    makeBlock(300, 50, "1996-03-01")->addToZoneMap(zoneMap);
+    makeBlock(100, 50, "1994-07-01")->addToZoneMap(zoneMap);
+    QUNIT_IS_EQUAL(2, zoneMap.getRanges().size());
+
+    int low = 0;
+    int justBelow = 99;
+    int first = 100;
+    int middle = 200;
+    int last = 349;
+    int justAbove = 350;
+    int high = 1000;
+
+    // ranges that overlap [100, 349] keep the page, even when they fall in the gap between blocks
+    QUNIT_IS_TRUE(zoneMap.mayMatch(keyFilter(&low, &first)));
+    QUNIT_IS_TRUE(zoneMap.mayMatch(keyFilter(&last, &high)));
+    QUNIT_IS_TRUE(zoneMap.mayMatch(keyFilter(&middle, &middle)));
+    QUNIT_IS_TRUE(zoneMap.mayMatch(keyFilter(nullptr, &first)));
+    QUNIT_IS_TRUE(zoneMap.mayMatch(keyFilter(&last, nullptr)));
+    QUNIT_IS_TRUE(zoneMap.mayMatch(keyFilter(nullptr, nullptr)));
+
+    // ranges outside of it rule the page out
+    QUNIT_IS_FALSE(zoneMap.mayMatch(keyFilter(&low, &justBelow)));
+    QUNIT_IS_FALSE(zoneMap.mayMatch(keyFilter(&justAbove, &high)));
+    QUNIT_IS_FALSE(zoneMap.mayMatch(keyFilter(nullptr, &justBelow)));
+    QUNIT_IS_FALSE(zoneMap.mayMatch(keyFilter(&justAbove, nullptr)));
+
+    // strings are compared like the FixedStrings they are stored as
+    FixedString<10> from1994("1994-01-01");
+    FixedString<10> to1995("1995-10-01");
+    FixedString<10> from1997("1997-01-01");
+    FixedString<10> to1998("1998-12-31");
+    QUNIT_IS_TRUE(zoneMap.mayMatch(ZoneMapFilter{ColumnRange::make("date", &from1994, &to1995)}));
+    QUNIT_IS_FALSE(zoneMap.mayMatch(ZoneMapFilter{ColumnRange::make("date", &from1997, &to1998)}));
+
+    // every range of a filter has to overlap, and attributes the page knows nothing about do not
+    // rule it out
+    QUNIT_IS_FALSE(zoneMap.mayMatch(ZoneMapFilter{ColumnRange::make("key", &first, &last),
+                                                  ColumnRange::make("date", &from1997, &to1998)}));
+    QUNIT_IS_TRUE(zoneMap.mayMatch(ZoneMapFilter{ColumnRange::make("price", &low, &justBelow)}));
+
+    // the zone map is kept in the meta data of the file, so it has to survive being written out
+    std::vector<char> buffer(zoneMap.getSerializedSize());
+    zoneMap.serialize(buffer.data());
+    PageZoneMap readBack;
+    QUNIT_IS_EQUAL(buffer.size(), readBack.deserialize(buffer.data()));
+    QUNIT_IS_EQUAL(2, readBack.getRanges().size());
+    QUNIT_IS_TRUE(readBack.mayMatch(keyFilter(&middle, &middle)));
+    QUNIT_IS_FALSE(readBack.mayMatch(keyFilter(&justAbove, &high)));
+    QUNIT_IS_FALSE(
+        readBack.mayMatch(ZoneMapFilter{ColumnRange::make("date", &from1997, &to1998)}));
+
+    // an empty block has no statistics to add
+    PageZoneMap emptyMap;
+    Handle<ColumnarBlock<TestRow>> emptyBlock = makeObject<ColumnarBlock<TestRow>>(10);
+    emptyBlock->addToZoneMap(emptyMap);
+    QUNIT_IS_TRUE(emptyMap.isEmpty());
+    QUNIT_IS_TRUE(emptyMap.mayMatch(keyFilter(&justAbove, &high)));
+
+    return qunit.errors();
+}